@@ -0,0 +1,202 @@
+/*
+ * gdb-command-result.h - Structured GDB command result for mcp-gdb
+ *
+ * Copyright (C) 2025 Zach Podbielniak
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ *
+ * GdbCommandResult holds the parsed GDB/MI records answering one
+ * command, split by class, so callers can read fields directly instead
+ * of searching the raw output text.
+ */
+
+#ifndef GDB_COMMAND_RESULT_H
+#define GDB_COMMAND_RESULT_H
+
+#include <glib-object.h>
+#include <json-glib/json-glib.h>
+
+#include "gdb-enums.h"
+#include "gdb-mi-parser.h"
+
+G_BEGIN_DECLS
+
+/**
+ * GdbCommandResult:
+ *
+ * The records answering one GDB command: its result record, the
+ * console and target stream output, the async records (exec, status and
+ * notify) and the log stream output, each in the order GDB printed them.
+ * This is a reference-counted boxed type.
+ */
+typedef struct _GdbCommandResult GdbCommandResult;
+
+#define GDB_TYPE_COMMAND_RESULT (gdb_command_result_get_type ())
+
+GType gdb_command_result_get_type (void) G_GNUC_CONST;
+
+/**
+ * gdb_command_result_new:
+ *
+ * Creates an empty command result.
+ *
+ * Returns: (transfer full): a new #GdbCommandResult
+ */
+GdbCommandResult *gdb_command_result_new (void);
+
+/**
+ * gdb_command_result_new_from_records:
+ * @records: (element-type GdbMiRecord): records in the order GDB printed them
+ *
+ * Creates a command result and adds each of @records to it.
+ *
+ * Returns: (transfer full): a new #GdbCommandResult
+ */
+GdbCommandResult *gdb_command_result_new_from_records (GList *records);
+
+/**
+ * gdb_command_result_ref:
+ * @self: a #GdbCommandResult
+ *
+ * Increases the reference count of @self.
+ *
+ * Returns: (transfer full): @self
+ */
+GdbCommandResult *gdb_command_result_ref (GdbCommandResult *self);
+
+/**
+ * gdb_command_result_unref:
+ * @self: a #GdbCommandResult
+ *
+ * Decreases the reference count of @self.
+ * When the count reaches zero, the result is freed.
+ */
+void gdb_command_result_unref (GdbCommandResult *self);
+
+/**
+ * gdb_command_result_add_record:
+ * @self: a #GdbCommandResult
+ * @record: a parsed record
+ *
+ * Files @record under its class. A result record replaces any earlier
+ * one; prompts and unknown records are ignored.
+ */
+void gdb_command_result_add_record (GdbCommandResult *self,
+                                    GdbMiRecord      *record);
+
+/**
+ * gdb_command_result_get_result:
+ * @self: a #GdbCommandResult
+ *
+ * Gets the result record (^done, ^running, ^error, ...).
+ *
+ * Returns: (transfer none) (nullable): the result record, or %NULL
+ */
+GdbMiRecord *gdb_command_result_get_result (GdbCommandResult *self);
+
+/**
+ * gdb_command_result_get_result_class:
+ * @self: a #GdbCommandResult
+ *
+ * Gets the class of the result record.
+ *
+ * Returns: the #GdbMiResultClass, %GDB_MI_RESULT_ERROR if there is no
+ *     result record
+ */
+GdbMiResultClass gdb_command_result_get_result_class (GdbCommandResult *self);
+
+/**
+ * gdb_command_result_is_error:
+ * @self: a #GdbCommandResult
+ *
+ * Checks whether GDB answered the command with ^error.
+ *
+ * Returns: %TRUE on ^error
+ */
+gboolean gdb_command_result_is_error (GdbCommandResult *self);
+
+/**
+ * gdb_command_result_get_error_message:
+ * @self: a #GdbCommandResult
+ *
+ * Gets the message of an ^error result.
+ *
+ * Returns: (transfer none) (nullable): the message, or %NULL
+ */
+const gchar *gdb_command_result_get_error_message (GdbCommandResult *self);
+
+/**
+ * gdb_command_result_get_field:
+ * @self: a #GdbCommandResult
+ * @name: a field of the result record, e.g. "value"
+ *
+ * Gets a string field of the result record, e.g. the value of
+ * "-data-evaluate-expression".
+ *
+ * Returns: (transfer none) (nullable): the field, or %NULL if it is
+ *     missing or not a string
+ */
+const gchar *gdb_command_result_get_field (GdbCommandResult *self,
+                                           const gchar      *name);
+
+/**
+ * gdb_command_result_get_console:
+ * @self: a #GdbCommandResult
+ *
+ * Gets the console and target stream records.
+ *
+ * Returns: (transfer none) (element-type GdbMiRecord): the records
+ */
+GPtrArray *gdb_command_result_get_console (GdbCommandResult *self);
+
+/**
+ * gdb_command_result_get_async:
+ * @self: a #GdbCommandResult
+ *
+ * Gets the exec, status and notify async records.
+ *
+ * Returns: (transfer none) (element-type GdbMiRecord): the records
+ */
+GPtrArray *gdb_command_result_get_async (GdbCommandResult *self);
+
+/**
+ * gdb_command_result_get_log:
+ * @self: a #GdbCommandResult
+ *
+ * Gets the log stream records.
+ *
+ * Returns: (transfer none) (element-type GdbMiRecord): the records
+ */
+GPtrArray *gdb_command_result_get_log (GdbCommandResult *self);
+
+/**
+ * gdb_command_result_get_console_text:
+ * @self: a #GdbCommandResult
+ *
+ * Gets the console and target output as text, i.e. what the command
+ * would print in a CLI session. The text is built once and cached.
+ *
+ * Returns: (transfer none): the console text, possibly empty
+ */
+const gchar *gdb_command_result_get_console_text (GdbCommandResult *self);
+
+/**
+ * gdb_command_result_to_json:
+ * @self: a #GdbCommandResult
+ *
+ * Serializes the result for a tool response:
+ * |[
+ * { "class": "done", "results": { ... }, "console": "...",
+ *   "async": [ { "type": "exec", "class": "stopped", "results": { ... } } ],
+ *   "log": "..." }
+ * ]|
+ * Missing parts are omitted.
+ *
+ * Returns: (transfer full): a #JsonNode holding an object
+ */
+JsonNode *gdb_command_result_to_json (GdbCommandResult *self);
+
+G_DEFINE_AUTOPTR_CLEANUP_FUNC (GdbCommandResult, gdb_command_result_unref)
+
+G_END_DECLS
+
+#endif /* GDB_COMMAND_RESULT_H */
@@ -199,6 +199,43 @@ const gchar *gdb_mi_result_class_to_string (GdbMiResultClass result_class);
  */
 GdbMiResultClass gdb_mi_result_class_from_string (const gchar *str);
 
+
+/**
+ * GdbStartupProfile:
+ * @GDB_STARTUP_PROFILE_DEFAULT: Start GDB as a user would, reading gdbinit
+ * @GDB_STARTUP_PROFILE_FAST: Skip gdbinit and the banner, and apply the
+ *     session settings on the command line
+ *
+ * How a GDB session launches its process.
+ */
+typedef enum {
+    GDB_STARTUP_PROFILE_DEFAULT,
+    GDB_STARTUP_PROFILE_FAST
+} GdbStartupProfile;
+
+GType gdb_startup_profile_get_type (void) G_GNUC_CONST;
+#define GDB_TYPE_STARTUP_PROFILE (gdb_startup_profile_get_type ())
+
+/**
+ * gdb_startup_profile_to_string:
+ * @profile: a #GdbStartupProfile
+ *
+ * Converts a startup profile to its string representation.
+ *
+ * Returns: (transfer none): the string representation
+ */
+const gchar *gdb_startup_profile_to_string (GdbStartupProfile profile);
+
+/**
+ * gdb_startup_profile_from_string:
+ * @str: a string representation
+ *
+ * Converts a string to its startup profile value.
+ *
+ * Returns: the #GdbStartupProfile, or %GDB_STARTUP_PROFILE_DEFAULT if unknown
+ */
+GdbStartupProfile gdb_startup_profile_from_string (const gchar *str);
+
 G_END_DECLS
 
 #endif /* GDB_ENUMS_H */
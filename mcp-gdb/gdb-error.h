@@ -45,6 +45,7 @@ GQuark gdb_error_quark (void);
  * @GDB_ERROR_ALREADY_RUNNING: Session already has a running process
  * @GDB_ERROR_NOT_RUNNING: No program is running
  * @GDB_ERROR_INTERNAL: Internal error
+ * @GDB_ERROR_QUEUE_FULL: Session command queue is full
  *
  * Error codes for GDB MCP server operations.
  */
@@ -61,7 +62,8 @@ typedef enum {
     GDB_ERROR_ATTACH_FAILED,
     GDB_ERROR_ALREADY_RUNNING,
     GDB_ERROR_NOT_RUNNING,
-    GDB_ERROR_INTERNAL
+    GDB_ERROR_INTERNAL,
+    GDB_ERROR_QUEUE_FULL
 } GdbErrorCode;
 
 /**
@@ -59,12 +59,127 @@ void gdb_mcp_server_set_default_gdb_path (GdbMcpServer *self,
  */
 const gchar *gdb_mcp_server_get_default_gdb_path (GdbMcpServer *self);
 
+/**
+ * gdb_mcp_server_get_max_workers:
+ * @self: a #GdbMcpServer
+ *
+ * Gets the number of tool calls that may run at once.
+ *
+ * Returns: the number of concurrent tool calls
+ */
+guint gdb_mcp_server_get_max_workers (GdbMcpServer *self);
+
+/**
+ * gdb_mcp_server_set_max_workers:
+ * @self: a #GdbMcpServer
+ * @max_workers: the number of concurrent tool calls, at least 1
+ *
+ * Sets the number of tool calls that may run at once. Tool calls run as
+ * fibers so a slow command does not stall other sessions; calls on the
+ * same session still run one at a time.
+ */
+void gdb_mcp_server_set_max_workers (GdbMcpServer *self,
+                                     guint         max_workers);
+
+/**
+ * gdb_mcp_server_listen:
+ * @self: a #GdbMcpServer
+ * @host: (nullable): the address to bind, %NULL for 127.0.0.1
+ * @port: the TCP port, 0 to pick a free one
+ * @error: return location for error
+ *
+ * Serves MCP over streamable HTTP at "/mcp" instead of stdio. Every
+ * client that sends initialize gets its own MCP session and session
+ * manager, named by the Mcp-Session-Id response header; the manager
+ * takes its settings, except the pool size, from
+ * #GdbMcpServer:session-manager. Call before gdb_mcp_server_run().
+ *
+ * Requests are refused with 403 if their Host header does not name the
+ * bound address (or localhost, when it is a loopback address), or if
+ * they carry an Origin header that is not a loopback origin.
+ *
+ * A client that disconnects mid-response raises SIGPIPE; the caller
+ * should ignore it, as gdb-mcp-server does in main().
+ *
+ * Returns: %TRUE if the server is listening
+ */
+gboolean gdb_mcp_server_listen (GdbMcpServer  *self,
+                                const gchar   *host,
+                                guint          port,
+                                GError       **error);
+
+/**
+ * gdb_mcp_server_get_port:
+ * @self: a #GdbMcpServer
+ *
+ * Gets the port the server listens on, e.g. after listening on port 0.
+ *
+ * Returns: the port, or 0 when serving stdio
+ */
+guint gdb_mcp_server_get_port (GdbMcpServer *self);
+
+/**
+ * gdb_mcp_server_listen_socket:
+ * @self: a #GdbMcpServer
+ * @path: the filesystem path of the socket
+ * @error: return location for error
+ *
+ * Accepts MCP clients on an AF_UNIX stream socket at @path, each
+ * speaking newline-delimited JSON-RPC as over stdio. The socket is
+ * created with mode 0600, so only the owning user can connect. A socket
+ * at @path that refuses connections is replaced; if a server still
+ * accepts on it, this fails with %G_IO_ERROR_ADDRESS_IN_USE. The socket
+ * is removed when @self is disposed.
+ * Like gdb_mcp_server_listen(), each connection gets its own session
+ * manager unless #GdbMcpServer:share-sessions is set. Call before
+ * gdb_mcp_server_run(); it can be combined with gdb_mcp_server_listen().
+ *
+ * Returns: %TRUE if the server is listening
+ */
+gboolean gdb_mcp_server_listen_socket (GdbMcpServer  *self,
+                                       const gchar   *path,
+                                       GError       **error);
+
+/**
+ * gdb_mcp_server_get_share_sessions:
+ * @self: a #GdbMcpServer
+ *
+ * Gets whether HTTP and socket clients share the server's session
+ * manager.
+ *
+ * Returns: %TRUE if sessions are shared
+ */
+gboolean gdb_mcp_server_get_share_sessions (GdbMcpServer *self);
+
+/**
+ * gdb_mcp_server_set_share_sessions:
+ * @self: a #GdbMcpServer
+ * @share_sessions: whether to share sessions
+ *
+ * Sets whether HTTP and socket clients that connect from now on use the
+ * server's session manager instead of one of their own. Shared sessions
+ * outlive the client that started them.
+ */
+void gdb_mcp_server_set_share_sessions (GdbMcpServer *self,
+                                        gboolean      share_sessions);
+
+/**
+ * gdb_mcp_server_get_client_count:
+ * @self: a #GdbMcpServer
+ *
+ * Gets the number of clients connected over HTTP or the Unix socket.
+ *
+ * Returns: the client count
+ */
+guint gdb_mcp_server_get_client_count (GdbMcpServer *self);
+
 /**
  * gdb_mcp_server_run:
  * @self: a #GdbMcpServer
  *
  * Runs the server main loop. This function blocks until the server
- * is stopped via gdb_mcp_server_stop() or the client disconnects.
+ * is stopped via gdb_mcp_server_stop() or, when serving stdio, the
+ * client disconnects.
  */
 void gdb_mcp_server_run (GdbMcpServer *self);
 
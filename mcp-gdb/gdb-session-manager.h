@@ -17,6 +17,45 @@
 
 G_BEGIN_DECLS
 
+/**
+ * GdbSessionHandle:
+ *
+ * A compact session identifier: a slot number in the manager's session
+ * table and the generation of that slot. Handles of removed sessions
+ * never match a later session. The session ID string used by the tools
+ * is the handle written as "<slot>-<generation>".
+ */
+typedef guint64 GdbSessionHandle;
+
+/**
+ * GDB_SESSION_HANDLE_INVALID:
+ *
+ * A handle that never names a session.
+ */
+#define GDB_SESSION_HANDLE_INVALID ((GdbSessionHandle) 0)
+
+/**
+ * gdb_session_handle_parse:
+ * @session_id: (nullable): a session ID string
+ * @handle: (out): location for the handle
+ *
+ * Parses a session ID into its handle, without allocating.
+ *
+ * Returns: %TRUE if @session_id is well-formed
+ */
+gboolean gdb_session_handle_parse (const gchar      *session_id,
+                                   GdbSessionHandle *handle);
+
+/**
+ * gdb_session_handle_to_string:
+ * @handle: a #GdbSessionHandle
+ *
+ * Formats a handle as a session ID.
+ *
+ * Returns: (transfer full): the session ID
+ */
+gchar *gdb_session_handle_to_string (GdbSessionHandle handle);
+
 #define GDB_TYPE_SESSION_MANAGER (gdb_session_manager_get_type ())
 
 G_DECLARE_FINAL_TYPE (GdbSessionManager, gdb_session_manager, GDB, SESSION_MANAGER, GObject)
@@ -30,6 +69,20 @@ G_DECLARE_FINAL_TYPE (GdbSessionManager, gdb_session_manager, GDB, SESSION_MANAG
  */
 GdbSessionManager *gdb_session_manager_new (void);
 
+/**
+ * gdb_session_manager_new_sharing_limits:
+ * @other: a #GdbSessionManager
+ *
+ * Creates a new session manager with sessions of its own but the
+ * eviction limits of @other: idle timeout, session limit and memory
+ * budget. The limits then apply to the sessions of @other, the new
+ * manager and every other manager sharing them, taken together, and
+ * setting one on any of them sets it for all. Nothing else is copied.
+ *
+ * Returns: (transfer full): a new #GdbSessionManager
+ */
+GdbSessionManager *gdb_session_manager_new_sharing_limits (GdbSessionManager *other);
+
 /**
  * gdb_session_manager_get_default:
  *
@@ -79,6 +132,140 @@ guint gdb_session_manager_get_default_timeout_ms (GdbSessionManager *self);
 void gdb_session_manager_set_default_timeout_ms (GdbSessionManager *self,
                                                  guint              timeout_ms);
 
+/**
+ * gdb_session_manager_get_default_startup_profile:
+ * @self: a #GdbSessionManager
+ *
+ * Gets the startup profile for new sessions.
+ *
+ * Returns: the default #GdbStartupProfile
+ */
+GdbStartupProfile gdb_session_manager_get_default_startup_profile (GdbSessionManager *self);
+
+/**
+ * gdb_session_manager_set_default_startup_profile:
+ * @self: a #GdbSessionManager
+ * @profile: a #GdbStartupProfile
+ *
+ * Sets the startup profile for new sessions and the warm pool.
+ */
+void gdb_session_manager_set_default_startup_profile (GdbSessionManager *self,
+                                                      GdbStartupProfile  profile);
+
+/**
+ * gdb_session_manager_get_pool_size:
+ * @self: a #GdbSessionManager
+ *
+ * Gets the number of started GDB processes kept warm for new sessions.
+ *
+ * Returns: the pool size, 0 if the pool is disabled
+ */
+guint gdb_session_manager_get_pool_size (GdbSessionManager *self);
+
+/**
+ * gdb_session_manager_set_pool_size:
+ * @self: a #GdbSessionManager
+ * @pool_size: the pool size, 0 to disable the pool
+ *
+ * Sets the number of started GDB processes kept warm for new sessions.
+ * Missing sessions are started in the background on the main context
+ * that created @self; surplus ones are terminated.
+ */
+void gdb_session_manager_set_pool_size (GdbSessionManager *self,
+                                        guint              pool_size);
+
+/**
+ * gdb_session_manager_get_pool_count:
+ * @self: a #GdbSessionManager
+ *
+ * Gets the number of warm sessions ready to be handed out.
+ *
+ * Returns: the number of warm sessions
+ */
+guint gdb_session_manager_get_pool_count (GdbSessionManager *self);
+
+/**
+ * gdb_session_manager_get_idle_timeout:
+ * @self: a #GdbSessionManager
+ *
+ * Gets how long a session may go without commands before it is evicted.
+ *
+ * Returns: the idle timeout in seconds, 0 if idle sessions are kept
+ */
+guint gdb_session_manager_get_idle_timeout (GdbSessionManager *self);
+
+/**
+ * gdb_session_manager_set_idle_timeout:
+ * @self: a #GdbSessionManager
+ * @seconds: the idle timeout, 0 to keep idle sessions
+ *
+ * Sets how long a session may go without commands before it is evicted
+ * and #GdbSessionManager::session-removed is emitted for it. Sessions
+ * that are busy (see gdb_session_is_busy()) are never evicted.
+ */
+void gdb_session_manager_set_idle_timeout (GdbSessionManager *self,
+                                           guint              seconds);
+
+/**
+ * gdb_session_manager_get_max_sessions:
+ * @self: a #GdbSessionManager
+ *
+ * Gets the number of sessions kept before the least recently used are
+ * evicted.
+ *
+ * Returns: the session limit, 0 if there is none
+ */
+guint gdb_session_manager_get_max_sessions (GdbSessionManager *self);
+
+/**
+ * gdb_session_manager_set_max_sessions:
+ * @self: a #GdbSessionManager
+ * @max_sessions: the session limit, 0 for none
+ *
+ * Sets the number of sessions kept. Creating a session beyond the limit
+ * evicts the least recently used idle session first. Busy sessions are
+ * never evicted, so the limit can be exceeded while they all are.
+ */
+void gdb_session_manager_set_max_sessions (GdbSessionManager *self,
+                                           guint              max_sessions);
+
+/**
+ * gdb_session_manager_get_memory_budget:
+ * @self: a #GdbSessionManager
+ *
+ * Gets the resident memory the GDB processes may use in total.
+ *
+ * Returns: the budget in bytes, 0 if there is none
+ */
+guint64 gdb_session_manager_get_memory_budget (GdbSessionManager *self);
+
+/**
+ * gdb_session_manager_set_memory_budget:
+ * @self: a #GdbSessionManager
+ * @bytes: the budget, 0 for none
+ *
+ * Sets the resident memory the GDB processes may use in total, as
+ * reported by gdb_session_get_rss(). While they use more, the least
+ * recently used idle sessions are evicted.
+ */
+void gdb_session_manager_set_memory_budget (GdbSessionManager *self,
+                                            guint64            bytes);
+
+/**
+ * gdb_session_manager_reap:
+ * @self: a #GdbSessionManager
+ *
+ * Evicts the sessions over the idle timeout, session limit and memory
+ * budget now, least recently used first, from @self and every manager
+ * sharing its limits (see gdb_session_manager_new_sharing_limits()).
+ * This also runs periodically on the main context that created the
+ * first of them while any limit is set, and before each session is
+ * created.
+ *
+ * Returns: the number of sessions evicted
+ */
+guint gdb_session_manager_reap (GdbSessionManager *self);
+
 /**
  * gdb_session_manager_get_session_count:
  * @self: a #GdbSessionManager
@@ -96,7 +283,11 @@ guint gdb_session_manager_get_session_count (GdbSessionManager *self);
  * @working_dir: (nullable): working directory
  *
  * Creates a new session with a unique ID.
- * The session is not started; call gdb_session_start_async() on it.
+ *
+ * If @gdb_path is the default, @working_dir is %NULL and the warm pool
+ * has a session, that session is returned already started
+ * (%GDB_SESSION_STATE_READY). Otherwise the session is not started; call
+ * gdb_session_start_async() on it.
  *
  * Returns: (transfer full): a new #GdbSession
  */
@@ -104,18 +295,74 @@ GdbSession *gdb_session_manager_create_session (GdbSessionManager *self,
                                                 const gchar       *gdb_path,
                                                 const gchar       *working_dir);
 
+/**
+ * gdb_session_manager_create_session_full:
+ * @self: a #GdbSessionManager
+ * @gdb_path: (nullable): path to GDB, or %NULL for default
+ * @working_dir: (nullable): working directory
+ * @profile: how to launch GDB
+ * @init_script: (nullable): GDB command file to run at startup
+ * @auto_load_safe_path: (nullable): auto-load safe path for GDB
+ *
+ * Like gdb_session_manager_create_session(), with the startup options
+ * of the session. A warm session is only handed out for the default
+ * profile and no init script or safe path.
+ *
+ * Returns: (transfer full): a new #GdbSession
+ */
+GdbSession *gdb_session_manager_create_session_full (GdbSessionManager *self,
+                                                     const gchar       *gdb_path,
+                                                     const gchar       *working_dir,
+                                                     GdbStartupProfile  profile,
+                                                     const gchar       *init_script,
+                                                     const gchar       *auto_load_safe_path);
+
 /**
  * gdb_session_manager_get_session:
  * @self: a #GdbSessionManager
  * @session_id: the session ID
  *
- * Gets a session by its ID.
+ * Gets a session by its ID. The session is only guaranteed to stay alive
+ * while nobody removes it, which no caller can know once tool calls run
+ * concurrently.
  *
  * Returns: (transfer none) (nullable): the #GdbSession, or %NULL if not found
+ *
+ * Deprecated: Use gdb_session_manager_lookup_session(), which returns a
+ *   reference that outlives a concurrent removal.
  */
+G_GNUC_DEPRECATED_FOR (gdb_session_manager_lookup_session)
 GdbSession *gdb_session_manager_get_session (GdbSessionManager *self,
                                              const gchar       *session_id);
 
+/**
+ * gdb_session_manager_lookup_session:
+ * @self: a #GdbSessionManager
+ * @session_id: the session ID
+ *
+ * Gets a session by its ID and takes a reference on it, so the session
+ * outlives a concurrent removal. A removed session is terminated, and
+ * commands on it fail instead of touching freed memory. Safe to call
+ * from any thread.
+ *
+ * Returns: (transfer full) (nullable): the #GdbSession, or %NULL if not found
+ */
+GdbSession *gdb_session_manager_lookup_session (GdbSessionManager *self,
+                                                const gchar       *session_id);
+
+/**
+ * gdb_session_manager_lookup_handle:
+ * @self: a #GdbSessionManager
+ * @handle: a #GdbSessionHandle
+ *
+ * Like gdb_session_manager_lookup_session(), for a parsed handle: one
+ * array index and generation compare, with no hashing or locking.
+ *
+ * Returns: (transfer full) (nullable): the #GdbSession, or %NULL if not found
+ */
+GdbSession *gdb_session_manager_lookup_handle (GdbSessionManager *self,
+                                               GdbSessionHandle   handle);
+
 /**
  * gdb_session_manager_remove_session:
  * @self: a #GdbSessionManager
@@ -15,15 +15,12 @@
 #include <glib-object.h>
 #include <gio/gio.h>
 #include <json-glib/json-glib.h>
+#include <libdex.h>
 
+#include "gdb-command-result.h"
 #include "gdb-enums.h"
 #include "gdb-mi-parser.h"
 
-/* Default delay (ms) after writing command before reading output.
- * Override with GDB_MCP_POST_COMMAND_DELAY_MS environment variable.
- */
-#define DEFAULT_POST_COMMAND_DELAY_MS 2000
-
 G_BEGIN_DECLS
 
 #define GDB_TYPE_SESSION (gdb_session_get_type ())
@@ -135,6 +132,142 @@ guint gdb_session_get_timeout_ms (GdbSession *self);
 void gdb_session_set_timeout_ms (GdbSession *self,
                                  guint       timeout_ms);
 
+/**
+ * gdb_session_get_max_queue_depth:
+ * @self: a #GdbSession
+ *
+ * Gets the maximum number of commands that may wait in the session's
+ * normal command lane.
+ *
+ * Returns: the queue depth
+ */
+guint gdb_session_get_max_queue_depth (GdbSession *self);
+
+/**
+ * gdb_session_set_max_queue_depth:
+ * @self: a #GdbSession
+ * @depth: the maximum number of queued commands, at least 1
+ *
+ * Sets the queue depth. Commands submitted while the normal lane is
+ * full fail with %GDB_ERROR_QUEUE_FULL. Interrupts and quit use the
+ * control lane and are never refused.
+ */
+void gdb_session_set_max_queue_depth (GdbSession *self,
+                                      guint       depth);
+
+/**
+ * gdb_session_get_startup_profile:
+ * @self: a #GdbSession
+ *
+ * Gets how the session launches GDB.
+ *
+ * Returns: the #GdbStartupProfile
+ */
+GdbStartupProfile gdb_session_get_startup_profile (GdbSession *self);
+
+/**
+ * gdb_session_set_startup_profile:
+ * @self: a #GdbSession
+ * @profile: a #GdbStartupProfile
+ *
+ * Sets how the next gdb_session_start_async() launches GDB. With
+ * %GDB_STARTUP_PROFILE_FAST, GDB is started with `-nx -q` and the
+ * session settings (pagination, width, height, confirm, print pretty)
+ * are passed with `-iex` in the same spawn.
+ */
+void gdb_session_set_startup_profile (GdbSession        *self,
+                                      GdbStartupProfile  profile);
+
+/**
+ * gdb_session_get_init_script:
+ * @self: a #GdbSession
+ *
+ * Gets the GDB command file run at startup.
+ *
+ * Returns: (transfer none) (nullable): the script path, or %NULL
+ */
+const gchar *gdb_session_get_init_script (GdbSession *self);
+
+/**
+ * gdb_session_set_init_script:
+ * @self: a #GdbSession
+ * @path: (nullable): a GDB command file, or %NULL for none
+ *
+ * Sets a command file GDB runs (`-x`) before its first prompt.
+ */
+void gdb_session_set_init_script (GdbSession  *self,
+                                  const gchar *path);
+
+/**
+ * gdb_session_get_auto_load_safe_path:
+ * @self: a #GdbSession
+ *
+ * Gets the auto-load safe path passed to GDB.
+ *
+ * Returns: (transfer none) (nullable): the safe path, or %NULL
+ */
+const gchar *gdb_session_get_auto_load_safe_path (GdbSession *self);
+
+/**
+ * gdb_session_set_auto_load_safe_path:
+ * @self: a #GdbSession
+ * @path: (nullable): colon-separated directories, or %NULL to keep
+ *     GDB's own setting
+ *
+ * Sets the directories GDB may auto-load scripts (e.g. pretty-printers)
+ * from. Applied with `-iex` before GDB loads any file.
+ */
+void gdb_session_set_auto_load_safe_path (GdbSession  *self,
+                                          const gchar *path);
+
+/**
+ * gdb_session_get_startup_time:
+ * @self: a #GdbSession
+ *
+ * Gets how long GDB took from being spawned to its first prompt, i.e.
+ * the time until the first command could be sent.
+ *
+ * Returns: the startup time in microseconds, or -1 if the session has
+ *     not started
+ */
+gint64 gdb_session_get_startup_time (GdbSession *self);
+
+/**
+ * gdb_session_get_last_used:
+ * @self: a #GdbSession
+ *
+ * Gets when a command was last submitted to or answered by @self, or
+ * when @self was created if it has run no command yet.
+ *
+ * Returns: a g_get_monotonic_time() timestamp
+ */
+gint64 gdb_session_get_last_used (GdbSession *self);
+
+/**
+ * gdb_session_is_busy:
+ * @self: a #GdbSession
+ *
+ * Checks whether @self is starting, has commands queued or in flight, or
+ * is running its target, i.e. whether terminating it would interrupt
+ * work in progress.
+ *
+ * Returns: %TRUE if @self is busy
+ */
+gboolean gdb_session_is_busy (GdbSession *self);
+
+/**
+ * gdb_session_get_rss:
+ * @self: a #GdbSession
+ *
+ * Gets the resident memory of the GDB process, read from
+ * `/proc/<pid>/statm`. Symbol tables of large programs can make this
+ * several gigabytes.
+ *
+ * Returns: the resident set size in bytes, or 0 if GDB is not running or
+ *     the size cannot be read
+ */
+guint64 gdb_session_get_rss (GdbSession *self);
+
 /**
  * gdb_session_start_async:
  * @self: a #GdbSession
@@ -163,6 +296,18 @@ gboolean gdb_session_start_finish (GdbSession    *self,
                                    GAsyncResult  *result,
                                    GError       **error);
 
+/**
+ * gdb_session_start_future:
+ * @self: a #GdbSession
+ *
+ * Like gdb_session_start_async(), but returns a future that a fiber can
+ * await with dex_await_boolean().
+ *
+ * Returns: (transfer full): a #DexFuture resolving to %TRUE once GDB is
+ *     ready, or rejecting with the start error
+ */
+DexFuture *gdb_session_start_future (GdbSession *self);
+
 /**
  * gdb_session_execute_async:
  * @self: a #GdbSession
@@ -171,8 +316,23 @@ gboolean gdb_session_start_finish (GdbSession    *self,
  * @callback: callback to call when complete
  * @user_data: user data for @callback
  *
- * Executes a GDB command and returns the parsed MI output.
- * The session must be in the READY or STOPPED state.
+ * Executes a GDB command and returns its output. The command is
+ * tagged with a numeric token; the operation completes as soon as the
+ * result record carrying that token and the following prompt have been
+ * read (after *stopped for commands answering ^running).
+ * The session must be in the READY or STOPPED state, except for control
+ * commands ("-exec-interrupt", "interrupt", "-gdb-exit", "quit"), which
+ * are also accepted while the target runs.
+ *
+ * Commands wait in a per-session queue before they are written. Control
+ * commands are written ahead of everything else; other commands fail
+ * with %GDB_ERROR_QUEUE_FULL once #GdbSession:max-queue-depth commands
+ * are waiting.
+ *
+ * Cancelling @cancellable completes the operation right away. A command
+ * that resumed the target is interrupted with "-exec-interrupt", and
+ * the rest of the command's output is consumed before further commands
+ * are written.
  */
 void gdb_session_execute_async (GdbSession          *self,
                                 const gchar         *command,
@@ -194,6 +354,134 @@ gchar *gdb_session_execute_finish (GdbSession    *self,
                                    GAsyncResult  *result,
                                    GError       **error);
 
+/**
+ * gdb_session_execute_get_queue_time:
+ * @self: a #GdbSession
+ * @result: the #GAsyncResult of an execute operation
+ *
+ * Gets how long the command waited in the session's queue before it
+ * was written to GDB. For a batch this is the wait of the whole batch.
+ * Valid in the completion callback, before or after the finish call.
+ *
+ * Returns: the wait in microseconds, or -1 if the command was never
+ *     written
+ */
+gint64 gdb_session_execute_get_queue_time (GdbSession   *self,
+                                           GAsyncResult *result);
+
+/**
+ * gdb_session_execute_detached_async:
+ * @self: a #GdbSession
+ * @command: an execution command, e.g. "continue" or "-exec-next"
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when complete
+ * @user_data: user data for @callback
+ *
+ * Like gdb_session_execute_async(), but for commands that resume the
+ * target: the operation completes once GDB has answered ^running,
+ * without waiting for the target to stop. The stop is delivered later
+ * through the #GdbSession::stopped signal and
+ * gdb_session_wait_for_stop_async().
+ */
+void gdb_session_execute_detached_async (GdbSession          *self,
+                                         const gchar         *command,
+                                         GCancellable        *cancellable,
+                                         GAsyncReadyCallback  callback,
+                                         gpointer             user_data);
+
+/**
+ * gdb_session_execute_detached_finish:
+ * @self: a #GdbSession
+ * @result: the #GAsyncResult
+ * @run_id: (out) (optional): return location for the run ID, or 0 if
+ *     the command did not resume the target
+ * @error: (nullable): return location for a #GError
+ *
+ * Completes a detached execute operation.
+ *
+ * Returns: (transfer full) (nullable): the output up to ^running, or
+ *     %NULL on error
+ */
+gchar *gdb_session_execute_detached_finish (GdbSession    *self,
+                                            GAsyncResult  *result,
+                                            guint64       *run_id,
+                                            GError       **error);
+
+/**
+ * gdb_session_execute_detached_future:
+ * @self: a #GdbSession
+ * @command: an execution command, e.g. "continue" or "-exec-next"
+ *
+ * Like gdb_session_execute_detached_async(), but returns a future that a
+ * fiber can await with dex_await_object(). It resolves to the
+ * #GAsyncResult, from which gdb_session_execute_detached_finish() gets
+ * the output, the run ID and any error.
+ *
+ * Returns: (transfer full): a #DexFuture resolving to a #GAsyncResult
+ */
+DexFuture *gdb_session_execute_detached_future (GdbSession  *self,
+                                                const gchar *command);
+
+/**
+ * gdb_session_wait_for_stop_async:
+ * @self: a #GdbSession
+ * @run_id: the run ID from gdb_session_execute_detached_finish(), or 0
+ *     for the most recent run
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when complete
+ * @user_data: user data for @callback
+ *
+ * Waits until the target stops after the given run. Completes right
+ * away if it already has. There is no timeout; use @cancellable to stop
+ * waiting.
+ */
+void gdb_session_wait_for_stop_async (GdbSession          *self,
+                                      guint64              run_id,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data);
+
+/**
+ * gdb_session_wait_for_stop_finish:
+ * @self: a #GdbSession
+ * @result: the #GAsyncResult
+ * @reason: (out) (optional): return location for the stop reason
+ * @details: (out) (optional) (transfer full) (nullable): return location
+ *     for the fields of the *stopped record
+ * @output: (out) (optional) (transfer full): return location for the
+ *     output GDB printed while the target ran
+ * @error: (nullable): return location for a #GError
+ *
+ * Completes a wait-for-stop operation. If the target has stopped more
+ * than once since the run, the latest stop is reported.
+ *
+ * Returns: %TRUE on success
+ */
+gboolean gdb_session_wait_for_stop_finish (GdbSession     *self,
+                                           GAsyncResult   *result,
+                                           GdbStopReason  *reason,
+                                           JsonObject    **details,
+                                           gchar         **output,
+                                           GError        **error);
+
+/**
+ * gdb_session_wait_for_stop_future:
+ * @self: a #GdbSession
+ * @run_id: the run ID, or 0 for the most recent run
+ * @cancellable: (nullable): a #GCancellable
+ *
+ * Like gdb_session_wait_for_stop_async(), but returns a future that a
+ * fiber can await with dex_await_object(). It resolves to the
+ * #GAsyncResult, to be passed to gdb_session_wait_for_stop_finish().
+ * Cancel @cancellable when giving up on the future, or the wait stays
+ * pending until the target stops.
+ *
+ * Returns: (transfer full): a #DexFuture resolving to a #GAsyncResult
+ */
+DexFuture *gdb_session_wait_for_stop_future (GdbSession   *self,
+                                             guint64       run_id,
+                                             GCancellable *cancellable);
+
 /**
  * gdb_session_execute_mi_async:
  * @self: a #GdbSession
@@ -224,15 +512,195 @@ GList *gdb_session_execute_mi_finish (GdbSession    *self,
                                       GAsyncResult  *result,
                                       GError       **error);
 
+/**
+ * gdb_session_execute_result_async:
+ * @self: a #GdbSession
+ * @command: the GDB command to execute
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when complete
+ * @user_data: user data for @callback
+ *
+ * Like gdb_session_execute_async(), but returns the parsed records
+ * split by class as a #GdbCommandResult instead of the raw output text.
+ * No text is accumulated for the command, so large outputs are parsed
+ * once and never searched again.
+ */
+void gdb_session_execute_result_async (GdbSession          *self,
+                                       const gchar         *command,
+                                       GCancellable        *cancellable,
+                                       GAsyncReadyCallback  callback,
+                                       gpointer             user_data);
+
+/**
+ * gdb_session_execute_result_finish:
+ * @self: a #GdbSession
+ * @result: the #GAsyncResult
+ * @error: (nullable): return location for a #GError
+ *
+ * Completes a structured execute operation. Like
+ * gdb_session_execute_finish(), an ^error answer is reported as
+ * %GDB_ERROR_COMMAND_FAILED.
+ *
+ * Returns: (transfer full) (nullable): the result, or %NULL on error
+ */
+GdbCommandResult *gdb_session_execute_result_finish (GdbSession    *self,
+                                                     GAsyncResult  *result,
+                                                     GError       **error);
+
+/**
+ * gdb_session_execute_future:
+ * @self: a #GdbSession
+ * @command: the GDB command to execute
+ *
+ * Like gdb_session_execute_async(), but returns a future that a fiber can
+ * await with dex_await_string(), without a main loop of its own.
+ *
+ * Returns: (transfer full): a #DexFuture resolving to the output, or
+ *     rejecting with the same errors as gdb_session_execute_finish()
+ */
+DexFuture *gdb_session_execute_future (GdbSession  *self,
+                                       const gchar *command);
+
+/**
+ * gdb_session_execute_result_future:
+ * @self: a #GdbSession
+ * @command: the GDB command to execute
+ *
+ * Like gdb_session_execute_result_async(), but returns a future that a
+ * fiber can await with dex_await_boxed().
+ *
+ * Returns: (transfer full): a #DexFuture resolving to a #GdbCommandResult,
+ *     or rejecting with the same errors as
+ *     gdb_session_execute_result_finish()
+ */
+DexFuture *gdb_session_execute_result_future (GdbSession  *self,
+                                              const gchar *command);
+
+/**
+ * gdb_session_execute_batch_async:
+ * @self: a #GdbSession
+ * @commands: (array zero-terminated=1): the GDB commands to execute
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when complete
+ * @user_data: user data for @callback
+ *
+ * Executes several GDB commands as a pipelined batch. All commands are
+ * token-tagged and written to GDB with a single write, so independent
+ * commands cost one pipe round trip instead of one each. GDB still
+ * executes them in order, so the Nth command times out after N times
+ * #GdbSession:timeout-ms from submission rather than after one.
+ */
+void gdb_session_execute_batch_async (GdbSession          *self,
+                                      const gchar * const *commands,
+                                      GCancellable        *cancellable,
+                                      GAsyncReadyCallback  callback,
+                                      gpointer             user_data);
+
+/**
+ * gdb_session_execute_batch_finish:
+ * @self: a #GdbSession
+ * @result: the #GAsyncResult
+ * @error: (nullable): return location for a #GError
+ *
+ * Completes a batch execute operation. The result holds one entry per
+ * command, in order: its output as returned by
+ * gdb_session_execute_finish(), or %NULL if GDB answered it with ^error.
+ * Timeouts, cancellation and GDB exiting fail the whole batch.
+ *
+ * Returns: (transfer full) (element-type utf8) (nullable): the outputs
+ */
+GPtrArray *gdb_session_execute_batch_finish (GdbSession    *self,
+                                             GAsyncResult  *result,
+                                             GError       **error);
+
+/**
+ * gdb_session_execute_batch_future:
+ * @self: a #GdbSession
+ * @commands: (array zero-terminated=1): the GDB commands to execute
+ *
+ * Like gdb_session_execute_batch_async(), but returns a future that a
+ * fiber can await with dex_await_boxed().
+ *
+ * Returns: (transfer full): a #DexFuture resolving to a #GPtrArray of
+ *     outputs, or rejecting with the same errors as
+ *     gdb_session_execute_batch_finish()
+ */
+DexFuture *gdb_session_execute_batch_future (GdbSession          *self,
+                                             const gchar * const *commands);
+
+/**
+ * gdb_session_execute_result_batch_async:
+ * @self: a #GdbSession
+ * @commands: (array zero-terminated=1): the GDB commands to execute
+ * @cancellable: (nullable): a #GCancellable
+ * @callback: callback to call when complete
+ * @user_data: user data for @callback
+ *
+ * Like gdb_session_execute_batch_async(), but keeps the parsed records
+ * answering each command instead of its output text.
+ */
+void gdb_session_execute_result_batch_async (GdbSession          *self,
+                                             const gchar * const *commands,
+                                             GCancellable        *cancellable,
+                                             GAsyncReadyCallback  callback,
+                                             gpointer             user_data);
+
+/**
+ * gdb_session_execute_result_batch_finish:
+ * @self: a #GdbSession
+ * @result: the #GAsyncResult
+ * @error: (nullable): return location for a #GError
+ *
+ * Completes a structured batch execute operation. The result holds one
+ * #GdbCommandResult per command, in order. A command GDB answered with
+ * ^error has one too, for which gdb_command_result_is_error() is %TRUE.
+ * Timeouts, cancellation and GDB exiting fail the whole batch.
+ *
+ * Returns: (transfer full) (element-type GdbCommandResult) (nullable):
+ *     the results
+ */
+GPtrArray *gdb_session_execute_result_batch_finish (GdbSession    *self,
+                                                    GAsyncResult  *result,
+                                                    GError       **error);
+
+/**
+ * gdb_session_execute_result_batch_future:
+ * @self: a #GdbSession
+ * @commands: (array zero-terminated=1): the GDB commands to execute
+ *
+ * Like gdb_session_execute_result_batch_async(), but returns a future
+ * that a fiber can await with dex_await_boxed().
+ *
+ * Returns: (transfer full): a #DexFuture resolving to a #GPtrArray of
+ *     #GdbCommandResult, or rejecting with the same errors as
+ *     gdb_session_execute_result_batch_finish()
+ */
+DexFuture *gdb_session_execute_result_batch_future (GdbSession          *self,
+                                                    const gchar * const *commands);
+
 /**
  * gdb_session_terminate:
  * @self: a #GdbSession
  *
  * Terminates the GDB subprocess.
- * Sends "quit" command first, then force kills if needed.
+ * Sends "quit" command first, then force kills if needed. The session is
+ * cleaned up, and #GdbSession::terminated emitted, as soon as GDB exits;
+ * a GDB still running after 500 ms is killed.
  */
 void gdb_session_terminate (GdbSession *self);
 
+/**
+ * gdb_session_terminate_many:
+ * @sessions: (element-type GdbSession): the sessions to terminate
+ *
+ * Terminates a group of sessions at once. "quit" is sent to every GDB
+ * without blocking, and a single deadline force kills all that are
+ * still running, so the group is torn down in about the time one
+ * session takes regardless of its size. Sessions that are already
+ * terminating are left alone.
+ */
+void gdb_session_terminate_many (GPtrArray *sessions);
+
 /**
  * gdb_session_get_mi_parser:
  * @self: a #GdbSession
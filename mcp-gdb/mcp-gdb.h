@@ -16,6 +16,7 @@
 #include <mcp-gdb/gdb-enums.h>
 #include <mcp-gdb/gdb-error.h>
 #include <mcp-gdb/gdb-mi-parser.h>
+#include <mcp-gdb/gdb-command-result.h>
 #include <mcp-gdb/gdb-session.h>
 #include <mcp-gdb/gdb-session-manager.h>
 #include <mcp-gdb/gdb-mcp-server.h>
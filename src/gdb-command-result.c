@@ -0,0 +1,361 @@
+/*
+ * gdb-command-result.c - Structured GDB command result for mcp-gdb
+ *
+ * Copyright (C) 2025 Zach Podbielniak
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include "mcp-gdb/gdb-command-result.h"
+
+/* ========================================================================== */
+/* GdbCommandResult Boxed Type                                                */
+/* ========================================================================== */
+
+struct _GdbCommandResult
+{
+    volatile gint  ref_count;
+    GdbMiRecord   *result;
+    GPtrArray     *console;       /* Console and target stream records */
+    GPtrArray     *async;         /* Exec, status and notify records */
+    GPtrArray     *log;           /* Log stream records */
+    gchar         *console_text;  /* Built on first request */
+};
+
+GdbCommandResult *
+gdb_command_result_new (void)
+{
+    GdbCommandResult *self;
+
+    self = g_slice_new0 (GdbCommandResult);
+    self->ref_count = 1;
+    self->console = g_ptr_array_new_with_free_func ((GDestroyNotify) gdb_mi_record_unref);
+    self->async = g_ptr_array_new_with_free_func ((GDestroyNotify) gdb_mi_record_unref);
+    self->log = g_ptr_array_new_with_free_func ((GDestroyNotify) gdb_mi_record_unref);
+
+    return self;
+}
+
+GdbCommandResult *
+gdb_command_result_new_from_records (GList *records)
+{
+    GdbCommandResult *self;
+    GList *l;
+
+    self = gdb_command_result_new ();
+    for (l = records; l != NULL; l = l->next)
+    {
+        gdb_command_result_add_record (self, l->data);
+    }
+
+    return self;
+}
+
+GdbCommandResult *
+gdb_command_result_ref (GdbCommandResult *self)
+{
+    g_return_val_if_fail (self != NULL, NULL);
+
+    g_atomic_int_inc (&self->ref_count);
+
+    return self;
+}
+
+void
+gdb_command_result_unref (GdbCommandResult *self)
+{
+    if (self == NULL)
+    {
+        return;
+    }
+
+    if (g_atomic_int_dec_and_test (&self->ref_count))
+    {
+        g_clear_pointer (&self->result, gdb_mi_record_unref);
+        g_ptr_array_unref (self->console);
+        g_ptr_array_unref (self->async);
+        g_ptr_array_unref (self->log);
+        g_free (self->console_text);
+        g_slice_free (GdbCommandResult, self);
+    }
+}
+
+G_DEFINE_BOXED_TYPE (GdbCommandResult, gdb_command_result,
+                     gdb_command_result_ref, gdb_command_result_unref)
+
+/* ========================================================================== */
+/* Building                                                                   */
+/* ========================================================================== */
+
+void
+gdb_command_result_add_record (GdbCommandResult *self,
+                               GdbMiRecord      *record)
+{
+    g_return_if_fail (self != NULL);
+    g_return_if_fail (record != NULL);
+
+    switch (gdb_mi_record_get_type_enum (record))
+    {
+        case GDB_MI_RECORD_RESULT:
+            g_clear_pointer (&self->result, gdb_mi_record_unref);
+            self->result = gdb_mi_record_ref (record);
+            break;
+        case GDB_MI_RECORD_CONSOLE:
+        case GDB_MI_RECORD_TARGET:
+            g_ptr_array_add (self->console, gdb_mi_record_ref (record));
+            g_clear_pointer (&self->console_text, g_free);
+            break;
+        case GDB_MI_RECORD_EXEC_ASYNC:
+        case GDB_MI_RECORD_STATUS_ASYNC:
+        case GDB_MI_RECORD_NOTIFY_ASYNC:
+            g_ptr_array_add (self->async, gdb_mi_record_ref (record));
+            break;
+        case GDB_MI_RECORD_LOG:
+            g_ptr_array_add (self->log, gdb_mi_record_ref (record));
+            break;
+        case GDB_MI_RECORD_PROMPT:
+        case GDB_MI_RECORD_UNKNOWN:
+        default:
+            break;
+    }
+}
+
+/* ========================================================================== */
+/* Accessors                                                                  */
+/* ========================================================================== */
+
+GdbMiRecord *
+gdb_command_result_get_result (GdbCommandResult *self)
+{
+    g_return_val_if_fail (self != NULL, NULL);
+
+    return self->result;
+}
+
+GdbMiResultClass
+gdb_command_result_get_result_class (GdbCommandResult *self)
+{
+    g_return_val_if_fail (self != NULL, GDB_MI_RESULT_ERROR);
+
+    if (self->result == NULL)
+    {
+        return GDB_MI_RESULT_ERROR;
+    }
+
+    return gdb_mi_record_get_result_class (self->result);
+}
+
+gboolean
+gdb_command_result_is_error (GdbCommandResult *self)
+{
+    g_return_val_if_fail (self != NULL, TRUE);
+
+    return self->result != NULL && gdb_mi_record_is_error (self->result);
+}
+
+const gchar *
+gdb_command_result_get_error_message (GdbCommandResult *self)
+{
+    g_return_val_if_fail (self != NULL, NULL);
+
+    if (!gdb_command_result_is_error (self))
+    {
+        return NULL;
+    }
+
+    return gdb_mi_record_get_error_message (self->result);
+}
+
+const gchar *
+gdb_command_result_get_field (GdbCommandResult *self,
+                              const gchar      *name)
+{
+    JsonObject *results;
+    JsonNode *node;
+
+    g_return_val_if_fail (self != NULL, NULL);
+    g_return_val_if_fail (name != NULL, NULL);
+
+    if (self->result == NULL)
+    {
+        return NULL;
+    }
+
+    results = gdb_mi_record_get_results (self->result);
+    if (results == NULL)
+    {
+        return NULL;
+    }
+
+    node = json_object_get_member (results, name);
+    if (node == NULL || !JSON_NODE_HOLDS_VALUE (node) ||
+        json_node_get_value_type (node) != G_TYPE_STRING)
+    {
+        return NULL;
+    }
+
+    return json_node_get_string (node);
+}
+
+GPtrArray *
+gdb_command_result_get_console (GdbCommandResult *self)
+{
+    g_return_val_if_fail (self != NULL, NULL);
+
+    return self->console;
+}
+
+GPtrArray *
+gdb_command_result_get_async (GdbCommandResult *self)
+{
+    g_return_val_if_fail (self != NULL, NULL);
+
+    return self->async;
+}
+
+GPtrArray *
+gdb_command_result_get_log (GdbCommandResult *self)
+{
+    g_return_val_if_fail (self != NULL, NULL);
+
+    return self->log;
+}
+
+/*
+ * join_streams:
+ * @records: (element-type GdbMiRecord): stream records
+ *
+ * Returns: (transfer full): the stream contents, concatenated
+ */
+static gchar *
+join_streams (GPtrArray *records)
+{
+    GString *text;
+    guint i;
+
+    text = g_string_new (NULL);
+    for (i = 0; i < records->len; i++)
+    {
+        const gchar *content;
+
+        content = gdb_mi_record_get_stream_content (g_ptr_array_index (records, i));
+        if (content != NULL)
+        {
+            g_string_append (text, content);
+        }
+    }
+
+    return g_string_free (text, FALSE);
+}
+
+const gchar *
+gdb_command_result_get_console_text (GdbCommandResult *self)
+{
+    g_return_val_if_fail (self != NULL, NULL);
+
+    if (self->console_text == NULL)
+    {
+        self->console_text = join_streams (self->console);
+    }
+
+    return self->console_text;
+}
+
+/* ========================================================================== */
+/* Serialization                                                              */
+/* ========================================================================== */
+
+static const gchar *
+async_type_name (GdbMiRecordType type)
+{
+    switch (type)
+    {
+        case GDB_MI_RECORD_EXEC_ASYNC:
+            return "exec";
+        case GDB_MI_RECORD_STATUS_ASYNC:
+            return "status";
+        case GDB_MI_RECORD_NOTIFY_ASYNC:
+            return "notify";
+        default:
+            return "unknown";
+    }
+}
+
+/*
+ * record_to_json_object:
+ * @record: a result or async record
+ *
+ * Returns: (transfer full): the record's class and results
+ */
+static JsonObject *
+record_to_json_object (GdbMiRecord *record)
+{
+    JsonObject *object;
+    JsonObject *results;
+    const gchar *klass;
+
+    object = json_object_new ();
+
+    klass = gdb_mi_record_get_class (record);
+    if (klass != NULL)
+    {
+        json_object_set_string_member (object, "class", klass);
+    }
+
+    results = gdb_mi_record_get_results (record);
+    if (results != NULL)
+    {
+        /* Records are immutable once parsed, so the object is shared */
+        json_object_set_object_member (object, "results", json_object_ref (results));
+    }
+
+    return object;
+}
+
+JsonNode *
+gdb_command_result_to_json (GdbCommandResult *self)
+{
+    JsonObject *object;
+    JsonNode *node;
+
+    g_return_val_if_fail (self != NULL, NULL);
+
+    object = self->result != NULL
+             ? record_to_json_object (self->result)
+             : json_object_new ();
+
+    if (self->console->len > 0)
+    {
+        json_object_set_string_member (object, "console",
+                                       gdb_command_result_get_console_text (self));
+    }
+
+    if (self->async->len > 0)
+    {
+        JsonArray *array;
+        guint i;
+
+        array = json_array_sized_new (self->async->len);
+        for (i = 0; i < self->async->len; i++)
+        {
+            GdbMiRecord *record = g_ptr_array_index (self->async, i);
+            JsonObject *entry = record_to_json_object (record);
+
+            json_object_set_string_member (entry, "type",
+                                           async_type_name (gdb_mi_record_get_type_enum (record)));
+            json_array_add_object_element (array, entry);
+        }
+        json_object_set_array_member (object, "async", array);
+    }
+
+    if (self->log->len > 0)
+    {
+        g_autofree gchar *log = join_streams (self->log);
+
+        json_object_set_string_member (object, "log", log);
+    }
+
+    node = json_node_new (JSON_NODE_OBJECT);
+    json_node_take_object (node, object);
+
+    return node;
+}
@@ -333,3 +333,51 @@ gdb_mi_result_class_from_string (const gchar *str)
 
     return GDB_MI_RESULT_ERROR;
 }
+
+/* ========================================================================== */
+/* GdbStartupProfile                                                          */
+/* ========================================================================== */
+
+static const GEnumValue startup_profile_values[] = {
+    { GDB_STARTUP_PROFILE_DEFAULT, "GDB_STARTUP_PROFILE_DEFAULT", "default" },
+    { GDB_STARTUP_PROFILE_FAST,    "GDB_STARTUP_PROFILE_FAST",    "fast" },
+    { 0, NULL, NULL }
+};
+
+GType
+gdb_startup_profile_get_type (void)
+{
+    static gsize g_define_type_id__volatile = 0;
+
+    if (g_once_init_enter (&g_define_type_id__volatile))
+    {
+        GType g_define_type_id =
+            g_enum_register_static ("GdbStartupProfile", startup_profile_values);
+        g_once_init_leave (&g_define_type_id__volatile, g_define_type_id);
+    }
+
+    return g_define_type_id__volatile;
+}
+
+const gchar *
+gdb_startup_profile_to_string (GdbStartupProfile profile)
+{
+    switch (profile)
+    {
+        case GDB_STARTUP_PROFILE_DEFAULT:
+            return "default";
+        case GDB_STARTUP_PROFILE_FAST:
+            return "fast";
+        default:
+            return "default";
+    }
+}
+
+GdbStartupProfile
+gdb_startup_profile_from_string (const gchar *str)
+{
+    if (g_strcmp0 (str, "fast") == 0)
+        return GDB_STARTUP_PROFILE_FAST;
+
+    return GDB_STARTUP_PROFILE_DEFAULT;
+}
@@ -44,6 +44,8 @@ gdb_error_code_to_string (GdbErrorCode code)
             return "No program is running";
         case GDB_ERROR_INTERNAL:
             return "Internal error";
+        case GDB_ERROR_QUEUE_FULL:
+            return "Command queue is full";
         default:
             return "Unknown error";
     }
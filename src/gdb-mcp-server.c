@@ -9,11 +9,23 @@
  * - Registers all GDB debugging tools
  * - Manages the GdbSessionManager
  * - Handles server lifecycle
+ * - Serves clients over stdio, HTTP or a Unix socket
  */
 
 #include "mcp-gdb/gdb-mcp-server.h"
 #include "tools/gdb-tools-internal.h"
 #include <mcp.h>
+#include <libsoup/soup.h>
+#include <gio/gunixinputstream.h>
+#include <gio/gunixoutputstream.h>
+#include <gio/gunixsocketaddress.h>
+#include <glib-unix.h>
+#include <glib/gstdio.h>
+#include <sys/stat.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
 
 /* ========================================================================== */
 /* GdbMcpServer Structure                                                     */
@@ -32,10 +44,35 @@ struct _GdbMcpServer
     McpServer *mcp_server;
     GdbSessionManager *session_manager;
     GMainLoop *main_loop;
+
+    /* Tool dispatch (see "Tool Dispatch") */
+    GMutex dispatch_lock;
+    GCond dispatch_idle;
+    GHashTable *session_calls;   /* sessionId -> GQueue of parked ToolCalls */
+    GQueue ready;                /* Calls waiting for a free slot */
+    guint running;               /* Fibers currently running a call */
+    guint max_workers;
+
+    /* Clients (see "Clients") */
+    gboolean share_sessions;
+
+    /* HTTP transport (see "HTTP Transport") */
+    SoupServer *http_server;
+    GHashTable *http_clients;    /* Mcp-Session-Id -> HttpClient */
+    guint http_sweep_id;
+
+    /* Stream transport (see "Stream Transport") */
+    gpointer stdio_client;       /* StreamClient, once running on stdio */
+    GSocketService *socket_service;
+    gchar *socket_path;
+    GPtrArray *socket_clients;   /* StreamClients */
 };
 
 G_DEFINE_TYPE (GdbMcpServer, gdb_mcp_server, G_TYPE_OBJECT)
 
+#define DEFAULT_MAX_WORKERS 64
+#define MAX_WORKERS         4096
+
 enum
 {
     PROP_0,
@@ -43,6 +80,8 @@ enum
     PROP_VERSION,
     PROP_DEFAULT_GDB_PATH,
     PROP_SESSION_MANAGER,
+    PROP_MAX_WORKERS,
+    PROP_SHARE_SESSIONS,
     N_PROPS
 };
 
@@ -70,6 +109,8 @@ static const gchar *SERVER_INSTRUCTIONS =
     "- gdb_step: Step into functions (stepi for instructions)\n"
     "- gdb_next: Step over function calls (nexti for instructions)\n"
     "- gdb_finish: Execute until current function returns\n"
+    "- gdb_wait_for_stop: Wait for a target started with async=true to stop\n"
+    "  (all execution tools accept async=true and return a runId)\n"
     "\n"
     "## Breakpoints\n"
     "- gdb_set_breakpoint: Set a breakpoint with optional condition\n"
@@ -80,6 +121,7 @@ static const gchar *SERVER_INSTRUCTIONS =
     "- gdb_examine: Examine memory at address\n"
     "- gdb_info_registers: Show CPU registers\n"
     "- gdb_command: Execute arbitrary GDB command\n"
+    "- gdb_batch: Execute several GDB commands in one call\n"
     "\n"
     "## GLib/GObject Debugging\n"
     "- gdb_glib_print_gobject: Pretty-print a GObject instance\n"
@@ -97,6 +139,349 @@ static const gchar *SERVER_INSTRUCTIONS =
     "6. gdb_step/next to trace execution\n"
     "7. gdb_terminate when done\n";
 
+/* ========================================================================== */
+/* Tool Dispatch                                                              */
+/* ========================================================================== */
+
+/*
+ * Tool handlers wait until GDB answers, which can take as long as the
+ * target runs. Each call therefore runs as a fiber on the default libdex
+ * thread pool scheduler. A fiber awaiting GDB is suspended, not blocked,
+ * so a few scheduler threads carry many calls; max-workers caps how many
+ * run at once. Calls naming the same sessionId run one at a time, in
+ * arrival order; calls on different sessions, or on none, run in
+ * parallel.
+ *
+ * Links (see "Links") start calls without waiting and answer each one
+ * when its fiber is done. A call that reaches the handler registered
+ * with the McpServer instead keeps iterating the main context until its
+ * fiber is done, so session signals, timers and other requests are
+ * served meanwhile. That contract is synchronous, so a call nesting
+ * inside another one's wait returns first even if the outer call
+ * finished earlier.
+ */
+
+/*
+ * DispatchedTool:
+ *
+ * The real handler of a registered tool.
+ */
+typedef struct
+{
+    GdbMcpServer      *server;     /* Unowned; outlives its tools */
+    McpToolHandler     handler;
+    GdbSessionManager *manager;    /* The handler's user data */
+} DispatchedTool;
+
+static void
+dispatched_tool_free (DispatchedTool *tool)
+{
+    g_object_unref (tool->manager);
+    g_free (tool);
+}
+
+/*
+ * DISPATCHED_TOOLS_KEY:
+ *
+ * Data key of the table, on each McpServer, of its tools by name
+ * (DispatchedTools owned by the McpServer).
+ */
+#define DISPATCHED_TOOLS_KEY "gdb-dispatched-tools"
+
+typedef struct _ToolCall ToolCall;
+
+typedef void (*ToolCallFunc) (ToolCall *call);
+
+/*
+ * ToolCall:
+ *
+ * One tool call on its way through the dispatcher.
+ */
+struct _ToolCall
+{
+    DispatchedTool *tool;
+    McpServer      *mcp_server;
+    gchar          *name;
+    JsonObject     *arguments;
+    gchar          *session_id;    /* Serialization key, or NULL */
+    GMainContext   *context;       /* Where the call is finished */
+    McpToolResult  *result;
+    gint            done;          /* Atomic */
+    ToolCallFunc    complete;      /* Run on @context once done, or NULL */
+    gpointer        complete_data;
+    JsonNode       *request_id;    /* JSON-RPC id, for @complete */
+};
+
+/*
+ * tool_call_new:
+ * @tool: the tool
+ * @mcp_server: the McpServer @tool is registered with
+ * @name: the tool name
+ * @arguments: (nullable): the call's arguments
+ *
+ * Returns: (transfer full): a call for dispatch_push(), finished on the
+ *     thread-default main context
+ */
+static ToolCall *
+tool_call_new (DispatchedTool *tool,
+               McpServer      *mcp_server,
+               const gchar    *name,
+               JsonObject     *arguments)
+{
+    const gchar *session_id;
+    ToolCall *call;
+
+    call = g_slice_new0 (ToolCall);
+    call->tool = tool;
+    /* Keeps @tool alive if the client goes away meanwhile */
+    call->mcp_server = g_object_ref (mcp_server);
+    call->name = g_strdup (name);
+    call->arguments = arguments != NULL ? json_object_ref (arguments) : NULL;
+
+    /* Session IDs are unique per manager, and clients may each have one */
+    session_id = gdb_tools_get_session_id (arguments);
+    if (session_id != NULL)
+    {
+        call->session_id = g_strdup_printf ("%p/%s", (gpointer) tool->manager, session_id);
+    }
+
+    call->context = g_main_context_ref_thread_default ();
+
+    return call;
+}
+
+static void
+tool_call_free (ToolCall *call)
+{
+    g_object_unref (call->mcp_server);
+    g_free (call->name);
+    g_clear_pointer (&call->arguments, json_object_unref);
+    g_free (call->session_id);
+    g_main_context_unref (call->context);
+    g_clear_pointer (&call->request_id, json_node_unref);
+    g_slice_free (ToolCall, call);
+}
+
+static DexFuture *dispatch_fiber (gpointer data);
+
+/*
+ * dispatch_start_locked:
+ *
+ * Spawns the fiber for @call, or queues it until a running call
+ * finishes if max-workers are already running. Called with
+ * dispatch_lock held.
+ */
+static void
+dispatch_start_locked (GdbMcpServer *self,
+                       ToolCall     *call)
+{
+    if (self->running >= self->max_workers)
+    {
+        g_queue_push_tail (&self->ready, call);
+        return;
+    }
+
+    self->running++;
+    dex_future_disown (dex_scheduler_spawn (dex_thread_pool_scheduler_get_default (), 0,
+                                            dispatch_fiber, call, NULL));
+}
+
+/*
+ * dispatch_push:
+ *
+ * Starts @call, or parks it behind the call already running on its
+ * session.
+ */
+static void
+dispatch_push (GdbMcpServer *self,
+               ToolCall     *call)
+{
+    g_mutex_lock (&self->dispatch_lock);
+
+    if (call->session_id != NULL)
+    {
+        GQueue *waiting;
+
+        waiting = g_hash_table_lookup (self->session_calls, call->session_id);
+        if (waiting != NULL)
+        {
+            g_queue_push_tail (waiting, call);
+            g_mutex_unlock (&self->dispatch_lock);
+            return;
+        }
+        g_hash_table_insert (self->session_calls, g_strdup (call->session_id),
+                             g_queue_new ());
+    }
+
+    dispatch_start_locked (self, call);
+    g_mutex_unlock (&self->dispatch_lock);
+}
+
+/*
+ * dispatch_complete:
+ * @data: a ToolCall with a complete function
+ *
+ * Finishes a call on the main context it was made on.
+ */
+static gboolean
+dispatch_complete (gpointer data)
+{
+    ToolCall *call = (ToolCall *)data;
+
+    call->complete (call);
+    tool_call_free (call);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * dispatch_fiber:
+ * @data: the ToolCall
+ *
+ * Runs a tool call as a fiber, then starts the next call parked on the
+ * same session and the next one waiting for a slot.
+ */
+static DexFuture *
+dispatch_fiber (gpointer data)
+{
+    ToolCall *call = (ToolCall *)data;
+    GdbMcpServer *self = call->tool->server;
+    ToolCall *next;
+
+    /* Scheduler threads only ever run fibers */
+    gdb_tools_mark_fiber_thread ();
+
+    call->result = call->tool->handler (call->mcp_server, call->name,
+                                        call->arguments, call->tool->manager);
+
+    /* Answered like any other tool failure, whichever path asked */
+    if (call->result == NULL)
+    {
+        call->result = gdb_tools_create_error_result ("Tool %s returned no result",
+                                                      call->name);
+    }
+
+    g_mutex_lock (&self->dispatch_lock);
+
+    self->running--;
+
+    if (call->session_id != NULL)
+    {
+        GQueue *waiting;
+
+        waiting = g_hash_table_lookup (self->session_calls, call->session_id);
+        next = g_queue_pop_head (waiting);
+        if (next == NULL)
+        {
+            g_hash_table_remove (self->session_calls, call->session_id);
+        }
+        else
+        {
+            dispatch_start_locked (self, next);
+        }
+    }
+
+    while (self->running < self->max_workers &&
+           (next = g_queue_pop_head (&self->ready)) != NULL)
+    {
+        dispatch_start_locked (self, next);
+    }
+
+    if (self->running == 0)
+    {
+        g_cond_broadcast (&self->dispatch_idle);
+    }
+
+    g_mutex_unlock (&self->dispatch_lock);
+
+    if (call->complete != NULL)
+    {
+        GSource *source;
+
+        source = g_idle_source_new ();
+        g_source_set_callback (source, dispatch_complete, call, NULL);
+        g_source_attach (source, call->context);
+        g_source_unref (source);
+    }
+    else
+    {
+        /* The waiting handler frees the call once it sees it done */
+        g_atomic_int_set (&call->done, TRUE);
+        g_main_context_wakeup (call->context);
+    }
+
+    return dex_future_new_for_boolean (TRUE);
+}
+
+/*
+ * dispatch_tool_call:
+ *
+ * The McpToolHandler registered for every tool. Runs the real handler as
+ * a fiber and iterates the caller's main context until it is done.
+ */
+static McpToolResult *
+dispatch_tool_call (McpServer   *mcp_server,
+                    const gchar *name,
+                    JsonObject  *arguments,
+                    gpointer     user_data)
+{
+    DispatchedTool *tool = (DispatchedTool *)user_data;
+    McpToolResult *result;
+    ToolCall *call;
+
+    call = tool_call_new (tool, mcp_server, name, arguments);
+    dispatch_push (tool->server, call);
+
+    while (!g_atomic_int_get (&call->done))
+    {
+        g_main_context_iteration (call->context, TRUE);
+    }
+
+    result = call->result;
+    tool_call_free (call);
+
+    return result;
+}
+
+/*
+ * add_dispatched_tool:
+ * @self: the server
+ * @mcp_server: the McpServer to register with
+ * @tool: the tool
+ * @handler: the tool's handler, run as a fiber
+ * @manager: the session manager passed to @handler
+ *
+ * Registers @tool with the McpServer behind the dispatcher, and files
+ * it under DISPATCHED_TOOLS_KEY for links.
+ */
+static void
+add_dispatched_tool (GdbMcpServer      *self,
+                     McpServer         *mcp_server,
+                     McpTool           *tool,
+                     McpToolHandler     handler,
+                     GdbSessionManager *manager)
+{
+    DispatchedTool *dispatched;
+    GHashTable *tools;
+
+    dispatched = g_new0 (DispatchedTool, 1);
+    dispatched->server = self;
+    dispatched->handler = handler;
+    dispatched->manager = g_object_ref (manager);
+
+    tools = g_object_get_data (G_OBJECT (mcp_server), DISPATCHED_TOOLS_KEY);
+    if (tools == NULL)
+    {
+        tools = g_hash_table_new_full (g_str_hash, g_str_equal, g_free, NULL);
+        g_object_set_data_full (G_OBJECT (mcp_server), DISPATCHED_TOOLS_KEY, tools,
+                                (GDestroyNotify) g_hash_table_unref);
+    }
+    g_hash_table_replace (tools, g_strdup (mcp_tool_get_name (tool)), dispatched);
+
+    mcp_server_add_tool (mcp_server, tool, dispatch_tool_call, dispatched,
+                         (GDestroyNotify) dispatched_tool_free);
+}
+
 /* ========================================================================== */
 /* Tool Registration                                                          */
 /* ========================================================================== */
@@ -104,11 +489,15 @@ static const gchar *SERVER_INSTRUCTIONS =
 /*
  * register_session_tools:
  * @self: the server
+ * @mcp_server: the McpServer to register with
+ * @manager: the session manager the tools act on
  *
  * Registers session management tools: gdb_start, gdb_terminate, gdb_list_sessions
  */
 static void
-register_session_tools (GdbMcpServer *self)
+register_session_tools (GdbMcpServer      *self,
+                        McpServer         *mcp_server,
+                        GdbSessionManager *manager)
 {
     /* gdb_start */
     {
@@ -117,9 +506,9 @@ register_session_tools (GdbMcpServer *self)
             "Start a new GDB debugging session");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_start_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_start,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_terminate */
@@ -129,9 +518,9 @@ register_session_tools (GdbMcpServer *self)
             "Terminate a GDB session");
         g_autoptr(JsonNode) schema = gdb_tools_create_session_id_only_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_terminate,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_list_sessions */
@@ -140,20 +529,24 @@ register_session_tools (GdbMcpServer *self)
             "gdb_list_sessions",
             "List all active GDB sessions");
         /* No schema needed - no arguments */
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_list_sessions,
-                             self->session_manager, NULL);
+                             manager);
     }
 }
 
 /*
  * register_load_tools:
  * @self: the server
+ * @mcp_server: the McpServer to register with
+ * @manager: the session manager the tools act on
  *
  * Registers program loading tools: gdb_load, gdb_attach, gdb_load_core
  */
 static void
-register_load_tools (GdbMcpServer *self)
+register_load_tools (GdbMcpServer      *self,
+                     McpServer         *mcp_server,
+                     GdbSessionManager *manager)
 {
     /* gdb_load */
     {
@@ -162,9 +555,9 @@ register_load_tools (GdbMcpServer *self)
             "Load a program into GDB for debugging");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_load_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_load,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_attach */
@@ -174,9 +567,9 @@ register_load_tools (GdbMcpServer *self)
             "Attach to a running process by PID");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_attach_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_attach,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_load_core */
@@ -186,31 +579,36 @@ register_load_tools (GdbMcpServer *self)
             "Load a core dump file for post-mortem debugging");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_load_core_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_load_core,
-                             self->session_manager, NULL);
+                             manager);
     }
 }
 
 /*
  * register_exec_tools:
  * @self: the server
+ * @mcp_server: the McpServer to register with
+ * @manager: the session manager the tools act on
  *
- * Registers execution control tools: gdb_continue, gdb_step, gdb_next, gdb_finish
+ * Registers execution control tools: gdb_continue, gdb_step, gdb_next,
+ * gdb_finish, gdb_wait_for_stop
  */
 static void
-register_exec_tools (GdbMcpServer *self)
+register_exec_tools (GdbMcpServer      *self,
+                     McpServer         *mcp_server,
+                     GdbSessionManager *manager)
 {
     /* gdb_continue */
     {
         g_autoptr(McpTool) tool = mcp_tool_new (
             "gdb_continue",
             "Continue program execution until next breakpoint or exit");
-        g_autoptr(JsonNode) schema = gdb_tools_create_session_id_only_schema ();
+        g_autoptr(JsonNode) schema = gdb_tools_create_gdb_continue_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_continue,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_step */
@@ -220,9 +618,9 @@ register_exec_tools (GdbMcpServer *self)
             "Step into functions (single step by source line or instruction)");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_step_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_step,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_next */
@@ -232,9 +630,9 @@ register_exec_tools (GdbMcpServer *self)
             "Step over function calls (single step without entering functions)");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_next_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_next,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_finish */
@@ -242,22 +640,38 @@ register_exec_tools (GdbMcpServer *self)
         g_autoptr(McpTool) tool = mcp_tool_new (
             "gdb_finish",
             "Execute until the current function returns");
-        g_autoptr(JsonNode) schema = gdb_tools_create_session_id_only_schema ();
+        g_autoptr(JsonNode) schema = gdb_tools_create_gdb_finish_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_finish,
-                             self->session_manager, NULL);
+                             manager);
+    }
+
+    /* gdb_wait_for_stop */
+    {
+        g_autoptr(McpTool) tool = mcp_tool_new (
+            "gdb_wait_for_stop",
+            "Wait until a target resumed with async=true stops, and report where");
+        g_autoptr(JsonNode) schema = gdb_tools_create_gdb_wait_for_stop_schema ();
+        mcp_tool_set_input_schema (tool, schema);
+        add_dispatched_tool (self, mcp_server, tool,
+                             gdb_tools_handle_gdb_wait_for_stop,
+                             manager);
     }
 }
 
 /*
  * register_breakpoint_tools:
  * @self: the server
+ * @mcp_server: the McpServer to register with
+ * @manager: the session manager the tools act on
  *
  * Registers breakpoint tools: gdb_set_breakpoint
  */
 static void
-register_breakpoint_tools (GdbMcpServer *self)
+register_breakpoint_tools (GdbMcpServer      *self,
+                           McpServer         *mcp_server,
+                           GdbSessionManager *manager)
 {
     /* gdb_set_breakpoint */
     {
@@ -266,21 +680,25 @@ register_breakpoint_tools (GdbMcpServer *self)
             "Set a breakpoint at a location (function, file:line, or *address)");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_breakpoint_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_set_breakpoint,
-                             self->session_manager, NULL);
+                             manager);
     }
 }
 
 /*
  * register_inspect_tools:
  * @self: the server
+ * @mcp_server: the McpServer to register with
+ * @manager: the session manager the tools act on
  *
  * Registers inspection tools: gdb_backtrace, gdb_print, gdb_examine,
- *                             gdb_info_registers, gdb_command
+ *                             gdb_info_registers, gdb_command, gdb_batch
  */
 static void
-register_inspect_tools (GdbMcpServer *self)
+register_inspect_tools (GdbMcpServer      *self,
+                        McpServer         *mcp_server,
+                        GdbSessionManager *manager)
 {
     /* gdb_backtrace */
     {
@@ -289,9 +707,9 @@ register_inspect_tools (GdbMcpServer *self)
             "Show the current call stack / backtrace");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_backtrace_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_backtrace,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_print */
@@ -301,9 +719,9 @@ register_inspect_tools (GdbMcpServer *self)
             "Evaluate and print an expression");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_print_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_print,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_examine */
@@ -313,9 +731,9 @@ register_inspect_tools (GdbMcpServer *self)
             "Examine memory at a given address");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_examine_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_examine,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_info_registers */
@@ -325,9 +743,9 @@ register_inspect_tools (GdbMcpServer *self)
             "Show CPU register values");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_info_registers_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_info_registers,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_command */
@@ -337,20 +755,36 @@ register_inspect_tools (GdbMcpServer *self)
             "Execute an arbitrary GDB command (escape hatch for advanced use)");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_command_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_command,
-                             self->session_manager, NULL);
+                             manager);
+    }
+
+    /* gdb_batch */
+    {
+        g_autoptr(McpTool) tool = mcp_tool_new (
+            "gdb_batch",
+            "Execute several GDB commands in one call and return a structured result for each");
+        g_autoptr(JsonNode) schema = gdb_tools_create_gdb_batch_schema ();
+        mcp_tool_set_input_schema (tool, schema);
+        add_dispatched_tool (self, mcp_server, tool,
+                             gdb_tools_handle_gdb_batch,
+                             manager);
     }
 }
 
 /*
  * register_glib_tools:
  * @self: the server
+ * @mcp_server: the McpServer to register with
+ * @manager: the session manager the tools act on
  *
  * Registers GLib/GObject debugging tools
  */
 static void
-register_glib_tools (GdbMcpServer *self)
+register_glib_tools (GdbMcpServer      *self,
+                     McpServer         *mcp_server,
+                     GdbSessionManager *manager)
 {
     /* gdb_glib_print_gobject */
     {
@@ -359,9 +793,9 @@ register_glib_tools (GdbMcpServer *self)
             "Pretty-print a GObject instance (type, ref_count, properties)");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_glib_print_gobject_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_glib_print_gobject,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_glib_print_glist */
@@ -371,9 +805,9 @@ register_glib_tools (GdbMcpServer *self)
             "Pretty-print GList or GSList contents");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_glib_print_glist_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_glib_print_glist,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_glib_print_ghash */
@@ -383,9 +817,9 @@ register_glib_tools (GdbMcpServer *self)
             "Pretty-print GHashTable key-value pairs");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_glib_print_ghash_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_glib_print_ghash,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_glib_type_hierarchy */
@@ -395,9 +829,9 @@ register_glib_tools (GdbMcpServer *self)
             "Show the GType inheritance hierarchy for a type or instance");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_glib_type_hierarchy_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_glib_type_hierarchy,
-                             self->session_manager, NULL);
+                             manager);
     }
 
     /* gdb_glib_signal_info */
@@ -407,118 +841,1789 @@ register_glib_tools (GdbMcpServer *self)
             "List signals registered on a GObject type or instance");
         g_autoptr(JsonNode) schema = gdb_tools_create_gdb_glib_signal_info_schema ();
         mcp_tool_set_input_schema (tool, schema);
-        mcp_server_add_tool (self->mcp_server, tool,
+        add_dispatched_tool (self, mcp_server, tool,
                              gdb_tools_handle_gdb_glib_signal_info,
-                             self->session_manager, NULL);
+                             manager);
     }
 }
 
 /*
  * register_all_tools:
  * @self: the server
+ * @mcp_server: the McpServer to register with
+ * @manager: the session manager the tools act on
  *
  * Registers all GDB debugging tools with the MCP server.
  */
 static void
-register_all_tools (GdbMcpServer *self)
+register_all_tools (GdbMcpServer      *self,
+                    McpServer         *mcp_server,
+                    GdbSessionManager *manager)
 {
-    register_session_tools (self);
-    register_load_tools (self);
-    register_exec_tools (self);
-    register_breakpoint_tools (self);
-    register_inspect_tools (self);
-    register_glib_tools (self);
+    register_session_tools (self, mcp_server, manager);
+    register_load_tools (self, mcp_server, manager);
+    register_exec_tools (self, mcp_server, manager);
+    register_breakpoint_tools (self, mcp_server, manager);
+    register_inspect_tools (self, mcp_server, manager);
+    register_glib_tools (self, mcp_server, manager);
 }
 
 /* ========================================================================== */
-/* Signal Handlers                                                            */
+/* Clients                                                                    */
 /* ========================================================================== */
 
-static void
-on_client_disconnected (McpServer *mcp_server G_GNUC_UNUSED,
-                        gpointer   user_data)
+/*
+ * Clients served over HTTP or a Unix socket each get an McpServer of
+ * their own. Unless share-sessions is set, they also get a session
+ * manager of their own, so they never see each other's GDB sessions.
+ */
+
+/*
+ * client_manager_new:
+ * @self: the server
+ *
+ * Gets the session manager for a new client: the server's own if
+ * share-sessions is set, otherwise a new one with its settings. Its
+ * eviction limits are the server manager's, shared, so they bound all
+ * clients together rather than each. The warm pool is not copied: it
+ * would keep GDB processes running per client.
+ *
+ * Returns: (transfer full): the manager
+ */
+static GdbSessionManager *
+client_manager_new (GdbMcpServer *self)
 {
-    GdbMcpServer *self = GDB_MCP_SERVER (user_data);
+    GdbSessionManager *template = self->session_manager;
+    GdbSessionManager *manager;
+
+    if (self->share_sessions)
+    {
+        return g_object_ref (template);
+    }
 
-    g_message ("Client disconnected, shutting down");
+    manager = gdb_session_manager_new_sharing_limits (template);
+    gdb_session_manager_set_default_gdb_path (
+        manager, gdb_session_manager_get_default_gdb_path (template));
+    gdb_session_manager_set_default_timeout_ms (
+        manager, gdb_session_manager_get_default_timeout_ms (template));
+    gdb_session_manager_set_default_startup_profile (
+        manager, gdb_session_manager_get_default_startup_profile (template));
 
-    if (self->main_loop != NULL)
+    return manager;
+}
+
+/*
+ * client_manager_end_sessions:
+ * @self: the server
+ * @manager: a manager from client_manager_new()
+ *
+ * Terminates the sessions of a departing client, unless they are shared.
+ */
+static void
+client_manager_end_sessions (GdbMcpServer      *self,
+                             GdbSessionManager *manager)
+{
+    if (manager != self->session_manager)
     {
-        g_main_loop_quit (self->main_loop);
+        gdb_session_manager_terminate_all (manager);
     }
 }
 
+/*
+ * client_mcp_server_new:
+ * @self: the server
+ * @manager: the client's session manager
+ *
+ * Returns: (transfer full): an McpServer with every tool, acting on @manager
+ */
+static McpServer *
+client_mcp_server_new (GdbMcpServer      *self,
+                       GdbSessionManager *manager)
+{
+    McpServer *mcp_server;
+
+    mcp_server = mcp_server_new (self->name, self->version);
+    mcp_server_set_instructions (mcp_server, SERVER_INSTRUCTIONS);
+    register_all_tools (self, mcp_server, manager);
+
+    return mcp_server;
+}
+
 /* ========================================================================== */
-/* GObject Implementation                                                     */
+/* Line I/O                                                                   */
 /* ========================================================================== */
 
+/*
+ * Every transport ends up moving JSON-RPC messages one per line. A
+ * LineReader hands each line of a stream to its owner; a LineQueue
+ * writes lines one at a time so they never interleave. Pending I/O holds
+ * a reference, so an owner only has to close them before it goes away:
+ * once closed, neither calls back.
+ */
+
+typedef void (*LineFunc) (const gchar *line, gpointer user_data);
+
+typedef struct
+{
+    gint              ref_count;
+    GDataInputStream *stream;
+    GCancellable     *cancellable;
+    LineFunc          func;          /* Gets NULL at the end of the stream */
+    gpointer          user_data;     /* Unowned */
+} LineReader;
+
+typedef struct
+{
+    gint           ref_count;
+    GOutputStream *stream;
+    GQueue         lines;            /* GBytes not yet written */
+    GBytes        *writing;          /* Being written, or NULL */
+    GCancellable  *cancellable;
+} LineQueue;
+
 static void
-gdb_mcp_server_dispose (GObject *object)
+line_reader_unref (LineReader *reader)
 {
-    GdbMcpServer *self = GDB_MCP_SERVER (object);
+    if (--reader->ref_count > 0)
+    {
+        return;
+    }
 
-    g_clear_object (&self->mcp_server);
-    g_clear_object (&self->session_manager);
+    g_object_unref (reader->stream);
+    g_object_unref (reader->cancellable);
+    g_slice_free (LineReader, reader);
+}
 
-    if (self->main_loop != NULL)
+static void line_reader_read_next (LineReader *reader);
+
+static void
+on_line_read (GObject      *source,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+    LineReader *reader = (LineReader *)user_data;
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *line = NULL;
+
+    line = g_data_input_stream_read_line_finish_utf8 (G_DATA_INPUT_STREAM (source),
+                                                      result, NULL, &error);
+    if (g_cancellable_is_cancelled (reader->cancellable))
     {
-        g_main_loop_unref (self->main_loop);
-        self->main_loop = NULL;
+        line_reader_unref (reader);
+        return;
     }
 
-    G_OBJECT_CLASS (gdb_mcp_server_parent_class)->dispose (object);
+    if (line == NULL)
+    {
+        if (error != NULL)
+        {
+            g_warning ("Read failed: %s", error->message);
+        }
+        reader->func (NULL, reader->user_data);
+    }
+    else
+    {
+        if (*line != '\0')
+        {
+            reader->func (line, reader->user_data);
+        }
+
+        /* Stops if @func closed the reader */
+        line_reader_read_next (reader);
+    }
+
+    line_reader_unref (reader);
 }
 
 static void
-gdb_mcp_server_finalize (GObject *object)
+line_reader_read_next (LineReader *reader)
 {
-    GdbMcpServer *self = GDB_MCP_SERVER (object);
+    if (g_cancellable_is_cancelled (reader->cancellable))
+    {
+        return;
+    }
 
-    g_free (self->name);
-    g_free (self->version);
-    g_free (self->default_gdb_path);
+    reader->ref_count++;
+    g_data_input_stream_read_line_async (reader->stream, G_PRIORITY_DEFAULT,
+                                         reader->cancellable, on_line_read, reader);
+}
 
-    G_OBJECT_CLASS (gdb_mcp_server_parent_class)->finalize (object);
+/*
+ * line_reader_new:
+ * @stream: the stream to read
+ * @func: called with each non-empty line, then with %NULL at the end
+ * @user_data: data for @func
+ *
+ * Returns: (transfer full): a reader, already reading
+ */
+static LineReader *
+line_reader_new (GInputStream *stream,
+                 LineFunc      func,
+                 gpointer      user_data)
+{
+    LineReader *reader;
+
+    reader = g_slice_new0 (LineReader);
+    reader->ref_count = 1;
+    reader->stream = g_data_input_stream_new (stream);
+    reader->cancellable = g_cancellable_new ();
+    reader->func = func;
+    reader->user_data = user_data;
+
+    line_reader_read_next (reader);
+
+    return reader;
 }
 
+/*
+ * line_reader_close:
+ * @reader: (transfer full): the reader
+ *
+ * Stops reading and drops the owner's reference.
+ */
 static void
-gdb_mcp_server_get_property (GObject    *object,
-                             guint       prop_id,
-                             GValue     *value,
-                             GParamSpec *pspec)
+line_reader_close (LineReader *reader)
 {
-    GdbMcpServer *self = GDB_MCP_SERVER (object);
+    g_cancellable_cancel (reader->cancellable);
+    line_reader_unref (reader);
+}
 
-    switch (prop_id)
+static void
+line_queue_unref (LineQueue *queue)
+{
+    if (--queue->ref_count > 0)
     {
-        case PROP_NAME:
-            g_value_set_string (value, self->name);
-            break;
+        return;
+    }
 
-        case PROP_VERSION:
-            g_value_set_string (value, self->version);
-            break;
+    g_object_unref (queue->stream);
+    g_queue_clear_full (&queue->lines, (GDestroyNotify) g_bytes_unref);
+    g_clear_pointer (&queue->writing, g_bytes_unref);
+    g_object_unref (queue->cancellable);
+    g_slice_free (LineQueue, queue);
+}
 
-        case PROP_DEFAULT_GDB_PATH:
-            g_value_set_string (value, self->default_gdb_path);
-            break;
+static void line_queue_write_next (LineQueue *queue);
 
-        case PROP_SESSION_MANAGER:
-            g_value_set_object (value, self->session_manager);
-            break;
+static void
+on_line_written (GObject      *source,
+                 GAsyncResult *result,
+                 gpointer      user_data)
+{
+    LineQueue *queue = (LineQueue *)user_data;
+    g_autoptr(GError) error = NULL;
 
-        default:
-            G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    if (!g_output_stream_write_all_finish (G_OUTPUT_STREAM (source), result, NULL, &error))
+    {
+        /* The peer is gone, which its reader reports; drop the rest */
+        g_debug ("Write failed: %s", error->message);
+        g_cancellable_cancel (queue->cancellable);
     }
+
+    g_clear_pointer (&queue->writing, g_bytes_unref);
+    line_queue_write_next (queue);
+    line_queue_unref (queue);
 }
 
 static void
-gdb_mcp_server_set_property (GObject      *object,
-                             guint         prop_id,
-                             const GValue *value,
-                             GParamSpec   *pspec)
+line_queue_write_next (LineQueue *queue)
 {
-    GdbMcpServer *self = GDB_MCP_SERVER (object);
+    gconstpointer data;
+    gsize size;
+
+    if (queue->writing != NULL || g_cancellable_is_cancelled (queue->cancellable))
+    {
+        return;
+    }
+
+    queue->writing = g_queue_pop_head (&queue->lines);
+    if (queue->writing == NULL)
+    {
+        return;
+    }
+
+    data = g_bytes_get_data (queue->writing, &size);
+    queue->ref_count++;
+    g_output_stream_write_all_async (queue->stream, data, size, G_PRIORITY_DEFAULT,
+                                     queue->cancellable, on_line_written, queue);
+}
+
+/*
+ * line_queue_new:
+ * @stream: the stream to write
+ *
+ * Returns: (transfer full): an empty queue
+ */
+static LineQueue *
+line_queue_new (GOutputStream *stream)
+{
+    LineQueue *queue;
+
+    queue = g_slice_new0 (LineQueue);
+    queue->ref_count = 1;
+    queue->stream = g_object_ref (stream);
+    queue->cancellable = g_cancellable_new ();
+    g_queue_init (&queue->lines);
+
+    return queue;
+}
+
+/*
+ * line_queue_push:
+ * @queue: the queue
+ * @line: a line, without its newline
+ *
+ * Writes @line after every line pushed before it.
+ */
+static void
+line_queue_push (LineQueue   *queue,
+                 const gchar *line)
+{
+    g_queue_push_tail (&queue->lines,
+                       g_bytes_new_take (g_strconcat (line, "\n", NULL),
+                                         strlen (line) + 1));
+    line_queue_write_next (queue);
+}
+
+/*
+ * line_queue_close:
+ * @queue: (transfer full): the queue
+ *
+ * Drops unwritten lines and the owner's reference.
+ */
+static void
+line_queue_close (LineQueue *queue)
+{
+    g_cancellable_cancel (queue->cancellable);
+    line_queue_unref (queue);
+}
+
+/* ========================================================================== */
+/* Links                                                                      */
+/* ========================================================================== */
+
+/*
+ * A Link carries one client's JSON-RPC messages to its McpServer, which
+ * runs the stdio transport over a pair of pipes. The McpServer answers
+ * in order, and its handler contract is synchronous, so a slow tool call
+ * would hold back every response after it. The link therefore takes
+ * tools/call requests for dispatched tools off the stream, starts them
+ * through the dispatcher without waiting, and hands each response over
+ * with its id as soon as the call is done. Calls naming different
+ * sessions thus finish in the time of the slowest; calls on one session
+ * still run one at a time. Everything else, unknown tools included,
+ * reaches the McpServer in arrival order. The link only parses lines
+ * that mention tools/call, and its responses carry the same isError
+ * results the McpServer would send.
+ */
+
+typedef struct
+{
+    gint          ref_count;
+    McpServer    *mcp_server;
+    GHashTable   *tools;             /* Unowned; see DISPATCHED_TOOLS_KEY */
+    LineQueue    *to_server;
+    LineReader   *from_server;
+    LineFunc      deliver;           /* Gets NULL once the McpServer is gone */
+    gpointer      user_data;         /* Unowned */
+    gboolean      closed;
+} Link;
+
+static void
+link_unref (Link *link)
+{
+    if (--link->ref_count > 0)
+    {
+        return;
+    }
+
+    g_object_unref (link->mcp_server);
+    g_slice_free (Link, link);
+}
+
+/*
+ * link_new:
+ * @mcp_server: the McpServer answering the client; its transport is set
+ * @deliver: called with each message for the client, then with %NULL
+ *     if the McpServer closes its end
+ * @user_data: data for @deliver
+ * @error: return location for error
+ *
+ * Returns: (transfer full) (nullable): the link, or %NULL on error
+ */
+static Link *
+link_new (McpServer  *mcp_server,
+          LineFunc    deliver,
+          gpointer    user_data,
+          GError    **error)
+{
+    g_autoptr(McpStdioTransport) transport = NULL;
+    g_autoptr(GInputStream) server_input = NULL;
+    g_autoptr(GOutputStream) server_output = NULL;
+    g_autoptr(GInputStream) input = NULL;
+    g_autoptr(GOutputStream) output = NULL;
+    Link *link;
+    gint to_fds[2];
+    gint from_fds[2];
+
+    if (!g_unix_open_pipe (to_fds, FD_CLOEXEC, error))
+    {
+        return NULL;
+    }
+    if (!g_unix_open_pipe (from_fds, FD_CLOEXEC, error))
+    {
+        close (to_fds[0]);
+        close (to_fds[1]);
+        return NULL;
+    }
+
+    /* Our write end feeds the McpServer's input and vice versa */
+    output = g_unix_output_stream_new (to_fds[1], TRUE);
+    input = g_unix_input_stream_new (from_fds[0], TRUE);
+    server_input = g_unix_input_stream_new (to_fds[0], TRUE);
+    server_output = g_unix_output_stream_new (from_fds[1], TRUE);
+
+    link = g_slice_new0 (Link);
+    link->ref_count = 1;
+    link->mcp_server = g_object_ref (mcp_server);
+    link->tools = g_object_get_data (G_OBJECT (mcp_server), DISPATCHED_TOOLS_KEY);
+    link->deliver = deliver;
+    link->user_data = user_data;
+    link->to_server = line_queue_new (output);
+    link->from_server = line_reader_new (input, deliver, user_data);
+
+    transport = mcp_stdio_transport_new_with_streams (server_input, server_output);
+    mcp_server_set_transport (mcp_server, MCP_TRANSPORT (transport));
+    mcp_server_start_async (mcp_server, NULL, NULL, NULL);
+
+    return link;
+}
+
+/*
+ * link_close:
+ * @link: (transfer full): the link
+ *
+ * Stops delivering messages and drops the owner's reference. Calls in
+ * flight still run, but their responses are dropped.
+ */
+static void
+link_close (Link *link)
+{
+    link->closed = TRUE;
+    g_clear_pointer (&link->to_server, line_queue_close);
+    g_clear_pointer (&link->from_server, line_reader_close);
+    link_unref (link);
+}
+
+static void
+on_link_call_done (ToolCall *call)
+{
+    Link *link = (Link *)call->complete_data;
+
+    if (!link->closed)
+    {
+        g_autoptr(JsonBuilder) builder = json_builder_new ();
+        g_autoptr(JsonNode) response = NULL;
+        g_autofree gchar *text = NULL;
+
+        json_builder_begin_object (builder);
+        json_builder_set_member_name (builder, "jsonrpc");
+        json_builder_add_string_value (builder, "2.0");
+        json_builder_set_member_name (builder, "id");
+        json_builder_add_value (builder, json_node_copy (call->request_id));
+        json_builder_set_member_name (builder, "result");
+        json_builder_add_value (builder, mcp_tool_result_to_json (call->result));
+        json_builder_end_object (builder);
+
+        response = json_builder_get_root (builder);
+        text = json_to_string (response, FALSE);
+        link->deliver (text, link->user_data);
+    }
+
+    g_clear_pointer (&call->result, mcp_tool_result_unref);
+    link_unref (link);
+}
+
+/*
+ * link_start_call:
+ * @link: the link
+ * @message: a JSON-RPC message from the client
+ *
+ * Starts @message as a tool call if it is a tools/call request for a
+ * dispatched tool.
+ *
+ * Returns: %TRUE if the call was started
+ */
+static gboolean
+link_start_call (Link     *link,
+                 JsonNode *message)
+{
+    JsonObject *object;
+    JsonObject *params;
+    JsonObject *arguments = NULL;
+    JsonNode *id;
+    JsonNode *node;
+    DispatchedTool *tool;
+    const gchar *name;
+    ToolCall *call;
+
+    if (link->tools == NULL || message == NULL || !JSON_NODE_HOLDS_OBJECT (message))
+    {
+        return FALSE;
+    }
+
+    object = json_node_get_object (message);
+    id = json_object_get_member (object, "id");
+    node = json_object_get_member (object, "params");
+    if (g_strcmp0 (json_object_get_string_member_with_default (object, "method", NULL),
+                   "tools/call") != 0 ||
+        id == NULL || !JSON_NODE_HOLDS_VALUE (id) ||
+        node == NULL || !JSON_NODE_HOLDS_OBJECT (node))
+    {
+        return FALSE;
+    }
+
+    params = json_node_get_object (node);
+    name = json_object_get_string_member_with_default (params, "name", NULL);
+    tool = name != NULL ? g_hash_table_lookup (link->tools, name) : NULL;
+    if (tool == NULL)
+    {
+        return FALSE;
+    }
+
+    node = json_object_get_member (params, "arguments");
+    if (node != NULL && JSON_NODE_HOLDS_OBJECT (node))
+    {
+        arguments = json_node_get_object (node);
+    }
+
+    call = tool_call_new (tool, link->mcp_server, name, arguments);
+    call->complete = on_link_call_done;
+    call->complete_data = link;
+    call->request_id = json_node_copy (id);
+    link->ref_count++;
+
+    dispatch_push (tool->server, call);
+
+    return TRUE;
+}
+
+/*
+ * link_send:
+ * @link: the link
+ * @message: a JSON-RPC message from the client
+ *
+ * Starts @message as a tool call, or queues it for the McpServer.
+ */
+static void
+link_send (Link     *link,
+           JsonNode *message)
+{
+    g_autofree gchar *text = NULL;
+
+    if (link->closed || link_start_call (link, message))
+    {
+        return;
+    }
+
+    text = json_to_string (message, FALSE);
+    line_queue_push (link->to_server, text);
+}
+
+/*
+ * link_send_line:
+ * @link: the link
+ * @line: one line the client sent
+ *
+ * Like link_send(), for unparsed input. Other lines go to the McpServer
+ * as they are; it answers those that are not JSON with a parse error.
+ */
+static void
+link_send_line (Link        *link,
+                const gchar *line)
+{
+    g_autoptr(JsonParser) parser = NULL;
+
+    if (link->closed)
+    {
+        return;
+    }
+
+    /*
+     * Only a tools/call request needs parsing here; the method string
+     * must then appear verbatim. One spelled with escapes still works,
+     * through the McpServer.
+     */
+    if (strstr (line, "\"tools/call\"") != NULL)
+    {
+        parser = json_parser_new ();
+        if (json_parser_load_from_data (parser, line, -1, NULL) &&
+            link_start_call (link, json_parser_get_root (parser)))
+        {
+            return;
+        }
+    }
+
+    line_queue_push (link->to_server, line);
+}
+
+/* ========================================================================== */
+/* HTTP Transport                                                             */
+/* ========================================================================== */
+
+/*
+ * In HTTP mode the server speaks the MCP streamable HTTP transport on a
+ * single endpoint, HTTP_ENDPOINT:
+ *
+ *  - POST carries JSON-RPC messages from the client. Requests are
+ *    answered in the response body; notifications and responses get
+ *    202 Accepted.
+ *  - GET opens a text/event-stream for messages the server initiates,
+ *    such as notifications.
+ *  - DELETE ends the client's MCP session.
+ *
+ * An initialize request without an Mcp-Session-Id header creates an
+ * HttpClient (see "Clients"). Later requests name the client
+ * by the Mcp-Session-Id returned with the initialize response. Each
+ * client's messages go through a Link (see "Links"), so this layer only
+ * routes messages. Tool calls of every client share the dispatcher, and
+ * so max-workers.
+ *
+ * Clients that leave without DELETE are dropped once they have been
+ * silent for HTTP_CLIENT_TIMEOUT_SECONDS with nothing in flight.
+ *
+ * Any web page can make a browser POST to a loopback port, and a DNS
+ * name rebound to 127.0.0.1 even lets it read the reply, so a request
+ * gets 403 Forbidden if it has an Origin that is not a loopback origin,
+ * or a Host other than the address it arrived on (see http_host_allowed()).
+ */
+
+#define HTTP_ENDPOINT                "/mcp"
+#define HTTP_SESSION_HEADER          "Mcp-Session-Id"
+#define HTTP_CLIENT_TIMEOUT_SECONDS  1800
+#define HTTP_SWEEP_INTERVAL_SECONDS  60
+#define HTTP_STREAM_OPENED           ": stream open\n\n"
+
+/*
+ * HttpExchange:
+ *
+ * A POST waiting for the responses to the requests it carried.
+ */
+typedef struct
+{
+    gint               ref_count;
+    SoupServerMessage *msg;          /* NULL once the connection is gone */
+    JsonArray         *responses;
+    guint              remaining;
+    gboolean           batch;        /* Answer with an array */
+} HttpExchange;
+
+/*
+ * HttpClient:
+ *
+ * One MCP client served over HTTP. Pending I/O holds a reference.
+ */
+typedef struct
+{
+    gint               ref_count;
+    GdbMcpServer      *server;       /* Unowned; outlives its clients */
+    gchar             *id;           /* Mcp-Session-Id */
+    GdbSessionManager *manager;
+    Link              *link;         /* NULL once removed */
+    GHashTable        *pending;      /* JSON-RPC id -> HttpExchange */
+    GPtrArray         *streams;      /* SoupServerMessages of GET streams */
+    gint64             last_seen;    /* Monotonic time of the last request */
+} HttpClient;
+
+static HttpExchange *
+http_exchange_ref (HttpExchange *exchange)
+{
+    exchange->ref_count++;
+    return exchange;
+}
+
+static void
+http_exchange_unref (HttpExchange *exchange)
+{
+    if (--exchange->ref_count > 0)
+    {
+        return;
+    }
+
+    json_array_unref (exchange->responses);
+    g_slice_free (HttpExchange, exchange);
+}
+
+static HttpClient *
+http_client_ref (HttpClient *client)
+{
+    client->ref_count++;
+    return client;
+}
+
+static void
+http_client_unref (HttpClient *client)
+{
+    if (--client->ref_count > 0)
+    {
+        return;
+    }
+
+    g_free (client->id);
+    g_clear_object (&client->manager);
+    g_clear_pointer (&client->link, link_close);
+    g_hash_table_unref (client->pending);
+    g_ptr_array_unref (client->streams);
+    g_slice_free (HttpClient, client);
+}
+
+/*
+ * http_message_id_key:
+ * @object: a JSON-RPC message
+ *
+ * Returns: (transfer full) (nullable): the message id as JSON text, so
+ *     numeric and string ids never collide, or %NULL without one
+ */
+static gchar *
+http_message_id_key (JsonObject *object)
+{
+    JsonNode *id;
+
+    id = json_object_get_member (object, "id");
+    if (id == NULL || JSON_NODE_HOLDS_NULL (id))
+    {
+        return NULL;
+    }
+
+    return json_to_string (id, FALSE);
+}
+
+/*
+ * http_respond:
+ * @msg: the message
+ * @status: the HTTP status
+ * @body: (nullable): a JSON body
+ *
+ * Sets the response of @msg. Paused messages must be resumed after.
+ */
+static void
+http_respond (SoupServerMessage *msg,
+              guint              status,
+              JsonNode          *body)
+{
+    soup_server_message_set_status (msg, status, NULL);
+
+    if (body != NULL)
+    {
+        gchar *text;
+
+        text = json_to_string (body, FALSE);
+        soup_server_message_set_response (msg, "application/json",
+                                          SOUP_MEMORY_TAKE, text, strlen (text));
+    }
+}
+
+/*
+ * http_respond_error:
+ * @msg: the message
+ * @status: the HTTP status
+ * @code: the JSON-RPC error code
+ * @message: the error message
+ *
+ * Answers @msg with a JSON-RPC error that has no id.
+ */
+static void
+http_respond_error (SoupServerMessage *msg,
+                    guint              status,
+                    gint               code,
+                    const gchar       *message)
+{
+    g_autoptr(JsonBuilder) builder = json_builder_new ();
+    g_autoptr(JsonNode) body = NULL;
+
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "jsonrpc");
+    json_builder_add_string_value (builder, "2.0");
+    json_builder_set_member_name (builder, "id");
+    json_builder_add_null_value (builder);
+    json_builder_set_member_name (builder, "error");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "code");
+    json_builder_add_int_value (builder, code);
+    json_builder_set_member_name (builder, "message");
+    json_builder_add_string_value (builder, message);
+    json_builder_end_object (builder);
+    json_builder_end_object (builder);
+
+    body = json_builder_get_root (builder);
+    http_respond (msg, status, body);
+}
+
+static void
+on_exchange_closure_notify (gpointer  data,
+                            GClosure *closure G_GNUC_UNUSED)
+{
+    http_exchange_unref ((HttpExchange *)data);
+}
+
+static void
+on_exchange_finished (SoupServerMessage *msg G_GNUC_UNUSED,
+                      gpointer           user_data)
+{
+    HttpExchange *exchange = (HttpExchange *)user_data;
+
+    exchange->msg = NULL;
+}
+
+/*
+ * http_exchange_complete:
+ * @exchange: an exchange with no responses outstanding
+ *
+ * Sends the collected responses, unless the client hung up.
+ */
+static void
+http_exchange_complete (HttpExchange *exchange)
+{
+    g_autoptr(JsonNode) body = NULL;
+
+    if (exchange->msg == NULL)
+    {
+        return;
+    }
+
+    if (exchange->batch)
+    {
+        body = json_node_new (JSON_NODE_ARRAY);
+        json_node_set_array (body, exchange->responses);
+    }
+    else
+    {
+        body = json_node_copy (json_array_get_element (exchange->responses, 0));
+    }
+
+    http_respond (exchange->msg, SOUP_STATUS_OK, body);
+    soup_server_message_unpause (exchange->msg);
+}
+
+/* --- Message Routing ----------------------------------------------------- */
+
+static void http_client_remove (HttpClient *client);
+
+/*
+ * http_client_broadcast:
+ * @client: the client
+ * @line: a JSON-RPC message the server initiated
+ *
+ * Sends @line as an event on every open GET stream. Messages arriving
+ * while no stream is open are dropped.
+ */
+static void
+http_client_broadcast (HttpClient  *client,
+                       const gchar *line)
+{
+    g_autofree gchar *event = NULL;
+    guint i;
+
+    if (client->streams->len == 0)
+    {
+        g_debug ("HTTP client %s: no stream open, dropping: %s", client->id, line);
+        return;
+    }
+
+    event = g_strdup_printf ("event: message\ndata: %s\n\n", line);
+    for (i = 0; i < client->streams->len; i++)
+    {
+        SoupServerMessage *msg = g_ptr_array_index (client->streams, i);
+
+        soup_message_body_append (soup_server_message_get_response_body (msg),
+                                  SOUP_MEMORY_COPY, event, strlen (event));
+        soup_server_message_unpause (msg);
+    }
+}
+
+/*
+ * http_client_route:
+ * @client: the client
+ * @line: one message for the client
+ *
+ * Hands responses to the POST waiting for them and everything else to
+ * the GET streams.
+ */
+static void
+http_client_route (HttpClient  *client,
+                   const gchar *line)
+{
+    g_autoptr(JsonParser) parser = json_parser_new ();
+    g_autofree gchar *key = NULL;
+    JsonObject *object;
+    HttpExchange *exchange;
+
+    if (!json_parser_load_from_data (parser, line, -1, NULL) ||
+        !JSON_NODE_HOLDS_OBJECT (json_parser_get_root (parser)))
+    {
+        g_warning ("HTTP client %s: unparsable server message", client->id);
+        return;
+    }
+
+    object = json_node_get_object (json_parser_get_root (parser));
+    if (json_object_has_member (object, "method") ||
+        (key = http_message_id_key (object)) == NULL ||
+        (exchange = g_hash_table_lookup (client->pending, key)) == NULL)
+    {
+        http_client_broadcast (client, line);
+        return;
+    }
+
+    json_array_add_element (exchange->responses,
+                            json_node_copy (json_parser_get_root (parser)));
+    if (--exchange->remaining == 0)
+    {
+        http_exchange_complete (exchange);
+    }
+    g_hash_table_remove (client->pending, key);
+}
+
+static void
+on_http_client_message (const gchar *line,
+                        gpointer     user_data)
+{
+    HttpClient *client = (HttpClient *)user_data;
+
+    if (line == NULL)
+    {
+        /* The McpServer closed its end */
+        http_client_remove (client);
+        return;
+    }
+
+    http_client_route (client, line);
+}
+
+/* --- Client Lifecycle ---------------------------------------------------- */
+
+/*
+ * http_client_new:
+ * @self: the server
+ * @error: return location for error
+ *
+ * Creates a client with its own McpServer and session manager, and
+ * registers it under a fresh Mcp-Session-Id.
+ *
+ * Returns: (transfer none) (nullable): the client, owned by the server
+ */
+static HttpClient *
+http_client_new (GdbMcpServer  *self,
+                 GError       **error)
+{
+    g_autoptr(McpServer) mcp_server = NULL;
+    HttpClient *client;
+
+    client = g_slice_new0 (HttpClient);
+    client->ref_count = 1;
+    client->server = self;
+    client->id = g_uuid_string_random ();
+    client->manager = client_manager_new (self);
+    client->pending = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                             (GDestroyNotify) http_exchange_unref);
+    client->streams = g_ptr_array_new_with_free_func (g_object_unref);
+    client->last_seen = g_get_monotonic_time ();
+
+    mcp_server = client_mcp_server_new (self, client->manager);
+    client->link = link_new (mcp_server, on_http_client_message, client, error);
+    if (client->link == NULL)
+    {
+        http_client_unref (client);
+        return NULL;
+    }
+
+    g_hash_table_insert (self->http_clients, client->id, client);
+
+    g_message ("HTTP client %s connected", client->id);
+
+    return client;
+}
+
+/*
+ * http_client_remove:
+ * @client: the client
+ *
+ * Ends the client: its own GDB sessions are terminated, waiting requests
+ * fail with 404 and open streams are closed. Safe to call twice.
+ */
+static void
+http_client_remove (HttpClient *client)
+{
+    GdbMcpServer *self = client->server;
+    g_autoptr(GPtrArray) streams = NULL;
+    GHashTableIter iter;
+    gpointer value;
+    guint i;
+
+    if (client->link == NULL)
+    {
+        return;
+    }
+
+    g_message ("HTTP client %s disconnected", client->id);
+
+    g_clear_pointer (&client->link, link_close);
+    client_manager_end_sessions (self, client->manager);
+
+    g_hash_table_iter_init (&iter, client->pending);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+        HttpExchange *exchange = (HttpExchange *)value;
+
+        if (exchange->msg != NULL)
+        {
+            http_respond_error (exchange->msg, SOUP_STATUS_NOT_FOUND,
+                                -32000, "Session terminated");
+            soup_server_message_unpause (exchange->msg);
+            exchange->msg = NULL;
+        }
+    }
+    g_hash_table_remove_all (client->pending);
+
+    /* Ending a stream may emit "finished", which edits the array */
+    streams = g_steal_pointer (&client->streams);
+    client->streams = g_ptr_array_new_with_free_func (g_object_unref);
+    for (i = 0; i < streams->len; i++)
+    {
+        SoupServerMessage *msg = g_ptr_array_index (streams, i);
+
+        soup_message_body_complete (soup_server_message_get_response_body (msg));
+        soup_server_message_unpause (msg);
+    }
+
+    /* Drops the server's reference */
+    g_hash_table_remove (self->http_clients, client->id);
+}
+
+static gboolean
+on_http_sweep (gpointer user_data)
+{
+    GdbMcpServer *self = GDB_MCP_SERVER (user_data);
+    g_autoptr(GPtrArray) idle = g_ptr_array_new ();
+    gint64 cutoff;
+    GHashTableIter iter;
+    gpointer value;
+    guint i;
+
+    cutoff = g_get_monotonic_time () - HTTP_CLIENT_TIMEOUT_SECONDS * G_USEC_PER_SEC;
+
+    g_hash_table_iter_init (&iter, self->http_clients);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+        HttpClient *client = (HttpClient *)value;
+
+        if (client->last_seen < cutoff &&
+            client->streams->len == 0 &&
+            g_hash_table_size (client->pending) == 0)
+        {
+            g_ptr_array_add (idle, client);
+        }
+    }
+
+    for (i = 0; i < idle->len; i++)
+    {
+        http_client_remove (g_ptr_array_index (idle, i));
+    }
+
+    return G_SOURCE_CONTINUE;
+}
+
+/* --- Request Handling ---------------------------------------------------- */
+
+static void
+on_stream_closure_notify (gpointer  data,
+                          GClosure *closure G_GNUC_UNUSED)
+{
+    http_client_unref ((HttpClient *)data);
+}
+
+static void
+on_stream_finished (SoupServerMessage *msg,
+                    gpointer           user_data)
+{
+    HttpClient *client = (HttpClient *)user_data;
+
+    g_ptr_array_remove (client->streams, msg);
+}
+
+/*
+ * http_handle_post:
+ * @self: the server
+ * @msg: the request
+ * @client: (nullable): the client named by the request
+ *
+ * Forwards the messages in the request body to the client's McpServer,
+ * creating the client on initialize.
+ */
+static void
+http_handle_post (GdbMcpServer      *self,
+                  SoupServerMessage *msg,
+                  HttpClient        *client)
+{
+    g_autoptr(JsonParser) parser = json_parser_new ();
+    g_autoptr(GError) error = NULL;
+    g_autoptr(GPtrArray) messages = g_ptr_array_new ();
+    SoupMessageBody *body;
+    HttpExchange *exchange = NULL;
+    JsonNode *root;
+    gboolean initialize = FALSE;
+    guint i;
+
+    body = soup_server_message_get_request_body (msg);
+    if (!json_parser_load_from_data (parser, body->data, body->length, &error))
+    {
+        http_respond_error (msg, SOUP_STATUS_BAD_REQUEST, -32700, error->message);
+        return;
+    }
+
+    root = json_parser_get_root (parser);
+    if (JSON_NODE_HOLDS_ARRAY (root))
+    {
+        JsonArray *array = json_node_get_array (root);
+
+        for (i = 0; i < json_array_get_length (array); i++)
+        {
+            g_ptr_array_add (messages, json_array_get_element (array, i));
+        }
+    }
+    else
+    {
+        g_ptr_array_add (messages, root);
+    }
+
+    for (i = 0; i < messages->len; i++)
+    {
+        JsonNode *node = g_ptr_array_index (messages, i);
+
+        if (!JSON_NODE_HOLDS_OBJECT (node))
+        {
+            http_respond_error (msg, SOUP_STATUS_BAD_REQUEST, -32600, "Invalid Request");
+            return;
+        }
+        if (g_strcmp0 (json_object_get_string_member_with_default (
+                           json_node_get_object (node), "method", NULL),
+                       "initialize") == 0)
+        {
+            initialize = TRUE;
+        }
+    }
+
+    if (client == NULL)
+    {
+        if (!initialize)
+        {
+            http_respond_error (msg, SOUP_STATUS_BAD_REQUEST, -32000,
+                                "Missing " HTTP_SESSION_HEADER " header");
+            return;
+        }
+
+        client = http_client_new (self, &error);
+        if (client == NULL)
+        {
+            http_respond_error (msg, SOUP_STATUS_INTERNAL_SERVER_ERROR, -32603,
+                                error->message);
+            return;
+        }
+    }
+
+    soup_message_headers_replace (soup_server_message_get_response_headers (msg),
+                                  HTTP_SESSION_HEADER, client->id);
+
+    /* Requests are answered in this response; the rest only need sending */
+    for (i = 0; i < messages->len; i++)
+    {
+        JsonObject *object = json_node_get_object (g_ptr_array_index (messages, i));
+        gchar *key;
+
+        if (!json_object_has_member (object, "method") ||
+            (key = http_message_id_key (object)) == NULL)
+        {
+            continue;
+        }
+
+        /* A client reusing an id in flight gets the answer on the older POST */
+        if (g_hash_table_contains (client->pending, key))
+        {
+            g_free (key);
+            continue;
+        }
+
+        if (exchange == NULL)
+        {
+            exchange = g_slice_new0 (HttpExchange);
+            exchange->ref_count = 1;
+            exchange->msg = msg;
+            exchange->responses = json_array_new ();
+            exchange->batch = JSON_NODE_HOLDS_ARRAY (root);
+        }
+
+        exchange->remaining++;
+        g_hash_table_replace (client->pending, key, http_exchange_ref (exchange));
+    }
+
+    for (i = 0; i < messages->len; i++)
+    {
+        link_send (client->link, g_ptr_array_index (messages, i));
+    }
+
+    if (exchange == NULL)
+    {
+        soup_server_message_set_status (msg, SOUP_STATUS_ACCEPTED, NULL);
+        return;
+    }
+
+    /* The "finished" handler owns the first reference */
+    soup_server_message_pause (msg);
+    g_signal_connect_data (msg, "finished", G_CALLBACK (on_exchange_finished),
+                           exchange, on_exchange_closure_notify, 0);
+}
+
+/*
+ * http_handle_get:
+ * @msg: the request
+ * @client: the client named by the request
+ *
+ * Opens an event stream for messages the client's McpServer initiates.
+ */
+static void
+http_handle_get (SoupServerMessage *msg,
+                 HttpClient        *client)
+{
+    SoupMessageHeaders *headers;
+    const gchar *accept;
+
+    accept = soup_message_headers_get_one (soup_server_message_get_request_headers (msg),
+                                           "Accept");
+    if (accept == NULL || strstr (accept, "text/event-stream") == NULL)
+    {
+        soup_server_message_set_status (msg, SOUP_STATUS_NOT_ACCEPTABLE, NULL);
+        return;
+    }
+
+    headers = soup_server_message_get_response_headers (msg);
+    soup_message_headers_set_content_type (headers, "text/event-stream", NULL);
+    soup_message_headers_set_encoding (headers, SOUP_ENCODING_CHUNKED);
+    soup_message_headers_replace (headers, "Cache-Control", "no-cache");
+    soup_message_headers_replace (headers, HTTP_SESSION_HEADER, client->id);
+    soup_server_message_set_status (msg, SOUP_STATUS_OK, NULL);
+
+    g_ptr_array_add (client->streams, g_object_ref (msg));
+    g_signal_connect_data (msg, "finished", G_CALLBACK (on_stream_finished),
+                           http_client_ref (client), on_stream_closure_notify, 0);
+
+    /* Flushes the headers; the stream stays open until either side ends it */
+    soup_message_body_append (soup_server_message_get_response_body (msg),
+                              SOUP_MEMORY_STATIC, HTTP_STREAM_OPENED,
+                              strlen (HTTP_STREAM_OPENED));
+}
+
+/*
+ * http_origin_allowed:
+ * @origin: (nullable): the Origin header
+ *
+ * Non-browser clients send no Origin; browsers may only connect from a
+ * page served by this machine.
+ *
+ * Returns: %TRUE if @origin is absent or a loopback origin
+ */
+static gboolean
+http_origin_allowed (const gchar *origin)
+{
+    g_autoptr(GUri) uri = NULL;
+    g_autoptr(GInetAddress) address = NULL;
+    const gchar *scheme;
+    const gchar *host;
+
+    if (origin == NULL)
+    {
+        return TRUE;
+    }
+
+    /* An opaque origin, "null", does not parse */
+    uri = g_uri_parse (origin, G_URI_FLAGS_NONE, NULL);
+    if (uri == NULL)
+    {
+        return FALSE;
+    }
+
+    scheme = g_uri_get_scheme (uri);
+    host = g_uri_get_host (uri);
+    if ((g_strcmp0 (scheme, "http") != 0 && g_strcmp0 (scheme, "https") != 0) ||
+        host == NULL)
+    {
+        return FALSE;
+    }
+
+    if (g_ascii_strcasecmp (host, "localhost") == 0)
+    {
+        return TRUE;
+    }
+
+    address = g_inet_address_new_from_string (host);
+    return address != NULL && g_inet_address_get_is_loopback (address);
+}
+
+/*
+ * http_host_allowed:
+ * @msg: the request
+ * @host: (nullable): the Host header
+ *
+ * The Host must name the address and port the request arrived on, or
+ * "localhost" with that port when the address is a loopback one. A DNS
+ * name can be rebound to us by whoever controls it, so none is accepted.
+ *
+ * Returns: %TRUE if @host names the bound address
+ */
+static gboolean
+http_host_allowed (SoupServerMessage *msg,
+                   const gchar       *host)
+{
+    g_autoptr(GUri) uri = NULL;
+    g_autoptr(GInetAddress) address = NULL;
+    g_autofree gchar *uri_string = NULL;
+    GSocketAddress *local;
+    GInetAddress *local_address;
+    const gchar *name;
+    gint port;
+
+    local = soup_server_message_get_local_address (msg);
+    if (host == NULL || strpbrk (host, "@/?#") != NULL ||
+        !G_IS_INET_SOCKET_ADDRESS (local))
+    {
+        return FALSE;
+    }
+
+    /* A Host header is a URI authority, IPv6 brackets included */
+    uri_string = g_strconcat ("http://", host, NULL);
+    uri = g_uri_parse (uri_string, G_URI_FLAGS_NONE, NULL);
+    if (uri == NULL || g_uri_get_host (uri) == NULL)
+    {
+        return FALSE;
+    }
+
+    port = g_uri_get_port (uri);
+    if ((port == -1 ? 80 : port) !=
+        g_inet_socket_address_get_port (G_INET_SOCKET_ADDRESS (local)))
+    {
+        return FALSE;
+    }
+
+    name = g_uri_get_host (uri);
+    local_address = g_inet_socket_address_get_address (G_INET_SOCKET_ADDRESS (local));
+    if (g_ascii_strcasecmp (name, "localhost") == 0)
+    {
+        return g_inet_address_get_is_loopback (local_address);
+    }
+
+    address = g_inet_address_new_from_string (name);
+    return address != NULL && g_inet_address_equal (address, local_address);
+}
+
+static void
+http_handle_request (SoupServer        *server G_GNUC_UNUSED,
+                     SoupServerMessage *msg,
+                     const char        *path G_GNUC_UNUSED,
+                     GHashTable        *query G_GNUC_UNUSED,
+                     gpointer           user_data)
+{
+    GdbMcpServer *self = GDB_MCP_SERVER (user_data);
+    SoupMessageHeaders *headers;
+    const gchar *method;
+    const gchar *session_id;
+    HttpClient *client = NULL;
+
+    headers = soup_server_message_get_request_headers (msg);
+    if (!http_origin_allowed (soup_message_headers_get_one (headers, "Origin")))
+    {
+        http_respond_error (msg, SOUP_STATUS_FORBIDDEN, -32000, "Origin not allowed");
+        return;
+    }
+    if (!http_host_allowed (msg, soup_message_headers_get_one (headers, "Host")))
+    {
+        http_respond_error (msg, SOUP_STATUS_FORBIDDEN, -32000, "Host not allowed");
+        return;
+    }
+
+    method = soup_server_message_get_method (msg);
+    session_id = soup_message_headers_get_one (headers, HTTP_SESSION_HEADER);
+
+    if (session_id != NULL)
+    {
+        client = g_hash_table_lookup (self->http_clients, session_id);
+        if (client == NULL)
+        {
+            http_respond_error (msg, SOUP_STATUS_NOT_FOUND, -32001, "Unknown session");
+            return;
+        }
+        client->last_seen = g_get_monotonic_time ();
+    }
+
+    if (g_strcmp0 (method, SOUP_METHOD_POST) == 0)
+    {
+        http_handle_post (self, msg, client);
+    }
+    else if (client == NULL && (g_strcmp0 (method, SOUP_METHOD_GET) == 0 ||
+                                g_strcmp0 (method, SOUP_METHOD_DELETE) == 0))
+    {
+        http_respond_error (msg, SOUP_STATUS_BAD_REQUEST, -32000,
+                            "Missing " HTTP_SESSION_HEADER " header");
+    }
+    else if (g_strcmp0 (method, SOUP_METHOD_GET) == 0)
+    {
+        http_handle_get (msg, client);
+    }
+    else if (g_strcmp0 (method, SOUP_METHOD_DELETE) == 0)
+    {
+        http_client_remove (client);
+        soup_server_message_set_status (msg, SOUP_STATUS_NO_CONTENT, NULL);
+    }
+    else
+    {
+        soup_message_headers_replace (soup_server_message_get_response_headers (msg),
+                                      "Allow", "GET, POST, DELETE");
+        soup_server_message_set_status (msg, SOUP_STATUS_METHOD_NOT_ALLOWED, NULL);
+    }
+}
+
+/* ========================================================================== */
+/* Stream Transport                                                           */
+/* ========================================================================== */
+
+/*
+ * Over stdio and the Unix socket, clients send one JSON-RPC message per
+ * line, with no framing of our own. Each connection is a StreamClient
+ * whose messages go through a Link (see "Links"), so tool call responses
+ * are written as they finish, each with its id.
+ *
+ * Socket clients each get an McpServer and session manager (see
+ * "Clients") and end when they close the connection. The stdio client
+ * uses the server's own, and ends the server when stdin closes.
+ */
+
+/*
+ * StreamClient:
+ *
+ * One MCP client on stdio or connected to the Unix socket.
+ */
+typedef struct
+{
+    GdbMcpServer      *server;       /* Unowned; outlives its clients */
+    GIOStream         *connection;   /* NULL on stdio */
+    GdbSessionManager *manager;
+    LineReader        *input;
+    LineQueue         *output;
+    Link              *link;
+} StreamClient;
+
+static void
+stream_client_free (StreamClient *client)
+{
+    g_clear_pointer (&client->input, line_reader_close);
+    g_clear_pointer (&client->link, link_close);
+    g_clear_pointer (&client->output, line_queue_close);
+    client_manager_end_sessions (client->server, client->manager);
+    g_clear_object (&client->manager);
+
+    if (client->connection != NULL)
+    {
+        g_io_stream_close (client->connection, NULL, NULL);
+        g_object_unref (client->connection);
+    }
+
+    g_slice_free (StreamClient, client);
+}
+
+/*
+ * stream_client_end:
+ * @client: the client
+ *
+ * Drops a socket client, or stops the server when the stdio client
+ * leaves.
+ */
+static void
+stream_client_end (StreamClient *client)
+{
+    GdbMcpServer *self = client->server;
+
+    if (client == self->stdio_client)
+    {
+        g_message ("Client disconnected, shutting down");
+
+        if (self->main_loop != NULL)
+        {
+            g_main_loop_quit (self->main_loop);
+        }
+        return;
+    }
+
+    g_message ("Socket client disconnected");
+    g_ptr_array_remove_fast (self->socket_clients, client);
+}
+
+static void
+on_stream_client_request (const gchar *line,
+                          gpointer     user_data)
+{
+    StreamClient *client = (StreamClient *)user_data;
+
+    if (line == NULL)
+    {
+        stream_client_end (client);
+        return;
+    }
+
+    link_send_line (client->link, line);
+}
+
+static void
+on_stream_client_reply (const gchar *line,
+                        gpointer     user_data)
+{
+    StreamClient *client = (StreamClient *)user_data;
+
+    if (line == NULL)
+    {
+        stream_client_end (client);
+        return;
+    }
+
+    line_queue_push (client->output, line);
+}
+
+/*
+ * stream_client_new:
+ * @self: the server
+ * @input: the stream the client writes to
+ * @output: the stream the client reads from
+ * @mcp_server: the McpServer answering the client
+ * @manager: the client's session manager
+ * @error: return location for error
+ *
+ * Returns: (transfer full) (nullable): the client, already reading
+ */
+static StreamClient *
+stream_client_new (GdbMcpServer       *self,
+                   GInputStream       *input,
+                   GOutputStream      *output,
+                   McpServer          *mcp_server,
+                   GdbSessionManager  *manager,
+                   GError            **error)
+{
+    StreamClient *client;
+
+    client = g_slice_new0 (StreamClient);
+    client->server = self;
+    client->manager = g_object_ref (manager);
+
+    client->link = link_new (mcp_server, on_stream_client_reply, client, error);
+    if (client->link == NULL)
+    {
+        stream_client_free (client);
+        return NULL;
+    }
+
+    client->output = line_queue_new (output);
+    client->input = line_reader_new (input, on_stream_client_request, client);
+
+    return client;
+}
+
+static gboolean
+on_socket_incoming (GSocketService    *service G_GNUC_UNUSED,
+                    GSocketConnection *connection,
+                    GObject           *source_object G_GNUC_UNUSED,
+                    gpointer           user_data)
+{
+    GdbMcpServer *self = GDB_MCP_SERVER (user_data);
+    g_autoptr(GdbSessionManager) manager = NULL;
+    g_autoptr(McpServer) mcp_server = NULL;
+    g_autoptr(GError) error = NULL;
+    StreamClient *client;
+
+    manager = client_manager_new (self);
+    mcp_server = client_mcp_server_new (self, manager);
+
+    client = stream_client_new (self,
+                                g_io_stream_get_input_stream (G_IO_STREAM (connection)),
+                                g_io_stream_get_output_stream (G_IO_STREAM (connection)),
+                                mcp_server, manager, &error);
+    if (client == NULL)
+    {
+        g_warning ("Failed to accept socket client: %s", error->message);
+        return TRUE;
+    }
+    client->connection = G_IO_STREAM (g_object_ref (connection));
+
+    g_ptr_array_add (self->socket_clients, client);
+    g_message ("Socket client connected");
+
+    return TRUE;
+}
+
+/* ========================================================================== */
+/* GObject Implementation                                                     */
+/* ========================================================================== */
+
+/*
+ * end_all_sessions:
+ * @self: the server
+ *
+ * Terminates the sessions of the server's own manager and of every
+ * client's. A tool call blocked on one of them, such as a
+ * gdb_wait_for_stop without a deadline, fails once GDB's output ends.
+ */
+static void
+end_all_sessions (GdbMcpServer *self)
+{
+    GHashTableIter iter;
+    gpointer value;
+    guint i;
+
+    if (self->session_manager != NULL)
+    {
+        gdb_session_manager_terminate_all (self->session_manager);
+    }
+
+    g_hash_table_iter_init (&iter, self->http_clients);
+    while (g_hash_table_iter_next (&iter, NULL, &value))
+    {
+        client_manager_end_sessions (self, ((HttpClient *)value)->manager);
+    }
+
+    for (i = 0; i < self->socket_clients->len; i++)
+    {
+        StreamClient *client = g_ptr_array_index (self->socket_clients, i);
+
+        client_manager_end_sessions (self, client->manager);
+    }
+
+    if (self->stdio_client != NULL)
+    {
+        client_manager_end_sessions (self, ((StreamClient *)self->stdio_client)->manager);
+    }
+}
+
+static void
+gdb_mcp_server_dispose (GObject *object)
+{
+    GdbMcpServer *self = GDB_MCP_SERVER (object);
+
+    /* Let running tool calls finish before their objects go away. One
+     * may wait on its session indefinitely, so end the sessions first.
+     */
+    end_all_sessions (self);
+
+    g_mutex_lock (&self->dispatch_lock);
+    while (self->running > 0)
+    {
+        g_cond_wait (&self->dispatch_idle, &self->dispatch_lock);
+    }
+    g_mutex_unlock (&self->dispatch_lock);
+
+    if (self->http_server != NULL)
+    {
+        g_autoptr(GList) clients = g_hash_table_get_values (self->http_clients);
+        GList *l;
+
+        g_clear_handle_id (&self->http_sweep_id, g_source_remove);
+        soup_server_disconnect (self->http_server);
+        for (l = clients; l != NULL; l = l->next)
+        {
+            http_client_remove (l->data);
+        }
+        g_clear_object (&self->http_server);
+    }
+
+    if (self->socket_service != NULL)
+    {
+        g_socket_service_stop (self->socket_service);
+        g_socket_listener_close (G_SOCKET_LISTENER (self->socket_service));
+        g_clear_object (&self->socket_service);
+        g_unlink (self->socket_path);
+    }
+    g_ptr_array_set_size (self->socket_clients, 0);
+    g_clear_pointer (&self->stdio_client, stream_client_free);
+
+    g_clear_object (&self->mcp_server);
+    g_clear_object (&self->session_manager);
+
+    if (self->main_loop != NULL)
+    {
+        g_main_loop_unref (self->main_loop);
+        self->main_loop = NULL;
+    }
+
+    G_OBJECT_CLASS (gdb_mcp_server_parent_class)->dispose (object);
+}
+
+static void
+gdb_mcp_server_finalize (GObject *object)
+{
+    GdbMcpServer *self = GDB_MCP_SERVER (object);
+
+    g_free (self->name);
+    g_free (self->version);
+    g_free (self->default_gdb_path);
+    g_hash_table_unref (self->session_calls);
+    g_hash_table_unref (self->http_clients);
+    g_ptr_array_unref (self->socket_clients);
+    g_free (self->socket_path);
+    g_mutex_clear (&self->dispatch_lock);
+    g_cond_clear (&self->dispatch_idle);
+
+    G_OBJECT_CLASS (gdb_mcp_server_parent_class)->finalize (object);
+}
+
+static void
+gdb_mcp_server_get_property (GObject    *object,
+                             guint       prop_id,
+                             GValue     *value,
+                             GParamSpec *pspec)
+{
+    GdbMcpServer *self = GDB_MCP_SERVER (object);
+
+    switch (prop_id)
+    {
+        case PROP_NAME:
+            g_value_set_string (value, self->name);
+            break;
+
+        case PROP_VERSION:
+            g_value_set_string (value, self->version);
+            break;
+
+        case PROP_DEFAULT_GDB_PATH:
+            g_value_set_string (value, self->default_gdb_path);
+            break;
+
+        case PROP_SESSION_MANAGER:
+            g_value_set_object (value, self->session_manager);
+            break;
+
+        case PROP_MAX_WORKERS:
+            g_value_set_uint (value, gdb_mcp_server_get_max_workers (self));
+            break;
+
+        case PROP_SHARE_SESSIONS:
+            g_value_set_boolean (value, self->share_sessions);
+            break;
+
+        default:
+            G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
+    }
+}
+
+static void
+gdb_mcp_server_set_property (GObject      *object,
+                             guint         prop_id,
+                             const GValue *value,
+                             GParamSpec   *pspec)
+{
+    GdbMcpServer *self = GDB_MCP_SERVER (object);
 
     switch (prop_id)
     {
@@ -542,6 +2647,14 @@ gdb_mcp_server_set_property (GObject      *object,
             }
             break;
 
+        case PROP_MAX_WORKERS:
+            gdb_mcp_server_set_max_workers (self, g_value_get_uint (value));
+            break;
+
+        case PROP_SHARE_SESSIONS:
+            gdb_mcp_server_set_share_sessions (self, g_value_get_boolean (value));
+            break;
+
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
     }
@@ -566,12 +2679,8 @@ gdb_mcp_server_constructed (GObject *object)
             self->session_manager, self->default_gdb_path);
     }
 
-    /* Connect signals */
-    g_signal_connect (self->mcp_server, "client-disconnected",
-                      G_CALLBACK (on_client_disconnected), self);
-
     /* Register all tools */
-    register_all_tools (self);
+    register_all_tools (self, self->mcp_server, self->session_manager);
 }
 
 static void
@@ -585,6 +2694,9 @@ gdb_mcp_server_class_init (GdbMcpServerClass *klass)
     object_class->set_property = gdb_mcp_server_set_property;
     object_class->constructed = gdb_mcp_server_constructed;
 
+    /* Tool calls run as fibers (see "Tool Dispatch") */
+    dex_init ();
+
     /**
      * GdbMcpServer:name:
      *
@@ -639,6 +2751,37 @@ gdb_mcp_server_class_init (GdbMcpServerClass *klass)
                              G_PARAM_READABLE |
                              G_PARAM_STATIC_STRINGS);
 
+    /**
+     * GdbMcpServer:max-workers:
+     *
+     * Number of tool calls that may run at once. Calls run as fibers,
+     * so this bounds outstanding GDB work rather than threads. Calls on
+     * the same session always run one at a time.
+     */
+    properties[PROP_MAX_WORKERS] =
+        g_param_spec_uint ("max-workers",
+                           "Max Workers",
+                           "Number of tool calls that may run at once",
+                           1, MAX_WORKERS, DEFAULT_MAX_WORKERS,
+                           G_PARAM_READWRITE |
+                           G_PARAM_STATIC_STRINGS);
+
+    /**
+     * GdbMcpServer:share-sessions:
+     *
+     * Whether clients connecting over HTTP or the Unix socket use the
+     * server's session manager, and so see each other's sessions,
+     * instead of one of their own. Applies to clients connecting after
+     * it is set.
+     */
+    properties[PROP_SHARE_SESSIONS] =
+        g_param_spec_boolean ("share-sessions",
+                              "Share Sessions",
+                              "Whether network clients share one session manager",
+                              FALSE,
+                              G_PARAM_READWRITE |
+                              G_PARAM_STATIC_STRINGS);
+
     g_object_class_install_properties (object_class, N_PROPS, properties);
 }
 
@@ -651,6 +2794,25 @@ gdb_mcp_server_init (GdbMcpServer *self)
     self->mcp_server = NULL;
     self->session_manager = NULL;
     self->main_loop = NULL;
+
+    g_mutex_init (&self->dispatch_lock);
+    g_cond_init (&self->dispatch_idle);
+    self->session_calls = g_hash_table_new_full (g_str_hash, g_str_equal, g_free,
+                                                 (GDestroyNotify) g_queue_free);
+    g_queue_init (&self->ready);
+    self->running = 0;
+    self->max_workers = DEFAULT_MAX_WORKERS;
+
+    self->http_server = NULL;
+    self->http_clients = g_hash_table_new_full (g_str_hash, g_str_equal, NULL,
+                                                (GDestroyNotify) http_client_unref);
+    self->http_sweep_id = 0;
+
+    self->stdio_client = NULL;
+    self->socket_service = NULL;
+    self->socket_path = NULL;
+    self->socket_clients = g_ptr_array_new_with_free_func ((GDestroyNotify) stream_client_free);
+    self->share_sessions = FALSE;
 }
 
 /* ========================================================================== */
@@ -692,23 +2854,288 @@ gdb_mcp_server_get_default_gdb_path (GdbMcpServer *self)
     return self->default_gdb_path;
 }
 
+guint
+gdb_mcp_server_get_max_workers (GdbMcpServer *self)
+{
+    g_return_val_if_fail (GDB_IS_MCP_SERVER (self), 0);
+
+    return self->max_workers;
+}
+
 void
-gdb_mcp_server_run (GdbMcpServer *self)
+gdb_mcp_server_set_max_workers (GdbMcpServer *self,
+                                guint         max_workers)
 {
-    g_autoptr(McpStdioTransport) transport = NULL;
+    g_return_if_fail (GDB_IS_MCP_SERVER (self));
+    g_return_if_fail (max_workers >= 1);
+
+    max_workers = MIN (max_workers, MAX_WORKERS);
+
+    g_mutex_lock (&self->dispatch_lock);
+    if (self->max_workers == max_workers)
+    {
+        g_mutex_unlock (&self->dispatch_lock);
+        return;
+    }
+
+    self->max_workers = max_workers;
+
+    /* A raised limit starts waiting calls right away */
+    {
+        ToolCall *next;
+
+        while (self->running < self->max_workers &&
+               (next = g_queue_pop_head (&self->ready)) != NULL)
+        {
+            dispatch_start_locked (self, next);
+        }
+    }
+    g_mutex_unlock (&self->dispatch_lock);
+
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MAX_WORKERS]);
+}
+
+gboolean
+gdb_mcp_server_listen (GdbMcpServer  *self,
+                       const gchar   *host,
+                       guint          port,
+                       GError       **error)
+{
+    g_autoptr(GSocketAddress) address = NULL;
+    g_autoptr(SoupServer) http_server = NULL;
+
+    g_return_val_if_fail (GDB_IS_MCP_SERVER (self), FALSE);
+    g_return_val_if_fail (self->http_server == NULL, FALSE);
+    g_return_val_if_fail (port <= G_MAXUINT16, FALSE);
+
+    if (host == NULL)
+    {
+        host = "127.0.0.1";
+    }
+
+    address = g_inet_socket_address_new_from_string (host, port);
+    if (address == NULL)
+    {
+        g_set_error (error, GDB_ERROR, GDB_ERROR_INVALID_ARGUMENT,
+                     "Invalid listen address: %s", host);
+        return FALSE;
+    }
+
+    http_server = soup_server_new ("server-header", "gdb-mcp-server ", NULL);
+    soup_server_add_handler (http_server, HTTP_ENDPOINT, http_handle_request, self, NULL);
+    if (!soup_server_listen (http_server, address, 0, error))
+    {
+        return FALSE;
+    }
+
+    self->http_server = g_steal_pointer (&http_server);
+    self->http_sweep_id = g_timeout_add_seconds (HTTP_SWEEP_INTERVAL_SECONDS,
+                                                 on_http_sweep, self);
+
+    return TRUE;
+}
+
+guint
+gdb_mcp_server_get_port (GdbMcpServer *self)
+{
+    GSList *uris;
+    guint port;
+
+    g_return_val_if_fail (GDB_IS_MCP_SERVER (self), 0);
+
+    if (self->http_server == NULL)
+    {
+        return 0;
+    }
+
+    uris = soup_server_get_uris (self->http_server);
+    port = uris != NULL ? (guint) g_uri_get_port (uris->data) : 0;
+    g_slist_free_full (uris, (GDestroyNotify) g_uri_unref);
+
+    return port;
+}
+
+/*
+ * socket_unlink_stale:
+ * @path: the socket path
+ * @address: the address of @path
+ * @error: return location for error
+ *
+ * Removes a socket at @path that was left by a server that died, which
+ * would make bind fail. Only a refused connection proves that nobody is
+ * listening; anything else is left for bind to report.
+ *
+ * Returns: %FALSE if a running server owns @path
+ */
+static gboolean
+socket_unlink_stale (const gchar     *path,
+                     GSocketAddress  *address,
+                     GError         **error)
+{
+    g_autoptr(GSocket) probe = NULL;
+    g_autoptr(GError) local_error = NULL;
+    GStatBuf st;
+
+    if (g_lstat (path, &st) != 0 || !S_ISSOCK (st.st_mode))
+    {
+        return TRUE;
+    }
+
+    probe = g_socket_new (G_SOCKET_FAMILY_UNIX, G_SOCKET_TYPE_STREAM,
+                          G_SOCKET_PROTOCOL_DEFAULT, error);
+    if (probe == NULL)
+    {
+        return FALSE;
+    }
+
+    /* A server with a full backlog must not block us */
+    g_socket_set_blocking (probe, FALSE);
+
+    if (g_socket_connect (probe, address, NULL, &local_error) ||
+        g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_PENDING) ||
+        g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_WOULD_BLOCK))
+    {
+        g_set_error (error, G_IO_ERROR, G_IO_ERROR_ADDRESS_IN_USE,
+                     "Another server is listening on %s", path);
+        return FALSE;
+    }
+
+    if (g_error_matches (local_error, G_IO_ERROR, G_IO_ERROR_CONNECTION_REFUSED))
+    {
+        g_unlink (path);
+    }
+
+    return TRUE;
+}
+
+gboolean
+gdb_mcp_server_listen_socket (GdbMcpServer  *self,
+                              const gchar   *path,
+                              GError       **error)
+{
+    g_autoptr(GSocketAddress) address = NULL;
+    g_autoptr(GSocketService) service = NULL;
+    g_autoptr(GSocket) socket = NULL;
+
+    g_return_val_if_fail (GDB_IS_MCP_SERVER (self), FALSE);
+    g_return_val_if_fail (path != NULL, FALSE);
+    g_return_val_if_fail (self->socket_service == NULL, FALSE);
+
+    address = g_unix_socket_address_new (path);
+    if (!socket_unlink_stale (path, address, error))
+    {
+        return FALSE;
+    }
+
+    socket = g_socket_new (G_SOCKET_FAMILY_UNIX, G_SOCKET_TYPE_STREAM,
+                           G_SOCKET_PROTOCOL_DEFAULT, error);
+    if (socket == NULL || !g_socket_bind (socket, address, FALSE, error))
+    {
+        return FALSE;
+    }
+
+    /* Every client gets a GDB that runs as us, so only we may connect.
+     * Restricted before listen(), so nobody gets in during the chmod.
+     */
+    if (g_chmod (path, 0600) != 0)
+    {
+        int saved_errno = errno;
+
+        g_set_error (error, G_IO_ERROR, g_io_error_from_errno (saved_errno),
+                     "Failed to restrict %s: %s", path, g_strerror (saved_errno));
+        g_unlink (path);
+        return FALSE;
+    }
+
+    service = g_socket_service_new ();
+    if (!g_socket_listen (socket, error) ||
+        !g_socket_listener_add_socket (G_SOCKET_LISTENER (service), socket, NULL, error))
+    {
+        g_unlink (path);
+        return FALSE;
+    }
+
+    g_signal_connect (service, "incoming", G_CALLBACK (on_socket_incoming), self);
+    g_socket_service_start (service);
+
+    self->socket_service = g_steal_pointer (&service);
+    self->socket_path = g_strdup (path);
+
+    return TRUE;
+}
+
+gboolean
+gdb_mcp_server_get_share_sessions (GdbMcpServer *self)
+{
+    g_return_val_if_fail (GDB_IS_MCP_SERVER (self), FALSE);
+
+    return self->share_sessions;
+}
+
+void
+gdb_mcp_server_set_share_sessions (GdbMcpServer *self,
+                                   gboolean      share_sessions)
+{
+    g_return_if_fail (GDB_IS_MCP_SERVER (self));
+
+    share_sessions = !!share_sessions;
+    if (self->share_sessions == share_sessions)
+    {
+        return;
+    }
+
+    self->share_sessions = share_sessions;
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SHARE_SESSIONS]);
+}
+
+guint
+gdb_mcp_server_get_client_count (GdbMcpServer *self)
+{
+    g_return_val_if_fail (GDB_IS_MCP_SERVER (self), 0);
+
+    return g_hash_table_size (self->http_clients) + self->socket_clients->len;
+}
 
+void
+gdb_mcp_server_run (GdbMcpServer *self)
+{
     g_return_if_fail (GDB_IS_MCP_SERVER (self));
 
     /* Create main loop */
     self->main_loop = g_main_loop_new (NULL, FALSE);
 
-    /* Set up stdio transport */
-    transport = mcp_stdio_transport_new ();
-    mcp_server_set_transport (self->mcp_server, MCP_TRANSPORT (transport));
-
-    /* Start the server */
     g_message ("Starting GDB MCP Server (%s %s)...", self->name, self->version);
-    mcp_server_start_async (self->mcp_server, NULL, NULL, NULL);
+
+    if (self->http_server != NULL || self->socket_service != NULL)
+    {
+        /* Clients arrive through the HTTP handler or the socket service */
+        if (self->http_server != NULL)
+        {
+            g_message ("Listening on port %u, endpoint %s",
+                       gdb_mcp_server_get_port (self), HTTP_ENDPOINT);
+        }
+        if (self->socket_service != NULL)
+        {
+            g_message ("Listening on socket %s", self->socket_path);
+        }
+    }
+    else if (self->stdio_client == NULL)
+    {
+        g_autoptr(GInputStream) input = NULL;
+        g_autoptr(GOutputStream) output = NULL;
+        g_autoptr(GError) error = NULL;
+
+        /* Serve stdio through a link, like any other client */
+        input = g_unix_input_stream_new (STDIN_FILENO, FALSE);
+        output = g_unix_output_stream_new (STDOUT_FILENO, FALSE);
+        self->stdio_client = stream_client_new (self, input, output, self->mcp_server,
+                                                self->session_manager, &error);
+        if (self->stdio_client == NULL)
+        {
+            g_critical ("Failed to serve stdio: %s", error->message);
+            return;
+        }
+    }
 
     /* Run the main loop */
     g_main_loop_run (self->main_loop);
@@ -7,29 +7,75 @@
 
 #include "mcp-gdb/gdb-session-manager.h"
 
+#include <errno.h>
 #include <string.h>
 
 #define DEFAULT_TIMEOUT_MS 10000
 #define DEFAULT_GDB_PATH   "gdb"
+#define DEFAULT_POOL_SIZE  0
+#define MAX_POOL_SIZE      32
+
+#define REAPER_INTERVAL_SECONDS 5
 
 /* ========================================================================== */
 /* GdbSessionManager Structure                                                */
 /* ========================================================================== */
 
+/*
+ * SessionSlot:
+ *
+ * One entry of the session table. A handle names a slot and the
+ * generation it was issued for; the generation is bumped whenever the
+ * slot is freed, so handles of removed sessions never match again.
+ */
+typedef struct {
+    guint32     generation;
+    GdbSession *session;            /* NULL if free or reserved */
+} SessionSlot;
+
+/*
+ * SessionIndex:
+ *
+ * An immutable copy of the slot table, read without locking. It holds a
+ * reference on every session in it.
+ */
+typedef struct {
+    guint       n_slots;
+    guint       n_sessions;
+    SessionSlot slots[1];           /* n_slots entries */
+} SessionIndex;
+
+typedef struct _SessionLimits SessionLimits;
+
 struct _GdbSessionManager
 {
     GObject      parent_instance;
 
-    /* Session storage */
-    GHashTable  *sessions;          /* session_id -> GdbSession */
+    /* Session storage (see "Session Slots", protected by mutex) */
+    GArray      *slots;             /* SessionSlot, indexed by handle slot */
+    GArray      *free_slots;        /* guint32 slot numbers to reuse */
+    guint        n_sessions;        /* Slots holding a session */
     GMutex       mutex;             /* Thread safety */
 
+    /* Lock-free read index (see "Session Index") */
+    SessionIndex *index;            /* Immutable copy of slots */
+    gint         index_readers;     /* Lookups currently using an index */
+    GList       *index_retired;     /* Replaced indexes (protected by mutex) */
+
     /* Configuration */
     gchar       *default_gdb_path;
     guint        default_timeout_ms;
+    GdbStartupProfile default_startup_profile;
+
+    /* Warm pool of started, unclaimed sessions (protected by mutex) */
+    GQueue       pool;              /* READY GdbSession, oldest first */
+    guint        pool_size;         /* Target number of warm sessions */
+    guint        pool_starting;     /* Sessions spawned but not yet READY */
+    gboolean     pool_refill_queued;
+    GMainContext *pool_context;     /* Context the pool sessions run on */
 
-    /* Session ID generation */
-    guint64      session_counter;
+    /* Eviction limits, possibly shared (see "Reaper") */
+    SessionLimits *limits;
 };
 
 /* ========================================================================== */
@@ -41,6 +87,11 @@ enum {
     PROP_DEFAULT_GDB_PATH,
     PROP_DEFAULT_TIMEOUT_MS,
     PROP_SESSION_COUNT,
+    PROP_POOL_SIZE,
+    PROP_DEFAULT_STARTUP_PROFILE,
+    PROP_IDLE_TIMEOUT,
+    PROP_MAX_SESSIONS,
+    PROP_MEMORY_BUDGET,
     N_PROPS
 };
 
@@ -63,6 +114,18 @@ static GdbSessionManager *default_manager = NULL;
 
 G_DEFINE_TYPE (GdbSessionManager, gdb_session_manager, G_TYPE_OBJECT)
 
+static void pool_drain (GdbSessionManager *self,
+                        guint              keep);
+static void index_free (SessionIndex *index);
+static SessionIndex *index_new_locked (GdbSessionManager *self);
+static SessionLimits *session_limits_new (GMainContext *context);
+static SessionLimits *session_limits_ref (SessionLimits *limits);
+static void session_limits_unref (SessionLimits *limits);
+static void session_limits_join (SessionLimits     *limits,
+                                 GdbSessionManager *manager);
+static void session_limits_leave (SessionLimits     *limits,
+                                  GdbSessionManager *manager);
+
 /* ========================================================================== */
 /* GObject Implementation                                                     */
 /* ========================================================================== */
@@ -72,6 +135,15 @@ gdb_session_manager_dispose (GObject *object)
 {
     GdbSessionManager *self = GDB_SESSION_MANAGER (object);
 
+    /* Pending pool starts hold a reference, so only warm sessions remain */
+    g_mutex_lock (&self->mutex);
+    self->pool_size = 0;
+    g_mutex_unlock (&self->mutex);
+    pool_drain (self, 0);
+
+    /* Shared limits outlive us, but no longer count our sessions */
+    session_limits_leave (self->limits, self);
+
     gdb_session_manager_terminate_all (self);
 
     G_OBJECT_CLASS (gdb_session_manager_parent_class)->dispose (object);
@@ -82,8 +154,14 @@ gdb_session_manager_finalize (GObject *object)
 {
     GdbSessionManager *self = GDB_SESSION_MANAGER (object);
 
-    g_clear_pointer (&self->sessions, g_hash_table_unref);
+    g_clear_pointer (&self->slots, g_array_unref);
+    g_clear_pointer (&self->free_slots, g_array_unref);
+    g_clear_pointer (&self->index, index_free);
+    g_list_free_full (self->index_retired, (GDestroyNotify) index_free);
+    self->index_retired = NULL;
     g_clear_pointer (&self->default_gdb_path, g_free);
+    g_clear_pointer (&self->pool_context, g_main_context_unref);
+    g_clear_pointer (&self->limits, session_limits_unref);
     g_mutex_clear (&self->mutex);
 
     if (default_manager == self)
@@ -113,6 +191,21 @@ gdb_session_manager_get_property (GObject    *object,
         case PROP_SESSION_COUNT:
             g_value_set_uint (value, gdb_session_manager_get_session_count (self));
             break;
+        case PROP_POOL_SIZE:
+            g_value_set_uint (value, gdb_session_manager_get_pool_size (self));
+            break;
+        case PROP_DEFAULT_STARTUP_PROFILE:
+            g_value_set_enum (value, gdb_session_manager_get_default_startup_profile (self));
+            break;
+        case PROP_IDLE_TIMEOUT:
+            g_value_set_uint (value, gdb_session_manager_get_idle_timeout (self));
+            break;
+        case PROP_MAX_SESSIONS:
+            g_value_set_uint (value, gdb_session_manager_get_max_sessions (self));
+            break;
+        case PROP_MEMORY_BUDGET:
+            g_value_set_uint64 (value, gdb_session_manager_get_memory_budget (self));
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
             break;
@@ -135,6 +228,21 @@ gdb_session_manager_set_property (GObject      *object,
         case PROP_DEFAULT_TIMEOUT_MS:
             gdb_session_manager_set_default_timeout_ms (self, g_value_get_uint (value));
             break;
+        case PROP_POOL_SIZE:
+            gdb_session_manager_set_pool_size (self, g_value_get_uint (value));
+            break;
+        case PROP_DEFAULT_STARTUP_PROFILE:
+            gdb_session_manager_set_default_startup_profile (self, g_value_get_enum (value));
+            break;
+        case PROP_IDLE_TIMEOUT:
+            gdb_session_manager_set_idle_timeout (self, g_value_get_uint (value));
+            break;
+        case PROP_MAX_SESSIONS:
+            gdb_session_manager_set_max_sessions (self, g_value_get_uint (value));
+            break;
+        case PROP_MEMORY_BUDGET:
+            gdb_session_manager_set_memory_budget (self, g_value_get_uint64 (value));
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
             break;
@@ -187,6 +295,71 @@ gdb_session_manager_class_init (GdbSessionManagerClass *klass)
                            0, G_MAXUINT, 0,
                            G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
 
+    /**
+     * GdbSessionManager:pool-size:
+     *
+     * Number of started GDB processes kept warm for new sessions.
+     * 0 disables the pool.
+     */
+    properties[PROP_POOL_SIZE] =
+        g_param_spec_uint ("pool-size",
+                           "Pool Size",
+                           "Number of pre-started GDB processes kept for new sessions",
+                           0, MAX_POOL_SIZE, DEFAULT_POOL_SIZE,
+                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * GdbSessionManager:default-startup-profile:
+     *
+     * Startup profile for new sessions and the warm pool.
+     */
+    properties[PROP_DEFAULT_STARTUP_PROFILE] =
+        g_param_spec_enum ("default-startup-profile",
+                           "Default Startup Profile",
+                           "Startup profile for new sessions",
+                           GDB_TYPE_STARTUP_PROFILE,
+                           GDB_STARTUP_PROFILE_DEFAULT,
+                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * GdbSessionManager:idle-timeout:
+     *
+     * Seconds a session may go without commands before it is evicted.
+     * 0 keeps idle sessions.
+     */
+    properties[PROP_IDLE_TIMEOUT] =
+        g_param_spec_uint ("idle-timeout",
+                           "Idle Timeout",
+                           "Seconds without commands before a session is evicted",
+                           0, G_MAXUINT, 0,
+                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * GdbSessionManager:max-sessions:
+     *
+     * Number of sessions above which the least recently used idle ones
+     * are evicted. 0 means no limit.
+     */
+    properties[PROP_MAX_SESSIONS] =
+        g_param_spec_uint ("max-sessions",
+                           "Max Sessions",
+                           "Number of sessions kept before evicting the least recently used",
+                           0, G_MAXUINT, 0,
+                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * GdbSessionManager:memory-budget:
+     *
+     * Total resident memory, in bytes, the GDB processes may use before
+     * the least recently used idle sessions are evicted. 0 means no limit.
+     */
+    properties[PROP_MEMORY_BUDGET] =
+        g_param_spec_uint64 ("memory-budget",
+                             "Memory Budget",
+                             "Bytes of GDB resident memory kept before evicting sessions",
+                             0, G_MAXUINT64, 0,
+                             G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
     g_object_class_install_properties (object_class, N_PROPS, properties);
 
     /**
@@ -224,226 +397,1479 @@ static void
 gdb_session_manager_init (GdbSessionManager *self)
 {
     g_mutex_init (&self->mutex);
-    self->sessions = g_hash_table_new_full (g_str_hash, g_str_equal,
-                                            g_free, g_object_unref);
+    self->slots = g_array_new (FALSE, TRUE, sizeof (SessionSlot));
+    self->free_slots = g_array_new (FALSE, FALSE, sizeof (guint32));
+    self->index = index_new_locked (self);
     self->default_gdb_path = g_strdup (DEFAULT_GDB_PATH);
     self->default_timeout_ms = DEFAULT_TIMEOUT_MS;
-    self->session_counter = 0;
+    self->default_startup_profile = GDB_STARTUP_PROFILE_DEFAULT;
+    g_queue_init (&self->pool);
+    self->pool_size = DEFAULT_POOL_SIZE;
+    self->pool_context = g_main_context_ref_thread_default ();
+    self->limits = session_limits_new (self->pool_context);
+    session_limits_join (self->limits, self);
 }
 
 /* ========================================================================== */
-/* Public API                                                                 */
+/* Session Handles                                                            */
 /* ========================================================================== */
 
-GdbSessionManager *
-gdb_session_manager_new (void)
+#define HANDLE_SLOT(handle)       ((guint32) ((handle) & G_MAXUINT32))
+#define HANDLE_GENERATION(handle) ((guint32) ((handle) >> 32))
+#define HANDLE_MAKE(slot, gen)    ((((GdbSessionHandle) (gen)) << 32) | (slot))
+
+/*
+ * handle_parse_number:
+ * @str: the text
+ * @min: the smallest accepted value
+ * @value: (out): return location for the number
+ * @end: (out): return location for the first character after it
+ *
+ * Parses the decimal number at the start of @str, without the leading
+ * whitespace and sign g_ascii_strtoull() would accept.
+ *
+ * Returns: %TRUE if @str starts with a number in [@min, G_MAXUINT32]
+ */
+static gboolean
+handle_parse_number (const gchar  *str,
+                     guint64       min,
+                     guint64      *value,
+                     const gchar **end)
 {
-    return (GdbSessionManager *)g_object_new (GDB_TYPE_SESSION_MANAGER, NULL);
+    gchar *endptr;
+
+    if (!g_ascii_isdigit (*str))
+    {
+        return FALSE;
+    }
+
+    errno = 0;
+    *value = g_ascii_strtoull (str, &endptr, 10);
+    *end = endptr;
+
+    return errno == 0 && *value >= min && *value <= G_MAXUINT32;
 }
 
-GdbSessionManager *
-gdb_session_manager_get_default (void)
+gboolean
+gdb_session_handle_parse (const gchar      *session_id,
+                          GdbSessionHandle *handle)
 {
-    if (default_manager == NULL)
+    const gchar *end;
+    guint64 slot;
+    guint64 generation;
+
+    g_return_val_if_fail (handle != NULL, FALSE);
+
+    *handle = GDB_SESSION_HANDLE_INVALID;
+
+    /* Parsed in place: this runs on every lookup */
+    if (session_id == NULL ||
+        !handle_parse_number (session_id, 0, &slot, &end) || *end != '-' ||
+        !handle_parse_number (end + 1, 1, &generation, &end) || *end != '\0')
     {
-        default_manager = gdb_session_manager_new ();
+        return FALSE;
     }
 
-    return default_manager;
+    *handle = HANDLE_MAKE (slot, generation);
+    return TRUE;
 }
 
-const gchar *
-gdb_session_manager_get_default_gdb_path (GdbSessionManager *self)
+gchar *
+gdb_session_handle_to_string (GdbSessionHandle handle)
 {
-    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
-    return self->default_gdb_path;
+    return g_strdup_printf ("%u-%u",
+                            (guint) HANDLE_SLOT (handle),
+                            (guint) HANDLE_GENERATION (handle));
 }
 
-void
-gdb_session_manager_set_default_gdb_path (GdbSessionManager *self,
-                                          const gchar       *gdb_path)
-{
-    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+/* ========================================================================== */
+/* Session Slots                                                              */
+/* ========================================================================== */
 
-    g_free (self->default_gdb_path);
-    self->default_gdb_path = g_strdup (gdb_path ? gdb_path : DEFAULT_GDB_PATH);
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_DEFAULT_GDB_PATH]);
-}
+/*
+ * Sessions live in a slot array indexed by the small integer in their
+ * handle, so lookups are one bounds check and one generation compare
+ * instead of hashing the ID string. Freed slots are reused newest first.
+ * Warm pool sessions hold a reserved slot: their ID is fixed at
+ * construction, but they are not visible until handed out.
+ */
 
-guint
-gdb_session_manager_get_default_timeout_ms (GdbSessionManager *self)
+/*
+ * slot_reserve_locked:
+ *
+ * Returns: a handle for a new slot, not yet holding a session
+ *
+ * Must be called with mutex held.
+ */
+static GdbSessionHandle
+slot_reserve_locked (GdbSessionManager *self)
 {
-    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), DEFAULT_TIMEOUT_MS);
-    return self->default_timeout_ms;
+    SessionSlot fresh = { 1, NULL };
+    guint32 slot;
+
+    if (self->free_slots->len > 0)
+    {
+        slot = g_array_index (self->free_slots, guint32, self->free_slots->len - 1);
+        g_array_set_size (self->free_slots, self->free_slots->len - 1);
+    }
+    else
+    {
+        slot = self->slots->len;
+        g_array_append_val (self->slots, fresh);
+    }
+
+    return HANDLE_MAKE (slot, g_array_index (self->slots, SessionSlot, slot).generation);
 }
 
-void
-gdb_session_manager_set_default_timeout_ms (GdbSessionManager *self,
-                                            guint              timeout_ms)
+/*
+ * slot_get_locked:
+ *
+ * Returns: (nullable): the slot @handle was issued for, or %NULL if the
+ *     slot has been freed since
+ *
+ * Must be called with mutex held.
+ */
+static SessionSlot *
+slot_get_locked (GdbSessionManager *self,
+                 GdbSessionHandle   handle)
 {
-    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+    SessionSlot *slot;
 
-    self->default_timeout_ms = timeout_ms;
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_DEFAULT_TIMEOUT_MS]);
+    if (HANDLE_SLOT (handle) >= self->slots->len)
+    {
+        return NULL;
+    }
+
+    slot = &g_array_index (self->slots, SessionSlot, HANDLE_SLOT (handle));
+    if (slot->generation != HANDLE_GENERATION (handle))
+    {
+        return NULL;
+    }
+
+    return slot;
 }
 
-guint
-gdb_session_manager_get_session_count (GdbSessionManager *self)
+/*
+ * slot_release_locked:
+ * @session_id: the ID of a session holding or reserving a slot
+ *
+ * Frees the slot and drops its session reference, if any.
+ * Must be called with mutex held.
+ */
+static void
+slot_release_locked (GdbSessionManager *self,
+                     const gchar       *session_id)
 {
-    guint count;
+    GdbSessionHandle handle;
+    SessionSlot *slot;
+    guint32 slot_index;
 
-    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), 0);
+    if (!gdb_session_handle_parse (session_id, &handle) ||
+        (slot = slot_get_locked (self, handle)) == NULL)
+    {
+        return;
+    }
 
-    g_mutex_lock (&self->mutex);
-    count = g_hash_table_size (self->sessions);
-    g_mutex_unlock (&self->mutex);
+    if (slot->session != NULL)
+    {
+        g_clear_object (&slot->session);
+        self->n_sessions--;
+    }
 
-    return count;
+    /* Generation 0 never appears in a handle */
+    if (++slot->generation == 0)
+    {
+        slot->generation = 1;
+    }
+
+    slot_index = HANDLE_SLOT (handle);
+    g_array_append_val (self->free_slots, slot_index);
 }
 
-GdbSession *
-gdb_session_manager_create_session (GdbSessionManager *self,
-                                    const gchar       *gdb_path,
-                                    const gchar       *working_dir)
-{
-    GdbSession *session;
-    g_autofree gchar *session_id = NULL;
+/* ========================================================================== */
+/* Session Index                                                              */
+/* ========================================================================== */
 
-    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
+/*
+ * Lookups run on every tool call, creation and removal only on gdb_start
+ * and gdb_terminate. Readers therefore never take the mutex: they use an
+ * immutable copy of the slot table that writers replace wholesale
+ * (read-copy-update). A replaced index is retired, not freed, and is
+ * reclaimed once no lookup is in progress: by the writer if it sees no
+ * readers, otherwise by the last reader to leave. Each index holds its
+ * own session references, so a session found in a retired index stays
+ * alive until the index is reclaimed.
+ *
+ * index_readers is raised before the index pointer is loaded, and the
+ * writer checks it after publishing, so a reader either sees the new
+ * index or is counted (both are full barriers). Likewise the writer
+ * retires before checking index_readers and a reader drops out before
+ * checking index_retired, so one of them always reclaims.
+ */
 
-    g_mutex_lock (&self->mutex);
+static SessionIndex *
+index_new_locked (GdbSessionManager *self)
+{
+    SessionIndex *index;
+    guint i;
 
-    /* Generate unique session ID using timestamp + counter */
-    session_id = g_strdup_printf ("%" G_GINT64_FORMAT "-%lu",
-                                  g_get_real_time (),
-                                  (gulong) self->session_counter++);
+    index = g_malloc0 (G_STRUCT_OFFSET (SessionIndex, slots) +
+                       MAX (self->slots->len, 1) * sizeof (SessionSlot));
+    index->n_slots = self->slots->len;
+    index->n_sessions = self->n_sessions;
 
-    /* Use default GDB path if not specified */
-    if (gdb_path == NULL)
+    for (i = 0; i < index->n_slots; i++)
     {
-        gdb_path = self->default_gdb_path;
+        SessionSlot *slot = &g_array_index (self->slots, SessionSlot, i);
+
+        index->slots[i].generation = slot->generation;
+        index->slots[i].session = slot->session != NULL ? g_object_ref (slot->session) : NULL;
     }
 
-    /* Create session */
-    session = gdb_session_new (session_id, gdb_path, working_dir);
-    gdb_session_set_timeout_ms (session, self->default_timeout_ms);
+    return index;
+}
+
+static void
+index_free (SessionIndex *index)
+{
+    guint i;
 
-    /* Store in hash table */
-    g_hash_table_insert (self->sessions,
-                         g_strdup (session_id),
-                         g_object_ref (session));
+    for (i = 0; i < index->n_slots; i++)
+    {
+        g_clear_object (&index->slots[i].session);
+    }
+    g_free (index);
+}
 
-    g_mutex_unlock (&self->mutex);
+/*
+ * index_acquire:
+ *
+ * Returns: (transfer none): the current index, valid until index_release()
+ */
+static SessionIndex *
+index_acquire (GdbSessionManager *self)
+{
+    g_atomic_int_inc (&self->index_readers);
+    return (SessionIndex *) g_atomic_pointer_get (&self->index);
+}
 
-    g_signal_emit (self, signals[SIGNAL_SESSION_ADDED], 0, session);
-    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SESSION_COUNT]);
+/*
+ * index_reclaim_locked:
+ *
+ * Returns: (transfer full): the retired indexes if no lookup can still be
+ *   using them, to be freed after unlocking
+ */
+static GList *
+index_reclaim_locked (GdbSessionManager *self)
+{
+    GList *retired = NULL;
 
-    return session;
+    /* New readers only see the current index, which is never retired */
+    if (g_atomic_int_get (&self->index_readers) == 0)
+    {
+        retired = self->index_retired;
+        g_atomic_pointer_set (&self->index_retired, NULL);
+    }
+
+    return retired;
 }
 
-GdbSession *
-gdb_session_manager_get_session (GdbSessionManager *self,
-                                 const gchar       *session_id)
+static void
+index_release (GdbSessionManager *self)
 {
-    GdbSession *session;
+    GList *retired;
 
-    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
-    g_return_val_if_fail (session_id != NULL, NULL);
+    if (!g_atomic_int_dec_and_test (&self->index_readers) ||
+        g_atomic_pointer_get (&self->index_retired) == NULL)
+    {
+        return;
+    }
 
+    /* Last reader out: free what writers retired while it was reading.
+     * Only taken after a concurrent removal, so lookups stay lock-free.
+     */
     g_mutex_lock (&self->mutex);
-    session = (GdbSession *)g_hash_table_lookup (self->sessions, session_id);
+    retired = index_reclaim_locked (self);
     g_mutex_unlock (&self->mutex);
 
-    return session;
+    g_list_free_full (retired, (GDestroyNotify) index_free);
 }
 
-gboolean
-gdb_session_manager_remove_session (GdbSessionManager *self,
-                                    const gchar       *session_id)
+/*
+ * index_lookup:
+ *
+ * Returns: (transfer none) (nullable): the session @handle names in @index
+ */
+static GdbSession *
+index_lookup (SessionIndex     *index,
+              GdbSessionHandle  handle)
 {
-    GdbSession *session;
-    gboolean removed;
-
-    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), FALSE);
-    g_return_val_if_fail (session_id != NULL, FALSE);
-
-    g_mutex_lock (&self->mutex);
+    SessionSlot *slot;
 
-    session = (GdbSession *)g_hash_table_lookup (self->sessions, session_id);
-    if (session != NULL)
-    {
-        gdb_session_terminate (session);
-        removed = g_hash_table_remove (self->sessions, session_id);
-    }
-    else
+    if (HANDLE_SLOT (handle) >= index->n_slots)
     {
-        removed = FALSE;
+        return NULL;
     }
 
-    g_mutex_unlock (&self->mutex);
-
-    if (removed)
+    slot = &index->slots[HANDLE_SLOT (handle)];
+    if (slot->generation != HANDLE_GENERATION (handle))
     {
-        g_signal_emit (self, signals[SIGNAL_SESSION_REMOVED], 0, session_id);
-        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SESSION_COUNT]);
+        return NULL;
     }
 
-    return removed;
+    return slot->session;
 }
 
-GList *
-gdb_session_manager_list_sessions (GdbSessionManager *self)
+/*
+ * index_publish_locked:
+ *
+ * Publishes a copy of the slot table and retires the previous index.
+ * Must be called with mutex held, after every change to a slot's session.
+ */
+static void
+index_publish_locked (GdbSessionManager *self)
 {
-    GList *sessions;
-    GHashTableIter iter;
-    gpointer value;
+    SessionIndex *index;
 
-    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
+    index = index_new_locked (self);
 
-    sessions = NULL;
+    g_atomic_pointer_set (&self->index_retired,
+                          g_list_prepend (self->index_retired, self->index));
+    g_atomic_pointer_set (&self->index, index);
 
-    g_mutex_lock (&self->mutex);
+    /* Otherwise the last reader reclaims it in index_release() */
+    g_list_free_full (index_reclaim_locked (self), (GDestroyNotify) index_free);
+}
+
+/* ========================================================================== */
+/* Warm Pool                                                                  */
+/* ========================================================================== */
+
+/*
+ * The pool holds sessions that were started with the default GDB path and
+ * startup profile and no working directory, so a matching gdb_start skips
+ * spawning GDB and waiting for its first prompt. Sessions are started on
+ * the context that created the manager; refills run from an idle source
+ * there, so neither create_session() nor the thread calling it ever
+ * waits for a spawn.
+ */
 
-    g_hash_table_iter_init (&iter, self->sessions);
-    while (g_hash_table_iter_next (&iter, NULL, &value))
+/*
+ * pool_drain:
+ * @keep: number of warm sessions to keep
+ *
+ * Terminates the oldest warm sessions until at most @keep remain.
+ */
+static void
+pool_drain (GdbSessionManager *self,
+            guint              keep)
+{
+    g_autoptr(GPtrArray) stale = NULL;
+
+    stale = g_ptr_array_new_with_free_func (g_object_unref);
+
+    g_mutex_lock (&self->mutex);
+    while (self->pool.length > keep)
     {
-        sessions = g_list_prepend (sessions, g_object_ref (value));
-    }
+        GdbSession *session = g_queue_pop_head (&self->pool);
 
+        slot_release_locked (self, gdb_session_get_session_id (session));
+        g_ptr_array_add (stale, session);
+    }
     g_mutex_unlock (&self->mutex);
 
-    return sessions;
+    gdb_session_terminate_many (stale);
 }
 
-void
-gdb_session_manager_terminate_all (GdbSessionManager *self)
+static void
+on_pool_session_started (GObject      *source,
+                         GAsyncResult *result,
+                         gpointer      user_data)
 {
-    GList *session_ids;
-    GHashTableIter iter;
-    gpointer key;
+    g_autoptr(GdbSessionManager) self = GDB_SESSION_MANAGER (user_data);
+    GdbSession *session = GDB_SESSION (source);
+    g_autoptr(GError) error = NULL;
+    gboolean kept = FALSE;
 
-    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+    if (!gdb_session_start_finish (session, result, &error))
+    {
+        /* Not retried here, or a bad GDB path would respawn forever */
+        g_warning ("Failed to pre-start GDB for the session pool: %s",
+                   error->message);
+    }
 
     g_mutex_lock (&self->mutex);
-
-    /* Collect all session IDs first */
-    session_ids = NULL;
-    g_hash_table_iter_init (&iter, self->sessions);
-    while (g_hash_table_iter_next (&iter, &key, NULL))
+    self->pool_starting--;
+    if (error == NULL &&
+        self->pool.length < self->pool_size &&
+        g_strcmp0 (gdb_session_get_gdb_path (session), self->default_gdb_path) == 0 &&
+        gdb_session_get_startup_profile (session) == self->default_startup_profile)
     {
-        session_ids = g_list_prepend (session_ids, g_strdup ((gchar *)key));
+        g_queue_push_tail (&self->pool, g_object_ref (session));
+        kept = TRUE;
+    }
+    else
+    {
+        slot_release_locked (self, gdb_session_get_session_id (session));
     }
-
     g_mutex_unlock (&self->mutex);
 
-    /* Remove each session (this will emit signals) */
+    if (!kept)
     {
-        GList *l;
-        for (l = session_ids; l != NULL; l = l->next)
-        {
-            gdb_session_manager_remove_session (self, (gchar *)l->data);
-        }
+        gdb_session_terminate (session);
+    }
+}
+
+static gboolean
+pool_refill_cb (gpointer user_data)
+{
+    GdbSessionManager *self = GDB_SESSION_MANAGER (user_data);
+    g_autofree gchar *gdb_path = NULL;
+    GdbStartupProfile profile;
+    guint timeout_ms;
+    guint needed = 0;
+    guint i;
+
+    g_mutex_lock (&self->mutex);
+    self->pool_refill_queued = FALSE;
+    if (self->pool.length + self->pool_starting < self->pool_size)
+    {
+        needed = self->pool_size - self->pool.length - self->pool_starting;
+    }
+    self->pool_starting += needed;
+    gdb_path = g_strdup (self->default_gdb_path);
+    timeout_ms = self->default_timeout_ms;
+    profile = self->default_startup_profile;
+    g_mutex_unlock (&self->mutex);
+
+    /* Sessions and their start tasks belong to the pool context */
+    g_main_context_push_thread_default (self->pool_context);
+
+    for (i = 0; i < needed; i++)
+    {
+        g_autoptr(GdbSession) session = NULL;
+        g_autofree gchar *session_id = NULL;
+
+        g_mutex_lock (&self->mutex);
+        session_id = gdb_session_handle_to_string (slot_reserve_locked (self));
+        g_mutex_unlock (&self->mutex);
+
+        session = gdb_session_new (session_id, gdb_path, NULL);
+        gdb_session_set_timeout_ms (session, timeout_ms);
+        gdb_session_set_startup_profile (session, profile);
+
+        /* The task keeps the session alive until it is READY */
+        gdb_session_start_async (session, NULL, on_pool_session_started,
+                                 g_object_ref (self));
+    }
+
+    g_main_context_pop_thread_default (self->pool_context);
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * pool_schedule_refill:
+ *
+ * Queues a refill on the pool context if the pool is short.
+ * Must be called without mutex held.
+ */
+static void
+pool_schedule_refill (GdbSessionManager *self)
+{
+    GSource *source;
+
+    g_mutex_lock (&self->mutex);
+    if (self->pool_refill_queued ||
+        self->pool.length + self->pool_starting >= self->pool_size)
+    {
+        g_mutex_unlock (&self->mutex);
+        return;
+    }
+    self->pool_refill_queued = TRUE;
+    g_mutex_unlock (&self->mutex);
+
+    source = g_idle_source_new ();
+    g_source_set_callback (source, pool_refill_cb,
+                           g_object_ref (self), g_object_unref);
+    g_source_attach (source, self->pool_context);
+    g_source_unref (source);
+}
+
+/*
+ * pool_take_locked:
+ *
+ * Returns: (transfer full) (nullable): a READY warm session, or %NULL
+ *
+ * Warm sessions whose GDB exited while idle are moved to @dead.
+ * Must be called with mutex held.
+ */
+static GdbSession *
+pool_take_locked (GdbSessionManager  *self,
+                  GList             **dead)
+{
+    GdbSession *session;
+
+    while ((session = g_queue_pop_head (&self->pool)) != NULL)
+    {
+        if (gdb_session_get_state (session) == GDB_SESSION_STATE_READY)
+        {
+            return session;
+        }
+        slot_release_locked (self, gdb_session_get_session_id (session));
+        *dead = g_list_prepend (*dead, session);
+    }
+
+    return NULL;
+}
+
+/* ========================================================================== */
+/* Removal                                                                    */
+/* ========================================================================== */
+
+/*
+ * remove_sessions:
+ * @sessions: (element-type GdbSession): sessions to remove, each holding
+ *     a reference
+ *
+ * Empties the slots of those of @sessions still in the table, publishing
+ * the index once rather than once per session, then terminates them as a
+ * group and emits session-removed for each. Sessions removed concurrently
+ * are dropped from @sessions. Must be called without mutex held.
+ *
+ * Returns: the number of sessions removed
+ */
+static guint
+remove_sessions (GdbSessionManager *self,
+                 GPtrArray         *sessions)
+{
+    guint i;
+
+    g_mutex_lock (&self->mutex);
+    i = 0;
+    while (i < sessions->len)
+    {
+        GdbSession *session = g_ptr_array_index (sessions, i);
+        const gchar *session_id = gdb_session_get_session_id (session);
+        GdbSessionHandle handle;
+        SessionSlot *slot;
+
+        if (gdb_session_handle_parse (session_id, &handle) &&
+            (slot = slot_get_locked (self, handle)) != NULL &&
+            slot->session == session)
+        {
+            slot_release_locked (self, session_id);
+            i++;
+        }
+        else
+        {
+            g_ptr_array_remove_index (sessions, i);
+        }
+    }
+    if (sessions->len > 0)
+    {
+        index_publish_locked (self);
+    }
+    g_mutex_unlock (&self->mutex);
+
+    if (sessions->len == 0)
+    {
+        return 0;
+    }
+
+    /* Every GDB is asked to quit at once and shares one kill deadline */
+    gdb_session_terminate_many (sessions);
+
+    for (i = 0; i < sessions->len; i++)
+    {
+        GdbSession *session = g_ptr_array_index (sessions, i);
+
+        g_signal_emit (self, signals[SIGNAL_SESSION_REMOVED], 0,
+                       gdb_session_get_session_id (session));
+    }
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SESSION_COUNT]);
+
+    return sessions->len;
+}
+
+/* ========================================================================== */
+/* Reaper                                                                     */
+/* ========================================================================== */
+
+/*
+ * Agents do not always call gdb_terminate, and an idle GDB can hold
+ * gigabytes of symbol tables. The reaper evicts sessions that have run no
+ * command for idle_timeout seconds, then evicts the least recently used
+ * ones while there are more than max_sessions or their GDB processes use
+ * more than memory_budget bytes. Busy sessions are never evicted. It runs
+ * every REAPER_INTERVAL_SECONDS on the pool context while any limit is
+ * set, and before every session is created.
+ *
+ * The limits live in a SessionLimits that managers created with
+ * gdb_session_manager_new_sharing_limits() share with the manager they
+ * were created from. A pass then weighs the sessions of all of them
+ * together, so clients with managers of their own cannot multiply the
+ * limits. Managers hold the SessionLimits; it only holds weak references
+ * back, and its lock is never taken with a manager's mutex held.
+ */
+
+typedef struct {
+    GWeakRef           ref;
+    GdbSessionManager *manager;     /* Unowned; identifies the entry */
+} LimitsMember;
+
+struct _SessionLimits {
+    gint          ref_count;        /* Atomic */
+    GMutex        mutex;
+    GPtrArray    *members;          /* LimitsMember, one per manager */
+    guint         idle_timeout;     /* Seconds; 0 keeps idle sessions */
+    guint         max_sessions;     /* 0 for no limit */
+    guint64       memory_budget;    /* Bytes of GDB RSS; 0 for no limit */
+    GMainContext *context;          /* Pool context of the first manager */
+    GSource      *reaper_source;    /* Periodic pass on context */
+};
+
+static void
+limits_member_free (gpointer data)
+{
+    LimitsMember *member = (LimitsMember *)data;
+
+    g_weak_ref_clear (&member->ref);
+    g_slice_free (LimitsMember, member);
+}
+
+static SessionLimits *
+session_limits_new (GMainContext *context)
+{
+    SessionLimits *limits;
+
+    limits = g_slice_new0 (SessionLimits);
+    limits->ref_count = 1;
+    g_mutex_init (&limits->mutex);
+    limits->members = g_ptr_array_new_with_free_func (limits_member_free);
+    limits->context = g_main_context_ref (context);
+
+    return limits;
+}
+
+static SessionLimits *
+session_limits_ref (SessionLimits *limits)
+{
+    g_atomic_int_inc (&limits->ref_count);
+    return limits;
+}
+
+static void
+session_limits_unref (SessionLimits *limits)
+{
+    if (!g_atomic_int_dec_and_test (&limits->ref_count))
+    {
+        return;
+    }
+
+    /* The reaper source holds a reference, so it is gone by now */
+    g_ptr_array_unref (limits->members);
+    g_main_context_unref (limits->context);
+    g_mutex_clear (&limits->mutex);
+    g_slice_free (SessionLimits, limits);
+}
+
+/*
+ * session_limits_join:
+ * @limits: the limits
+ * @manager: a manager starting to use them
+ */
+static void
+session_limits_join (SessionLimits     *limits,
+                     GdbSessionManager *manager)
+{
+    LimitsMember *member;
+
+    member = g_slice_new0 (LimitsMember);
+    g_weak_ref_init (&member->ref, manager);
+    member->manager = manager;
+
+    g_mutex_lock (&limits->mutex);
+    g_ptr_array_add (limits->members, member);
+    g_mutex_unlock (&limits->mutex);
+}
+
+/*
+ * session_limits_leave:
+ * @limits: the limits
+ * @manager: a manager being disposed
+ *
+ * Drops @manager from @limits, and stops the reaper once no manager is
+ * left. Does nothing if @manager already left.
+ */
+static void
+session_limits_leave (SessionLimits     *limits,
+                      GdbSessionManager *manager)
+{
+    GSource *stale = NULL;
+    guint i;
+
+    g_mutex_lock (&limits->mutex);
+    for (i = 0; i < limits->members->len; i++)
+    {
+        LimitsMember *member = g_ptr_array_index (limits->members, i);
+
+        if (member->manager == manager)
+        {
+            g_ptr_array_remove_index_fast (limits->members, i);
+            break;
+        }
+    }
+    if (limits->members->len == 0)
+    {
+        stale = g_steal_pointer (&limits->reaper_source);
+    }
+    g_mutex_unlock (&limits->mutex);
+
+    if (stale != NULL)
+    {
+        g_source_destroy (stale);
+        g_source_unref (stale);
+    }
+}
+
+typedef struct {
+    GdbSession        *session;
+    GdbSessionManager *manager;     /* Unowned; reaper_run() holds it */
+    gint64             last_used;
+    guint64            rss;
+    gboolean           busy;
+    gboolean           evict;
+} ReapCandidate;
+
+static void
+reap_candidate_clear (gpointer data)
+{
+    ReapCandidate *candidate = (ReapCandidate *)data;
+
+    g_clear_object (&candidate->session);
+}
+
+static gint
+reap_candidate_compare (gconstpointer a,
+                        gconstpointer b)
+{
+    const ReapCandidate *ca = (const ReapCandidate *)a;
+    const ReapCandidate *cb = (const ReapCandidate *)b;
+
+    return (ca->last_used > cb->last_used) - (ca->last_used < cb->last_used);
+}
+
+/*
+ * reaper_run:
+ * @limits: the limits to enforce
+ * @reserve: sessions about to be added, counted against max_sessions
+ *
+ * Evicts sessions over the configured limits, least recently used first,
+ * from every manager sharing @limits. Must be called without any
+ * manager's mutex held.
+ *
+ * Returns: the number of sessions evicted
+ */
+static guint
+reaper_run (SessionLimits *limits,
+            guint          reserve)
+{
+    g_autoptr(GPtrArray) managers = NULL;
+    GArray *candidates;
+    guint idle_timeout;
+    guint max_sessions;
+    guint64 memory_budget;
+    guint64 memory = 0;
+    guint n_evicted = 0;
+    guint live;
+    gint64 now;
+    guint i;
+    guint j;
+
+    managers = g_ptr_array_new_with_free_func (g_object_unref);
+
+    g_mutex_lock (&limits->mutex);
+    idle_timeout = limits->idle_timeout;
+    max_sessions = limits->max_sessions;
+    memory_budget = limits->memory_budget;
+    if (idle_timeout > 0 || max_sessions > 0 || memory_budget > 0)
+    {
+        for (i = 0; i < limits->members->len; i++)
+        {
+            LimitsMember *member = g_ptr_array_index (limits->members, i);
+            GdbSessionManager *manager;
+
+            /* NULL once the manager's last reference is gone */
+            manager = g_weak_ref_get (&member->ref);
+            if (manager != NULL)
+            {
+                g_ptr_array_add (managers, manager);
+            }
+        }
+    }
+    g_mutex_unlock (&limits->mutex);
+
+    if (managers->len == 0)
+    {
+        return 0;
+    }
+
+    candidates = g_array_new (FALSE, TRUE, sizeof (ReapCandidate));
+    g_array_set_clear_func (candidates, reap_candidate_clear);
+    for (j = 0; j < managers->len; j++)
+    {
+        GdbSessionManager *self = g_ptr_array_index (managers, j);
+
+        g_mutex_lock (&self->mutex);
+        for (i = 0; i < self->slots->len; i++)
+        {
+            SessionSlot *slot = &g_array_index (self->slots, SessionSlot, i);
+            ReapCandidate candidate = { NULL, NULL, 0, 0, FALSE, FALSE };
+
+            if (slot->session != NULL)
+            {
+                candidate.session = g_object_ref (slot->session);
+                candidate.manager = self;
+                g_array_append_val (candidates, candidate);
+            }
+        }
+        g_mutex_unlock (&self->mutex);
+    }
+
+    /* Reading /proc is too slow to do under the mutex */
+    for (i = 0; i < candidates->len; i++)
+    {
+        ReapCandidate *candidate = &g_array_index (candidates, ReapCandidate, i);
+
+        candidate->last_used = gdb_session_get_last_used (candidate->session);
+        candidate->busy = gdb_session_is_busy (candidate->session);
+        if (memory_budget > 0)
+        {
+            candidate->rss = gdb_session_get_rss (candidate->session);
+            memory += candidate->rss;
+        }
+    }
+    g_array_sort (candidates, reap_candidate_compare);
+
+    now = g_get_monotonic_time ();
+    live = candidates->len + reserve;
+    for (i = 0; i < candidates->len; i++)
+    {
+        ReapCandidate *candidate = &g_array_index (candidates, ReapCandidate, i);
+        gboolean idle;
+
+        if (candidate->busy)
+        {
+            continue;
+        }
+
+        idle = idle_timeout > 0 &&
+               now - candidate->last_used >= (gint64) idle_timeout * G_USEC_PER_SEC;
+        if (idle ||
+            (max_sessions > 0 && live > max_sessions) ||
+            (memory_budget > 0 && memory > memory_budget))
+        {
+            g_debug ("Evicting GDB session %s (idle %" G_GINT64_FORMAT " s, %" G_GUINT64_FORMAT " bytes)",
+                     gdb_session_get_session_id (candidate->session),
+                     (now - candidate->last_used) / G_USEC_PER_SEC,
+                     candidate->rss);
+            candidate->evict = TRUE;
+            live--;
+            memory -= candidate->rss;
+        }
+    }
+
+    /* Each manager removes its own, publishing its index once */
+    for (j = 0; j < managers->len; j++)
+    {
+        GdbSessionManager *self = g_ptr_array_index (managers, j);
+        g_autoptr(GPtrArray) evicted = NULL;
+
+        evicted = g_ptr_array_new_with_free_func (g_object_unref);
+        for (i = 0; i < candidates->len; i++)
+        {
+            ReapCandidate *candidate = &g_array_index (candidates, ReapCandidate, i);
+
+            if (candidate->evict && candidate->manager == self)
+            {
+                g_ptr_array_add (evicted, g_object_ref (candidate->session));
+            }
+        }
+        if (evicted->len > 0)
+        {
+            n_evicted += remove_sessions (self, evicted);
+        }
+    }
+    g_array_unref (candidates);
+
+    return n_evicted;
+}
+
+static gboolean
+reaper_cb (gpointer user_data)
+{
+    reaper_run ((SessionLimits *)user_data, 0);
+
+    return G_SOURCE_CONTINUE;
+}
+
+/*
+ * reaper_update:
+ *
+ * Arms the periodic reaper while any limit is set and disarms it
+ * otherwise.
+ */
+static void
+reaper_update (SessionLimits *limits)
+{
+    GSource *stale = NULL;
+
+    g_mutex_lock (&limits->mutex);
+    if ((limits->idle_timeout > 0 || limits->max_sessions > 0 || limits->memory_budget > 0) &&
+        limits->members->len > 0)
+    {
+        if (limits->reaper_source == NULL)
+        {
+            /* Dropped with the last member, so the reference is no cycle */
+            limits->reaper_source = g_timeout_source_new_seconds (REAPER_INTERVAL_SECONDS);
+            g_source_set_callback (limits->reaper_source, reaper_cb,
+                                   session_limits_ref (limits),
+                                   (GDestroyNotify) session_limits_unref);
+            g_source_attach (limits->reaper_source, limits->context);
+        }
+    }
+    else
+    {
+        stale = g_steal_pointer (&limits->reaper_source);
+    }
+    g_mutex_unlock (&limits->mutex);
+
+    if (stale != NULL)
+    {
+        g_source_destroy (stale);
+        g_source_unref (stale);
+    }
+}
+
+/* ========================================================================== */
+/* Public API                                                                 */
+/* ========================================================================== */
+
+GdbSessionManager *
+gdb_session_manager_new (void)
+{
+    return (GdbSessionManager *)g_object_new (GDB_TYPE_SESSION_MANAGER, NULL);
+}
+
+GdbSessionManager *
+gdb_session_manager_new_sharing_limits (GdbSessionManager *other)
+{
+    GdbSessionManager *self;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (other), NULL);
+
+    self = gdb_session_manager_new ();
+
+    session_limits_leave (self->limits, self);
+    session_limits_unref (self->limits);
+    self->limits = session_limits_ref (other->limits);
+    session_limits_join (self->limits, self);
+
+    return self;
+}
+
+GdbSessionManager *
+gdb_session_manager_get_default (void)
+{
+    if (default_manager == NULL)
+    {
+        default_manager = gdb_session_manager_new ();
+    }
+
+    return default_manager;
+}
+
+const gchar *
+gdb_session_manager_get_default_gdb_path (GdbSessionManager *self)
+{
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
+    return self->default_gdb_path;
+}
+
+void
+gdb_session_manager_set_default_gdb_path (GdbSessionManager *self,
+                                          const gchar       *gdb_path)
+{
+    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+
+    g_mutex_lock (&self->mutex);
+    g_free (self->default_gdb_path);
+    self->default_gdb_path = g_strdup (gdb_path ? gdb_path : DEFAULT_GDB_PATH);
+    g_mutex_unlock (&self->mutex);
+
+    /* Warm sessions run the old GDB */
+    pool_drain (self, 0);
+    pool_schedule_refill (self);
+
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_DEFAULT_GDB_PATH]);
+}
+
+guint
+gdb_session_manager_get_default_timeout_ms (GdbSessionManager *self)
+{
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), DEFAULT_TIMEOUT_MS);
+    return self->default_timeout_ms;
+}
+
+void
+gdb_session_manager_set_default_timeout_ms (GdbSessionManager *self,
+                                            guint              timeout_ms)
+{
+    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+
+    self->default_timeout_ms = timeout_ms;
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_DEFAULT_TIMEOUT_MS]);
+}
+
+GdbStartupProfile
+gdb_session_manager_get_default_startup_profile (GdbSessionManager *self)
+{
+    GdbStartupProfile profile;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), GDB_STARTUP_PROFILE_DEFAULT);
+
+    g_mutex_lock (&self->mutex);
+    profile = self->default_startup_profile;
+    g_mutex_unlock (&self->mutex);
+
+    return profile;
+}
+
+void
+gdb_session_manager_set_default_startup_profile (GdbSessionManager *self,
+                                                 GdbStartupProfile  profile)
+{
+    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+
+    g_mutex_lock (&self->mutex);
+    self->default_startup_profile = profile;
+    g_mutex_unlock (&self->mutex);
+
+    /* Warm sessions were started with the old profile */
+    pool_drain (self, 0);
+    pool_schedule_refill (self);
+
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_DEFAULT_STARTUP_PROFILE]);
+}
+
+guint
+gdb_session_manager_get_pool_size (GdbSessionManager *self)
+{
+    guint pool_size;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), DEFAULT_POOL_SIZE);
+
+    g_mutex_lock (&self->mutex);
+    pool_size = self->pool_size;
+    g_mutex_unlock (&self->mutex);
+
+    return pool_size;
+}
+
+void
+gdb_session_manager_set_pool_size (GdbSessionManager *self,
+                                   guint              pool_size)
+{
+    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+
+    pool_size = MIN (pool_size, MAX_POOL_SIZE);
+
+    g_mutex_lock (&self->mutex);
+    if (self->pool_size == pool_size)
+    {
+        g_mutex_unlock (&self->mutex);
+        return;
+    }
+    self->pool_size = pool_size;
+    g_mutex_unlock (&self->mutex);
+
+    pool_drain (self, pool_size);
+    pool_schedule_refill (self);
+
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_POOL_SIZE]);
+}
+
+guint
+gdb_session_manager_get_pool_count (GdbSessionManager *self)
+{
+    guint count;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), 0);
+
+    g_mutex_lock (&self->mutex);
+    count = self->pool.length;
+    g_mutex_unlock (&self->mutex);
+
+    return count;
+}
+
+guint
+gdb_session_manager_get_session_count (GdbSessionManager *self)
+{
+    guint count;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), 0);
+
+    count = index_acquire (self)->n_sessions;
+    index_release (self);
+
+    return count;
+}
+
+GdbSession *
+gdb_session_manager_create_session (GdbSessionManager *self,
+                                    const gchar       *gdb_path,
+                                    const gchar       *working_dir)
+{
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
+
+    return gdb_session_manager_create_session_full (
+        self, gdb_path, working_dir,
+        gdb_session_manager_get_default_startup_profile (self),
+        NULL, NULL);
+}
+
+GdbSession *
+gdb_session_manager_create_session_full (GdbSessionManager *self,
+                                         const gchar       *gdb_path,
+                                         const gchar       *working_dir,
+                                         GdbStartupProfile  profile,
+                                         const gchar       *init_script,
+                                         const gchar       *auto_load_safe_path)
+{
+    GdbSession *session = NULL;
+    GList *dead = NULL;
+    GList *l;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
+
+    /* Make room for the new session */
+    reaper_run (self->limits, 1);
+
+    g_mutex_lock (&self->mutex);
+
+    /* Use default GDB path if not specified */
+    if (gdb_path == NULL)
+    {
+        gdb_path = self->default_gdb_path;
+    }
+
+    /* Hand out a warm session if one matches */
+    if (working_dir == NULL && init_script == NULL && auto_load_safe_path == NULL &&
+        profile == self->default_startup_profile &&
+        g_strcmp0 (gdb_path, self->default_gdb_path) == 0)
+    {
+        session = pool_take_locked (self, &dead);
+    }
+
+    if (session == NULL)
+    {
+        g_autofree gchar *session_id = NULL;
+
+        session_id = gdb_session_handle_to_string (slot_reserve_locked (self));
+        session = gdb_session_new (session_id, gdb_path, working_dir);
+        gdb_session_set_startup_profile (session, profile);
+        gdb_session_set_init_script (session, init_script);
+        gdb_session_set_auto_load_safe_path (session, auto_load_safe_path);
+    }
+    gdb_session_set_timeout_ms (session, self->default_timeout_ms);
+
+    /* Fill the slot reserved for its ID */
+    {
+        GdbSessionHandle handle;
+
+        gdb_session_handle_parse (gdb_session_get_session_id (session), &handle);
+        slot_get_locked (self, handle)->session = g_object_ref (session);
+        self->n_sessions++;
+    }
+    index_publish_locked (self);
+
+    g_mutex_unlock (&self->mutex);
+
+    for (l = dead; l != NULL; l = l->next)
+    {
+        gdb_session_terminate (l->data);
+    }
+    g_list_free_full (dead, g_object_unref);
+
+    pool_schedule_refill (self);
+
+    g_signal_emit (self, signals[SIGNAL_SESSION_ADDED], 0, session);
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SESSION_COUNT]);
+
+    return session;
+}
+
+GdbSession *
+gdb_session_manager_get_session (GdbSessionManager *self,
+                                 const gchar       *session_id)
+{
+    GdbSessionHandle handle;
+    GdbSession *session;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
+    g_return_val_if_fail (session_id != NULL, NULL);
+
+    if (!gdb_session_handle_parse (session_id, &handle))
+    {
+        return NULL;
+    }
+
+    /* Lock-free; the session stays in the table until it is removed */
+    session = index_lookup (index_acquire (self), handle);
+    index_release (self);
+
+    return session;
+}
+
+GdbSession *
+gdb_session_manager_lookup_handle (GdbSessionManager *self,
+                                   GdbSessionHandle   handle)
+{
+    GdbSession *session;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
+
+    /* The index holds a reference until it is reclaimed, which cannot
+     * happen before index_release(), so the session is alive to be reffed.
+     */
+    session = index_lookup (index_acquire (self), handle);
+    if (session != NULL)
+    {
+        g_object_ref (session);
+    }
+    index_release (self);
+
+    return session;
+}
+
+GdbSession *
+gdb_session_manager_lookup_session (GdbSessionManager *self,
+                                    const gchar       *session_id)
+{
+    GdbSessionHandle handle;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
+    g_return_val_if_fail (session_id != NULL, NULL);
+
+    if (!gdb_session_handle_parse (session_id, &handle))
+    {
+        return NULL;
+    }
+
+    return gdb_session_manager_lookup_handle (self, handle);
+}
+
+gboolean
+gdb_session_manager_remove_session (GdbSessionManager *self,
+                                    const gchar       *session_id)
+{
+    g_autoptr(GdbSession) session = NULL;
+    GdbSessionHandle handle;
+    SessionSlot *slot = NULL;
+    gboolean removed;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), FALSE);
+    g_return_val_if_fail (session_id != NULL, FALSE);
+
+    if (!gdb_session_handle_parse (session_id, &handle))
+    {
+        return FALSE;
+    }
+
+    g_mutex_lock (&self->mutex);
+
+    slot = slot_get_locked (self, handle);
+    if (slot != NULL && slot->session != NULL)
+    {
+        session = g_object_ref (slot->session);
+        slot_release_locked (self, session_id);
+        index_publish_locked (self);
+    }
+
+    g_mutex_unlock (&self->mutex);
+
+    removed = session != NULL;
+    if (removed)
+    {
+        /* Outside the mutex, as in remove_sessions(): terminating can
+         * emit ::terminated and fail pending commands right here, and
+         * those handlers may call back into the manager.
+         */
+        gdb_session_terminate (session);
+        g_signal_emit (self, signals[SIGNAL_SESSION_REMOVED], 0, session_id);
+        g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_SESSION_COUNT]);
+    }
+
+    return removed;
+}
+
+GList *
+gdb_session_manager_list_sessions (GdbSessionManager *self)
+{
+    GList *sessions;
+    SessionIndex *index;
+    guint i;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), NULL);
+
+    sessions = NULL;
+
+    index = index_acquire (self);
+    for (i = index->n_slots; i > 0; i--)
+    {
+        if (index->slots[i - 1].session != NULL)
+        {
+            sessions = g_list_prepend (sessions, g_object_ref (index->slots[i - 1].session));
+        }
+    }
+    index_release (self);
+
+    return sessions;
+}
+
+void
+gdb_session_manager_terminate_all (GdbSessionManager *self)
+{
+    g_autoptr(GPtrArray) sessions = NULL;
+    guint i;
+
+    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+
+    sessions = g_ptr_array_new_with_free_func (g_object_unref);
+
+    g_mutex_lock (&self->mutex);
+    for (i = 0; i < self->slots->len; i++)
+    {
+        SessionSlot *slot = &g_array_index (self->slots, SessionSlot, i);
+
+        if (slot->session != NULL)
+        {
+            g_ptr_array_add (sessions, g_object_ref (slot->session));
+        }
+    }
+    g_mutex_unlock (&self->mutex);
+
+    remove_sessions (self, sessions);
+}
+
+guint
+gdb_session_manager_get_idle_timeout (GdbSessionManager *self)
+{
+    guint idle_timeout;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), 0);
+
+    g_mutex_lock (&self->limits->mutex);
+    idle_timeout = self->limits->idle_timeout;
+    g_mutex_unlock (&self->limits->mutex);
+
+    return idle_timeout;
+}
+
+void
+gdb_session_manager_set_idle_timeout (GdbSessionManager *self,
+                                      guint              seconds)
+{
+    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+
+    g_mutex_lock (&self->limits->mutex);
+    if (self->limits->idle_timeout == seconds)
+    {
+        g_mutex_unlock (&self->limits->mutex);
+        return;
+    }
+    self->limits->idle_timeout = seconds;
+    g_mutex_unlock (&self->limits->mutex);
+
+    reaper_update (self->limits);
+
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_IDLE_TIMEOUT]);
+}
+
+guint
+gdb_session_manager_get_max_sessions (GdbSessionManager *self)
+{
+    guint max_sessions;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), 0);
+
+    g_mutex_lock (&self->limits->mutex);
+    max_sessions = self->limits->max_sessions;
+    g_mutex_unlock (&self->limits->mutex);
+
+    return max_sessions;
+}
+
+void
+gdb_session_manager_set_max_sessions (GdbSessionManager *self,
+                                      guint              max_sessions)
+{
+    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+
+    g_mutex_lock (&self->limits->mutex);
+    if (self->limits->max_sessions == max_sessions)
+    {
+        g_mutex_unlock (&self->limits->mutex);
+        return;
+    }
+    self->limits->max_sessions = max_sessions;
+    g_mutex_unlock (&self->limits->mutex);
+
+    reaper_update (self->limits);
+
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MAX_SESSIONS]);
+}
+
+guint64
+gdb_session_manager_get_memory_budget (GdbSessionManager *self)
+{
+    guint64 memory_budget;
+
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), 0);
+
+    g_mutex_lock (&self->limits->mutex);
+    memory_budget = self->limits->memory_budget;
+    g_mutex_unlock (&self->limits->mutex);
+
+    return memory_budget;
+}
+
+void
+gdb_session_manager_set_memory_budget (GdbSessionManager *self,
+                                       guint64            bytes)
+{
+    g_return_if_fail (GDB_IS_SESSION_MANAGER (self));
+
+    g_mutex_lock (&self->limits->mutex);
+    if (self->limits->memory_budget == bytes)
+    {
+        g_mutex_unlock (&self->limits->mutex);
+        return;
     }
+    self->limits->memory_budget = bytes;
+    g_mutex_unlock (&self->limits->mutex);
+
+    reaper_update (self->limits);
+
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MEMORY_BUDGET]);
+}
+
+guint
+gdb_session_manager_reap (GdbSessionManager *self)
+{
+    g_return_val_if_fail (GDB_IS_SESSION_MANAGER (self), 0);
 
-    g_list_free_full (session_ids, g_free);
+    return reaper_run (self->limits, 0);
 }
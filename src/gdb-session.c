@@ -9,10 +9,16 @@
 #include "mcp-gdb/gdb-error.h"
 
 #include <gio/gio.h>
+#include <gio/gunixinputstream.h>
+#include <glib-unix.h>
+#include <errno.h>
 #include <string.h>
+#include <unistd.h>
 
-#define DEFAULT_TIMEOUT_MS 10000
-#define DEFAULT_GDB_PATH   "gdb"
+#define DEFAULT_TIMEOUT_MS      10000
+#define DEFAULT_GDB_PATH        "gdb"
+#define DEFAULT_MAX_QUEUE_DEPTH 64
+#define MAX_IN_FLIGHT           8
 
 /* ========================================================================== */
 /* GdbSession Structure                                                       */
@@ -27,17 +33,65 @@ struct _GdbSession
     gchar           *gdb_path;
     gchar           *working_dir;
 
+    /* Startup (see "Start Implementation") */
+    GdbStartupProfile startup_profile;
+    gchar           *init_script;
+    gchar           *auto_load_safe_path;
+
     /* Target info */
     gchar           *target_program;
 
     /* Process management */
     GSubprocess     *process;
     GOutputStream   *stdin_pipe;
-    GDataInputStream *stdout_reader;
+    GInputStream    *stdout_pipe;    /* Read by the reader thread only */
+    GMutex           write_lock;     /* Serializes writes to stdin_pipe */
+
+    /* Signals are emitted on the thread that created the session */
+    GMainContext    *owner_context;
+    GThread         *owner_thread;
 
-    /* State */
+    /* Fields below are shared with the reader thread, protected by lock */
+    GMutex           lock;
     GdbSessionState  state;
     guint            timeout_ms;
+    gboolean         terminating;    /* quit has been sent */
+    GTask           *start_task;     /* Startup waiting for the first prompt */
+    gint64           startup_time;   /* Spawn to first prompt, in µs; -1 if none */
+    gint64           last_used;      /* Last command submitted or answered */
+
+    /* Command multiplexing (see "Execute Implementation") */
+    guint64          next_token;     /* Token for the next command */
+    GHashTable      *pending;        /* token -> GTask awaiting a response */
+    GQueue           pending_order;  /* Pending GTasks in write order */
+    GString         *unclaimed_text; /* Untagged lines not yet attributed */
+    GList           *unclaimed;      /* Untagged records not yet attributed */
+
+    /* Command queue (see "Command Queue") */
+    GQueue           control_queue;  /* Submissions in the control lane */
+    GQueue           normal_queue;   /* Submissions in the normal lane */
+    guint            queued;         /* Commands waiting in either lane */
+    guint            in_flight;      /* Commands written, not yet answered */
+    guint            draining;       /* Cancelled commands still in flight */
+    guint            max_queue_depth;
+
+    /* Command deadlines (see "Deadlines") */
+    GQueue           deadlines;      /* Pending GTasks by ascending deadline */
+    gint             wakeup_fds[2];  /* Wakes the reader's poll; -1 if none */
+
+    /* Reader thread (see "Reader Thread") */
+    GThread         *reader_thread;  /* Joined by dispose */
+    gboolean         reader_stopping;
+
+    /* Execution tracking (see "Execution State Tracking") */
+    guint64          run_serial;     /* Bumped whenever the target resumes */
+    GString         *run_output;     /* Untagged output since the last resume */
+    gboolean         run_detached;   /* A detached command left the run unowned */
+    guint64          stop_serial;    /* run_serial at the last *stopped */
+    GdbStopReason    stop_reason;
+    GdbMiRecord     *stop_record;    /* The last *stopped record */
+    gchar           *stop_output;
+    GList           *stop_waiters;   /* GTasks waiting for a *stopped */
 
     /* MI Parser */
     GdbMiParser     *mi_parser;
@@ -55,6 +109,11 @@ enum {
     PROP_TARGET_PROGRAM,
     PROP_STATE,
     PROP_TIMEOUT_MS,
+    PROP_MAX_QUEUE_DEPTH,
+    PROP_STARTUP_PROFILE,
+    PROP_INIT_SCRIPT,
+    PROP_AUTO_LOAD_SAFE_PATH,
+    PROP_STARTUP_TIME,
     N_PROPS
 };
 
@@ -70,6 +129,7 @@ enum {
     SIGNAL_CONSOLE_OUTPUT,
     SIGNAL_READY,
     SIGNAL_TERMINATED,
+    SIGNAL_ASYNC_RECORD,
     N_SIGNALS
 };
 
@@ -81,40 +141,145 @@ G_DEFINE_TYPE (GdbSession, gdb_session, G_TYPE_OBJECT)
 /* Private Helper Functions                                                   */
 /* ========================================================================== */
 
+/*
+ * SignalEmission:
+ *
+ * A signal emission carried over to the session's owner thread. The
+ * reader thread never emits signals itself, so handlers always run on
+ * the thread that created the session.
+ */
+typedef struct {
+    GdbSession      *session;
+    guint            signal;         /* Index into signals[] */
+    GdbSessionState  old_state;
+    GdbSessionState  new_state;
+    GdbStopReason    reason;
+    gchar           *text;
+    GdbMiRecord     *record;
+} SignalEmission;
+
+static void
+signal_emission_free (SignalEmission *emission)
+{
+    g_clear_object (&emission->session);
+    g_free (emission->text);
+    g_clear_pointer (&emission->record, gdb_mi_record_unref);
+    g_slice_free (SignalEmission, emission);
+}
+
+static gboolean
+emit_signal_emission (gpointer user_data)
+{
+    SignalEmission *emission = (SignalEmission *)user_data;
+
+    switch (emission->signal)
+    {
+        case SIGNAL_STATE_CHANGED:
+            g_signal_emit (emission->session, signals[SIGNAL_STATE_CHANGED], 0,
+                           emission->old_state, emission->new_state);
+            if (emission->new_state == GDB_SESSION_STATE_READY)
+            {
+                g_signal_emit (emission->session, signals[SIGNAL_READY], 0);
+            }
+            break;
+        case SIGNAL_CONSOLE_OUTPUT:
+            g_signal_emit (emission->session, signals[SIGNAL_CONSOLE_OUTPUT], 0,
+                           emission->text);
+            break;
+        case SIGNAL_ASYNC_RECORD:
+            g_signal_emit (emission->session, signals[SIGNAL_ASYNC_RECORD], 0,
+                           emission->record);
+            break;
+        case SIGNAL_STOPPED:
+            g_signal_emit (emission->session, signals[SIGNAL_STOPPED], 0,
+                           emission->reason,
+                           gdb_mi_record_get_results (emission->record));
+            break;
+        default:
+            g_assert_not_reached ();
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * queue_emission:
+ * @self: the session
+ * @emission: (transfer full): the emission
+ *
+ * Emits right away on the owner thread, otherwise defers the emission
+ * to the owner's main context.
+ */
+static void
+queue_emission (GdbSession     *self,
+                SignalEmission *emission)
+{
+    GSource *source;
+
+    emission->session = g_object_ref (self);
+
+    /* A session created on a worker thread belongs to the main loop that
+     * iterates its context, so the owner thread only emits directly if
+     * no other thread is running that context.
+     */
+    if (g_thread_self () == self->owner_thread &&
+        g_main_context_acquire (self->owner_context))
+    {
+        emit_signal_emission (emission);
+        g_main_context_release (self->owner_context);
+        signal_emission_free (emission);
+        return;
+    }
+
+    source = g_idle_source_new ();
+    g_source_set_priority (source, G_PRIORITY_DEFAULT);
+    g_source_set_callback (source, emit_signal_emission, emission,
+                           (GDestroyNotify) signal_emission_free);
+    g_source_attach (source, self->owner_context);
+    g_source_unref (source);
+}
+
 static void
 set_state (GdbSession      *self,
            GdbSessionState  new_state)
 {
+    SignalEmission *emission;
     GdbSessionState old_state;
 
+    g_mutex_lock (&self->lock);
     if (self->state == new_state)
     {
+        g_mutex_unlock (&self->lock);
         return;
     }
 
     old_state = self->state;
     self->state = new_state;
+    g_mutex_unlock (&self->lock);
 
-    g_signal_emit (self, signals[SIGNAL_STATE_CHANGED], 0, old_state, new_state);
-
-    if (new_state == GDB_SESSION_STATE_READY)
-    {
-        g_signal_emit (self, signals[SIGNAL_READY], 0);
-    }
+    emission = g_slice_new0 (SignalEmission);
+    emission->signal = SIGNAL_STATE_CHANGED;
+    emission->old_state = old_state;
+    emission->new_state = new_state;
+    queue_emission (self, emission);
 }
 
 /* ========================================================================== */
 /* GObject Implementation                                                     */
 /* ========================================================================== */
 
+static void reader_stop (GdbSession *self);
+static void terminate_disposed (GdbSession *self);
+static void terminate_write_quit (GdbSession *self);
+
 static void
 gdb_session_dispose (GObject *object)
 {
     GdbSession *self = GDB_SESSION (object);
 
-    gdb_session_terminate (self);
-
-    g_clear_object (&self->mi_parser);
+    /* Before GDB quits, so the reader cannot see its EOF */
+    reader_stop (self);
+    terminate_disposed (self);
 
     G_OBJECT_CLASS (gdb_session_parent_class)->dispose (object);
 }
@@ -127,7 +292,22 @@ gdb_session_finalize (GObject *object)
     g_clear_pointer (&self->session_id, g_free);
     g_clear_pointer (&self->gdb_path, g_free);
     g_clear_pointer (&self->working_dir, g_free);
+    g_clear_pointer (&self->init_script, g_free);
+    g_clear_pointer (&self->auto_load_safe_path, g_free);
     g_clear_pointer (&self->target_program, g_free);
+    g_clear_pointer (&self->pending, g_hash_table_unref);
+    g_string_free (self->unclaimed_text, TRUE);
+    g_list_free_full (self->unclaimed, (GDestroyNotify) gdb_mi_record_unref);
+    if (self->run_output != NULL)
+    {
+        g_string_free (self->run_output, TRUE);
+    }
+    g_clear_pointer (&self->stop_record, gdb_mi_record_unref);
+    g_clear_pointer (&self->stop_output, g_free);
+    g_clear_pointer (&self->owner_context, g_main_context_unref);
+    g_clear_object (&self->mi_parser);
+    g_mutex_clear (&self->lock);
+    g_mutex_clear (&self->write_lock);
 
     G_OBJECT_CLASS (gdb_session_parent_class)->finalize (object);
 }
@@ -155,11 +335,26 @@ gdb_session_get_property (GObject    *object,
             g_value_set_string (value, self->target_program);
             break;
         case PROP_STATE:
-            g_value_set_enum (value, self->state);
+            g_value_set_enum (value, gdb_session_get_state (self));
             break;
         case PROP_TIMEOUT_MS:
             g_value_set_uint (value, self->timeout_ms);
             break;
+        case PROP_MAX_QUEUE_DEPTH:
+            g_value_set_uint (value, gdb_session_get_max_queue_depth (self));
+            break;
+        case PROP_STARTUP_PROFILE:
+            g_value_set_enum (value, self->startup_profile);
+            break;
+        case PROP_INIT_SCRIPT:
+            g_value_set_string (value, self->init_script);
+            break;
+        case PROP_AUTO_LOAD_SAFE_PATH:
+            g_value_set_string (value, self->auto_load_safe_path);
+            break;
+        case PROP_STARTUP_TIME:
+            g_value_set_int64 (value, gdb_session_get_startup_time (self));
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
             break;
@@ -195,6 +390,18 @@ gdb_session_set_property (GObject      *object,
         case PROP_TIMEOUT_MS:
             self->timeout_ms = g_value_get_uint (value);
             break;
+        case PROP_MAX_QUEUE_DEPTH:
+            gdb_session_set_max_queue_depth (self, g_value_get_uint (value));
+            break;
+        case PROP_STARTUP_PROFILE:
+            gdb_session_set_startup_profile (self, g_value_get_enum (value));
+            break;
+        case PROP_INIT_SCRIPT:
+            gdb_session_set_init_script (self, g_value_get_string (value));
+            break;
+        case PROP_AUTO_LOAD_SAFE_PATH:
+            gdb_session_set_auto_load_safe_path (self, g_value_get_string (value));
+            break;
         default:
             G_OBJECT_WARN_INVALID_PROPERTY_ID (object, prop_id, pspec);
             break;
@@ -284,6 +491,71 @@ gdb_session_class_init (GdbSessionClass *klass)
                            0, G_MAXUINT, DEFAULT_TIMEOUT_MS,
                            G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
 
+    /**
+     * GdbSession:max-queue-depth:
+     *
+     * Maximum number of commands waiting to be written to GDB. Commands
+     * submitted beyond it fail with %GDB_ERROR_QUEUE_FULL; control
+     * commands are never refused.
+     */
+    properties[PROP_MAX_QUEUE_DEPTH] =
+        g_param_spec_uint ("max-queue-depth",
+                           "Max Queue Depth",
+                           "Maximum number of queued commands",
+                           1, G_MAXUINT, DEFAULT_MAX_QUEUE_DEPTH,
+                           G_PARAM_READWRITE | G_PARAM_CONSTRUCT | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * GdbSession:startup-profile:
+     *
+     * How the next gdb_session_start_async() launches GDB.
+     */
+    properties[PROP_STARTUP_PROFILE] =
+        g_param_spec_enum ("startup-profile",
+                           "Startup Profile",
+                           "How GDB is launched",
+                           GDB_TYPE_STARTUP_PROFILE,
+                           GDB_STARTUP_PROFILE_DEFAULT,
+                           G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * GdbSession:init-script:
+     *
+     * GDB command file run at startup, after any gdbinit.
+     */
+    properties[PROP_INIT_SCRIPT] =
+        g_param_spec_string ("init-script",
+                             "Init Script",
+                             "GDB command file run at startup",
+                             NULL,
+                             G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * GdbSession:auto-load-safe-path:
+     *
+     * Directories GDB may auto-load scripts from, or %NULL to keep
+     * GDB's own setting.
+     */
+    properties[PROP_AUTO_LOAD_SAFE_PATH] =
+        g_param_spec_string ("auto-load-safe-path",
+                             "Auto-load Safe Path",
+                             "Directories GDB may auto-load scripts from",
+                             NULL,
+                             G_PARAM_READWRITE | G_PARAM_STATIC_STRINGS);
+
+    /**
+     * GdbSession:startup-time:
+     *
+     * Microseconds from spawning GDB to its first prompt, or -1 if the
+     * session has not started.
+     */
+    properties[PROP_STARTUP_TIME] =
+        g_param_spec_int64 ("startup-time",
+                            "Startup Time",
+                            "Microseconds from spawn to the first prompt",
+                            -1, G_MAXINT64, -1,
+                            G_PARAM_READABLE | G_PARAM_STATIC_STRINGS);
+
     g_object_class_install_properties (object_class, N_PROPS, properties);
 
     /**
@@ -307,9 +579,13 @@ gdb_session_class_init (GdbSessionClass *klass)
      * GdbSession::stopped:
      * @session: the #GdbSession
      * @reason: the stop reason
-     * @details: additional details as JsonObject
+     * @details: (nullable): the fields of the *stopped record as a
+     *     JsonObject, including the "frame" the target stopped in
      *
-     * Emitted when the target program stops.
+     * Emitted on the owner thread when GDB reports that the target
+     * program stopped or exited. The session state has already moved
+     * to %GDB_SESSION_STATE_STOPPED, or back to %GDB_SESSION_STATE_READY
+     * if the program exited.
      */
     signals[SIGNAL_STOPPED] =
         g_signal_new ("stopped",
@@ -362,6 +638,23 @@ gdb_session_class_init (GdbSessionClass *klass)
                       0, NULL, NULL, NULL,
                       G_TYPE_NONE, 1,
                       G_TYPE_INT);
+
+    /**
+     * GdbSession::async-record:
+     * @session: the #GdbSession
+     * @record: the #GdbMiRecord
+     *
+     * Emitted for every exec, status and notify async record GDB
+     * prints (e.g. *stopped, =thread-created), whether or not a
+     * command is waiting for a response.
+     */
+    signals[SIGNAL_ASYNC_RECORD] =
+        g_signal_new ("async-record",
+                      G_TYPE_FROM_CLASS (klass),
+                      G_SIGNAL_RUN_LAST,
+                      0, NULL, NULL, NULL,
+                      G_TYPE_NONE, 1,
+                      GDB_TYPE_MI_RECORD);
 }
 
 static void
@@ -369,6 +662,24 @@ gdb_session_init (GdbSession *self)
 {
     self->state = GDB_SESSION_STATE_DISCONNECTED;
     self->timeout_ms = DEFAULT_TIMEOUT_MS;
+    self->startup_profile = GDB_STARTUP_PROFILE_DEFAULT;
+    self->startup_time = -1;
+    self->last_used = g_get_monotonic_time ();
+    self->next_token = 1;
+    self->pending = g_hash_table_new (g_int64_hash, g_int64_equal);
+    g_queue_init (&self->pending_order);
+    g_queue_init (&self->control_queue);
+    g_queue_init (&self->normal_queue);
+    self->max_queue_depth = DEFAULT_MAX_QUEUE_DEPTH;
+    g_queue_init (&self->deadlines);
+    self->wakeup_fds[0] = -1;
+    self->wakeup_fds[1] = -1;
+    self->unclaimed_text = g_string_new (NULL);
+    self->stop_reason = GDB_STOP_REASON_UNKNOWN;
+    g_mutex_init (&self->lock);
+    g_mutex_init (&self->write_lock);
+    self->owner_context = g_main_context_ref_thread_default ();
+    self->owner_thread = g_thread_self ();
     self->mi_parser = gdb_mi_parser_new ();
 }
 
@@ -434,17 +745,27 @@ gdb_session_set_target_program (GdbSession  *self,
 GdbSessionState
 gdb_session_get_state (GdbSession *self)
 {
+    GdbSessionState state;
+
     g_return_val_if_fail (GDB_IS_SESSION (self), GDB_SESSION_STATE_DISCONNECTED);
-    return self->state;
+
+    g_mutex_lock (&self->lock);
+    state = self->state;
+    g_mutex_unlock (&self->lock);
+
+    return state;
 }
 
 gboolean
 gdb_session_is_ready (GdbSession *self)
 {
+    GdbSessionState state;
+
     g_return_val_if_fail (GDB_IS_SESSION (self), FALSE);
 
-    return self->state == GDB_SESSION_STATE_READY ||
-           self->state == GDB_SESSION_STATE_STOPPED;
+    state = gdb_session_get_state (self);
+    return state == GDB_SESSION_STATE_READY ||
+           state == GDB_SESSION_STATE_STOPPED;
 }
 
 guint
@@ -464,6 +785,164 @@ gdb_session_set_timeout_ms (GdbSession *self,
     g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_TIMEOUT_MS]);
 }
 
+guint
+gdb_session_get_max_queue_depth (GdbSession *self)
+{
+    guint depth;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), DEFAULT_MAX_QUEUE_DEPTH);
+
+    g_mutex_lock (&self->lock);
+    depth = self->max_queue_depth;
+    g_mutex_unlock (&self->lock);
+
+    return depth;
+}
+
+void
+gdb_session_set_max_queue_depth (GdbSession *self,
+                                 guint       depth)
+{
+    g_return_if_fail (GDB_IS_SESSION (self));
+    g_return_if_fail (depth > 0);
+
+    g_mutex_lock (&self->lock);
+    self->max_queue_depth = depth;
+    g_mutex_unlock (&self->lock);
+
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_MAX_QUEUE_DEPTH]);
+}
+
+GdbStartupProfile
+gdb_session_get_startup_profile (GdbSession *self)
+{
+    g_return_val_if_fail (GDB_IS_SESSION (self), GDB_STARTUP_PROFILE_DEFAULT);
+    return self->startup_profile;
+}
+
+void
+gdb_session_set_startup_profile (GdbSession        *self,
+                                 GdbStartupProfile  profile)
+{
+    g_return_if_fail (GDB_IS_SESSION (self));
+
+    self->startup_profile = profile;
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_STARTUP_PROFILE]);
+}
+
+const gchar *
+gdb_session_get_init_script (GdbSession *self)
+{
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    return self->init_script;
+}
+
+void
+gdb_session_set_init_script (GdbSession  *self,
+                             const gchar *path)
+{
+    g_return_if_fail (GDB_IS_SESSION (self));
+
+    g_free (self->init_script);
+    self->init_script = g_strdup (path);
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_INIT_SCRIPT]);
+}
+
+const gchar *
+gdb_session_get_auto_load_safe_path (GdbSession *self)
+{
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    return self->auto_load_safe_path;
+}
+
+void
+gdb_session_set_auto_load_safe_path (GdbSession  *self,
+                                     const gchar *path)
+{
+    g_return_if_fail (GDB_IS_SESSION (self));
+
+    g_free (self->auto_load_safe_path);
+    self->auto_load_safe_path = g_strdup (path);
+    g_object_notify_by_pspec (G_OBJECT (self), properties[PROP_AUTO_LOAD_SAFE_PATH]);
+}
+
+gint64
+gdb_session_get_startup_time (GdbSession *self)
+{
+    gint64 startup_time;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), -1);
+
+    g_mutex_lock (&self->lock);
+    startup_time = self->startup_time;
+    g_mutex_unlock (&self->lock);
+
+    return startup_time;
+}
+
+gint64
+gdb_session_get_last_used (GdbSession *self)
+{
+    gint64 last_used;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), 0);
+
+    g_mutex_lock (&self->lock);
+    last_used = self->last_used;
+    g_mutex_unlock (&self->lock);
+
+    return last_used;
+}
+
+gboolean
+gdb_session_is_busy (GdbSession *self)
+{
+    gboolean busy;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), FALSE);
+
+    g_mutex_lock (&self->lock);
+    busy = g_hash_table_size (self->pending) > 0 ||
+           self->state == GDB_SESSION_STATE_STARTING ||
+           self->state == GDB_SESSION_STATE_RUNNING;
+    g_mutex_unlock (&self->lock);
+
+    return busy;
+}
+
+guint64
+gdb_session_get_rss (GdbSession *self)
+{
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *contents = NULL;
+    const gchar *pid;
+    guint64 resident_pages;
+    gchar **fields;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), 0);
+
+    if (self->process == NULL ||
+        (pid = g_subprocess_get_identifier (self->process)) == NULL)
+    {
+        return 0;
+    }
+
+    /* statm: size resident shared text lib data dt, in pages */
+    path = g_strdup_printf ("/proc/%s/statm", pid);
+    if (!g_file_get_contents (path, &contents, NULL, NULL))
+    {
+        return 0;
+    }
+
+    fields = g_strsplit (contents, " ", 3);
+    resident_pages = g_strv_length (fields) >= 2
+                     ? g_ascii_strtoull (fields[1], NULL, 10)
+                     : 0;
+    g_strfreev (fields);
+
+    return resident_pages * (guint64) sysconf (_SC_PAGESIZE);
+}
+
 GdbMiParser *
 gdb_session_get_mi_parser (GdbSession *self)
 {
@@ -515,176 +994,94 @@ add_timeout_to_context (guint        interval_ms,
     return source;
 }
 
-/*
- * get_post_command_delay_ms:
- *
- * Gets the delay (in milliseconds) to wait after writing a command
- * to GDB before starting to read the response. This gives GDB time
- * to process the command and buffer output.
- *
- * The delay can be configured via the GDB_MCP_POST_COMMAND_DELAY_MS
- * environment variable. If not set, DEFAULT_POST_COMMAND_DELAY_MS is used.
- *
- * Returns: The delay in milliseconds
- */
-static guint
-get_post_command_delay_ms (void)
-{
-    const gchar *env_val;
-    guint delay;
-
-    env_val = g_getenv ("GDB_MCP_POST_COMMAND_DELAY_MS");
-    if (env_val != NULL)
-    {
-        delay = (guint) g_ascii_strtoull (env_val, NULL, 10);
-        if (delay > 0)
-        {
-            return delay;
-        }
-    }
-
-    return DEFAULT_POST_COMMAND_DELAY_MS;
-}
+static void reader_start (GdbSession *self);
 
 /* ========================================================================== */
 /* Start Implementation                                                       */
 /* ========================================================================== */
 
 typedef struct {
-    GdbSession *session;
-    gboolean    ready_received;
-    GSource    *timeout_source;
+    GSource *timeout_source;
+    gint64   spawned_at;         /* Monotonic time GDB was spawned */
 } StartData;
 
+/*
+ * Settings the fast profile passes with -iex, so they apply before GDB
+ * reads anything and the tools need not send them one by one.
+ */
+static const gchar * const fast_startup_settings[] = {
+    "set pagination off",
+    "set width 0",
+    "set height 0",
+    "set confirm off",
+    "set print pretty on",
+};
+
 static void
 start_data_free (StartData *data)
 {
-    /* Destroy timeout source if still pending */
-    if (data->timeout_source != NULL)
-    {
-        g_source_destroy (data->timeout_source);
-        g_source_unref (data->timeout_source);
-        data->timeout_source = NULL;
-    }
-    g_clear_object (&data->session);
     g_slice_free (StartData, data);
 }
 
+/*
+ * start_return:
+ * @task: (transfer full): the start task, already detached from the session
+ * @error: (transfer full) (nullable): the error, or %NULL on success
+ *
+ * Completes startup. Called by whoever detached the task from the
+ * session: the reader thread on the first prompt or EOF, or the
+ * startup timeout.
+ */
 static void
-on_startup_line_read (GObject      *source,
-                      GAsyncResult *result,
-                      gpointer      user_data);
-
-static void
-read_next_startup_line (GTask *task)
-{
-    StartData *data = (StartData *)g_task_get_task_data (task);
-
-    g_data_input_stream_read_line_async (data->session->stdout_reader,
-                                         G_PRIORITY_DEFAULT,
-                                         g_task_get_cancellable (task),
-                                         on_startup_line_read,
-                                         task);
-}
-
-static void
-on_startup_line_read (GObject      *source,
-                      GAsyncResult *result,
-                      gpointer      user_data)
+start_return (GTask  *task,
+              GError *error)
 {
-    GTask *task = G_TASK (user_data);
+    GdbSession *self = GDB_SESSION (g_task_get_source_object (task));
     StartData *data = (StartData *)g_task_get_task_data (task);
-    g_autoptr(GError) error = NULL;
-    g_autofree gchar *line = NULL;
-    gsize length;
 
-    line = g_data_input_stream_read_line_finish (G_DATA_INPUT_STREAM (source),
-                                                 result, &length, &error);
-
-    if (error != NULL)
+    if (data->timeout_source != NULL)
     {
-        set_state (data->session, GDB_SESSION_STATE_ERROR);
-
-        /* Cancel the timeout before completing */
-        if (data->timeout_source != NULL)
-        {
-            g_source_destroy (data->timeout_source);
-            g_source_unref (data->timeout_source);
-            data->timeout_source = NULL;
-            g_object_unref (task);  /* Release ref held by timeout callback */
-        }
-
-        g_task_return_error (task, g_steal_pointer (&error));
-        g_object_unref (task);
-        return;
+        g_source_destroy (data->timeout_source);
+        g_source_unref (data->timeout_source);
+        data->timeout_source = NULL;
     }
 
-    if (line == NULL)
+    if (error != NULL)
     {
-        /* EOF - process exited */
-        set_state (data->session, GDB_SESSION_STATE_ERROR);
-
-        /* Cancel the timeout before completing */
-        if (data->timeout_source != NULL)
-        {
-            g_source_destroy (data->timeout_source);
-            g_source_unref (data->timeout_source);
-            data->timeout_source = NULL;
-            g_object_unref (task);  /* Release ref held by timeout callback */
-        }
-
-        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_SPAWN_FAILED,
-                                 "GDB process exited unexpectedly during startup");
-        g_object_unref (task);
-        return;
+        set_state (self, GDB_SESSION_STATE_ERROR);
+        g_task_return_error (task, error);
     }
-
-    /* Check if GDB is ready - only complete when we see the (gdb) prompt
-     * to ensure we've consumed all buffered output from startup.
-     * GDB sends ^done first, then (gdb) prompt - we must wait for the prompt
-     * to avoid leaving it buffered for the next command to read.
-     */
-    if (gdb_mi_parser_is_prompt (line))
+    else
     {
-        data->ready_received = TRUE;
-        set_state (data->session, GDB_SESSION_STATE_READY);
-
-        /* Cancel the timeout before completing - must unref the task ref it holds */
-        if (data->timeout_source != NULL)
-        {
-            g_source_destroy (data->timeout_source);
-            g_source_unref (data->timeout_source);
-            data->timeout_source = NULL;
-            g_object_unref (task);  /* Release ref held by timeout callback */
-        }
+        g_mutex_lock (&self->lock);
+        self->startup_time = g_get_monotonic_time () - data->spawned_at;
+        g_mutex_unlock (&self->lock);
 
+        set_state (self, GDB_SESSION_STATE_READY);
         g_task_return_boolean (task, TRUE);
-        g_object_unref (task);
-        return;
     }
 
-    /* Continue reading */
-    read_next_startup_line (task);
+    g_object_unref (task);
 }
 
 static gboolean
 on_start_timeout (gpointer user_data)
 {
     GTask *task = G_TASK (user_data);
-    StartData *data = (StartData *)g_task_get_task_data (task);
+    GdbSession *self = GDB_SESSION (g_task_get_source_object (task));
 
-    /* Clear source pointer and unref - the source is being removed by
-     * returning G_SOURCE_REMOVE, so start_data_free shouldn't touch it.
-     */
-    if (data != NULL && data->timeout_source != NULL)
+    g_mutex_lock (&self->lock);
+    if (self->start_task != task)
     {
-        g_source_unref (data->timeout_source);
-        data->timeout_source = NULL;
+        /* The reader completed startup concurrently */
+        g_mutex_unlock (&self->lock);
+        return G_SOURCE_REMOVE;
     }
+    task = g_steal_pointer (&self->start_task);
+    g_mutex_unlock (&self->lock);
 
-    g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_TIMEOUT,
-                             "GDB startup timed out");
-    g_object_unref (task);
+    start_return (task, g_error_new (GDB_ERROR, GDB_ERROR_TIMEOUT,
+                                     "GDB startup timed out"));
 
     return G_SOURCE_REMOVE;
 }
@@ -698,8 +1095,9 @@ gdb_session_start_async (GdbSession          *self,
     g_autoptr(GTask) task = NULL;
     g_autoptr(GError) error = NULL;
     g_autoptr(GSubprocessLauncher) launcher = NULL;
+    g_autoptr(GPtrArray) argv = NULL;
     StartData *data;
-    const gchar *argv[3];
+    gint64 spawned_at;
 
     g_return_if_fail (GDB_IS_SESSION (self));
 
@@ -707,7 +1105,7 @@ gdb_session_start_async (GdbSession          *self,
     g_task_set_source_tag (task, gdb_session_start_async);
 
     /* Check state */
-    if (self->state != GDB_SESSION_STATE_DISCONNECTED)
+    if (gdb_session_get_state (self) != GDB_SESSION_STATE_DISCONNECTED)
     {
         g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_ALREADY_RUNNING,
                                  "Session already started");
@@ -726,39 +1124,79 @@ gdb_session_start_async (GdbSession          *self,
         g_subprocess_launcher_set_cwd (launcher, self->working_dir);
     }
 
-    /* Build argv */
-    argv[0] = self->gdb_path;
-    argv[1] = "--interpreter=mi";
-    argv[2] = NULL;
+    /* Build argv, everything GDB should apply before its first prompt */
+    argv = g_ptr_array_new_with_free_func (g_free);
+    g_ptr_array_add (argv, g_strdup (self->gdb_path));
+    g_ptr_array_add (argv, g_strdup ("--interpreter=mi"));
 
-    /* Spawn subprocess */
-    self->process = g_subprocess_launcher_spawnv (launcher, argv, &error);
-    if (self->process == NULL)
+    /* In synchronous MI mode GDB stops reading stdin while the target
+     * runs, so an -exec-interrupt would only be seen once the target
+     * stopped on its own. Both profiles need it, before any target.
+     */
+    g_ptr_array_add (argv, g_strdup ("-iex"));
+    g_ptr_array_add (argv, g_strdup ("set mi-async on"));
+
+    if (self->startup_profile == GDB_STARTUP_PROFILE_FAST)
     {
-        set_state (self, GDB_SESSION_STATE_ERROR);
-        g_task_return_error (task, g_steal_pointer (&error));
-        return;
-    }
+        guint i;
+
+        g_ptr_array_add (argv, g_strdup ("-nx"));
+        g_ptr_array_add (argv, g_strdup ("-q"));
+        for (i = 0; i < G_N_ELEMENTS (fast_startup_settings); i++)
+        {
+            g_ptr_array_add (argv, g_strdup ("-iex"));
+            g_ptr_array_add (argv, g_strdup (fast_startup_settings[i]));
+        }
+    }
+
+    if (self->auto_load_safe_path != NULL)
+    {
+        g_ptr_array_add (argv, g_strdup ("-iex"));
+        g_ptr_array_add (argv, g_strdup_printf ("set auto-load safe-path %s",
+                                                self->auto_load_safe_path));
+    }
+
+    if (self->init_script != NULL)
+    {
+        g_ptr_array_add (argv, g_strdup ("-x"));
+        g_ptr_array_add (argv, g_strdup (self->init_script));
+    }
+
+    g_ptr_array_add (argv, NULL);
+
+    /* Spawn subprocess */
+    spawned_at = g_get_monotonic_time ();
+    self->process = g_subprocess_launcher_spawnv (launcher,
+                                                  (const gchar * const *) argv->pdata,
+                                                  &error);
+    if (self->process == NULL)
+    {
+        set_state (self, GDB_SESSION_STATE_ERROR);
+        g_task_return_error (task, g_steal_pointer (&error));
+        return;
+    }
 
     /* Get I/O streams */
     self->stdin_pipe = g_subprocess_get_stdin_pipe (self->process);
-    self->stdout_reader = g_data_input_stream_new (
-        g_subprocess_get_stdout_pipe (self->process));
+    self->stdout_pipe = g_subprocess_get_stdout_pipe (self->process);
 
     /* Set up task data */
     data = g_slice_new0 (StartData);
-    data->session = g_object_ref (self);
-    data->ready_received = FALSE;
-    data->timeout_source = NULL;
+    data->spawned_at = spawned_at;
     g_task_set_task_data (task, data, (GDestroyNotify) start_data_free);
 
-    /* Set up timeout - store source so we can cancel it when done */
-    data->timeout_source = add_timeout_to_context (self->timeout_ms,
-                                                    on_start_timeout,
-                                                    g_object_ref (task));
+    /* Set up timeout - the source holds its own task reference */
+    data->timeout_source = g_timeout_source_new (self->timeout_ms);
+    g_source_set_callback (data->timeout_source, on_start_timeout,
+                           g_object_ref (task), g_object_unref);
+    g_source_attach (data->timeout_source, g_task_get_context (task));
 
-    /* Start reading output */
-    read_next_startup_line (g_steal_pointer (&task));
+    /* The reader thread completes the task on GDB's first prompt */
+    g_mutex_lock (&self->lock);
+    self->start_task = g_steal_pointer (&task);
+    g_mutex_unlock (&self->lock);
+
+    reader_start (self);
 }
 
 gboolean
@@ -772,519 +1210,2764 @@ gdb_session_start_finish (GdbSession    *self,
     return g_task_propagate_boolean (G_TASK (result), error);
 }
 
+static void
+on_start_future_complete (GObject      *source,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+    DexPromise *promise = (DexPromise *)user_data;
+    GError *error = NULL;
+
+    if (gdb_session_start_finish (GDB_SESSION (source), result, &error))
+    {
+        dex_promise_resolve_boolean (promise, TRUE);
+    }
+    else
+    {
+        dex_promise_reject (promise, error);
+    }
+
+    dex_unref (promise);
+}
+
+DexFuture *
+gdb_session_start_future (GdbSession *self)
+{
+    DexPromise *promise;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+
+    promise = dex_promise_new ();
+    gdb_session_start_async (self, NULL, on_start_future_complete, dex_ref (promise));
+
+    return DEX_FUTURE (promise);
+}
+
 /* ========================================================================== */
 /* Execute Implementation                                                     */
 /* ========================================================================== */
 
+/*
+ * Command multiplexing
+ *
+ * Every command is written with a numeric token prefix, e.g.
+ * "7-break-insert main" or "8print x", and registered in the session's
+ * pending table under that token. GDB echoes the token on the result
+ * record answering the command, so several commands can be in flight on
+ * the same pipe: the session's reader thread (see "Reader Thread") routes
+ * each ^done/^error/^running/^exit to the GTask whose token matches.
+ *
+ * Stream and async records carry no token. GDB processes stdin strictly
+ * in order, so untagged output is attributed as follows:
+ *   - while a command is running (^running seen, *stopped not yet),
+ *     it belongs to that command;
+ *   - while a command is waiting for its prompt, it belongs to it;
+ *   - otherwise it is held as "unclaimed" and attributed to the next
+ *     result record: claimed if that result is pending, dropped if it
+ *     answers a command nobody waits for anymore (e.g. timed out).
+ *
+ * A command completes on the prompt following its result record, after
+ * *stopped for commands answering ^running, or immediately on ^exit.
+ * Detached commands (gdb_session_execute_detached_async()) do not wait
+ * for *stopped; the rest of their run is kept for stop waiters instead.
+ *
+ * The pending table is shared between the reader thread, which also
+ * expires deadlines, and the callers' cancellation sources, so it is
+ * only touched with the session lock held. Whoever removes a task from
+ * the table owns its completion; tasks are always returned after
+ * dropping the lock. The exception is a cancelled command: it is
+ * returned on cancellation and left in the table to drain, and its
+ * later completion only releases it.
+ */
+
 typedef struct {
     GdbSession *session;
-    GString    *output;
-    gboolean    complete;
+    guint64     token;           /* Token prefixed to the command */
+    GString    *output;          /* Raw lines attributed to this command, or
+                                  * NULL for structured results */
+    GList      *records;         /* Parsed records attributed to this command */
+    gboolean    saw_result;      /* Saw a result record with our token */
     gboolean    saw_error;       /* Saw ^error result */
     gchar      *error_message;   /* Error message from ^error */
     gboolean    saw_running;     /* Saw ^running or *running - wait for *stopped */
     gboolean    saw_stopped;     /* Saw *stopped - can complete on next (gdb) */
-    GSource    *timeout_source;
+    gboolean    detached;        /* Complete on ^running without waiting for *stopped */
+    guint64     run_id;          /* Run serial started by our ^running */
+    gboolean    written;         /* Left the queue and was written to GDB */
+    gint64      queued_at;       /* Monotonic time of submission */
+    gint64      written_at;      /* Monotonic time of the write */
+    gboolean    cancelled;       /* Returned early, still draining its output */
+    gint64      deadline;        /* Monotonic time the command times out */
+    GList       deadline_link;   /* Link in the session's deadline queue */
+    GSource    *cancel_source;
 } ExecuteData;
 
 static void
 execute_data_free (ExecuteData *data)
 {
-    /* Destroy timeout source if still pending */
-    if (data->timeout_source != NULL)
-    {
-        g_source_destroy (data->timeout_source);
-        g_source_unref (data->timeout_source);
-        data->timeout_source = NULL;
-    }
+    /* The cancel source is destroyed when the task leaves the table */
     g_clear_object (&data->session);
     if (data->output != NULL)
     {
         g_string_free (data->output, TRUE);
     }
+    g_list_free_full (data->records, (GDestroyNotify) gdb_mi_record_unref);
     g_free (data->error_message);
     g_slice_free (ExecuteData, data);
 }
 
-static void
-on_execute_line_read (GObject      *source,
-                      GAsyncResult *result,
-                      gpointer      user_data);
+static void queued_submission_free (gpointer data);
+static void queue_pump (GdbSession *self);
+static void queue_interrupt (GdbSession *self);
 
+/*
+ * execute_clear_sources:
+ * @data: the execute data
+ *
+ * Destroys the task's cancellation source.
+ */
 static void
-read_next_execute_line (GTask *task)
+execute_clear_sources (ExecuteData *data)
 {
-    ExecuteData *data = (ExecuteData *)g_task_get_task_data (task);
-
-    g_data_input_stream_read_line_async (data->session->stdout_reader,
-                                         G_PRIORITY_DEFAULT,
-                                         g_task_get_cancellable (task),
-                                         on_execute_line_read,
-                                         task);
+    if (data->cancel_source != NULL)
+    {
+        g_source_destroy (data->cancel_source);
+        g_source_unref (data->cancel_source);
+        data->cancel_source = NULL;
+    }
 }
 
+/* ========================================================================== */
+/* Deadlines                                                                  */
+/* ========================================================================== */
+
+/*
+ * Command timeouts are not GSources. Every pending command's deadline
+ * sits in one queue per session, sorted by time, and the reader thread
+ * polls GDB's stdout with the earliest deadline as its timeout. When the
+ * poll returns it expires every command that is due in a single pass.
+ * The cost per command is a list link, whatever the command rate, and
+ * timeouts fire even if nobody iterates the caller's main context.
+ *
+ * All commands use the same timeout, so a new deadline is almost always
+ * the latest and is appended without waking the reader. Only a deadline
+ * that becomes the earliest (the first one after an idle period, or one
+ * armed after lowering timeout-ms) writes a byte to the wakeup pipe so
+ * the reader shortens its poll.
+ */
+
+/*
+ * deadline_arm_locked:
+ * @self: the session
+ * @task: a task just added to the pending table
+ * @position: the task's position in its submission, from 1
+ *
+ * Inserts the task's deadline into the sorted queue. GDB answers the
+ * commands of a batch one after another, so each gets a full timeout
+ * after the one before it: the Nth command is due N timeouts after
+ * the batch was queued. Must be called with the session lock held.
+ */
 static void
-on_execute_line_read (GObject      *source,
-                      GAsyncResult *result,
-                      gpointer      user_data)
+deadline_arm_locked (GdbSession *self,
+                     GTask      *task,
+                     guint       position)
 {
-    GTask *task = G_TASK (user_data);
     ExecuteData *data = (ExecuteData *)g_task_get_task_data (task);
-    g_autoptr(GError) error = NULL;
-    g_autofree gchar *line = NULL;
-    gsize length;
+    GList *l;
 
-    line = g_data_input_stream_read_line_finish (G_DATA_INPUT_STREAM (source),
-                                                 result, &length, &error);
+    data->deadline = data->queued_at +
+                     (gint64) position * self->timeout_ms * G_TIME_SPAN_MILLISECOND;
+    data->deadline_link.data = task;
 
-    if (error != NULL)
+    /* Walk back from the latest deadline; usually zero steps */
+    for (l = self->deadlines.tail; l != NULL; l = l->prev)
     {
-        /* Cancel the timeout before completing */
-        if (data->timeout_source != NULL)
+        ExecuteData *other = (ExecuteData *)g_task_get_task_data (l->data);
+
+        if (other->deadline <= data->deadline)
         {
-            g_source_destroy (data->timeout_source);
-            g_source_unref (data->timeout_source);
-            data->timeout_source = NULL;
-            g_object_unref (task);  /* Release ref held by timeout callback */
+            break;
         }
-
-        g_task_return_error (task, g_steal_pointer (&error));
-        g_object_unref (task);
-        return;
     }
 
-    if (line == NULL)
+    if (l != NULL)
     {
-        /* EOF */
-        /* Cancel the timeout before completing */
-        if (data->timeout_source != NULL)
-        {
-            g_source_destroy (data->timeout_source);
-            g_source_unref (data->timeout_source);
-            data->timeout_source = NULL;
-            g_object_unref (task);  /* Release ref held by timeout callback */
-        }
-
-        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_COMMAND_FAILED,
-                                 "GDB process exited unexpectedly");
-        g_object_unref (task);
+        g_queue_insert_after_link (&self->deadlines, l, &data->deadline_link);
         return;
     }
 
-    /* Append to output */
-    g_string_append (data->output, line);
-    g_string_append_c (data->output, '\n');
-
-    /* Emit console output for stream records */
-    if (line[0] == '~')
+    g_queue_push_head_link (&self->deadlines, &data->deadline_link);
+    if (self->wakeup_fds[1] >= 0 && write (self->wakeup_fds[1], "", 1) < 0)
     {
-        g_autofree gchar *content = gdb_mi_parser_unescape_string (line + 1);
-        g_signal_emit (data->session, signals[SIGNAL_CONSOLE_OUTPUT], 0, content);
+        /* EAGAIN: the pipe is full, so a wakeup is pending anyway */
     }
+}
 
-    /* Track error results - we'll report them when the drain timeout fires */
-    if (g_str_has_prefix (line, "^error"))
-    {
-        g_autoptr(GdbMiRecord) record = NULL;
-        const gchar *msg;
-
-        record = gdb_mi_parser_parse_line (data->session->mi_parser, line, NULL);
-        msg = record ? gdb_mi_record_get_error_message (record) : "Unknown error";
-
-        data->saw_error = TRUE;
-        g_free (data->error_message);
-        data->error_message = g_strdup (msg ? msg : "GDB command failed");
-    }
+/*
+ * deadline_next_timeout_locked:
+ * @self: the session
+ * @now: the current monotonic time
+ *
+ * Returns: the poll timeout in milliseconds until the earliest
+ *     deadline, or -1 if no command is pending
+ */
+static gint
+deadline_next_timeout_locked (GdbSession *self,
+                              gint64      now)
+{
+    ExecuteData *data;
+    gint64 remaining;
 
-    /* Track execution state for async commands like run, continue, step, next, finish.
-     * These commands return ^running immediately, then *stopped when execution completes.
-     * We need to wait for *stopped before completing, otherwise we'll miss output.
-     */
-    if (g_str_has_prefix (line, "^running") || g_str_has_prefix (line, "*running"))
+    if (self->deadlines.head == NULL)
     {
-        data->saw_running = TRUE;
+        return -1;
     }
 
-    if (g_str_has_prefix (line, "*stopped"))
+    data = (ExecuteData *)g_task_get_task_data (self->deadlines.head->data);
+    remaining = data->deadline - now;
+    if (remaining <= 0)
     {
-        data->saw_stopped = TRUE;
+        return 0;
     }
 
-    /* Complete when we see the prompt, but for execution commands (^running),
-     * we must wait for *stopped first. This ensures we capture all async output
-     * including the stop reason, frame info, etc.
-     *
-     * For ^exit, GDB is terminating so we complete on that too.
-     */
-    if (gdb_mi_parser_is_prompt (line) || g_str_has_prefix (line, "^exit"))
-    {
-        gchar *result_str;
-
-        /* If we saw ^running but haven't seen *stopped yet, keep reading.
-         * The program is still executing and we need to wait for it to stop.
-         */
-        if (data->saw_running && !data->saw_stopped)
-        {
-            read_next_execute_line (task);
-            return;
-        }
+    /* Round up, so the poll never returns just before the deadline */
+    return (gint) MIN ((remaining + G_TIME_SPAN_MILLISECOND - 1) / G_TIME_SPAN_MILLISECOND,
+                       G_MAXINT);
+}
 
-        data->complete = TRUE;
+static GTask *pending_remove_locked (GdbSession *self, GTask *task);
 
-        /* Cancel the timeout before completing */
-        if (data->timeout_source != NULL)
-        {
-            g_source_destroy (data->timeout_source);
-            g_source_unref (data->timeout_source);
-            data->timeout_source = NULL;
-            g_object_unref (task);  /* Release ref held by timeout callback */
-        }
+/*
+ * deadline_take_expired_locked:
+ * @self: the session
+ * @now: the current monotonic time
+ *
+ * Removes every pending command whose deadline has passed. Must be
+ * called with the session lock held.
+ *
+ * Returns: (transfer full) (element-type GTask): the expired tasks
+ */
+static GList *
+deadline_take_expired_locked (GdbSession *self,
+                              gint64      now)
+{
+    GList *expired = NULL;
 
-        result_str = g_string_free (data->output, FALSE);
-        data->output = NULL;
+    while (self->deadlines.head != NULL)
+    {
+        GTask *task = (GTask *)self->deadlines.head->data;
+        ExecuteData *data = (ExecuteData *)g_task_get_task_data (task);
 
-        /* Return error if we saw one, otherwise success */
-        if (data->saw_error)
+        if (data->deadline > now)
         {
-            g_free (result_str);
-            g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_COMMAND_FAILED,
-                                     "%s", data->error_message);
-            g_object_unref (task);
-            return;
+            break;
         }
-
-        g_task_return_pointer (task, result_str, g_free);
-        g_object_unref (task);
-        return;
+        expired = g_list_prepend (expired, pending_remove_locked (self, task));
     }
 
-    /* Continue reading */
-    read_next_execute_line (task);
+    return g_list_reverse (expired);
 }
 
 /*
- * on_read_delay_complete:
- * @user_data: the GTask for the execute operation
+ * pending_remove_locked:
+ * @self: the session
+ * @task: the execute task
  *
- * Callback called after the post-command delay has elapsed.
- * This gives GDB time to process the command and buffer output
- * before we start reading the response.
+ * Unregisters @task from the pending table, written or still queued,
+ * disarms its deadline and destroys its cancellation source. Must be
+ * called with the session lock held.
  *
- * Returns: G_SOURCE_REMOVE to remove the timeout source
+ * Returns: (transfer full): @task, with the reference held by the table
  */
-static gboolean
-on_read_delay_complete (gpointer user_data)
+static GTask *
+pending_remove_locked (GdbSession *self,
+                       GTask      *task)
 {
-    GTask *task = G_TASK (user_data);
+    ExecuteData *data = (ExecuteData *)g_task_get_task_data (task);
 
-    /* Start reading response after delay */
-    read_next_execute_line (task);
+    g_hash_table_remove (self->pending, &data->token);
+    self->last_used = g_get_monotonic_time ();
 
-    return G_SOURCE_REMOVE;
+    if (data->written)
+    {
+        g_queue_remove (&self->pending_order, task);
+        self->in_flight--;
+        if (data->cancelled)
+        {
+            self->draining--;
+        }
+    }
+    else
+    {
+        /* Still queued; the queue skips tokens no longer pending */
+        self->queued--;
+    }
+
+    g_queue_unlink (&self->deadlines, &data->deadline_link);
+    execute_clear_sources (data);
+
+    return task;
 }
 
 /*
- * on_command_written:
- * @source: the output stream
- * @result: the async result
- * @user_data: the GTask for the execute operation
- *
- * Callback called after the command has been written to GDB's stdin.
- * Instead of immediately reading the response, we add a configurable
- * delay to give GDB time to process the command and buffer output.
- * This fixes issues where output from one command would appear in
- * the next command's response.
+ * execute_return:
+ * @task: (transfer full): the execute task, already out of the table
+ *
+ * Completes the task with the framed response. The text variant returns
+ * the raw output, the MI variant returns the parsed record list.
  */
 static void
-on_command_written (GObject      *source,
-                    GAsyncResult *result,
-                    gpointer      user_data)
+execute_return (GTask *task)
 {
-    GTask *task = G_TASK (user_data);
     ExecuteData *data = (ExecuteData *)g_task_get_task_data (task);
-    g_autoptr(GError) error = NULL;
-    GSource *delay_source;
 
-    if (!g_output_stream_write_all_finish (G_OUTPUT_STREAM (source), result, NULL, &error))
+    if (data->cancelled)
     {
-        /* Cancel the timeout before completing */
-        if (data != NULL && data->timeout_source != NULL)
-        {
-            g_source_destroy (data->timeout_source);
-            g_source_unref (data->timeout_source);
-            data->timeout_source = NULL;
-            g_object_unref (task);  /* Release ref held by timeout callback */
-        }
-
-        g_task_return_error (task, g_steal_pointer (&error));
+        /* Already returned when it was cancelled; this was the drain */
         g_object_unref (task);
         return;
     }
 
-    /* Add delay before reading to let GDB process and buffer output.
-     * We don't need to track this source since it's short-lived and
-     * just triggers the read operation.
-     */
-    delay_source = add_timeout_to_context (get_post_command_delay_ms (),
-                                            on_read_delay_complete,
-                                            task);
-    g_source_unref (delay_source);  /* Let the source own itself */
+    if (g_task_get_source_tag (task) == gdb_session_execute_mi_async)
+    {
+        GList *records;
+
+        /* MI callers inspect ^error records themselves */
+        records = data->records;
+        data->records = NULL;
+        g_task_return_pointer (task, records,
+                               (GDestroyNotify) (void (*)(GList *)) g_list_free);
+    }
+    else if (data->saw_error)
+    {
+        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_COMMAND_FAILED,
+                                 "%s", data->error_message);
+    }
+    else if (g_task_get_source_tag (task) == gdb_session_execute_result_async)
+    {
+        g_task_return_pointer (task,
+                               gdb_command_result_new_from_records (data->records),
+                               (GDestroyNotify) gdb_command_result_unref);
+    }
+    else
+    {
+        gchar *result_str;
+
+        result_str = g_string_free (data->output, FALSE);
+        data->output = NULL;
+        g_task_return_pointer (task, result_str, g_free);
+    }
+
+    g_object_unref (task);
 }
 
-static gboolean
-on_execute_timeout (gpointer user_data)
+/*
+ * execute_fail:
+ * @task: (transfer full): the execute task, already out of the table
+ * @error: (transfer full): the error
+ *
+ * Completes the task with an error, unless it was cancelled before.
+ */
+static void
+execute_fail (GTask  *task,
+              GError *error)
 {
-    GTask *task = G_TASK (user_data);
     ExecuteData *data = (ExecuteData *)g_task_get_task_data (task);
 
-    /* Clear source pointer and unref - the source is being removed by
-     * returning G_SOURCE_REMOVE, so execute_data_free shouldn't touch it.
-     */
-    if (data != NULL && data->timeout_source != NULL)
+    if (data->cancelled)
     {
-        g_source_unref (data->timeout_source);
-        data->timeout_source = NULL;
+        g_error_free (error);
+    }
+    else
+    {
+        g_task_return_error (task, error);
     }
-
-    g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_TIMEOUT,
-                             "GDB command timed out");
     g_object_unref (task);
-
-    return G_SOURCE_REMOVE;
 }
 
-void
-gdb_session_execute_async (GdbSession          *self,
-                           const gchar         *command,
-                           GCancellable        *cancellable,
-                           GAsyncReadyCallback  callback,
-                           gpointer             user_data)
+/*
+ * take_all_pending_locked:
+ * @self: the session
+ *
+ * Removes every command still waiting for a response, e.g. because GDB
+ * exited. Must be called with the session lock held.
+ *
+ * Returns: (transfer full) (element-type GTask): the removed tasks
+ */
+static GList *
+take_all_pending_locked (GdbSession *self)
 {
-    g_autoptr(GTask) task = NULL;
-    ExecuteData *data;
-    g_autofree gchar *cmd_with_nl = NULL;
-
-    g_return_if_fail (GDB_IS_SESSION (self));
-    g_return_if_fail (command != NULL);
-
-    task = g_task_new (self, cancellable, callback, user_data);
-    g_task_set_source_tag (task, gdb_session_execute_async);
+    GList *tasks = NULL;
+    GList *queued;
+    GList *l;
+    GTask *task;
 
-    /* Check state */
-    if (!gdb_session_is_ready (self))
+    while ((task = (GTask *)g_queue_peek_head (&self->pending_order)) != NULL)
     {
-        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
-                                 "Session not ready for commands");
-        return;
+        tasks = g_list_prepend (tasks, pending_remove_locked (self, task));
     }
 
-    /* Set up task data */
-    data = g_slice_new0 (ExecuteData);
-    data->session = g_object_ref (self);
-    data->output = g_string_new (NULL);
-    data->complete = FALSE;
-    data->timeout_source = NULL;
-    g_task_set_task_data (task, data, (GDestroyNotify) execute_data_free);
+    /* Commands that never left the queue */
+    queued = g_hash_table_get_values (self->pending);
+    for (l = queued; l != NULL; l = l->next)
+    {
+        tasks = g_list_prepend (tasks, pending_remove_locked (self, l->data));
+    }
+    g_list_free (queued);
 
-    /* Set up timeout - store source so we can cancel it when done */
-    data->timeout_source = add_timeout_to_context (self->timeout_ms,
-                                                    on_execute_timeout,
-                                                    g_object_ref (task));
+    g_queue_clear_full (&self->control_queue, queued_submission_free);
+    g_queue_clear_full (&self->normal_queue, queued_submission_free);
 
-    /* Send command */
-    cmd_with_nl = g_strdup_printf ("%s\n", command);
-    g_output_stream_write_all_async (self->stdin_pipe,
-                                     cmd_with_nl,
-                                     strlen (cmd_with_nl),
-                                     G_PRIORITY_DEFAULT,
-                                     cancellable,
-                                     on_command_written,
-                                     g_steal_pointer (&task));
+    return g_list_reverse (tasks);
 }
 
-gchar *
-gdb_session_execute_finish (GdbSession    *self,
-                            GAsyncResult  *result,
-                            GError       **error)
+/*
+ * fail_tasks:
+ * @tasks: (transfer full) (element-type GTask): removed tasks
+ * @error: the error to report
+ */
+static void
+fail_tasks (GList        *tasks,
+            const GError *error)
 {
-    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
-    g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+    GList *l;
 
-    return (gchar *)g_task_propagate_pointer (G_TASK (result), error);
+    for (l = tasks; l != NULL; l = l->next)
+    {
+        execute_fail (l->data, g_error_copy (error));
+    }
+    g_list_free (tasks);
 }
 
-/* ========================================================================== */
-/* Execute MI Implementation                                                  */
-/* ========================================================================== */
-
-typedef struct {
-    GdbSession *session;
-    GList      *records;
-    GString    *current_line;
-} ExecuteMiData;
-
+/*
+ * attribute_line:
+ * @task: the execute task the line belongs to
+ * @line: the raw line
+ * @record: (nullable): the parsed record
+ */
 static void
-execute_mi_data_free (ExecuteMiData *data)
+attribute_line (GTask       *task,
+                const gchar *line,
+                GdbMiRecord *record)
 {
-    g_clear_object (&data->session);
-    g_list_free_full (data->records, (GDestroyNotify) gdb_mi_record_unref);
-    if (data->current_line != NULL)
+    ExecuteData *data = (ExecuteData *)g_task_get_task_data (task);
+
+    if (data->output != NULL)
     {
-        g_string_free (data->current_line, TRUE);
+        g_string_append (data->output, line);
+        g_string_append_c (data->output, '\n');
+    }
+    if (record != NULL)
+    {
+        data->records = g_list_append (data->records, gdb_mi_record_ref (record));
     }
-    g_slice_free (ExecuteMiData, data);
 }
 
-static void
-on_execute_mi_line_read (GObject      *source,
-                         GAsyncResult *result,
-                         gpointer      user_data);
-
-static void
-read_next_mi_line (GTask *task)
+/*
+ * find_untagged_owner_locked:
+ * @self: the session
+ *
+ * Finds the pending command untagged output currently belongs to: the
+ * oldest running command, or else the command waiting for its prompt.
+ *
+ * Returns: (transfer none) (nullable): the owning task
+ */
+static GTask *
+find_untagged_owner_locked (GdbSession *self)
 {
-    ExecuteMiData *data = (ExecuteMiData *)g_task_get_task_data (task);
+    GList *l;
 
-    g_data_input_stream_read_line_async (data->session->stdout_reader,
-                                         G_PRIORITY_DEFAULT,
-                                         g_task_get_cancellable (task),
-                                         on_execute_mi_line_read,
-                                         task);
-}
+    for (l = self->pending_order.head; l != NULL; l = l->next)
+    {
+        ExecuteData *data = (ExecuteData *)g_task_get_task_data (l->data);
 
-static void
-on_execute_mi_line_read (GObject      *source,
-                         GAsyncResult *result,
-                         gpointer      user_data)
-{
-    GTask *task = G_TASK (user_data);
-    ExecuteMiData *data = (ExecuteMiData *)g_task_get_task_data (task);
+        if (data->saw_running && !data->saw_stopped)
+        {
+            return l->data;
+        }
+    }
+
+    for (l = self->pending_order.head; l != NULL; l = l->next)
+    {
+        ExecuteData *data = (ExecuteData *)g_task_get_task_data (l->data);
+
+        if (data->saw_result && !data->saw_running)
+        {
+            return l->data;
+        }
+    }
+
+    return NULL;
+}
+
+/*
+ * dispatch_result_locked:
+ * @self: the session
+ * @line: the raw line
+ * @record: the parsed result record
+ * @done: (inout): list of tasks to return once the lock is dropped
+ */
+static void
+dispatch_result_locked (GdbSession   *self,
+                        const gchar  *line,
+                        GdbMiRecord  *record,
+                        GList       **done)
+{
+    ExecuteData *data;
+    GTask *task;
+    gint64 token;
+
+    token = gdb_mi_record_get_token (record);
+    task = token >= 0 ? g_hash_table_lookup (self->pending, &token) : NULL;
+
+    if (task == NULL)
+    {
+        /* Answer to a command nobody waits for - it owns the unclaimed output */
+        g_debug ("Session %s: dropping stray output for token %" G_GINT64_FORMAT,
+                 self->session_id, token);
+        g_string_truncate (self->unclaimed_text, 0);
+        g_list_free_full (self->unclaimed, (GDestroyNotify) gdb_mi_record_unref);
+        self->unclaimed = NULL;
+        return;
+    }
+
+    data = (ExecuteData *)g_task_get_task_data (task);
+
+    /* Output printed while GDB processed this command precedes its result */
+    if (data->output != NULL)
+    {
+        g_string_append_len (data->output,
+                             self->unclaimed_text->str,
+                             self->unclaimed_text->len);
+    }
+    g_string_truncate (self->unclaimed_text, 0);
+    data->records = g_list_concat (data->records, self->unclaimed);
+    self->unclaimed = NULL;
+
+    data->saw_result = TRUE;
+    attribute_line (task, line, record);
+
+    switch (gdb_mi_record_get_result_class (record))
+    {
+        case GDB_MI_RESULT_ERROR:
+            {
+                const gchar *msg = gdb_mi_record_get_error_message (record);
+
+                data->saw_error = TRUE;
+                g_free (data->error_message);
+                data->error_message = g_strdup (msg ? msg : "GDB command failed");
+            }
+            break;
+        case GDB_MI_RESULT_RUNNING:
+            /* The state tracker has already counted this resume */
+            data->saw_running = TRUE;
+            data->run_id = self->run_serial;
+            break;
+        case GDB_MI_RESULT_EXIT:
+            /* GDB is terminating; no prompt will follow */
+            *done = g_list_append (*done, pending_remove_locked (self, task));
+            break;
+        default:
+            break;
+    }
+}
+
+/*
+ * dispatch_prompt_locked:
+ * @self: the session
+ * @line: the raw line
+ * @done: (inout): list of tasks to return once the lock is dropped
+ */
+static void
+dispatch_prompt_locked (GdbSession   *self,
+                        const gchar  *line,
+                        GList       **done)
+{
+    GList *l;
+
+    /* The prompt terminates every response whose result has been seen
+     * and which is not waiting for its program to stop.
+     */
+    l = self->pending_order.head;
+    while (l != NULL)
+    {
+        GTask *task = l->data;
+        ExecuteData *data = (ExecuteData *)g_task_get_task_data (task);
+
+        l = l->next;
+
+        if (data->saw_result &&
+            (!data->saw_running || data->saw_stopped || data->detached))
+        {
+            if (data->saw_running && !data->saw_stopped)
+            {
+                /* Nobody owns the rest of this run; stop waiters get it */
+                self->run_detached = TRUE;
+            }
+            attribute_line (task, line, NULL);
+            *done = g_list_append (*done, pending_remove_locked (self, task));
+        }
+    }
+}
+
+/*
+ * dispatch_untagged_locked:
+ * @self: the session
+ * @line: the raw line
+ * @record: (nullable): the parsed record
+ */
+static void
+dispatch_untagged_locked (GdbSession  *self,
+                          const gchar *line,
+                          GdbMiRecord *record)
+{
+    GTask *owner;
+
+    owner = find_untagged_owner_locked (self);
+    if (owner == NULL && self->run_detached)
+    {
+        /* Output of a detached run; it is kept in run_output */
+        return;
+    }
+    if (owner == NULL)
+    {
+        g_string_append (self->unclaimed_text, line);
+        g_string_append_c (self->unclaimed_text, '\n');
+        if (record != NULL)
+        {
+            self->unclaimed = g_list_append (self->unclaimed, gdb_mi_record_ref (record));
+        }
+        return;
+    }
+
+    attribute_line (owner, line, record);
+
+    /* Track execution state for commands like run, continue, step.
+     * These return ^running immediately and *stopped once execution
+     * completes; we wait for *stopped so the stop details are included.
+     */
+    if (record != NULL &&
+        gdb_mi_record_get_type_enum (record) == GDB_MI_RECORD_EXEC_ASYNC)
+    {
+        ExecuteData *data = (ExecuteData *)g_task_get_task_data (owner);
+        const gchar *klass = gdb_mi_record_get_class (record);
+
+        if (g_strcmp0 (klass, "running") == 0)
+        {
+            data->saw_running = TRUE;
+        }
+        else if (g_strcmp0 (klass, "stopped") == 0)
+        {
+            data->saw_stopped = TRUE;
+        }
+    }
+}
+
+/*
+ * on_execute_cancelled:
+ *
+ * A command still in the queue is simply dropped. A written command is
+ * returned right away but stays in the pending table, draining, so its
+ * result and any output it still causes are consumed here instead of
+ * being attributed to later commands; normal commands are held until it
+ * has drained. If it resumed the target, the target is interrupted so
+ * the drain ends promptly.
+ */
+static gboolean
+on_execute_cancelled (GCancellable *cancellable G_GNUC_UNUSED,
+                      gpointer      user_data)
+{
+    GTask *task = G_TASK (user_data);
+    ExecuteData *data = (ExecuteData *)g_task_get_task_data (task);
+    GdbSession *self = data->session;
+    gboolean interrupt;
+
+    g_mutex_lock (&self->lock);
+    if (g_hash_table_lookup (self->pending, &data->token) != task ||
+        data->cancelled)
+    {
+        g_mutex_unlock (&self->lock);
+        return G_SOURCE_REMOVE;
+    }
+
+    if (!data->written)
+    {
+        task = pending_remove_locked (self, task);
+        g_mutex_unlock (&self->lock);
+
+        execute_fail (task, g_error_new (G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                                         "Operation was cancelled"));
+        return G_SOURCE_REMOVE;
+    }
+
+    data->cancelled = TRUE;
+    self->draining++;
+    interrupt = data->saw_running && !data->saw_stopped;
+    g_mutex_unlock (&self->lock);
+
+    /* The table keeps its reference until the drain completes */
+    g_task_return_new_error (task, G_IO_ERROR, G_IO_ERROR_CANCELLED,
+                             "Operation was cancelled");
+
+    if (interrupt)
+    {
+        queue_interrupt (self);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * write_to_gdb_locked:
+ * @self: the session
+ * @buffer: the data to write
+ * @length: length of @buffer
+ * @error: return location for a #GError
+ *
+ * Writes to GDB's stdin. Commands are short, so a blocking write on
+ * the calling thread is cheap and keeps the writes of concurrent
+ * callers from interleaving. Must be called with the write lock held.
+ *
+ * Returns: %TRUE on success
+ */
+static gboolean
+write_to_gdb_locked (GdbSession   *self,
+                     const gchar  *buffer,
+                     gsize         length,
+                     GError      **error)
+{
+    if (self->stdin_pipe == NULL)
+    {
+        g_set_error (error, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
+                     "GDB process is not running");
+        return FALSE;
+    }
+
+    return g_output_stream_write_all (self->stdin_pipe, buffer, length,
+                                      NULL, NULL, error);
+}
+
+/*
+ * execute_prepare:
+ * @self: the session
+ * @task: the execute task
+ *
+ * Sets up the task data and arms the cancellation source. The deadline
+ * is armed when the command is submitted.
+ */
+static void
+execute_prepare (GdbSession *self,
+                 GTask      *task)
+{
+    ExecuteData *data;
+    GCancellable *cancellable;
+
+    data = g_slice_new0 (ExecuteData);
+    data->session = g_object_ref (self);
+    data->output = g_string_new (NULL);
+    g_task_set_task_data (task, data, (GDestroyNotify) execute_data_free);
+
+    /* The source holds its own task reference; the callback checks the
+     * pending table, so it is harmless if it races with completion.
+     */
+    cancellable = g_task_get_cancellable (task);
+    if (cancellable != NULL)
+    {
+        data->cancel_source = g_cancellable_source_new (cancellable);
+        g_source_set_callback (data->cancel_source,
+                               G_SOURCE_FUNC (on_execute_cancelled),
+                               g_object_ref (task), g_object_unref);
+        g_source_attach (data->cancel_source, g_task_get_context (task));
+    }
+}
+
+/* ========================================================================== */
+/* Command Queue                                                              */
+/* ========================================================================== */
+
+/*
+ * Submitted commands wait in one of two FIFO lanes before they are
+ * written to GDB:
+ *   - the control lane carries interrupts and quit; it is always
+ *     drained first and immediately, and is never refused;
+ *   - the normal lane carries everything else. It is written while
+ *     fewer than MAX_IN_FLIGHT commands are unanswered and no written
+ *     command is running the target, so cheap queries queued behind a
+ *     "continue" stay in the session, where an interrupt can still
+ *     overtake them, instead of in GDB's stdin. It is also held while
+ *     a cancelled command drains (see on_execute_cancelled()).
+ * The normal lane holds at most max_queue_depth commands; beyond that
+ * submissions fail with GDB_ERROR_QUEUE_FULL instead of piling up.
+ *
+ * A submission is one or more commands written together (a batch).
+ * Tokens are assigned and tasks registered in the pending table when
+ * the submission is queued, so queued commands time out and cancel like
+ * written ones; the queue simply skips tokens that left the table.
+ *
+ * The queue is pumped after every submission and whenever commands
+ * complete. Pumping may write from the reader thread; the in-flight
+ * window keeps the data GDB has not consumed far below a pipe buffer,
+ * so that write cannot block on a GDB that is itself blocked on us.
+ */
+
+typedef struct {
+    guint64  *tokens;
+    gchar   **lines;      /* Token-prefixed, newline-terminated */
+    guint     n_lines;
+} QueuedSubmission;
+
+static void
+queued_submission_free (gpointer data)
+{
+    QueuedSubmission *submission = (QueuedSubmission *)data;
+
+    g_free (submission->tokens);
+    g_strfreev (submission->lines);
+    g_slice_free (QueuedSubmission, submission);
+}
+
+/*
+ * is_control_command:
+ * @command: a command as submitted, without token
+ *
+ * Returns: %TRUE if @command belongs in the control lane
+ */
+static gboolean
+is_control_command (const gchar *command)
+{
+    static const gchar * const control[] = {
+        "-exec-interrupt", "interrupt", "-gdb-exit", "quit", NULL
+    };
+    guint i;
+
+    for (i = 0; control[i] != NULL; i++)
+    {
+        gsize len = strlen (control[i]);
+
+        if (strncmp (command, control[i], len) == 0 &&
+            (command[len] == '\0' || g_ascii_isspace (command[len])))
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*
+ * target_running_locked:
+ * @self: the session
+ *
+ * Returns: %TRUE if the target runs or a written command resumed it, in
+ *     which case normal commands stay queued
+ */
+static gboolean
+target_running_locked (GdbSession *self)
+{
+    GList *l;
+
+    if (self->state == GDB_SESSION_STATE_RUNNING)
+    {
+        return TRUE;
+    }
+
+    for (l = self->pending_order.head; l != NULL; l = l->next)
+    {
+        ExecuteData *data = (ExecuteData *)g_task_get_task_data (l->data);
+
+        if (data->saw_running && !data->saw_stopped)
+        {
+            return TRUE;
+        }
+    }
+
+    return FALSE;
+}
+
+/*
+ * queue_take_locked:
+ * @self: the session
+ * @submission: (transfer full): a submission popped from a lane
+ * @buffer: the write buffer
+ * @written: (element-type guint64): tokens written by this pump
+ *
+ * Moves the submission's still-pending commands to the in-flight set
+ * and appends them to @buffer.
+ */
+static void
+queue_take_locked (GdbSession       *self,
+                   QueuedSubmission *submission,
+                   GString          *buffer,
+                   GArray           *written)
+{
+    gint64 now = g_get_monotonic_time ();
+    guint i;
+
+    for (i = 0; i < submission->n_lines; i++)
+    {
+        GTask *task = g_hash_table_lookup (self->pending, &submission->tokens[i]);
+        ExecuteData *data;
+
+        if (task == NULL)
+        {
+            continue; /* Timed out or cancelled while queued */
+        }
+
+        data = (ExecuteData *)g_task_get_task_data (task);
+        data->written = TRUE;
+        data->written_at = now;
+        self->queued--;
+        self->in_flight++;
+        g_queue_push_tail (&self->pending_order, task);
+
+        g_string_append (buffer, submission->lines[i]);
+        g_array_append_val (written, submission->tokens[i]);
+    }
+
+    queued_submission_free (submission);
+}
+
+/*
+ * queue_pump:
+ * @self: the session
+ *
+ * Writes every control submission and as many normal submissions as
+ * the in-flight window allows, with a single write.
+ */
+static void
+queue_pump (GdbSession *self)
+{
     g_autoptr(GError) error = NULL;
+    g_autoptr(GArray) written = NULL;
+    QueuedSubmission *submission;
+    GString *buffer;
+    GList *failed = NULL;
+    guint i;
+
+    written = g_array_new (FALSE, FALSE, sizeof (guint64));
+    buffer = g_string_new (NULL);
+
+    /* The write lock keeps tokens hitting the pipe in pending_order */
+    g_mutex_lock (&self->write_lock);
+
+    g_mutex_lock (&self->lock);
+    while ((submission = g_queue_pop_head (&self->control_queue)) != NULL)
+    {
+        queue_take_locked (self, submission, buffer, written);
+    }
+    while (self->in_flight < MAX_IN_FLIGHT &&
+           self->draining == 0 &&
+           !g_queue_is_empty (&self->normal_queue) &&
+           !target_running_locked (self))
+    {
+        submission = g_queue_pop_head (&self->normal_queue);
+        queue_take_locked (self, submission, buffer, written);
+    }
+    g_mutex_unlock (&self->lock);
+
+    if (buffer->len == 0 ||
+        write_to_gdb_locked (self, buffer->str, buffer->len, &error))
+    {
+        g_mutex_unlock (&self->write_lock);
+        g_string_free (buffer, TRUE);
+        return;
+    }
+
+    g_mutex_unlock (&self->write_lock);
+    g_string_free (buffer, TRUE);
+
+    /* Fail whatever the reader has not completed already. Completed
+     * tasks may be gone, so only look them up by token.
+     */
+    g_mutex_lock (&self->lock);
+    for (i = 0; i < written->len; i++)
+    {
+        GTask *task = g_hash_table_lookup (self->pending,
+                                           &g_array_index (written, guint64, i));
+
+        if (task != NULL)
+        {
+            failed = g_list_append (failed, pending_remove_locked (self, task));
+        }
+    }
+    g_mutex_unlock (&self->lock);
+
+    fail_tasks (failed, error);
+}
+
+/*
+ * execute_submit:
+ * @self: the session
+ * @tasks: (array length=n_commands) (transfer full): prepared execute tasks
+ * @commands: (array length=n_commands): the commands, one per task
+ * @n_commands: number of commands
+ *
+ * Tags each command with a fresh token, registers the tasks in the
+ * pending table and queues them as one submission, which is written to
+ * GDB with a single write. GDB reads stdin sequentially, so a batch
+ * costs one pipe round trip instead of one per command.
+ */
+static void
+execute_submit (GdbSession          *self,
+                GTask              **tasks,
+                const gchar * const *commands,
+                guint                n_commands)
+{
+    QueuedSubmission *submission;
+    gboolean control;
+    gint64 now;
+    guint i;
+
+    control = n_commands == 1 && is_control_command (commands[0]);
+    now = g_get_monotonic_time ();
+
+    g_mutex_lock (&self->lock);
+
+    if (!control && self->queued + n_commands > self->max_queue_depth)
+    {
+        guint depth = self->max_queue_depth;
+
+        g_mutex_unlock (&self->lock);
+
+        /* Backpressure: refuse rather than queue without bound */
+        for (i = 0; i < n_commands; i++)
+        {
+            execute_clear_sources ((ExecuteData *)g_task_get_task_data (tasks[i]));
+            execute_fail (tasks[i], g_error_new (GDB_ERROR, GDB_ERROR_QUEUE_FULL,
+                                                 "Command queue full (%u commands)",
+                                                 depth));
+        }
+        return;
+    }
+
+    self->last_used = now;
+
+    submission = g_slice_new0 (QueuedSubmission);
+    submission->tokens = g_new (guint64, n_commands);
+    submission->lines = g_new0 (gchar *, n_commands + 1);
+    submission->n_lines = n_commands;
+
+    /* The pending table owns the task references until completion */
+    for (i = 0; i < n_commands; i++)
+    {
+        ExecuteData *data = (ExecuteData *)g_task_get_task_data (tasks[i]);
+
+        data->token = self->next_token++;
+        data->queued_at = now;
+        g_hash_table_insert (self->pending, &data->token, tasks[i]);
+        deadline_arm_locked (self, tasks[i], i + 1);
+        self->queued++;
+
+        submission->tokens[i] = data->token;
+        submission->lines[i] = g_strdup_printf ("%" G_GUINT64_FORMAT "%s\n",
+                                                data->token, commands[i]);
+    }
+
+    g_queue_push_tail (control ? &self->control_queue : &self->normal_queue,
+                       submission);
+    g_mutex_unlock (&self->lock);
+
+    queue_pump (self);
+}
+
+static void
+execute_submit_one (GdbSession  *self,
+                    GTask       *task,
+                    const gchar *command)
+{
+    execute_submit (self, &task, &command, 1);
+}
+
+/*
+ * queue_interrupt:
+ * @self: the session
+ *
+ * Sends -exec-interrupt through the control lane. Nobody waits for the
+ * answer; the command only carries a token so its result is consumed
+ * like any other.
+ */
+static void
+queue_interrupt (GdbSession *self)
+{
+    GTask *task;
+
+    task = g_task_new (self, NULL, NULL, NULL);
+    g_task_set_source_tag (task, gdb_session_execute_async);
+    execute_prepare (self, task);
+    execute_submit_one (self, task, "-exec-interrupt");
+}
+
+void
+gdb_session_execute_async (GdbSession          *self,
+                           const gchar         *command,
+                           GCancellable        *cancellable,
+                           GAsyncReadyCallback  callback,
+                           gpointer             user_data)
+{
+    g_autoptr(GTask) task = NULL;
+
+    g_return_if_fail (GDB_IS_SESSION (self));
+    g_return_if_fail (command != NULL);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, gdb_session_execute_async);
+
+    /* Check state; control commands are what a running target needs */
+    if (!gdb_session_is_ready (self) &&
+        !(gdb_session_get_state (self) == GDB_SESSION_STATE_RUNNING &&
+          is_control_command (command)))
+    {
+        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
+                                 "Session not ready for commands");
+        return;
+    }
+
+    execute_prepare (self, task);
+    execute_submit_one (self, g_steal_pointer (&task), command);
+}
+
+gchar *
+gdb_session_execute_finish (GdbSession    *self,
+                            GAsyncResult  *result,
+                            GError       **error)
+{
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+    return (gchar *)g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/* ========================================================================== */
+/* Execute Detached Implementation                                            */
+/* ========================================================================== */
+
+void
+gdb_session_execute_detached_async (GdbSession          *self,
+                                    const gchar         *command,
+                                    GCancellable        *cancellable,
+                                    GAsyncReadyCallback  callback,
+                                    gpointer             user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    ExecuteData *data;
+
+    g_return_if_fail (GDB_IS_SESSION (self));
+    g_return_if_fail (command != NULL);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, gdb_session_execute_detached_async);
+
+    if (!gdb_session_is_ready (self))
+    {
+        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
+                                 "Session not ready for commands");
+        return;
+    }
+
+    execute_prepare (self, task);
+    data = (ExecuteData *)g_task_get_task_data (task);
+    data->detached = TRUE;
+    execute_submit_one (self, g_steal_pointer (&task), command);
+}
+
+gchar *
+gdb_session_execute_detached_finish (GdbSession    *self,
+                                     GAsyncResult  *result,
+                                     guint64       *run_id,
+                                     GError       **error)
+{
+    ExecuteData *data;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+    data = (ExecuteData *)g_task_get_task_data (G_TASK (result));
+    if (run_id != NULL)
+    {
+        *run_id = data != NULL ? data->run_id : 0;
+    }
+
+    return (gchar *)g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/* ========================================================================== */
+/* Execute MI Implementation                                                  */
+/* ========================================================================== */
+
+void
+gdb_session_execute_mi_async (GdbSession          *self,
+                              const gchar         *command,
+                              GCancellable        *cancellable,
+                              GAsyncReadyCallback  callback,
+                              gpointer             user_data)
+{
+    g_autoptr(GTask) task = NULL;
+
+    g_return_if_fail (GDB_IS_SESSION (self));
+    g_return_if_fail (command != NULL);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, gdb_session_execute_mi_async);
+
+    if (!gdb_session_is_ready (self))
+    {
+        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
+                                 "Session not ready for commands");
+        return;
+    }
+
+    execute_prepare (self, task);
+    execute_submit_one (self, g_steal_pointer (&task), command);
+}
+
+GList *
+gdb_session_execute_mi_finish (GdbSession    *self,
+                               GAsyncResult  *result,
+                               GError       **error)
+{
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+    return (GList *)g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/* ========================================================================== */
+/* Execute Result Implementation                                              */
+/* ========================================================================== */
+
+void
+gdb_session_execute_result_async (GdbSession          *self,
+                                  const gchar         *command,
+                                  GCancellable        *cancellable,
+                                  GAsyncReadyCallback  callback,
+                                  gpointer             user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    ExecuteData *data;
+
+    g_return_if_fail (GDB_IS_SESSION (self));
+    g_return_if_fail (command != NULL);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, gdb_session_execute_result_async);
+
+    if (!gdb_session_is_ready (self))
+    {
+        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
+                                 "Session not ready for commands");
+        return;
+    }
+
+    execute_prepare (self, task);
+
+    /* Only the records are kept; no raw text is accumulated */
+    data = (ExecuteData *)g_task_get_task_data (task);
+    g_string_free (data->output, TRUE);
+    data->output = NULL;
+
+    execute_submit_one (self, g_steal_pointer (&task), command);
+}
+
+GdbCommandResult *
+gdb_session_execute_result_finish (GdbSession    *self,
+                                   GAsyncResult  *result,
+                                   GError       **error)
+{
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+    return (GdbCommandResult *)g_task_propagate_pointer (G_TASK (result), error);
+}
+
+/* ========================================================================== */
+/* Future Wrappers                                                            */
+/* ========================================================================== */
+
+/*
+ * The futures complete from the GTask callback, on whatever context was
+ * thread-default when they were created. Resolving a promise wakes the
+ * awaiting fiber on its own scheduler, so fibers need no main loop.
+ *
+ * Operations with more than one result (a run ID, a stop's details)
+ * resolve to their GAsyncResult instead, which the fiber hands to the
+ * matching _finish() function.
+ */
+
+static void
+on_async_result_future_complete (GObject      *source G_GNUC_UNUSED,
+                                 GAsyncResult *result,
+                                 gpointer      user_data)
+{
+    DexPromise *promise = (DexPromise *)user_data;
+
+    dex_promise_resolve_object (promise, g_object_ref (result));
+    dex_unref (promise);
+}
+
+static void
+on_execute_future_complete (GObject      *source,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+    DexPromise *promise = (DexPromise *)user_data;
+    GError *error = NULL;
+    gchar *output;
+
+    output = gdb_session_execute_finish (GDB_SESSION (source), result, &error);
+    if (output != NULL)
+    {
+        dex_promise_resolve_string (promise, output);
+    }
+    else
+    {
+        dex_promise_reject (promise, error);
+    }
+
+    dex_unref (promise);
+}
+
+DexFuture *
+gdb_session_execute_future (GdbSession  *self,
+                            const gchar *command)
+{
+    DexPromise *promise;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (command != NULL, NULL);
+
+    promise = dex_promise_new ();
+    gdb_session_execute_async (self, command, NULL,
+                               on_execute_future_complete, dex_ref (promise));
+
+    return DEX_FUTURE (promise);
+}
+
+static void
+on_execute_result_future_complete (GObject      *source,
+                                   GAsyncResult *result,
+                                   gpointer      user_data)
+{
+    DexPromise *promise = (DexPromise *)user_data;
+    GError *error = NULL;
+    GdbCommandResult *command_result;
+
+    command_result = gdb_session_execute_result_finish (GDB_SESSION (source), result, &error);
+    if (command_result != NULL)
+    {
+        dex_promise_resolve_boxed (promise, GDB_TYPE_COMMAND_RESULT, command_result);
+    }
+    else
+    {
+        dex_promise_reject (promise, error);
+    }
+
+    dex_unref (promise);
+}
+
+DexFuture *
+gdb_session_execute_result_future (GdbSession  *self,
+                                   const gchar *command)
+{
+    DexPromise *promise;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (command != NULL, NULL);
+
+    promise = dex_promise_new ();
+    gdb_session_execute_result_async (self, command, NULL,
+                                      on_execute_result_future_complete,
+                                      dex_ref (promise));
+
+    return DEX_FUTURE (promise);
+}
+
+DexFuture *
+gdb_session_execute_detached_future (GdbSession  *self,
+                                     const gchar *command)
+{
+    DexPromise *promise;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (command != NULL, NULL);
+
+    promise = dex_promise_new ();
+    gdb_session_execute_detached_async (self, command, NULL,
+                                        on_async_result_future_complete,
+                                        dex_ref (promise));
+
+    return DEX_FUTURE (promise);
+}
+
+/* ========================================================================== */
+/* Execute Batch Implementation                                               */
+/* ========================================================================== */
+
+typedef struct {
+    GPtrArray *outputs;     /* One output or result (or NULL) per command */
+    guint      remaining;   /* Commands still in flight */
+    GError    *error;       /* First session-level failure */
+    gint64     queue_time;  /* Shared by all commands, written together */
+} BatchData;
+
+typedef struct {
+    GTask *batch_task;
+    guint  index;
+} BatchItem;
+
+static void
+batch_data_free (BatchData *data)
+{
+    g_clear_pointer (&data->outputs, g_ptr_array_unref);
+    g_clear_error (&data->error);
+    g_slice_free (BatchData, data);
+}
+
+/*
+ * batch_item_complete:
+ * @item: (transfer full): the item
+ * @self: the session
+ * @result: the item's result
+ * @error: (transfer full) (nullable): the item's error
+ *
+ * Accounts for one finished command, whose entry the caller has filled
+ * in, and completes the batch after the last one.
+ */
+static void
+batch_item_complete (BatchItem    *item,
+                     GdbSession   *self,
+                     GAsyncResult *result,
+                     GError       *error)
+{
+    GTask *batch_task = item->batch_task;
+    BatchData *data = (BatchData *)g_task_get_task_data (batch_task);
+
+    if (item->index == 0)
+    {
+        data->queue_time = gdb_session_execute_get_queue_time (self, result);
+    }
+
+    /* A GDB-level ^error only affects its own command; anything else
+     * (timeout, cancellation, GDB exiting) fails the whole batch.
+     */
+    if (error != NULL && data->error == NULL &&
+        !g_error_matches (error, GDB_ERROR, GDB_ERROR_COMMAND_FAILED))
+    {
+        data->error = g_steal_pointer (&error);
+    }
+    g_clear_error (&error);
+
+    g_slice_free (BatchItem, item);
+
+    if (--data->remaining == 0)
+    {
+        if (data->error != NULL)
+        {
+            g_task_return_error (batch_task, g_steal_pointer (&data->error));
+        }
+        else
+        {
+            g_task_return_pointer (batch_task,
+                                   g_steal_pointer (&data->outputs),
+                                   (GDestroyNotify) g_ptr_array_unref);
+        }
+    }
+
+    g_object_unref (batch_task);
+}
+
+static void
+on_batch_item_done (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+    BatchItem *item = (BatchItem *)user_data;
+    BatchData *data = (BatchData *)g_task_get_task_data (item->batch_task);
+    GError *error = NULL;
+
+    g_ptr_array_index (data->outputs, item->index) =
+        gdb_session_execute_finish (GDB_SESSION (source), result, &error);
+    batch_item_complete (item, GDB_SESSION (source), result, error);
+}
+
+static void
+on_result_batch_item_done (GObject      *source,
+                           GAsyncResult *result,
+                           gpointer      user_data)
+{
+    BatchItem *item = (BatchItem *)user_data;
+    BatchData *data = (BatchData *)g_task_get_task_data (item->batch_task);
+    GError *error = NULL;
+    GList *records;
+
+    /* Items run as MI executes, so ^error arrives as a record */
+    records = gdb_session_execute_mi_finish (GDB_SESSION (source), result, &error);
+    if (error == NULL)
+    {
+        g_ptr_array_index (data->outputs, item->index) =
+            gdb_command_result_new_from_records (records);
+        g_list_free_full (records, (GDestroyNotify) gdb_mi_record_unref);
+    }
+    batch_item_complete (item, GDB_SESSION (source), result, error);
+}
+
+/*
+ * execute_batch:
+ * @self: the session
+ * @task: the batch task
+ * @commands: (array zero-terminated=1): the commands
+ * @keep_records: whether entries are #GdbCommandResults instead of text
+ *
+ * Submits @commands as one pipelined batch that completes @task.
+ */
+static void
+execute_batch (GdbSession          *self,
+               GTask               *task,
+               const gchar * const *commands,
+               gboolean             keep_records)
+{
+    BatchData *data;
+    GTask **tasks;
+    guint n_commands;
+    guint i;
+
+    n_commands = g_strv_length ((gchar **) commands);
+
+    data = g_slice_new0 (BatchData);
+    data->outputs = g_ptr_array_new_full (n_commands,
+                                          keep_records
+                                          ? (GDestroyNotify) gdb_command_result_unref
+                                          : g_free);
+    g_ptr_array_set_size (data->outputs, n_commands);
+    data->remaining = n_commands;
+    data->queue_time = -1;
+    g_task_set_task_data (task, data, (GDestroyNotify) batch_data_free);
+
+    if (!gdb_session_is_ready (self))
+    {
+        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
+                                 "Session not ready for commands");
+        return;
+    }
+
+    if (n_commands == 0)
+    {
+        g_task_return_pointer (task, g_steal_pointer (&data->outputs),
+                               (GDestroyNotify) g_ptr_array_unref);
+        return;
+    }
+
+    /* Each command is an ordinary execute task; they are only written
+     * together. Every item holds a reference on the batch task.
+     */
+    tasks = g_new0 (GTask *, n_commands);
+    for (i = 0; i < n_commands; i++)
+    {
+        BatchItem *item = g_slice_new0 (BatchItem);
+
+        item->batch_task = g_object_ref (task);
+        item->index = i;
+
+        if (keep_records)
+        {
+            tasks[i] = g_task_new (self, g_task_get_cancellable (task),
+                                   on_result_batch_item_done, item);
+            g_task_set_source_tag (tasks[i], gdb_session_execute_mi_async);
+        }
+        else
+        {
+            tasks[i] = g_task_new (self, g_task_get_cancellable (task),
+                                   on_batch_item_done, item);
+            g_task_set_source_tag (tasks[i], gdb_session_execute_async);
+        }
+        execute_prepare (self, tasks[i]);
+
+        if (keep_records)
+        {
+            /* Only the records are kept; no raw text is accumulated */
+            ExecuteData *execute = (ExecuteData *)g_task_get_task_data (tasks[i]);
+
+            g_string_free (execute->output, TRUE);
+            execute->output = NULL;
+        }
+    }
+
+    execute_submit (self, tasks, commands, n_commands);
+    g_free (tasks);
+}
+
+void
+gdb_session_execute_batch_async (GdbSession          *self,
+                                 const gchar * const *commands,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+    g_autoptr(GTask) task = NULL;
+
+    g_return_if_fail (GDB_IS_SESSION (self));
+    g_return_if_fail (commands != NULL);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, gdb_session_execute_batch_async);
+
+    execute_batch (self, task, commands, FALSE);
+}
+
+GPtrArray *
+gdb_session_execute_batch_finish (GdbSession    *self,
+                                  GAsyncResult  *result,
+                                  GError       **error)
+{
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+    return (GPtrArray *)g_task_propagate_pointer (G_TASK (result), error);
+}
+
+void
+gdb_session_execute_result_batch_async (GdbSession          *self,
+                                        const gchar * const *commands,
+                                        GCancellable        *cancellable,
+                                        GAsyncReadyCallback  callback,
+                                        gpointer             user_data)
+{
+    g_autoptr(GTask) task = NULL;
+
+    g_return_if_fail (GDB_IS_SESSION (self));
+    g_return_if_fail (commands != NULL);
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, gdb_session_execute_result_batch_async);
+
+    execute_batch (self, task, commands, TRUE);
+}
+
+GPtrArray *
+gdb_session_execute_result_batch_finish (GdbSession    *self,
+                                         GAsyncResult  *result,
+                                         GError       **error)
+{
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+
+    return (GPtrArray *)g_task_propagate_pointer (G_TASK (result), error);
+}
+
+static void
+on_execute_batch_future_complete (GObject      *source,
+                                  GAsyncResult *result,
+                                  gpointer      user_data)
+{
+    DexPromise *promise = (DexPromise *)user_data;
+    GError *error = NULL;
+    GPtrArray *outputs;
+
+    outputs = gdb_session_execute_batch_finish (GDB_SESSION (source), result, &error);
+    if (outputs != NULL)
+    {
+        dex_promise_resolve_boxed (promise, G_TYPE_PTR_ARRAY, outputs);
+    }
+    else
+    {
+        dex_promise_reject (promise, error);
+    }
+
+    dex_unref (promise);
+}
+
+DexFuture *
+gdb_session_execute_batch_future (GdbSession          *self,
+                                  const gchar * const *commands)
+{
+    DexPromise *promise;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (commands != NULL, NULL);
+
+    promise = dex_promise_new ();
+    gdb_session_execute_batch_async (self, commands, NULL,
+                                     on_execute_batch_future_complete,
+                                     dex_ref (promise));
+
+    return DEX_FUTURE (promise);
+}
+
+static void
+on_execute_result_batch_future_complete (GObject      *source,
+                                         GAsyncResult *result,
+                                         gpointer      user_data)
+{
+    DexPromise *promise = (DexPromise *)user_data;
+    GError *error = NULL;
+    GPtrArray *results;
+
+    results = gdb_session_execute_result_batch_finish (GDB_SESSION (source), result, &error);
+    if (results != NULL)
+    {
+        dex_promise_resolve_boxed (promise, G_TYPE_PTR_ARRAY, results);
+    }
+    else
+    {
+        dex_promise_reject (promise, error);
+    }
+
+    dex_unref (promise);
+}
+
+DexFuture *
+gdb_session_execute_result_batch_future (GdbSession          *self,
+                                         const gchar * const *commands)
+{
+    DexPromise *promise;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (commands != NULL, NULL);
+
+    promise = dex_promise_new ();
+    gdb_session_execute_result_batch_async (self, commands, NULL,
+                                            on_execute_result_batch_future_complete,
+                                            dex_ref (promise));
+
+    return DEX_FUTURE (promise);
+}
+
+gint64
+gdb_session_execute_get_queue_time (GdbSession   *self,
+                                    GAsyncResult *result)
+{
+    GTask *task;
+    ExecuteData *data;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), -1);
+    g_return_val_if_fail (g_task_is_valid (result, self), -1);
+
+    task = G_TASK (result);
+    if (g_task_get_source_tag (task) == gdb_session_execute_batch_async ||
+        g_task_get_source_tag (task) == gdb_session_execute_result_batch_async)
+    {
+        BatchData *batch = (BatchData *)g_task_get_task_data (task);
+
+        return batch != NULL ? batch->queue_time : -1;
+    }
+
+    /* Tasks refused before submission carry no execute data */
+    data = (ExecuteData *)g_task_get_task_data (task);
+    if (data == NULL || !data->written)
+    {
+        return -1;
+    }
+
+    return data->written_at - data->queued_at;
+}
+
+/* ========================================================================== */
+/* Execution State Tracking                                                   */
+/* ========================================================================== */
+
+/*
+ * set_exec_state:
+ * @self: the session
+ * @new_state: %GDB_SESSION_STATE_READY, _RUNNING or _STOPPED
+ *
+ * Like set_state(), but only moves between the states GDB can be in
+ * while it is up. A late *stopped must not revive a session that is
+ * terminating or has failed.
+ */
+static void
+set_exec_state (GdbSession      *self,
+                GdbSessionState  new_state)
+{
+    SignalEmission *emission;
+    GdbSessionState old_state;
+
+    g_mutex_lock (&self->lock);
+    old_state = self->state;
+    if (old_state == new_state || self->terminating ||
+        (old_state != GDB_SESSION_STATE_READY &&
+         old_state != GDB_SESSION_STATE_RUNNING &&
+         old_state != GDB_SESSION_STATE_STOPPED))
+    {
+        g_mutex_unlock (&self->lock);
+        return;
+    }
+    self->state = new_state;
+
+    if (new_state == GDB_SESSION_STATE_RUNNING)
+    {
+        /* A new run: collect its output until the next *stopped */
+        self->run_serial++;
+        if (self->run_output == NULL)
+        {
+            self->run_output = g_string_new (NULL);
+        }
+        g_string_truncate (self->run_output, 0);
+    }
+    g_mutex_unlock (&self->lock);
+
+    emission = g_slice_new0 (SignalEmission);
+    emission->signal = SIGNAL_STATE_CHANGED;
+    emission->old_state = old_state;
+    emission->new_state = new_state;
+    queue_emission (self, emission);
+}
+
+/*
+ * stop_reason_from_record:
+ * @record: a *stopped record
+ *
+ * Returns: the record's "reason" as a #GdbStopReason
+ */
+static GdbStopReason
+stop_reason_from_record (GdbMiRecord *record)
+{
+    JsonObject *results = gdb_mi_record_get_results (record);
+
+    if (results == NULL || !json_object_has_member (results, "reason"))
+    {
+        return GDB_STOP_REASON_UNKNOWN;
+    }
+
+    return gdb_stop_reason_from_string (
+        json_object_get_string_member (results, "reason"));
+}
+
+static gboolean
+is_stopped_record (GdbMiRecord *record)
+{
+    return record != NULL &&
+           gdb_mi_record_get_type_enum (record) == GDB_MI_RECORD_EXEC_ASYNC &&
+           g_strcmp0 (gdb_mi_record_get_class (record), "stopped") == 0;
+}
+
+/*
+ * track_exec_state:
+ * @self: the session
+ * @record: a parsed output record
+ *
+ * Drives the session state from the target's execution records:
+ * ^running and *running move to RUNNING, *stopped moves to STOPPED
+ * (or back to READY once the program has exited) and queues the
+ * GdbSession::stopped signal with the record's results.
+ */
+static void
+track_exec_state (GdbSession  *self,
+                  GdbMiRecord *record)
+{
+    SignalEmission *emission;
+    GdbStopReason reason;
+    const gchar *klass;
+
+    switch (gdb_mi_record_get_type_enum (record))
+    {
+        case GDB_MI_RECORD_RESULT:
+            if (gdb_mi_record_get_result_class (record) == GDB_MI_RESULT_RUNNING)
+            {
+                set_exec_state (self, GDB_SESSION_STATE_RUNNING);
+            }
+            return;
+        case GDB_MI_RECORD_EXEC_ASYNC:
+            break;
+        default:
+            return;
+    }
+
+    klass = gdb_mi_record_get_class (record);
+    if (g_strcmp0 (klass, "running") == 0)
+    {
+        set_exec_state (self, GDB_SESSION_STATE_RUNNING);
+        return;
+    }
+    if (g_strcmp0 (klass, "stopped") != 0)
+    {
+        return;
+    }
+
+    reason = stop_reason_from_record (record);
+
+    switch (reason)
+    {
+        case GDB_STOP_REASON_EXITED:
+        case GDB_STOP_REASON_EXITED_NORMALLY:
+        case GDB_STOP_REASON_EXITED_SIGNALLED:
+            set_exec_state (self, GDB_SESSION_STATE_READY);
+            break;
+        default:
+            set_exec_state (self, GDB_SESSION_STATE_STOPPED);
+            break;
+    }
+
+    emission = g_slice_new0 (SignalEmission);
+    emission->signal = SIGNAL_STOPPED;
+    emission->reason = reason;
+    emission->record = gdb_mi_record_ref (record);
+    queue_emission (self, emission);
+}
+
+/* ========================================================================== */
+/* Wait For Stop Implementation                                               */
+/* ========================================================================== */
+
+/*
+ * Every resume of the target (^running or *running while idle) starts a
+ * new run with a serial number, the run ID. Untagged output printed
+ * until the next *stopped is collected in run_output, and the *stopped
+ * record, reason and output are kept as the "last stop". Waiters for a
+ * run ID complete as soon as a stop with that serial or a later one has
+ * been seen, so they can never miss a stop that raced their call.
+ */
+
+typedef struct {
+    GdbStopReason  reason;
+    GdbMiRecord   *record;    /* The *stopped record */
+    gchar         *output;    /* Untagged output of the run */
+} StopData;
+
+typedef struct {
+    GdbSession *session;
+    guint64     run_id;
+    GSource    *cancel_source;
+} WaitData;
+
+static void
+stop_data_free (StopData *data)
+{
+    g_clear_pointer (&data->record, gdb_mi_record_unref);
+    g_free (data->output);
+    g_slice_free (StopData, data);
+}
+
+static void
+wait_data_free (WaitData *data)
+{
+    g_clear_object (&data->session);
+    g_slice_free (WaitData, data);
+}
+
+static StopData *
+stop_data_copy (const StopData *data)
+{
+    StopData *copy = g_slice_new0 (StopData);
+
+    copy->reason = data->reason;
+    copy->record = data->record != NULL ? gdb_mi_record_ref (data->record) : NULL;
+    copy->output = g_strdup (data->output);
+
+    return copy;
+}
+
+/*
+ * stop_data_new_locked:
+ * @self: the session
+ *
+ * Returns: (transfer full): a snapshot of the last stop
+ */
+static StopData *
+stop_data_new_locked (GdbSession *self)
+{
+    StopData *stop = g_slice_new0 (StopData);
+
+    stop->reason = self->stop_reason;
+    stop->record = self->stop_record != NULL ? gdb_mi_record_ref (self->stop_record) : NULL;
+    stop->output = g_strdup (self->stop_output);
+
+    return stop;
+}
+
+/*
+ * stop_waiter_remove_locked:
+ * @self: the session
+ * @task: a wait-for-stop task
+ *
+ * Returns: (transfer full): @task, with the reference held by the list
+ */
+static GTask *
+stop_waiter_remove_locked (GdbSession *self,
+                           GTask      *task)
+{
+    WaitData *data = (WaitData *)g_task_get_task_data (task);
+
+    self->stop_waiters = g_list_remove (self->stop_waiters, task);
+
+    if (data->cancel_source != NULL)
+    {
+        g_source_destroy (data->cancel_source);
+        g_source_unref (data->cancel_source);
+        data->cancel_source = NULL;
+    }
+
+    return task;
+}
+
+/*
+ * record_stop_locked:
+ * @self: the session
+ * @record: the *stopped record
+ * @woken: (inout): waiters to complete once the lock is dropped
+ *
+ * Ends the current run and takes every waiter the stop satisfies.
+ *
+ * Returns: (transfer full): a snapshot of the stop for the waiters
+ */
+static StopData *
+record_stop_locked (GdbSession  *self,
+                    GdbMiRecord *record,
+                    GList      **woken)
+{
+    GList *l;
+
+    self->stop_serial = self->run_serial;
+    self->stop_reason = stop_reason_from_record (record);
+    g_clear_pointer (&self->stop_record, gdb_mi_record_unref);
+    self->stop_record = gdb_mi_record_ref (record);
+    g_free (self->stop_output);
+    self->stop_output = self->run_output != NULL ?
+                        g_string_free (self->run_output, FALSE) : g_strdup ("");
+    self->run_output = NULL;
+    self->run_detached = FALSE;
+
+    l = self->stop_waiters;
+    while (l != NULL)
+    {
+        GTask *task = l->data;
+        WaitData *data = (WaitData *)g_task_get_task_data (task);
+
+        l = l->next;
+
+        if (data->run_id <= self->stop_serial)
+        {
+            *woken = g_list_append (*woken, stop_waiter_remove_locked (self, task));
+        }
+    }
+
+    return stop_data_new_locked (self);
+}
+
+/*
+ * wake_stop_waiters:
+ * @woken: (transfer full) (element-type GTask): waiters taken by
+ *     record_stop_locked()
+ * @stop: (transfer full): the stop they waited for
+ */
+static void
+wake_stop_waiters (GList    *woken,
+                   StopData *stop)
+{
+    GList *l;
+
+    for (l = woken; l != NULL; l = l->next)
+    {
+        GTask *task = l->data;
+
+        g_task_return_pointer (task, stop_data_copy (stop),
+                               (GDestroyNotify) stop_data_free);
+        g_object_unref (task);
+    }
+    g_list_free (woken);
+    stop_data_free (stop);
+}
+
+/*
+ * fail_stop_waiters:
+ * @tasks: (transfer full) (element-type GTask): removed waiters
+ * @error: the error to report
+ */
+static void
+fail_stop_waiters (GList        *tasks,
+                   const GError *error)
+{
+    GList *l;
+
+    for (l = tasks; l != NULL; l = l->next)
+    {
+        g_task_return_error (l->data, g_error_copy (error));
+        g_object_unref (l->data);
+    }
+    g_list_free (tasks);
+}
+
+/*
+ * take_all_stop_waiters_locked:
+ * @self: the session
+ *
+ * Returns: (transfer full) (element-type GTask): every waiter
+ */
+static GList *
+take_all_stop_waiters_locked (GdbSession *self)
+{
+    GList *tasks = NULL;
+
+    while (self->stop_waiters != NULL)
+    {
+        tasks = g_list_append (tasks, stop_waiter_remove_locked (self, self->stop_waiters->data));
+    }
+
+    return tasks;
+}
+
+static gboolean
+on_wait_cancelled (GCancellable *cancellable G_GNUC_UNUSED,
+                   gpointer      user_data)
+{
+    GTask *task = G_TASK (user_data);
+    WaitData *data = (WaitData *)g_task_get_task_data (task);
+    GdbSession *self = data->session;
+
+    g_mutex_lock (&self->lock);
+    if (g_list_find (self->stop_waiters, task) == NULL)
+    {
+        g_mutex_unlock (&self->lock);
+        return G_SOURCE_REMOVE;
+    }
+    task = stop_waiter_remove_locked (self, task);
+    g_mutex_unlock (&self->lock);
+
+    g_task_return_error_if_cancelled (task);
+    g_object_unref (task);
+
+    return G_SOURCE_REMOVE;
+}
+
+void
+gdb_session_wait_for_stop_async (GdbSession          *self,
+                                 guint64              run_id,
+                                 GCancellable        *cancellable,
+                                 GAsyncReadyCallback  callback,
+                                 gpointer             user_data)
+{
+    g_autoptr(GTask) task = NULL;
+    WaitData *data;
+    StopData *stop;
+
+    g_return_if_fail (GDB_IS_SESSION (self));
+
+    task = g_task_new (self, cancellable, callback, user_data);
+    g_task_set_source_tag (task, gdb_session_wait_for_stop_async);
+
+    data = g_slice_new0 (WaitData);
+    data->session = g_object_ref (self);
+    g_task_set_task_data (task, data, (GDestroyNotify) wait_data_free);
+
+    g_mutex_lock (&self->lock);
+
+    if (self->state != GDB_SESSION_STATE_READY &&
+        self->state != GDB_SESSION_STATE_RUNNING &&
+        self->state != GDB_SESSION_STATE_STOPPED)
+    {
+        g_mutex_unlock (&self->lock);
+        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
+                                 "Session not ready");
+        return;
+    }
+
+    data->run_id = run_id != 0 ? run_id : self->run_serial;
+    if (data->run_id == 0 || data->run_id > self->run_serial)
+    {
+        g_mutex_unlock (&self->lock);
+        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_NOT_RUNNING,
+                                 "No run with ID %" G_GUINT64_FORMAT, data->run_id);
+        return;
+    }
+
+    if (self->stop_serial >= data->run_id)
+    {
+        /* Already stopped */
+        stop = stop_data_new_locked (self);
+        g_mutex_unlock (&self->lock);
+        g_task_return_pointer (task, stop, (GDestroyNotify) stop_data_free);
+        return;
+    }
+
+    if (cancellable != NULL)
+    {
+        data->cancel_source = g_cancellable_source_new (cancellable);
+        g_source_set_callback (data->cancel_source,
+                               G_SOURCE_FUNC (on_wait_cancelled),
+                               g_object_ref (task), g_object_unref);
+        g_source_attach (data->cancel_source, g_task_get_context (task));
+    }
+
+    self->stop_waiters = g_list_append (self->stop_waiters, g_steal_pointer (&task));
+    g_mutex_unlock (&self->lock);
+}
+
+gboolean
+gdb_session_wait_for_stop_finish (GdbSession     *self,
+                                  GAsyncResult   *result,
+                                  GdbStopReason  *reason,
+                                  JsonObject    **details,
+                                  gchar         **output,
+                                  GError        **error)
+{
+    StopData *stop;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), FALSE);
+    g_return_val_if_fail (g_task_is_valid (result, self), FALSE);
+
+    stop = (StopData *)g_task_propagate_pointer (G_TASK (result), error);
+    if (stop == NULL)
+    {
+        return FALSE;
+    }
+
+    if (reason != NULL)
+    {
+        *reason = stop->reason;
+    }
+    if (details != NULL)
+    {
+        JsonObject *results = stop->record != NULL ?
+                              gdb_mi_record_get_results (stop->record) : NULL;
+
+        *details = results != NULL ? json_object_ref (results) : NULL;
+    }
+    if (output != NULL)
+    {
+        *output = g_steal_pointer (&stop->output);
+    }
+
+    stop_data_free (stop);
+    return TRUE;
+}
+
+DexFuture *
+gdb_session_wait_for_stop_future (GdbSession   *self,
+                                  guint64       run_id,
+                                  GCancellable *cancellable)
+{
+    DexPromise *promise;
+
+    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
+    g_return_val_if_fail (cancellable == NULL || G_IS_CANCELLABLE (cancellable), NULL);
+
+    promise = dex_promise_new ();
+    gdb_session_wait_for_stop_async (self, run_id, cancellable,
+                                     on_async_result_future_complete,
+                                     dex_ref (promise));
+
+    return DEX_FUTURE (promise);
+}
+
+/* ========================================================================== */
+/* Reader Thread                                                              */
+/* ========================================================================== */
+
+/*
+ * Each session runs one long-lived thread that owns GDB's stdout. It is
+ * started by gdb_session_start_async() and ends when GDB closes the pipe.
+ * Output is read into one reusable buffer; lines are framed in place
+ * with memchr() and handed on as NUL-terminated slices of it, so the only
+ * copies are the ones a consumer keeps (a command's output, a signal
+ * argument). Every line is parsed exactly once and fanned out:
+ *   - during startup, the first prompt completes the start task;
+ *   - result, prompt and untagged records go to the pending commands;
+ *   - console stream records are emitted as GdbSession::console-output;
+ *   - async records are emitted as GdbSession::async-record.
+ * Between reads the thread polls, which is also where command deadlines
+ * expire (see "Deadlines").
+ * Reading does not depend on any caller iterating a particular main
+ * context, so commands issued from nested main loops and from several
+ * callers at once are all served by the same reader.
+ *
+ * The thread holds no reference on the session: otherwise a session
+ * nobody terminated would never be disposed, and GDB would outlive it.
+ * Instead dispose stops the reader and joins it. The references the
+ * reader does take are handed to the owner context (signal emissions)
+ * or to a task's context (completions), so the last one is never
+ * dropped on the reader thread itself.
+ */
+
+#define READER_BUFFER_SIZE 65536
+
+typedef struct {
+    GdbSession   *session;
+    GInputStream *stream;
+    gint          stream_fd;
+    gint          wakeup_fd; /* Read end of the session's wakeup pipe */
+    gchar        *buffer;
+    gsize         capacity;
+    gsize         start;     /* First byte of the current line */
+    gsize         scan;      /* First byte not yet searched for '\n' */
+    gsize         end;       /* One past the last byte read */
+} ReaderData;
+
+static void
+reader_data_free (ReaderData *data)
+{
+    g_clear_object (&data->stream);
+    g_free (data->buffer);
+    g_slice_free (ReaderData, data);
+}
+
+/*
+ * reader_next_line:
+ * @data: the reader state
+ *
+ * Frames the next complete line in the buffer. The newline (and a
+ * preceding '\r') is overwritten with NUL, so the line is a slice of
+ * the buffer that stays valid until the next read.
+ *
+ * Returns: (transfer none) (nullable): the line, or %NULL if the buffer
+ *     holds no complete line
+ */
+static gchar *
+reader_next_line (ReaderData *data)
+{
+    gchar *line = data->buffer + data->start;
+    gchar *newline;
+
+    newline = memchr (data->buffer + data->scan, '\n', data->end - data->scan);
+    if (newline == NULL)
+    {
+        data->scan = data->end;
+        return NULL;
+    }
+
+    *newline = '\0';
+    if (newline > line && newline[-1] == '\r')
+    {
+        newline[-1] = '\0';
+    }
+
+    data->start = data->scan = (gsize) (newline - data->buffer) + 1;
+    return line;
+}
+
+/*
+ * reader_fill:
+ * @data: the reader state
+ * @error: return location for a #GError
+ *
+ * Moves the partial line at the end of the buffer to the front, grows
+ * the buffer if that line fills it, and reads more output. One byte is
+ * always kept free to terminate a final unterminated line.
+ *
+ * Returns: the number of bytes read, 0 on EOF, -1 on error
+ */
+static gssize
+reader_fill (ReaderData  *data,
+             GError     **error)
+{
+    gssize n_read;
+
+    if (data->start > 0)
+    {
+        memmove (data->buffer, data->buffer + data->start, data->end - data->start);
+        data->end -= data->start;
+        data->scan -= data->start;
+        data->start = 0;
+    }
+
+    if (data->capacity - data->end < 2)
+    {
+        data->capacity *= 2;
+        data->buffer = g_realloc (data->buffer, data->capacity);
+    }
+
+    n_read = g_input_stream_read (data->stream, data->buffer + data->end,
+                                  data->capacity - data->end - 1, NULL, error);
+    if (n_read > 0)
+    {
+        data->end += n_read;
+    }
+
+    return n_read;
+}
+
+/*
+ * reader_wait:
+ * @data: the reader state
+ *
+ * Waits until GDB's stdout is readable, failing commands whose
+ * deadline passes in the meantime.
+ *
+ * Returns: %FALSE if the reader was told to stop
+ */
+static gboolean
+reader_wait (ReaderData *data)
+{
+    GdbSession *self = data->session;
+
+    for (;;)
+    {
+        GPollFD fds[2];
+        GList *expired;
+        gint timeout;
+        gint n_fds = 1;
+
+        g_mutex_lock (&self->lock);
+        if (self->reader_stopping)
+        {
+            g_mutex_unlock (&self->lock);
+            return FALSE;
+        }
+        expired = deadline_take_expired_locked (self, g_get_monotonic_time ());
+        timeout = deadline_next_timeout_locked (self, g_get_monotonic_time ());
+        g_mutex_unlock (&self->lock);
+
+        if (expired != NULL)
+        {
+            g_autoptr(GError) error = NULL;
+
+            /* Expired commands leaving the window make room for queued
+             * ones. Output GDB still produces for them is dropped as
+             * stray; draining tasks were returned already.
+             */
+            queue_pump (self);
+            error = g_error_new (GDB_ERROR, GDB_ERROR_TIMEOUT, "GDB command timed out");
+            fail_tasks (expired, error);
+        }
+
+        fds[0].fd = data->stream_fd;
+        fds[0].events = G_IO_IN | G_IO_HUP | G_IO_ERR;
+        fds[0].revents = 0;
+        if (data->wakeup_fd >= 0)
+        {
+            fds[1].fd = data->wakeup_fd;
+            fds[1].events = G_IO_IN;
+            fds[1].revents = 0;
+            n_fds = 2;
+        }
+
+        if (g_poll (fds, n_fds, timeout) < 0)
+        {
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            return TRUE; /* Let the read report the problem */
+        }
+
+        if (n_fds == 2 && fds[1].revents != 0)
+        {
+            gchar drain[64];
+
+            while (read (data->wakeup_fd, drain, sizeof drain) > 0)
+            {
+                /* Only wakes the poll; nothing to read */
+            }
+        }
+
+        if (fds[0].revents != 0)
+        {
+            return TRUE;
+        }
+    }
+}
+
+/*
+ * reader_handle_line:
+ * @self: the session
+ * @line: the line read from GDB
+ *
+ * Parses @line and routes it to its consumers.
+ */
+static void
+reader_handle_line (GdbSession  *self,
+                    const gchar *line)
+{
     g_autoptr(GdbMiRecord) record = NULL;
-    g_autofree gchar *line = NULL;
-    gsize length;
+    GdbMiRecordType type;
+    GTask *start_task = NULL;
+    StopData *stop = NULL;
+    GList *woken = NULL;
+    GList *done = NULL;
+    GList *l;
+
+    record = gdb_mi_parser_parse_line (self->mi_parser, line, NULL);
+    type = record != NULL ? gdb_mi_record_get_type_enum (record) : GDB_MI_RECORD_UNKNOWN;
+
+    /* Emit console output for stream records */
+    if (type == GDB_MI_RECORD_CONSOLE)
+    {
+        SignalEmission *emission = g_slice_new0 (SignalEmission);
 
-    line = g_data_input_stream_read_line_finish (G_DATA_INPUT_STREAM (source),
-                                                 result, &length, &error);
+        emission->signal = SIGNAL_CONSOLE_OUTPUT;
+        emission->text = g_strdup (gdb_mi_record_get_stream_content (record));
+        queue_emission (self, emission);
+    }
+    else if (type == GDB_MI_RECORD_EXEC_ASYNC ||
+             type == GDB_MI_RECORD_STATUS_ASYNC ||
+             type == GDB_MI_RECORD_NOTIFY_ASYNC)
+    {
+        SignalEmission *emission = g_slice_new0 (SignalEmission);
 
-    if (error != NULL)
+        emission->signal = SIGNAL_ASYNC_RECORD;
+        emission->record = gdb_mi_record_ref (record);
+        queue_emission (self, emission);
+    }
+
+    /* Update the state before completing any command on this line, so
+     * completion callbacks already observe it.
+     */
+    if (record != NULL)
     {
-        g_task_return_error (task, g_steal_pointer (&error));
-        g_object_unref (task);
-        return;
+        track_exec_state (self, record);
     }
 
-    if (line == NULL)
+    g_mutex_lock (&self->lock);
+
+    if (self->start_task != NULL)
     {
-        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_COMMAND_FAILED,
-                                 "GDB process exited unexpectedly");
-        g_object_unref (task);
+        /* Startup banner and notifications are consumed up to the first
+         * prompt so none of it is left for the first command.
+         */
+        if (type == GDB_MI_RECORD_PROMPT)
+        {
+            start_task = g_steal_pointer (&self->start_task);
+        }
+        g_mutex_unlock (&self->lock);
+
+        if (start_task != NULL)
+        {
+            start_return (start_task, NULL);
+        }
         return;
     }
 
-    /* Parse the line */
-    record = gdb_mi_parser_parse_line (data->session->mi_parser, line, &error);
-    if (record != NULL)
+    if (type == GDB_MI_RECORD_PROMPT)
     {
-        data->records = g_list_append (data->records, gdb_mi_record_ref (record));
+        dispatch_prompt_locked (self, line, &done);
+    }
+    else if (type == GDB_MI_RECORD_RESULT)
+    {
+        dispatch_result_locked (self, line, record, &done);
+    }
+    else
+    {
+        dispatch_untagged_locked (self, line, record);
     }
 
-    /* Check for completion */
-    if (gdb_mi_parser_is_prompt (line) ||
-        (record && gdb_mi_record_get_type_enum (record) == GDB_MI_RECORD_RESULT))
+    /* Keep what the target prints while it runs for stop waiters */
+    if (self->run_output != NULL &&
+        type != GDB_MI_RECORD_PROMPT && type != GDB_MI_RECORD_RESULT)
+    {
+        g_string_append (self->run_output, line);
+        g_string_append_c (self->run_output, '\n');
+    }
+    if (is_stopped_record (record))
     {
-        GList *result_list;
+        stop = record_stop_locked (self, record, &woken);
+    }
 
-        result_list = data->records;
-        data->records = NULL;
+    g_mutex_unlock (&self->lock);
 
-        g_task_return_pointer (task, result_list,
-                               (GDestroyNotify) (void (*)(GList *)) g_list_free);
-        g_object_unref (task);
-        return;
+    for (l = done; l != NULL; l = l->next)
+    {
+        execute_return (l->data);
+    }
+
+    if (stop != NULL)
+    {
+        wake_stop_waiters (woken, stop);
     }
 
-    /* Continue reading */
-    read_next_mi_line (task);
+    /* Completions and stops open the window for queued commands */
+    if (done != NULL || stop != NULL)
+    {
+        queue_pump (self);
+    }
+    g_list_free (done);
 }
 
+/*
+ * reader_handle_eof:
+ * @self: the session
+ *
+ * Fails everything still waiting for GDB once its stdout is closed.
+ */
 static void
-on_mi_command_written (GObject      *source,
-                       GAsyncResult *result,
-                       gpointer      user_data)
+reader_handle_eof (GdbSession *self)
 {
-    GTask *task = G_TASK (user_data);
     g_autoptr(GError) error = NULL;
-
-    if (!g_output_stream_write_all_finish (G_OUTPUT_STREAM (source), result, NULL, &error))
+    GTask *start_task;
+    GList *tasks;
+    GList *waiters;
+    gboolean terminating;
+
+    g_mutex_lock (&self->lock);
+    start_task = g_steal_pointer (&self->start_task);
+    tasks = take_all_pending_locked (self);
+    waiters = take_all_stop_waiters_locked (self);
+    terminating = self->terminating;
+    g_mutex_unlock (&self->lock);
+
+    error = g_error_new (GDB_ERROR, GDB_ERROR_COMMAND_FAILED,
+                         "GDB process exited unexpectedly");
+    fail_tasks (tasks, error);
+    fail_stop_waiters (waiters, error);
+
+    if (start_task != NULL)
     {
-        g_task_return_error (task, g_steal_pointer (&error));
-        g_object_unref (task);
-        return;
+        start_return (start_task,
+                      g_error_new (GDB_ERROR, GDB_ERROR_SPAWN_FAILED,
+                                   "GDB process exited unexpectedly during startup"));
+    }
+    else if (!terminating)
+    {
+        /* Nothing reads our writes anymore; refuse further commands */
+        set_state (self, GDB_SESSION_STATE_ERROR);
     }
-
-    read_next_mi_line (task);
 }
 
-void
-gdb_session_execute_mi_async (GdbSession          *self,
-                              const gchar         *command,
-                              GCancellable        *cancellable,
-                              GAsyncReadyCallback  callback,
-                              gpointer             user_data)
+static gpointer
+reader_thread_func (gpointer user_data)
 {
-    g_autoptr(GTask) task = NULL;
-    ExecuteMiData *data;
-    g_autofree gchar *cmd_with_nl = NULL;
+    ReaderData *data = (ReaderData *)user_data;
+    GdbSession *self = data->session;
+    gboolean stopped = FALSE;
 
-    g_return_if_fail (GDB_IS_SESSION (self));
-    g_return_if_fail (command != NULL);
+    for (;;)
+    {
+        g_autoptr(GError) error = NULL;
+        gchar *line;
+        gssize n_read;
 
-    task = g_task_new (self, cancellable, callback, user_data);
-    g_task_set_source_tag (task, gdb_session_execute_mi_async);
+        line = reader_next_line (data);
+        if (line != NULL)
+        {
+            reader_handle_line (self, line);
+            continue;
+        }
 
-    if (!gdb_session_is_ready (self))
+        if (data->stream_fd >= 0 && !reader_wait (data))
+        {
+            stopped = TRUE;
+            break;
+        }
+
+        n_read = reader_fill (data, &error);
+        if (n_read > 0)
+        {
+            continue;
+        }
+
+        if (n_read < 0)
+        {
+            g_debug ("Session %s: reading GDB output failed: %s",
+                     self->session_id, error->message);
+        }
+        else if (data->end > data->start)
+        {
+            /* Unterminated last line */
+            data->buffer[data->end] = '\0';
+            reader_handle_line (self, data->buffer + data->start);
+        }
+        break;
+    }
+
+    if (!stopped)
     {
-        g_task_return_new_error (task, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
-                                 "Session not ready for commands");
-        return;
+        g_mutex_lock (&self->lock);
+        stopped = self->reader_stopping;
+        g_mutex_unlock (&self->lock);
     }
 
-    data = g_slice_new0 (ExecuteMiData);
-    data->session = g_object_ref (self);
-    data->records = NULL;
-    g_task_set_task_data (task, data, (GDestroyNotify) execute_mi_data_free);
+    /* Told to stop by dispose, so nobody is left waiting */
+    if (!stopped)
+    {
+        reader_handle_eof (self);
+    }
+
+    g_mutex_lock (&self->lock);
+    if (self->wakeup_fds[0] >= 0)
+    {
+        close (self->wakeup_fds[0]);
+        close (self->wakeup_fds[1]);
+        self->wakeup_fds[0] = self->wakeup_fds[1] = -1;
+    }
+    g_mutex_unlock (&self->lock);
 
-    /* Note: execute_mi doesn't track the timeout source for cancellation.
-     * This is a simplification - the MI parser is typically fast and timeouts
-     * are rare. The source will be cleaned up when it fires or context dies.
+    reader_data_free (data);
+
+    return NULL;
+}
+
+/*
+ * reader_start:
+ * @self: the session
+ *
+ * Starts the reader thread for the freshly spawned GDB process.
+ */
+static void
+reader_start (GdbSession *self)
+{
+    g_autoptr(GError) error = NULL;
+    ReaderData *data;
+    GThread *thread;
+    gint fds[2];
+
+    data = g_slice_new0 (ReaderData);
+    data->session = self;
+    data->stream = g_object_ref (self->stdout_pipe);
+    data->capacity = READER_BUFFER_SIZE;
+    data->buffer = g_malloc (data->capacity);
+
+    /* Without a pollable fd the reader blocks in read() and deadlines
+     * only expire when GDB prints something.
      */
+    data->stream_fd = G_IS_UNIX_INPUT_STREAM (data->stream)
+                      ? g_unix_input_stream_get_fd (G_UNIX_INPUT_STREAM (data->stream))
+                      : -1;
+    data->wakeup_fd = -1;
+
+    if (!g_unix_open_pipe (fds, FD_CLOEXEC, &error))
+    {
+        g_warning ("Session %s: no deadline wakeup pipe: %s",
+                   self->session_id, error->message);
+    }
+    else
     {
-        GSource *timeout_src = add_timeout_to_context (self->timeout_ms,
-                                                        on_execute_timeout,
-                                                        g_object_ref (task));
-        g_source_unref (timeout_src);
+        /* Neither end may block: a full pipe already holds a wakeup */
+        g_unix_set_fd_nonblocking (fds[0], TRUE, NULL);
+        g_unix_set_fd_nonblocking (fds[1], TRUE, NULL);
+
+        data->wakeup_fd = fds[0];
+        g_mutex_lock (&self->lock);
+        self->wakeup_fds[0] = fds[0];
+        self->wakeup_fds[1] = fds[1];
+        g_mutex_unlock (&self->lock);
     }
 
-    cmd_with_nl = g_strdup_printf ("%s\n", command);
-    g_output_stream_write_all_async (self->stdin_pipe,
-                                     cmd_with_nl,
-                                     strlen (cmd_with_nl),
-                                     G_PRIORITY_DEFAULT,
-                                     cancellable,
-                                     on_mi_command_written,
-                                     g_steal_pointer (&task));
+    thread = g_thread_new ("gdb-reader", reader_thread_func, data);
+
+    g_mutex_lock (&self->lock);
+    self->reader_thread = thread;
+    g_mutex_unlock (&self->lock);
 }
 
-GList *
-gdb_session_execute_mi_finish (GdbSession    *self,
-                               GAsyncResult  *result,
-                               GError       **error)
+/*
+ * reader_stop:
+ * @self: the session, being disposed
+ *
+ * Stops the reader thread and waits for it to exit. GDB, or whatever
+ * it started, may still hold its stdout open, so the reader is woken
+ * through its wakeup pipe rather than left to wait for EOF. Without a
+ * wakeup pipe, EOF is all it can stop on, so GDB is asked to quit.
+ */
+static void
+reader_stop (GdbSession *self)
 {
-    g_return_val_if_fail (GDB_IS_SESSION (self), NULL);
-    g_return_val_if_fail (g_task_is_valid (result, self), NULL);
+    GThread *thread;
+    gboolean woken = FALSE;
 
-    return (GList *)g_task_propagate_pointer (G_TASK (result), error);
+    g_mutex_lock (&self->lock);
+    thread = g_steal_pointer (&self->reader_thread);
+    self->reader_stopping = TRUE;
+    if (self->wakeup_fds[1] >= 0)
+    {
+        /* EAGAIN: the pipe is full, so a wakeup is pending anyway */
+        woken = write (self->wakeup_fds[1], "", 1) == 1 || errno == EAGAIN;
+    }
+    g_mutex_unlock (&self->lock);
+
+    if (thread != NULL)
+    {
+        if (!woken)
+        {
+            terminate_write_quit (self);
+        }
+        g_thread_join (thread);
+    }
 }
 
 /* ========================================================================== */
@@ -1297,13 +3980,15 @@ gdb_session_execute_mi_finish (GdbSession    *self,
  * cleanup_session_resources:
  * @self: the GdbSession
  *
- * Clean up session resources after termination. Called from timeout callback
- * after the process has exited or been force-killed.
+ * Clean up session resources after termination. Called once the process
+ * has been reaped, whether it quit or was force-killed.
  */
 static void
 cleanup_session_resources (GdbSession *self)
 {
     gint exit_status = -1;
+    GList *tasks;
+    GList *waiters;
 
     if (self->process != NULL && g_subprocess_get_if_exited (self->process))
     {
@@ -1313,86 +3998,352 @@ cleanup_session_resources (GdbSession *self)
     set_state (self, GDB_SESSION_STATE_TERMINATED);
     g_signal_emit (self, signals[SIGNAL_TERMINATED], 0, exit_status);
 
-    g_clear_object (&self->stdout_reader);
+    /* Nothing will answer commands still in flight */
+    g_mutex_lock (&self->lock);
+    tasks = take_all_pending_locked (self);
+    waiters = take_all_stop_waiters_locked (self);
+    g_mutex_unlock (&self->lock);
+
+    if (tasks != NULL || waiters != NULL)
+    {
+        g_autoptr(GError) error = NULL;
+
+        error = g_error_new (GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
+                             "Session terminated");
+        fail_tasks (tasks, error);
+        fail_stop_waiters (waiters, error);
+    }
+
+    /* Owned by subprocess; the reader thread holds its own reference */
+    self->stdout_pipe = NULL;
+
+    g_mutex_lock (&self->write_lock);
     self->stdin_pipe = NULL; /* Owned by subprocess */
+    g_mutex_unlock (&self->write_lock);
+
     g_clear_object (&self->process);
 }
 
 /*
- * on_terminate_timeout:
- * @user_data: the GdbSession (with extra ref held)
+ * terminate_write_quit:
+ * @self: the GdbSession
  *
- * Timeout callback to check if GDB process has exited and force kill if not.
- * This runs after sending the quit command, giving GDB time to exit gracefully.
- * We hold an extra reference to the session during the timeout to prevent
- * use-after-free if the session is removed from the manager before timeout fires.
+ * Asks GDB to quit. The quit is written without blocking, so a GDB that
+ * has stopped reading its stdin cannot stall the caller; if it does not
+ * fit, or another thread is mid-write, it is skipped and the force-kill
+ * deadline takes over.
+ */
+static void
+terminate_write_quit (GdbSession *self)
+{
+    const gchar *quit_cmd = "quit\n";
+
+    if (!g_mutex_trylock (&self->write_lock))
+    {
+        return;
+    }
+
+    if (self->stdin_pipe != NULL &&
+        G_IS_POLLABLE_OUTPUT_STREAM (self->stdin_pipe) &&
+        g_pollable_output_stream_can_poll (G_POLLABLE_OUTPUT_STREAM (self->stdin_pipe)))
+    {
+        /* Shorter than PIPE_BUF, so it is written whole or not at all */
+        g_pollable_output_stream_write_nonblocking (G_POLLABLE_OUTPUT_STREAM (self->stdin_pipe),
+                                                    quit_cmd, strlen (quit_cmd),
+                                                    NULL, NULL);
+    }
+    g_mutex_unlock (&self->write_lock);
+}
+
+/*
+ * terminate_begin:
+ * @self: the GdbSession
  *
- * Returns: G_SOURCE_REMOVE to run only once
+ * Marks @self as terminating and asks GDB to quit (see
+ * terminate_write_quit()).
+ *
+ * Returns: %TRUE if @self needs a force-kill deadline, %FALSE if it is
+ *     already terminating or was cleaned up right away
  */
 static gboolean
-on_terminate_timeout (gpointer user_data)
+terminate_begin (GdbSession *self)
 {
-    GdbSession *self = GDB_SESSION (user_data);
+    GdbSessionState state;
+    gboolean already_terminating;
 
     if (self->process == NULL)
     {
-        /* Already cleaned up somehow */
-        g_object_unref (self);
-        return G_SOURCE_REMOVE;
+        return FALSE;
+    }
+
+    g_mutex_lock (&self->lock);
+    state = self->state;
+    already_terminating = self->terminating;
+    self->terminating = TRUE;
+    g_mutex_unlock (&self->lock);
+
+    if (already_terminating)
+    {
+        /* Cleanup is already scheduled */
+        return FALSE;
     }
 
-    /* Check if process exited gracefully */
-    if (!g_subprocess_get_if_exited (self->process))
+    if (state == GDB_SESSION_STATE_TERMINATED ||
+        state == GDB_SESSION_STATE_DISCONNECTED)
     {
-        /* Still running - force kill it */
-        g_subprocess_force_exit (self->process);
+        /* Already terminated or disconnected - just clean up */
+        cleanup_session_resources (self);
+        return FALSE;
     }
 
-    /* Clean up resources */
-    cleanup_session_resources (self);
+    terminate_write_quit (self);
+
+    return TRUE;
+}
+
+/*
+ * TerminateGroup:
+ *
+ * Sessions asked to quit together. Each one is cleaned up the moment its
+ * GDB exits; the shared deadline only force kills the ones still running.
+ * The group holds a reference to each session, which prevents
+ * use-after-free if a session is removed from the manager meanwhile, and
+ * lives until every GDB has been reaped.
+ */
+typedef struct
+{
+    GPtrArray *sessions;  /* Sessions whose GDB has not exited yet */
+    GSource   *deadline;
+} TerminateGroup;
+
+static void
+terminate_group_free (TerminateGroup *group)
+{
+    g_source_destroy (group->deadline);
+    g_source_unref (group->deadline);
+    g_ptr_array_unref (group->sessions);
+    g_slice_free (TerminateGroup, group);
+}
+
+/*
+ * on_terminate_timeout:
+ * @user_data: the TerminateGroup
+ *
+ * Force kills every session still running once the shared deadline
+ * passes. All kills are sent at once, so the children die in parallel;
+ * each is cleaned up when its exit is reaped.
+ *
+ * Returns: G_SOURCE_REMOVE to run only once
+ */
+static gboolean
+on_terminate_timeout (gpointer user_data)
+{
+    TerminateGroup *group = user_data;
+    guint i;
+
+    for (i = 0; i < group->sessions->len; i++)
+    {
+        GdbSession *self = g_ptr_array_index (group->sessions, i);
 
-    /* Release the reference we held during the timeout */
-    g_object_unref (self);
+        g_subprocess_force_exit (self->process);
+    }
 
     return G_SOURCE_REMOVE;
 }
 
+/*
+ * on_terminate_wait:
+ * @source: the GSubprocess that exited
+ * @result: the wait result
+ * @user_data: the TerminateGroup
+ *
+ * Finishes terminating the session whose GDB just exited, whether it quit
+ * or was killed, and frees the group after the last one.
+ */
+static void
+on_terminate_wait (GObject      *source,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+    TerminateGroup *group = user_data;
+    GSubprocess *process = G_SUBPROCESS (source);
+    guint i;
+
+    g_subprocess_wait_finish (process, result, NULL);
+
+    for (i = 0; i < group->sessions->len; i++)
+    {
+        GdbSession *self = g_ptr_array_index (group->sessions, i);
+
+        if (self->process == process)
+        {
+            cleanup_session_resources (self);
+            g_ptr_array_remove_index_fast (group->sessions, i);
+            break;
+        }
+    }
+
+    if (group->sessions->len == 0)
+    {
+        terminate_group_free (group);
+    }
+}
+
 void
 gdb_session_terminate (GdbSession *self)
 {
+    g_autoptr(GPtrArray) sessions = NULL;
+
     g_return_if_fail (GDB_IS_SESSION (self));
 
-    if (self->process == NULL)
+    sessions = g_ptr_array_new ();
+    g_ptr_array_add (sessions, self);
+    gdb_session_terminate_many (sessions);
+}
+
+void
+gdb_session_terminate_many (GPtrArray *sessions)
+{
+    GPtrArray *quitting;
+    TerminateGroup *group;
+    guint i;
+
+    g_return_if_fail (sessions != NULL);
+
+    for (i = 0; i < sessions->len; i++)
     {
-        return;
+        g_return_if_fail (GDB_IS_SESSION (g_ptr_array_index (sessions, i)));
     }
 
-    if (self->state != GDB_SESSION_STATE_TERMINATED &&
-        self->state != GDB_SESSION_STATE_DISCONNECTED)
+    quitting = g_ptr_array_new_with_free_func (g_object_unref);
+    for (i = 0; i < sessions->len; i++)
     {
-        /* Try graceful shutdown first by sending quit command */
-        if (self->stdin_pipe != NULL)
-        {
-            const gchar *quit_cmd = "quit\n";
-            g_output_stream_write_all (self->stdin_pipe, quit_cmd,
-                                       strlen (quit_cmd), NULL, NULL, NULL);
-        }
+        GdbSession *self = g_ptr_array_index (sessions, i);
 
-        /* Schedule timeout to check/force kill - don't block the main loop.
-         * This returns immediately and the cleanup happens asynchronously.
-         * We take a reference to prevent use-after-free if the session is
-         * removed from the manager before the timeout fires.
-         */
+        if (terminate_begin (self))
         {
-            GSource *terminate_src = add_timeout_to_context (TERMINATE_TIMEOUT_MS,
-                                                              on_terminate_timeout,
-                                                              g_object_ref (self));
-            g_source_unref (terminate_src);
+            g_ptr_array_add (quitting, g_object_ref (self));
         }
     }
-    else
+
+    if (quitting->len == 0)
     {
-        /* Already terminated or disconnected - just clean up */
-        cleanup_session_resources (self);
+        g_ptr_array_unref (quitting);
+        return;
+    }
+
+    /* One deadline covers the whole group, so tearing down many sessions
+     * costs at most TERMINATE_TIMEOUT_MS once rather than once per
+     * session. This returns immediately; each session is cleaned up as
+     * soon as its GDB exits.
+     */
+    group = g_slice_new0 (TerminateGroup);
+    group->sessions = quitting;
+    group->deadline = add_timeout_to_context (TERMINATE_TIMEOUT_MS,
+                                              on_terminate_timeout, group);
+
+    for (i = 0; i < quitting->len; i++)
+    {
+        GdbSession *self = g_ptr_array_index (quitting, i);
+
+        g_subprocess_wait_async (self->process, NULL, on_terminate_wait, group);
+    }
+}
+
+/*
+ * OrphanGdb:
+ *
+ * A GDB whose session was disposed before it quit. Nothing may take a
+ * reference on a session being disposed, so it is reaped on its own,
+ * with the same force-kill deadline as a terminate group.
+ */
+typedef struct
+{
+    GSubprocess *process;
+    GSource     *deadline;
+} OrphanGdb;
+
+static gboolean
+on_orphan_timeout (gpointer user_data)
+{
+    OrphanGdb *orphan = user_data;
+
+    g_subprocess_force_exit (orphan->process);
+    return G_SOURCE_REMOVE;
+}
+
+static void
+on_orphan_exit (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+    OrphanGdb *orphan = user_data;
+
+    g_subprocess_wait_finish (G_SUBPROCESS (source), result, NULL);
+
+    g_source_destroy (orphan->deadline);
+    g_source_unref (orphan->deadline);
+    g_object_unref (orphan->process);
+    g_slice_free (OrphanGdb, orphan);
+}
+
+/*
+ * terminate_disposed:
+ * @self: the session, being disposed
+ *
+ * Tears down what gdb_session_terminate() would, without reffing @self
+ * or emitting signals on it: pending commands and stop waiters fail now,
+ * and GDB is asked to quit and reaped as an OrphanGdb on the owner
+ * context. A session already terminating is held by its terminate
+ * group, so only g_object_run_dispose() gets here with one; the group
+ * finishes it.
+ */
+static void
+terminate_disposed (GdbSession *self)
+{
+    OrphanGdb *orphan;
+    gboolean already_terminating;
+    GList *tasks;
+    GList *waiters;
+
+    g_mutex_lock (&self->lock);
+    already_terminating = self->terminating;
+    self->terminating = TRUE;
+    tasks = take_all_pending_locked (self);
+    waiters = take_all_stop_waiters_locked (self);
+    g_mutex_unlock (&self->lock);
+
+    if (tasks != NULL || waiters != NULL)
+    {
+        g_autoptr(GError) error = NULL;
+
+        error = g_error_new (GDB_ERROR, GDB_ERROR_SESSION_NOT_READY,
+                             "Session terminated");
+        fail_tasks (tasks, error);
+        fail_stop_waiters (waiters, error);
+    }
+
+    if (self->process == NULL || already_terminating)
+    {
+        return;
     }
+
+    terminate_write_quit (self);
+
+    orphan = g_slice_new0 (OrphanGdb);
+    orphan->process = g_steal_pointer (&self->process);
+    orphan->deadline = g_timeout_source_new (TERMINATE_TIMEOUT_MS);
+    g_source_set_callback (orphan->deadline, on_orphan_timeout, orphan, NULL);
+    g_source_attach (orphan->deadline, self->owner_context);
+
+    g_main_context_push_thread_default (self->owner_context);
+    g_subprocess_wait_async (orphan->process, NULL, on_orphan_exit, orphan);
+    g_main_context_pop_thread_default (self->owner_context);
+
+    /* Owned by the subprocess; the reader thread holds its own reference */
+    self->stdout_pipe = NULL;
+
+    g_mutex_lock (&self->write_lock);
+    self->stdin_pipe = NULL;
+    g_mutex_unlock (&self->write_lock);
 }
@@ -14,6 +14,8 @@
 #include <glib.h>
 #include <glib-unix.h>
 #include <locale.h>
+#include <signal.h>
+#include <string.h>
 
 #define SERVER_NAME    "gdb-mcp-server"
 #define SERVER_VERSION "1.0.0"
@@ -91,6 +93,15 @@ on_sigterm (gpointer user_data)
 static gboolean show_version = FALSE;
 static gboolean show_license = FALSE;
 static gchar *gdb_path = NULL;
+static gint pool_size = 0;
+static gboolean fast_startup = FALSE;
+static gint idle_timeout = 0;
+static gint max_sessions = 0;
+static gint memory_budget_mb = 0;
+static gint max_workers = 0;
+static gchar *listen_address = NULL;
+static gchar *socket_path = NULL;
+static gboolean share_sessions = FALSE;
 
 static GOptionEntry option_entries[] =
 {
@@ -106,9 +117,94 @@ static GOptionEntry option_entries[] =
         "gdb-path", 'g', 0, G_OPTION_ARG_FILENAME, &gdb_path,
         "Path to the GDB binary (default: 'gdb' from PATH)", "PATH"
     },
+    {
+        "pool-size", 'p', 0, G_OPTION_ARG_INT, &pool_size,
+        "Number of GDB processes to keep started for new sessions (default: 0)", "N"
+    },
+    {
+        "fast-startup", 'f', 0, G_OPTION_ARG_NONE, &fast_startup,
+        "Start GDB with -nx -q and session settings on the command line", NULL
+    },
+    {
+        "idle-timeout", 0, 0, G_OPTION_ARG_INT, &idle_timeout,
+        "Terminate sessions idle for this many seconds (default: 0, never)", "SECONDS"
+    },
+    {
+        "max-sessions", 0, 0, G_OPTION_ARG_INT, &max_sessions,
+        "Evict the least recently used sessions beyond N (default: 0, no limit)", "N"
+    },
+    {
+        "memory-budget", 0, 0, G_OPTION_ARG_INT, &memory_budget_mb,
+        "Evict the least recently used sessions while GDB uses more than MB (default: 0, no limit)", "MB"
+    },
+    {
+        "workers", 'w', 0, G_OPTION_ARG_INT, &max_workers,
+        "Number of tool calls that may run at once (default: 64)", "N"
+    },
+    {
+        "listen", 0, 0, G_OPTION_ARG_STRING, &listen_address,
+        "Serve MCP over HTTP at /mcp instead of stdio (host defaults to 127.0.0.1)", "[HOST:]PORT"
+    },
+    {
+        "socket", 0, 0, G_OPTION_ARG_FILENAME, &socket_path,
+        "Accept clients on a Unix socket instead of stdio", "PATH"
+    },
+    {
+        "share-sessions", 0, 0, G_OPTION_ARG_NONE, &share_sessions,
+        "Let --listen and --socket clients see each other's sessions", NULL
+    },
     { NULL }
 };
 
+/* ========================================================================== */
+/* Listen Address Parsing                                                     */
+/* ========================================================================== */
+
+/*
+ * parse_listen_address:
+ * @address: "PORT", "HOST:PORT" or "[IPV6]:PORT"
+ * @host: (out) (transfer full): the host, or %NULL for the default
+ * @port: (out): the port
+ *
+ * Returns: %TRUE if @address is valid
+ */
+static gboolean
+parse_listen_address (const gchar  *address,
+                      gchar       **host,
+                      guint        *port)
+{
+    const gchar *colon;
+    const gchar *port_text = address;
+    guint64 value;
+
+    *host = NULL;
+
+    colon = strrchr (address, ':');
+    if (colon != NULL)
+    {
+        port_text = colon + 1;
+
+        if (address[0] == '[' && colon > address + 1 && colon[-1] == ']')
+        {
+            *host = g_strndup (address + 1, colon - address - 2);
+        }
+        else
+        {
+            *host = g_strndup (address, colon - address);
+        }
+    }
+
+    if (!g_ascii_string_to_unsigned (port_text, 10, 0, G_MAXUINT16, &value, NULL))
+    {
+        g_clear_pointer (host, g_free);
+        return FALSE;
+    }
+
+    *port = (guint) value;
+
+    return TRUE;
+}
+
 /* ========================================================================== */
 /* Main Entry Point                                                           */
 /* ========================================================================== */
@@ -124,6 +220,9 @@ main (int   argc,
     /* Set up locale */
     setlocale (LC_ALL, "");
 
+    /* A client or GDB that went away must fail writes, not kill us */
+    signal (SIGPIPE, SIG_IGN);
+
     /* Parse command-line arguments */
     context = g_option_context_new ("- GDB debugger MCP server");
     g_option_context_add_main_entries (context, option_entries, NULL);
@@ -135,6 +234,10 @@ main (int   argc,
         "Examples:\n"
         "  gdb-mcp-server                    # Start with default GDB\n"
         "  gdb-mcp-server --gdb-path=/usr/bin/gdb-15\n"
+        "  gdb-mcp-server --pool-size=2      # Keep 2 GDB processes warm\n"
+        "  gdb-mcp-server --idle-timeout=900 # Reap sessions idle for 15 minutes\n"
+        "  gdb-mcp-server --listen=8080      # Serve many clients over HTTP\n"
+        "  gdb-mcp-server --socket=/run/user/1000/gdb-mcp.sock\n"
         "  gdb-mcp-server -v                 # Show version\n"
         "  gdb-mcp-server -l                 # Show license\n"
         "\n"
@@ -164,6 +267,14 @@ main (int   argc,
         return 0;
     }
 
+    /* Clients with managers of their own never see the server's pool */
+    if (pool_size > 0 && !share_sessions &&
+        (listen_address != NULL || socket_path != NULL))
+    {
+        g_printerr ("Error: --pool-size needs --share-sessions with --listen or --socket\n");
+        return 1;
+    }
+
     /* Create the server */
     server = gdb_mcp_server_new (SERVER_NAME, SERVER_VERSION);
     g_server = server;
@@ -175,6 +286,70 @@ main (int   argc,
         g_message ("Using GDB: %s", gdb_path);
     }
 
+    if (fast_startup)
+    {
+        gdb_session_manager_set_default_startup_profile (
+            gdb_mcp_server_get_session_manager (server), GDB_STARTUP_PROFILE_FAST);
+    }
+
+    /* Keep GDB processes warm; set after the path and profile so they use them */
+    if (pool_size > 0)
+    {
+        gdb_session_manager_set_pool_size (
+            gdb_mcp_server_get_session_manager (server), (guint) pool_size);
+    }
+
+    /* Evict forgotten sessions */
+    if (idle_timeout > 0)
+    {
+        gdb_session_manager_set_idle_timeout (
+            gdb_mcp_server_get_session_manager (server), (guint) idle_timeout);
+    }
+    if (max_sessions > 0)
+    {
+        gdb_session_manager_set_max_sessions (
+            gdb_mcp_server_get_session_manager (server), (guint) max_sessions);
+    }
+    if (memory_budget_mb > 0)
+    {
+        gdb_session_manager_set_memory_budget (
+            gdb_mcp_server_get_session_manager (server),
+            (guint64) memory_budget_mb * 1024 * 1024);
+    }
+
+    if (max_workers > 0)
+    {
+        gdb_mcp_server_set_max_workers (server, (guint) max_workers);
+    }
+
+    gdb_mcp_server_set_share_sessions (server, share_sessions);
+
+    /* Serve HTTP instead of stdio; clients get managers like the one above */
+    if (listen_address != NULL)
+    {
+        g_autofree gchar *host = NULL;
+        guint port;
+
+        if (!parse_listen_address (listen_address, &host, &port))
+        {
+            g_printerr ("Error: invalid --listen address: %s\n", listen_address);
+            return 1;
+        }
+
+        if (!gdb_mcp_server_listen (server, host, port, &error))
+        {
+            g_printerr ("Error: %s\n", error->message);
+            return 1;
+        }
+    }
+
+    if (socket_path != NULL &&
+        !gdb_mcp_server_listen_socket (server, socket_path, &error))
+    {
+        g_printerr ("Error: %s\n", error->message);
+        return 1;
+    }
+
     /* Set up signal handlers */
     g_unix_signal_add (SIGINT, on_sigint, server);
     g_unix_signal_add (SIGTERM, on_sigterm, server);
@@ -184,6 +359,8 @@ main (int   argc,
 
     /* Cleanup */
     g_free (gdb_path);
+    g_free (listen_address);
+    g_free (socket_path);
     g_server = NULL;
 
     return 0;
@@ -107,7 +107,7 @@ gdb_tools_handle_gdb_set_breakpoint (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *location;
     const gchar *condition = NULL;
     g_autofree gchar *output = NULL;
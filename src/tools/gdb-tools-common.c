@@ -7,6 +7,68 @@
 
 #include "gdb-tools-internal.h"
 
+/* ========================================================================== */
+/* Fiber Support                                                              */
+/* ========================================================================== */
+
+/* Set on scheduler threads that run tool handlers as fibers */
+static GPrivate fiber_thread;
+
+void
+gdb_tools_mark_fiber_thread (void)
+{
+    g_private_set (&fiber_thread, GINT_TO_POINTER (TRUE));
+}
+
+gboolean
+gdb_tools_on_fiber (void)
+{
+    return GPOINTER_TO_INT (g_private_get (&fiber_thread));
+}
+
+/*
+ * await_with_timeout:
+ * @session: the GDB session the future belongs to
+ * @future: (transfer full): a pending future
+ *
+ * Races @future against the session timeout (plus one second of slack,
+ * like the main loop fallbacks).
+ *
+ * Returns: (transfer full): a future for whichever settles first
+ */
+static DexFuture *
+await_with_timeout (GdbSession *session,
+                    DexFuture  *future)
+{
+    return dex_future_first (future,
+                             dex_timeout_new_msec (gdb_session_get_timeout_ms (session) + 1000),
+                             NULL);
+}
+
+/*
+ * propagate_await_error:
+ * @error: (transfer full): the error from a dex_await call
+ * @dest: (out) (optional): return location for error
+ * @command: the command, for the timeout message
+ *
+ * Reports a timed-out await the same way as the main loop fallbacks.
+ */
+static void
+propagate_await_error (GError      *error,
+                       GError     **dest,
+                       const gchar *command)
+{
+    if (g_error_matches (error, DEX_ERROR, DEX_ERROR_TIMED_OUT))
+    {
+        g_error_free (error);
+        g_set_error (dest, GDB_ERROR, GDB_ERROR_TIMEOUT,
+                     "GDB command timed out: %s", command);
+        return;
+    }
+
+    g_propagate_error (dest, error);
+}
+
 /* ========================================================================== */
 /* Synchronous Command Execution Wrapper                                     */
 /* ========================================================================== */
@@ -42,6 +104,22 @@ gdb_tools_execute_command_sync (GdbSession  *session,
     g_return_val_if_fail (GDB_IS_SESSION (session), NULL);
     g_return_val_if_fail (command != NULL, NULL);
 
+    /* Fibers suspend on the future instead of spinning a loop */
+    if (gdb_tools_on_fiber ())
+    {
+        GError *local_error = NULL;
+        gchar *output;
+
+        output = dex_await_string (
+            await_with_timeout (session, gdb_session_execute_future (session, command)),
+            &local_error);
+        if (output == NULL)
+        {
+            propagate_await_error (local_error, error, command);
+        }
+        return output;
+    }
+
     context = g_main_context_new ();
     loop = g_main_loop_new (context, FALSE);
     data.loop = loop;
@@ -108,3 +186,666 @@ gdb_tools_execute_command_sync (GdbSession  *session,
 
     return data.output;
 }
+
+/* ========================================================================== */
+/* Synchronous Structured Execution Wrapper                                   */
+/* ========================================================================== */
+
+typedef struct {
+    GMainLoop        *loop;
+    GdbCommandResult *result;
+    GError           *error;
+} SyncResultData;
+
+static void
+on_execute_result_complete (GObject      *source,
+                            GAsyncResult *result,
+                            gpointer      user_data)
+{
+    SyncResultData *data = (SyncResultData *)user_data;
+
+    data->result = gdb_session_execute_result_finish (GDB_SESSION (source), result, &data->error);
+    g_main_loop_quit (data->loop);
+}
+
+static gboolean
+on_execute_result_timeout (gpointer user_data)
+{
+    SyncResultData *data = (SyncResultData *)user_data;
+
+    if (data->loop != NULL && g_main_loop_is_running (data->loop))
+    {
+        g_main_loop_quit (data->loop);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+GdbCommandResult *
+gdb_tools_execute_result_sync (GdbSession  *session,
+                               const gchar *command,
+                               GError     **error)
+{
+    g_autoptr(GMainLoop) loop = NULL;
+    g_autoptr(GMainContext) context = NULL;
+    GSource *timeout_source = NULL;
+    SyncResultData data = { NULL, NULL, NULL };
+
+    g_return_val_if_fail (GDB_IS_SESSION (session), NULL);
+    g_return_val_if_fail (command != NULL, NULL);
+
+    if (gdb_tools_on_fiber ())
+    {
+        GError *local_error = NULL;
+        GdbCommandResult *result;
+
+        result = dex_await_boxed (
+            await_with_timeout (session, gdb_session_execute_result_future (session, command)),
+            &local_error);
+        if (result == NULL)
+        {
+            propagate_await_error (local_error, error, command);
+        }
+        return result;
+    }
+
+    context = g_main_context_new ();
+    loop = g_main_loop_new (context, FALSE);
+    data.loop = loop;
+
+    g_main_context_push_thread_default (context);
+
+    gdb_session_execute_result_async (session, command, NULL,
+                                      on_execute_result_complete, &data);
+
+    timeout_source = g_timeout_source_new (gdb_session_get_timeout_ms (session) + 1000);
+    g_source_set_callback (timeout_source, on_execute_result_timeout, &data, NULL);
+    g_source_attach (timeout_source, context);
+
+    g_main_loop_run (loop);
+
+    g_source_destroy (timeout_source);
+    g_source_unref (timeout_source);
+
+    g_main_context_pop_thread_default (context);
+
+    if (data.result == NULL && data.error == NULL)
+    {
+        g_set_error (error, GDB_ERROR, GDB_ERROR_TIMEOUT,
+                     "GDB command timed out: %s", command);
+        return NULL;
+    }
+
+    if (data.error != NULL)
+    {
+        g_propagate_error (error, data.error);
+        return NULL;
+    }
+
+    return data.result;
+}
+
+/* ========================================================================== */
+/* Synchronous Start Wrapper                                                  */
+/* ========================================================================== */
+
+typedef struct {
+    GMainLoop *loop;
+    gboolean   success;
+    GError    *error;
+    gboolean   done;
+} SyncStartData;
+
+static void
+on_start_complete (GObject      *source,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+    SyncStartData *data = (SyncStartData *)user_data;
+
+    data->success = gdb_session_start_finish (GDB_SESSION (source), result, &data->error);
+    data->done = TRUE;
+    g_main_loop_quit (data->loop);
+}
+
+static gboolean
+on_start_timeout (gpointer user_data)
+{
+    GMainLoop *loop = (GMainLoop *)user_data;
+
+    g_main_loop_quit (loop);
+    return G_SOURCE_REMOVE;
+}
+
+gboolean
+gdb_tools_start_sync (GdbSession  *session,
+                      GError     **error)
+{
+    g_autoptr(GMainLoop) loop = NULL;
+    g_autoptr(GMainContext) context = NULL;
+    GSource *timeout_source;
+    SyncStartData data = { NULL, FALSE, NULL, FALSE };
+
+    g_return_val_if_fail (GDB_IS_SESSION (session), FALSE);
+
+    if (gdb_tools_on_fiber ())
+    {
+        GError *local_error = NULL;
+
+        if (!dex_await_boolean (await_with_timeout (session, gdb_session_start_future (session)),
+                                &local_error))
+        {
+            if (g_error_matches (local_error, DEX_ERROR, DEX_ERROR_TIMED_OUT))
+            {
+                g_clear_error (&local_error);
+                g_set_error_literal (error, GDB_ERROR, GDB_ERROR_TIMEOUT, "Timeout");
+                return FALSE;
+            }
+            g_propagate_error (error, local_error);
+            return FALSE;
+        }
+        return TRUE;
+    }
+
+    context = g_main_context_new ();
+    loop = g_main_loop_new (context, FALSE);
+    data.loop = loop;
+
+    g_main_context_push_thread_default (context);
+
+    gdb_session_start_async (session, NULL, on_start_complete, &data);
+
+    timeout_source = g_timeout_source_new (gdb_session_get_timeout_ms (session) + 1000);
+    g_source_set_callback (timeout_source, on_start_timeout, loop, NULL);
+    g_source_attach (timeout_source, context);
+
+    g_main_loop_run (loop);
+
+    g_source_destroy (timeout_source);
+    g_source_unref (timeout_source);
+
+    g_main_context_pop_thread_default (context);
+
+    if (data.error != NULL)
+    {
+        g_propagate_error (error, data.error);
+        return FALSE;
+    }
+
+    if (!data.done || !data.success)
+    {
+        g_set_error_literal (error, GDB_ERROR, GDB_ERROR_TIMEOUT, "Timeout");
+        return FALSE;
+    }
+
+    return TRUE;
+}
+
+gchar *
+gdb_tools_evaluate_sync (GdbSession  *session,
+                         const gchar *expression,
+                         GError     **error)
+{
+    g_autoptr(GdbCommandResult) result = NULL;
+    g_autofree gchar *escaped = NULL;
+    g_autofree gchar *command = NULL;
+    const gchar *value;
+
+    g_return_val_if_fail (expression != NULL, NULL);
+
+    /* Quoted, so expressions with spaces and operators stay one argument */
+    escaped = g_strescape (expression, NULL);
+    command = g_strdup_printf ("-data-evaluate-expression \"%s\"", escaped);
+
+    result = gdb_tools_execute_result_sync (session, command, error);
+    if (result == NULL)
+    {
+        return NULL;
+    }
+
+    value = gdb_command_result_get_field (result, "value");
+    if (value == NULL)
+    {
+        g_set_error (error, GDB_ERROR, GDB_ERROR_PARSE_ERROR,
+                     "No value for expression: %s", expression);
+        return NULL;
+    }
+
+    return g_strdup (value);
+}
+
+/* ========================================================================== */
+/* Synchronous Batch Execution Wrapper                                        */
+/* ========================================================================== */
+
+typedef struct {
+    GMainLoop *loop;
+    GPtrArray *outputs;
+    GError    *error;
+} SyncBatchData;
+
+/*
+ * batch_timeout_ms:
+ * @session: the GDB session
+ * @commands: the batch
+ *
+ * The session gives the Nth command of a batch N timeouts from
+ * submission, since GDB answers them one after another. The guard
+ * outlasts the last of them, so a stuck batch normally ends on the
+ * session's own timeout and this only catches a session that hangs.
+ *
+ * Returns: the timeout for the whole batch, saturating at %G_MAXUINT
+ */
+static guint
+batch_timeout_ms (GdbSession          *session,
+                  const gchar * const *commands)
+{
+    guint64 timeout_ms;
+
+    /* Cannot wrap: both factors are at most G_MAXUINT */
+    timeout_ms = (guint64) gdb_session_get_timeout_ms (session) *
+                 g_strv_length ((gchar **) commands) + 1000;
+
+    return (guint) MIN (timeout_ms, G_MAXUINT);
+}
+
+/*
+ * await_batch:
+ * @session: the GDB session
+ * @commands: the batch
+ * @future: (transfer full): the pending batch future
+ * @error: (out) (optional): return location for error
+ *
+ * Awaits a batch future from a fiber, bounded by batch_timeout_ms().
+ *
+ * Returns: (transfer full) (nullable): the outputs or results
+ */
+static GPtrArray *
+await_batch (GdbSession          *session,
+             const gchar * const *commands,
+             DexFuture           *future,
+             GError             **error)
+{
+    GError *local_error = NULL;
+    GPtrArray *outputs;
+
+    /* In microseconds: dex_timeout_new_msec() takes an int, which a
+     * saturated timeout overflows.
+     */
+    outputs = dex_await_boxed (
+        dex_future_first (future,
+                          dex_timeout_new_usec ((gint64) batch_timeout_ms (session, commands) *
+                                                G_TIME_SPAN_MILLISECOND),
+                          NULL),
+        &local_error);
+    if (outputs == NULL)
+    {
+        if (g_error_matches (local_error, DEX_ERROR, DEX_ERROR_TIMED_OUT))
+        {
+            g_clear_error (&local_error);
+            g_set_error_literal (error, GDB_ERROR, GDB_ERROR_TIMEOUT,
+                                 "GDB command batch timed out");
+            return NULL;
+        }
+        g_propagate_error (error, local_error);
+    }
+
+    return outputs;
+}
+
+static void
+on_batch_complete (GObject      *source,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+    SyncBatchData *data = (SyncBatchData *)user_data;
+
+    data->outputs = gdb_session_execute_batch_finish (GDB_SESSION (source), result, &data->error);
+    g_main_loop_quit (data->loop);
+}
+
+static gboolean
+on_batch_timeout (gpointer user_data)
+{
+    SyncBatchData *data = (SyncBatchData *)user_data;
+
+    if (data->loop != NULL && g_main_loop_is_running (data->loop))
+    {
+        g_main_loop_quit (data->loop);
+    }
+    return G_SOURCE_REMOVE;
+}
+
+GPtrArray *
+gdb_tools_execute_batch_sync (GdbSession          *session,
+                              const gchar * const *commands,
+                              GError             **error)
+{
+    g_autoptr(GMainLoop) loop = NULL;
+    g_autoptr(GMainContext) context = NULL;
+    GSource *timeout_source = NULL;
+    SyncBatchData data = { NULL, NULL, NULL };
+
+    g_return_val_if_fail (GDB_IS_SESSION (session), NULL);
+    g_return_val_if_fail (commands != NULL, NULL);
+
+    if (gdb_tools_on_fiber ())
+    {
+        return await_batch (session, commands,
+                            gdb_session_execute_batch_future (session, commands),
+                            error);
+    }
+
+    context = g_main_context_new ();
+    loop = g_main_loop_new (context, FALSE);
+    data.loop = loop;
+
+    g_main_context_push_thread_default (context);
+
+    gdb_session_execute_batch_async (session, commands, NULL, on_batch_complete, &data);
+
+    timeout_source = g_timeout_source_new (batch_timeout_ms (session, commands));
+    g_source_set_callback (timeout_source, on_batch_timeout, &data, NULL);
+    g_source_attach (timeout_source, context);
+
+    g_main_loop_run (loop);
+
+    g_source_destroy (timeout_source);
+    g_source_unref (timeout_source);
+
+    g_main_context_pop_thread_default (context);
+
+    if (data.outputs == NULL && data.error == NULL)
+    {
+        g_set_error (error, GDB_ERROR, GDB_ERROR_TIMEOUT,
+                     "GDB command batch timed out");
+        return NULL;
+    }
+
+    if (data.error != NULL)
+    {
+        g_propagate_error (error, data.error);
+        return NULL;
+    }
+
+    return data.outputs;
+}
+
+static void
+on_result_batch_complete (GObject      *source,
+                          GAsyncResult *result,
+                          gpointer      user_data)
+{
+    SyncBatchData *data = (SyncBatchData *)user_data;
+
+    data->outputs = gdb_session_execute_result_batch_finish (GDB_SESSION (source), result,
+                                                             &data->error);
+    g_main_loop_quit (data->loop);
+}
+
+GPtrArray *
+gdb_tools_execute_result_batch_sync (GdbSession          *session,
+                                     const gchar * const *commands,
+                                     GError             **error)
+{
+    g_autoptr(GMainLoop) loop = NULL;
+    g_autoptr(GMainContext) context = NULL;
+    GSource *timeout_source = NULL;
+    SyncBatchData data = { NULL, NULL, NULL };
+    guint timeout_ms;
+
+    g_return_val_if_fail (GDB_IS_SESSION (session), NULL);
+    g_return_val_if_fail (commands != NULL, NULL);
+
+    if (gdb_tools_on_fiber ())
+    {
+        return await_batch (session, commands,
+                            gdb_session_execute_result_batch_future (session, commands),
+                            error);
+    }
+
+    timeout_ms = batch_timeout_ms (session, commands);
+
+    context = g_main_context_new ();
+    loop = g_main_loop_new (context, FALSE);
+    data.loop = loop;
+
+    g_main_context_push_thread_default (context);
+
+    gdb_session_execute_result_batch_async (session, commands, NULL,
+                                            on_result_batch_complete, &data);
+
+    timeout_source = g_timeout_source_new (timeout_ms);
+    g_source_set_callback (timeout_source, on_batch_timeout, &data, NULL);
+    g_source_attach (timeout_source, context);
+
+    g_main_loop_run (loop);
+
+    g_source_destroy (timeout_source);
+    g_source_unref (timeout_source);
+
+    g_main_context_pop_thread_default (context);
+
+    if (data.outputs == NULL && data.error == NULL)
+    {
+        g_set_error (error, GDB_ERROR, GDB_ERROR_TIMEOUT,
+                     "GDB command batch timed out");
+        return NULL;
+    }
+
+    if (data.error != NULL)
+    {
+        g_propagate_error (error, data.error);
+        return NULL;
+    }
+
+    return data.outputs;
+}
+
+/* ========================================================================== */
+/* Synchronous Detached Execution Wrappers                                    */
+/* ========================================================================== */
+
+typedef struct {
+    GMainLoop     *loop;
+    gboolean       done;
+    gchar         *output;
+    guint64        run_id;
+    GdbStopReason  reason;
+    JsonObject    *details;
+    GError        *error;
+} SyncRunData;
+
+static void
+on_detached_complete (GObject      *source,
+                      GAsyncResult *result,
+                      gpointer      user_data)
+{
+    SyncRunData *data = (SyncRunData *)user_data;
+
+    data->output = gdb_session_execute_detached_finish (GDB_SESSION (source), result,
+                                                        &data->run_id, &data->error);
+    data->done = TRUE;
+    g_main_loop_quit (data->loop);
+}
+
+static void
+on_wait_for_stop_complete (GObject      *source,
+                           GAsyncResult *result,
+                           gpointer      user_data)
+{
+    SyncRunData *data = (SyncRunData *)user_data;
+
+    gdb_session_wait_for_stop_finish (GDB_SESSION (source), result,
+                                      &data->reason, &data->details,
+                                      &data->output, &data->error);
+    data->done = TRUE;
+    g_main_loop_quit (data->loop);
+}
+
+static gboolean
+on_run_timeout (gpointer user_data)
+{
+    g_cancellable_cancel (G_CANCELLABLE (user_data));
+    return G_SOURCE_REMOVE;
+}
+
+gchar *
+gdb_tools_execute_detached_sync (GdbSession   *session,
+                                 const gchar  *command,
+                                 guint64      *run_id,
+                                 GError      **error)
+{
+    g_autoptr(GMainLoop) loop = NULL;
+    g_autoptr(GMainContext) context = NULL;
+    SyncRunData data = { NULL, FALSE, NULL, 0, GDB_STOP_REASON_UNKNOWN, NULL, NULL };
+
+    g_return_val_if_fail (GDB_IS_SESSION (session), NULL);
+    g_return_val_if_fail (command != NULL, NULL);
+
+    if (gdb_tools_on_fiber ())
+    {
+        g_autoptr(GAsyncResult) result = NULL;
+        GError *local_error = NULL;
+
+        result = dex_await_object (
+            await_with_timeout (session, gdb_session_execute_detached_future (session, command)),
+            &local_error);
+        if (result == NULL)
+        {
+            propagate_await_error (local_error, error, command);
+            return NULL;
+        }
+        return gdb_session_execute_detached_finish (session, result, run_id, error);
+    }
+
+    context = g_main_context_new ();
+    loop = g_main_loop_new (context, FALSE);
+    data.loop = loop;
+
+    g_main_context_push_thread_default (context);
+
+    /* The session's own command timeout bounds this */
+    gdb_session_execute_detached_async (session, command, NULL, on_detached_complete, &data);
+    while (!data.done)
+    {
+        g_main_loop_run (loop);
+    }
+
+    g_main_context_pop_thread_default (context);
+
+    if (data.error != NULL)
+    {
+        g_propagate_error (error, data.error);
+        return NULL;
+    }
+
+    if (run_id != NULL)
+    {
+        *run_id = data.run_id;
+    }
+    return data.output;
+}
+
+gboolean
+gdb_tools_wait_for_stop_sync (GdbSession     *session,
+                              guint64         run_id,
+                              guint           timeout_ms,
+                              GdbStopReason  *reason,
+                              JsonObject    **details,
+                              gchar         **output,
+                              GError        **error)
+{
+    g_autoptr(GMainLoop) loop = NULL;
+    g_autoptr(GMainContext) context = NULL;
+    g_autoptr(GCancellable) cancellable = NULL;
+    GSource *timeout_source;
+    SyncRunData data = { NULL, FALSE, NULL, 0, GDB_STOP_REASON_UNKNOWN, NULL, NULL };
+
+    g_return_val_if_fail (GDB_IS_SESSION (session), FALSE);
+
+    cancellable = g_cancellable_new ();
+
+    if (gdb_tools_on_fiber ())
+    {
+        g_autoptr(GAsyncResult) result = NULL;
+        GError *local_error = NULL;
+
+        result = dex_await_object (
+            dex_future_first (gdb_session_wait_for_stop_future (session, run_id, cancellable),
+                              dex_timeout_new_usec ((gint64) timeout_ms * G_TIME_SPAN_MILLISECOND),
+                              NULL),
+            &local_error);
+        if (result == NULL)
+        {
+            /* Waiting has no timeout of its own; stop it */
+            g_cancellable_cancel (cancellable);
+
+            if (g_error_matches (local_error, DEX_ERROR, DEX_ERROR_TIMED_OUT))
+            {
+                g_clear_error (&local_error);
+                g_set_error (error, GDB_ERROR, GDB_ERROR_TIMEOUT,
+                             "Target did not stop within %u ms", timeout_ms);
+                return FALSE;
+            }
+            g_propagate_error (error, local_error);
+            return FALSE;
+        }
+        return gdb_session_wait_for_stop_finish (session, result, reason, details,
+                                                 output, error);
+    }
+
+    context = g_main_context_new ();
+    loop = g_main_loop_new (context, FALSE);
+    data.loop = loop;
+
+    g_main_context_push_thread_default (context);
+
+    /* Waiting has no timeout of its own; cancel it when ours expires */
+    timeout_source = g_timeout_source_new (timeout_ms);
+    g_source_set_callback (timeout_source, on_run_timeout, cancellable, NULL);
+    g_source_attach (timeout_source, context);
+
+    gdb_session_wait_for_stop_async (session, run_id, cancellable,
+                                     on_wait_for_stop_complete, &data);
+    while (!data.done)
+    {
+        g_main_loop_run (loop);
+    }
+
+    g_source_destroy (timeout_source);
+    g_source_unref (timeout_source);
+
+    g_main_context_pop_thread_default (context);
+
+    if (data.error != NULL)
+    {
+        if (g_error_matches (data.error, G_IO_ERROR, G_IO_ERROR_CANCELLED))
+        {
+            g_clear_error (&data.error);
+            g_set_error (error, GDB_ERROR, GDB_ERROR_TIMEOUT,
+                         "Target did not stop within %u ms", timeout_ms);
+        }
+        else
+        {
+            g_propagate_error (error, data.error);
+        }
+        return FALSE;
+    }
+
+    if (reason != NULL)
+    {
+        *reason = data.reason;
+    }
+    if (details != NULL)
+    {
+        *details = g_steal_pointer (&data.details);
+    }
+    if (output != NULL)
+    {
+        *output = g_steal_pointer (&data.output);
+    }
+
+    g_clear_pointer (&data.details, json_object_unref);
+    g_free (data.output);
+    return TRUE;
+}
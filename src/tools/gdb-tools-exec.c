@@ -4,15 +4,113 @@
  * Copyright (C) 2025 Zach Podbielniak
  * SPDX-License-Identifier: AGPL-3.0-or-later
  *
- * Tools: gdb_continue, gdb_step, gdb_next, gdb_finish
+ * Tools: gdb_continue, gdb_step, gdb_next, gdb_finish, gdb_wait_for_stop
+ *
+ * Every execution tool takes an optional "async" flag. Without it the
+ * tool returns once the target stops again; with it the tool returns as
+ * soon as the target runs, with a run ID for gdb_wait_for_stop.
  */
 
 #include "gdb-tools-internal.h"
 
+/* ========================================================================== */
+/* Helpers                                                                    */
+/* ========================================================================== */
+
+static void
+add_async_property (JsonBuilder *builder)
+{
+    json_builder_set_member_name (builder, "async");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "boolean");
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder,
+        "Return as soon as the target runs, with a runId for gdb_wait_for_stop (optional)");
+    json_builder_end_object (builder);
+}
+
+static gboolean
+get_async_flag (JsonObject *arguments)
+{
+    return arguments != NULL &&
+           json_object_has_member (arguments, "async") &&
+           json_object_get_boolean_member (arguments, "async");
+}
+
+/*
+ * run_detached:
+ * @session: the GDB session
+ * @command: the execution command
+ * @action: what failed, for the error message
+ *
+ * Starts @command without waiting for the target to stop.
+ *
+ * Returns: (transfer full): the tool result carrying the run ID
+ */
+static McpToolResult *
+run_detached (GdbSession  *session,
+              const gchar *command,
+              const gchar *action)
+{
+    g_autofree gchar *output = NULL;
+    g_autoptr(GError) error = NULL;
+    guint64 run_id = 0;
+
+    output = gdb_tools_execute_detached_sync (session, command, &run_id, &error);
+
+    if (error != NULL)
+    {
+        return gdb_tools_create_error_result ("Failed to %s: %s", action, error->message);
+    }
+
+    return gdb_tools_create_success_result (
+        "Target running (runId: %" G_GUINT64_FORMAT ")\n"
+        "Use gdb_wait_for_stop with this runId to get the stop.\n\nOutput:\n%s",
+        run_id, output);
+}
+
+
 /* ========================================================================== */
 /* gdb_continue - Continue program execution                                 */
 /* ========================================================================== */
 
+JsonNode *
+gdb_tools_create_gdb_continue_schema (void)
+{
+    g_autoptr(JsonBuilder) builder = json_builder_new ();
+
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "object");
+
+    json_builder_set_member_name (builder, "properties");
+    json_builder_begin_object (builder);
+
+    /* sessionId */
+    json_builder_set_member_name (builder, "sessionId");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "string");
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder, "GDB session ID");
+    json_builder_end_object (builder);
+
+    /* async */
+    add_async_property (builder);
+
+    json_builder_end_object (builder); /* properties */
+
+    json_builder_set_member_name (builder, "required");
+    json_builder_begin_array (builder);
+    json_builder_add_string_value (builder, "sessionId");
+    json_builder_end_array (builder);
+
+    json_builder_end_object (builder);
+
+    return json_builder_get_root (builder);
+}
+
 McpToolResult *
 gdb_tools_handle_gdb_continue (McpServer   *server G_GNUC_UNUSED,
                                const gchar *name G_GNUC_UNUSED,
@@ -21,7 +119,7 @@ gdb_tools_handle_gdb_continue (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     g_autofree gchar *output = NULL;
     g_autoptr(GError) error = NULL;
 
@@ -32,6 +130,11 @@ gdb_tools_handle_gdb_continue (McpServer   *server G_GNUC_UNUSED,
         return error_result;
     }
 
+    if (get_async_flag (arguments))
+    {
+        return run_detached (session, "continue", "continue");
+    }
+
     /* Execute continue */
     output = gdb_tools_execute_command_sync (session, "continue", &error);
 
@@ -78,6 +181,9 @@ gdb_tools_create_gdb_step_schema (void)
     json_builder_add_string_value (builder, "Step by instructions instead of source lines (optional)");
     json_builder_end_object (builder);
 
+    /* async */
+    add_async_property (builder);
+
     json_builder_end_object (builder); /* properties */
 
     json_builder_set_member_name (builder, "required");
@@ -98,7 +204,7 @@ gdb_tools_handle_gdb_step (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     gboolean instructions = FALSE;
     const gchar *command;
     g_autofree gchar *output = NULL;
@@ -118,6 +224,11 @@ gdb_tools_handle_gdb_step (McpServer   *server G_GNUC_UNUSED,
     }
 
     command = instructions ? "stepi" : "step";
+    if (get_async_flag (arguments))
+    {
+        return run_detached (session, command, "step");
+    }
+
     output = gdb_tools_execute_command_sync (session, command, &error);
 
     if (error != NULL)
@@ -151,7 +262,7 @@ gdb_tools_handle_gdb_next (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     gboolean instructions = FALSE;
     const gchar *command;
     g_autofree gchar *output = NULL;
@@ -171,6 +282,11 @@ gdb_tools_handle_gdb_next (McpServer   *server G_GNUC_UNUSED,
     }
 
     command = instructions ? "nexti" : "next";
+    if (get_async_flag (arguments))
+    {
+        return run_detached (session, command, "step over");
+    }
+
     output = gdb_tools_execute_command_sync (session, command, &error);
 
     if (error != NULL)
@@ -189,6 +305,13 @@ gdb_tools_handle_gdb_next (McpServer   *server G_GNUC_UNUSED,
 /* gdb_finish - Execute until current function returns                       */
 /* ========================================================================== */
 
+JsonNode *
+gdb_tools_create_gdb_finish_schema (void)
+{
+    /* Same schema as continue */
+    return gdb_tools_create_gdb_continue_schema ();
+}
+
 McpToolResult *
 gdb_tools_handle_gdb_finish (McpServer   *server G_GNUC_UNUSED,
                              const gchar *name G_GNUC_UNUSED,
@@ -197,7 +320,7 @@ gdb_tools_handle_gdb_finish (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     g_autofree gchar *output = NULL;
     g_autoptr(GError) error = NULL;
 
@@ -208,6 +331,11 @@ gdb_tools_handle_gdb_finish (McpServer   *server G_GNUC_UNUSED,
         return error_result;
     }
 
+    if (get_async_flag (arguments))
+    {
+        return run_detached (session, "finish", "finish");
+    }
+
     /* Execute finish */
     output = gdb_tools_execute_command_sync (session, "finish", &error);
 
@@ -218,3 +346,142 @@ gdb_tools_handle_gdb_finish (McpServer   *server G_GNUC_UNUSED,
 
     return gdb_tools_create_success_result ("Finished current function\n\nOutput:\n%s", output);
 }
+
+
+/* ========================================================================== */
+/* gdb_wait_for_stop - Wait for a running target to stop                      */
+/* ========================================================================== */
+
+JsonNode *
+gdb_tools_create_gdb_wait_for_stop_schema (void)
+{
+    g_autoptr(JsonBuilder) builder = json_builder_new ();
+
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "object");
+
+    json_builder_set_member_name (builder, "properties");
+    json_builder_begin_object (builder);
+
+    /* sessionId */
+    json_builder_set_member_name (builder, "sessionId");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "string");
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder, "GDB session ID");
+    json_builder_end_object (builder);
+
+    /* runId */
+    json_builder_set_member_name (builder, "runId");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "integer");
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder, "Run ID returned by an async execution tool (optional, default: latest run)");
+    json_builder_end_object (builder);
+
+    /* timeoutMs */
+    json_builder_set_member_name (builder, "timeoutMs");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "integer");
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder, "How long to wait in milliseconds (optional, default: session command timeout)");
+    json_builder_end_object (builder);
+
+    json_builder_end_object (builder); /* properties */
+
+    json_builder_set_member_name (builder, "required");
+    json_builder_begin_array (builder);
+    json_builder_add_string_value (builder, "sessionId");
+    json_builder_end_array (builder);
+
+    json_builder_end_object (builder);
+
+    return json_builder_get_root (builder);
+}
+
+McpToolResult *
+gdb_tools_handle_gdb_wait_for_stop (McpServer   *server G_GNUC_UNUSED,
+                                    const gchar *name G_GNUC_UNUSED,
+                                    JsonObject  *arguments,
+                                    gpointer     user_data)
+{
+    GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
+    McpToolResult *error_result = NULL;
+    g_autoptr(GdbSession) session = NULL;
+    guint64 run_id = 0;
+    guint timeout_ms;
+    GdbStopReason reason = GDB_STOP_REASON_UNKNOWN;
+    g_autoptr(JsonObject) details = NULL;
+    g_autofree gchar *output = NULL;
+    g_autoptr(GError) error = NULL;
+    GString *result_text;
+
+    /* Get session */
+    session = gdb_tools_get_session (manager, arguments, &error_result);
+    if (session == NULL)
+    {
+        return error_result;
+    }
+
+    if (json_object_has_member (arguments, "runId"))
+    {
+        gint64 value = json_object_get_int_member (arguments, "runId");
+
+        if (value < 0)
+        {
+            return gdb_tools_create_error_result ("Invalid runId: %" G_GINT64_FORMAT, value);
+        }
+        run_id = (guint64) value;
+    }
+
+    timeout_ms = gdb_session_get_timeout_ms (session);
+    if (json_object_has_member (arguments, "timeoutMs"))
+    {
+        gint64 value = json_object_get_int_member (arguments, "timeoutMs");
+
+        if (value <= 0 || value > G_MAXUINT)
+        {
+            return gdb_tools_create_error_result ("Invalid timeoutMs: %" G_GINT64_FORMAT, value);
+        }
+        timeout_ms = (guint) value;
+    }
+
+    if (!gdb_tools_wait_for_stop_sync (session, run_id, timeout_ms,
+                                       &reason, &details, &output, &error))
+    {
+        return gdb_tools_create_error_result ("Failed to wait for stop: %s", error->message);
+    }
+
+    result_text = g_string_new (NULL);
+    g_string_printf (result_text, "Target stopped (%s)\n",
+                     gdb_stop_reason_to_string (reason));
+
+    if (details != NULL && json_object_has_member (details, "frame"))
+    {
+        JsonObject *frame = json_object_get_object_member (details, "frame");
+
+        g_string_append_printf (result_text, "Location: %s",
+                                json_object_has_member (frame, "func") ?
+                                json_object_get_string_member (frame, "func") : "??");
+        if (json_object_has_member (frame, "file") && json_object_has_member (frame, "line"))
+        {
+            g_string_append_printf (result_text, " at %s:%s",
+                                    json_object_get_string_member (frame, "file"),
+                                    json_object_get_string_member (frame, "line"));
+        }
+        g_string_append_c (result_text, '\n');
+    }
+
+    g_string_append_printf (result_text, "\nOutput:\n%s", output != NULL ? output : "");
+
+    {
+        McpToolResult *result = mcp_tool_result_new (FALSE);
+        mcp_tool_result_add_text (result, result_text->str);
+        g_string_free (result_text, TRUE);
+        return result;
+    }
+}
@@ -74,11 +74,8 @@ gdb_tools_handle_gdb_glib_print_gobject (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *expression;
-    g_autofree gchar *type_output = NULL;
-    g_autofree gchar *ref_output = NULL;
-    g_autofree gchar *data_output = NULL;
     GString *result_text;
 
     /* Get session */
@@ -98,33 +95,40 @@ gdb_tools_handle_gdb_glib_print_gobject (McpServer   *server G_GNUC_UNUSED,
     result_text = g_string_new (NULL);
     g_string_printf (result_text, "GObject Analysis: %s\n\n", expression);
 
-    /* Get type name */
-    {
-        g_autofree gchar *cmd = g_strdup_printf ("print g_type_name(G_OBJECT_TYPE(%s))", expression);
-        type_output = gdb_tools_execute_command_sync (session, cmd, NULL);
-        if (type_output != NULL)
-        {
-            g_string_append_printf (result_text, "Type: %s\n", type_output);
-        }
-    }
-
-    /* Get reference count */
+    /* Type name, reference count and object data are independent
+     * queries, so send them to GDB as one pipelined batch.
+     */
     {
-        g_autofree gchar *cmd = g_strdup_printf ("print ((GObject*)%s)->ref_count", expression);
-        ref_output = gdb_tools_execute_command_sync (session, cmd, NULL);
-        if (ref_output != NULL)
+        g_autofree gchar *type_cmd = g_strdup_printf ("print g_type_name(G_OBJECT_TYPE(%s))", expression);
+        g_autofree gchar *ref_cmd = g_strdup_printf ("print ((GObject*)%s)->ref_count", expression);
+        g_autofree gchar *data_cmd = g_strdup_printf ("print *(%s)", expression);
+        g_autoptr(GPtrArray) outputs = NULL;
+        const gchar *commands[4];
+
+        commands[0] = type_cmd;
+        commands[1] = ref_cmd;
+        commands[2] = data_cmd;
+        commands[3] = NULL;
+
+        outputs = gdb_tools_execute_batch_sync (session, commands, NULL);
+        if (outputs != NULL)
         {
-            g_string_append_printf (result_text, "Reference Count: %s\n", ref_output);
-        }
-    }
+            const gchar *type_output = g_ptr_array_index (outputs, 0);
+            const gchar *ref_output = g_ptr_array_index (outputs, 1);
+            const gchar *data_output = g_ptr_array_index (outputs, 2);
 
-    /* Print the object data */
-    {
-        g_autofree gchar *cmd = g_strdup_printf ("print *(%s)", expression);
-        data_output = gdb_tools_execute_command_sync (session, cmd, NULL);
-        if (data_output != NULL)
-        {
-            g_string_append_printf (result_text, "\nObject Data:\n%s", data_output);
+            if (type_output != NULL)
+            {
+                g_string_append_printf (result_text, "Type: %s\n", type_output);
+            }
+            if (ref_output != NULL)
+            {
+                g_string_append_printf (result_text, "Reference Count: %s\n", ref_output);
+            }
+            if (data_output != NULL)
+            {
+                g_string_append_printf (result_text, "\nObject Data:\n%s", data_output);
+            }
         }
     }
 
@@ -149,7 +153,7 @@ gdb_tools_handle_gdb_glib_print_glist (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *expression;
     GString *result_text;
     gint max_items = 20;
@@ -182,12 +186,10 @@ gdb_tools_handle_gdb_glib_print_glist (McpServer   *server G_GNUC_UNUSED,
 
         while (count < max_items)
         {
-            g_autofree gchar *check_cmd = g_strdup ("print $glist_iter");
-            g_autofree gchar *check_output = gdb_tools_execute_command_sync (session, check_cmd, NULL);
+            g_autofree gchar *node = gdb_tools_evaluate_sync (session, "$glist_iter", NULL);
 
             /* Check if we've reached the end (NULL pointer) */
-            if (check_output == NULL || g_strstr_len (check_output, -1, "0x0") != NULL ||
-                g_strstr_len (check_output, -1, "(nil)") != NULL)
+            if (node == NULL || g_strcmp0 (node, "0x0") == 0)
             {
                 break;
             }
@@ -239,7 +241,7 @@ gdb_tools_handle_gdb_glib_print_ghash (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *expression;
     GString *result_text;
 
@@ -260,33 +262,40 @@ gdb_tools_handle_gdb_glib_print_ghash (McpServer   *server G_GNUC_UNUSED,
     result_text = g_string_new (NULL);
     g_string_printf (result_text, "GHashTable Analysis: %s\n\n", expression);
 
-    /* Get hash table size */
-    {
-        g_autofree gchar *cmd = g_strdup_printf ("print ((GHashTable*)%s)->size", expression);
-        g_autofree gchar *size_output = gdb_tools_execute_command_sync (session, cmd, NULL);
-        if (size_output != NULL)
-        {
-            g_string_append_printf (result_text, "Size: %s\n", size_output);
-        }
-    }
-
-    /* Get number of nodes (nnodes) */
+    /* Size, entry count and structure are independent queries, so
+     * send them to GDB as one pipelined batch.
+     */
     {
-        g_autofree gchar *cmd = g_strdup_printf ("print ((GHashTable*)%s)->nnodes", expression);
-        g_autofree gchar *nnodes_output = gdb_tools_execute_command_sync (session, cmd, NULL);
-        if (nnodes_output != NULL)
+        g_autofree gchar *size_cmd = g_strdup_printf ("print ((GHashTable*)%s)->size", expression);
+        g_autofree gchar *nnodes_cmd = g_strdup_printf ("print ((GHashTable*)%s)->nnodes", expression);
+        g_autofree gchar *struct_cmd = g_strdup_printf ("print *(GHashTable*)%s", expression);
+        g_autoptr(GPtrArray) outputs = NULL;
+        const gchar *commands[4];
+
+        commands[0] = size_cmd;
+        commands[1] = nnodes_cmd;
+        commands[2] = struct_cmd;
+        commands[3] = NULL;
+
+        outputs = gdb_tools_execute_batch_sync (session, commands, NULL);
+        if (outputs != NULL)
         {
-            g_string_append_printf (result_text, "Number of entries: %s\n", nnodes_output);
-        }
-    }
+            const gchar *size_output = g_ptr_array_index (outputs, 0);
+            const gchar *nnodes_output = g_ptr_array_index (outputs, 1);
+            const gchar *struct_output = g_ptr_array_index (outputs, 2);
 
-    /* Print the hash table structure */
-    {
-        g_autofree gchar *cmd = g_strdup_printf ("print *(GHashTable*)%s", expression);
-        g_autofree gchar *struct_output = gdb_tools_execute_command_sync (session, cmd, NULL);
-        if (struct_output != NULL)
-        {
-            g_string_append_printf (result_text, "\nStructure:\n%s\n", struct_output);
+            if (size_output != NULL)
+            {
+                g_string_append_printf (result_text, "Size: %s\n", size_output);
+            }
+            if (nnodes_output != NULL)
+            {
+                g_string_append_printf (result_text, "Number of entries: %s\n", nnodes_output);
+            }
+            if (struct_output != NULL)
+            {
+                g_string_append_printf (result_text, "\nStructure:\n%s\n", struct_output);
+            }
         }
     }
 
@@ -314,7 +323,7 @@ gdb_tools_handle_gdb_glib_type_hierarchy (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *expression;
     GString *result_text;
     gint depth = 0;
@@ -343,11 +352,10 @@ gdb_tools_handle_gdb_glib_type_hierarchy (McpServer   *server G_GNUC_UNUSED,
 
         while (depth < 20) /* Safety limit */
         {
-            /* Get type name */
-            g_autofree gchar *name_cmd = g_strdup ("print g_type_name($gtype)");
-            g_autofree gchar *name_output = gdb_tools_execute_command_sync (session, name_cmd, NULL);
+            /* Get type name, e.g. 0x7ffff7e8b2a4 "GObject" */
+            g_autofree gchar *name_output = gdb_tools_evaluate_sync (session, "g_type_name($gtype)", NULL);
 
-            if (name_output == NULL || g_strstr_len (name_output, -1, "0x0") != NULL)
+            if (name_output == NULL || g_strcmp0 (name_output, "0x0") == 0)
             {
                 break;
             }
@@ -370,10 +378,9 @@ gdb_tools_handle_gdb_glib_type_hierarchy (McpServer   *server G_GNUC_UNUSED,
             gdb_tools_execute_command_sync (session, "set $gtype = g_type_parent($gtype)", NULL);
 
             /* Check if we've reached GObject or a fundamental type */
-            g_autofree gchar *check_cmd = g_strdup ("print $gtype");
-            g_autofree gchar *check_output = gdb_tools_execute_command_sync (session, check_cmd, NULL);
+            g_autofree gchar *check_output = gdb_tools_evaluate_sync (session, "$gtype", NULL);
 
-            if (check_output != NULL && g_strstr_len (check_output, -1, " = 0") != NULL)
+            if (check_output != NULL && g_strcmp0 (check_output, "0") == 0)
             {
                 break;
             }
@@ -403,7 +410,7 @@ gdb_tools_handle_gdb_glib_signal_info (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *expression;
     GString *result_text;
 
@@ -432,7 +439,7 @@ gdb_tools_handle_gdb_glib_signal_info (McpServer   *server G_GNUC_UNUSED,
 
     /* Get type name */
     {
-        g_autofree gchar *name_output = gdb_tools_execute_command_sync (session, "print g_type_name($gtype)", NULL);
+        g_autofree gchar *name_output = gdb_tools_evaluate_sync (session, "g_type_name($gtype)", NULL);
         if (name_output != NULL)
         {
             g_string_append_printf (result_text, "Type: %s\n\n", name_output);
@@ -448,7 +455,7 @@ gdb_tools_handle_gdb_glib_signal_info (McpServer   *server G_GNUC_UNUSED,
         gdb_tools_execute_command_sync (session, "set $n_ids = 0", NULL);
         gdb_tools_execute_command_sync (session, "set $signal_ids = (guint*)g_signal_list_ids($gtype, &$n_ids)", NULL);
 
-        g_autofree gchar *count_output = gdb_tools_execute_command_sync (session, "print $n_ids", NULL);
+        g_autofree gchar *count_output = gdb_tools_evaluate_sync (session, "$n_ids", NULL);
         if (count_output != NULL)
         {
             g_string_append_printf (result_text, "Number of signals: %s\n", count_output);
@@ -461,17 +468,17 @@ gdb_tools_handle_gdb_glib_signal_info (McpServer   *server G_GNUC_UNUSED,
             gint i;
             for (i = 0; i < 50; i++) /* Safety limit */
             {
-                g_autofree gchar *idx_check = g_strdup_printf ("print $n_ids > %d", i);
-                g_autofree gchar *check_output = gdb_tools_execute_command_sync (session, idx_check, NULL);
+                g_autofree gchar *idx_check = g_strdup_printf ("$n_ids > %d", i);
+                g_autofree gchar *check_output = gdb_tools_evaluate_sync (session, idx_check, NULL);
 
-                if (check_output == NULL || g_strstr_len (check_output, -1, " = 0") != NULL)
+                if (check_output == NULL || g_strcmp0 (check_output, "0") == 0)
                 {
                     break;
                 }
 
                 {
-                    g_autofree gchar *sig_cmd = g_strdup_printf ("print g_signal_name($signal_ids[%d])", i);
-                    g_autofree gchar *sig_output = gdb_tools_execute_command_sync (session, sig_cmd, NULL);
+                    g_autofree gchar *sig_expr = g_strdup_printf ("g_signal_name($signal_ids[%d])", i);
+                    g_autofree gchar *sig_output = gdb_tools_evaluate_sync (session, sig_expr, NULL);
 
                     if (sig_output != NULL)
                     {
@@ -4,10 +4,12 @@
  * Copyright (C) 2025 Zach Podbielniak
  * SPDX-License-Identifier: AGPL-3.0-or-later
  *
- * Tools: gdb_backtrace, gdb_print, gdb_examine, gdb_info_registers, gdb_command
+ * Tools: gdb_backtrace, gdb_print, gdb_examine, gdb_info_registers, gdb_command,
+ *        gdb_batch
  */
 
 #include "gdb-tools-internal.h"
+#include <string.h>
 
 /* ========================================================================== */
 /* gdb_backtrace - Show call stack                                           */
@@ -72,7 +74,7 @@ gdb_tools_handle_gdb_backtrace (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     gboolean full = FALSE;
     gint64 limit = -1;
     GString *cmd;
@@ -181,7 +183,7 @@ gdb_tools_handle_gdb_print (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *expression;
     g_autofree gchar *output = NULL;
     g_autoptr(GError) error = NULL;
@@ -287,7 +289,7 @@ gdb_tools_handle_gdb_examine (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *expression;
     const gchar *format = "x";
     gint64 count = 1;
@@ -388,7 +390,7 @@ gdb_tools_handle_gdb_info_registers (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *reg_name = NULL;
     g_autofree gchar *output = NULL;
     g_autoptr(GError) error = NULL;
@@ -487,7 +489,7 @@ gdb_tools_handle_gdb_command (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *command;
     g_autofree gchar *output = NULL;
     g_autoptr(GError) error = NULL;
@@ -516,3 +518,253 @@ gdb_tools_handle_gdb_command (McpServer   *server G_GNUC_UNUSED,
 
     return gdb_tools_create_success_result ("Command: %s\n\nOutput:\n%s", command, output);
 }
+
+
+/* ========================================================================== */
+/* gdb_batch - Execute several GDB commands                                  */
+/* ========================================================================== */
+
+JsonNode *
+gdb_tools_create_gdb_batch_schema (void)
+{
+    g_autoptr(JsonBuilder) builder = json_builder_new ();
+
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "object");
+
+    json_builder_set_member_name (builder, "properties");
+    json_builder_begin_object (builder);
+
+    /* sessionId */
+    json_builder_set_member_name (builder, "sessionId");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "string");
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder, "GDB session ID");
+    json_builder_end_object (builder);
+
+    /* commands */
+    json_builder_set_member_name (builder, "commands");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "array");
+    json_builder_set_member_name (builder, "items");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "string");
+    json_builder_end_object (builder);
+    json_builder_set_member_name (builder, "maxItems");
+    json_builder_add_int_value (builder, GDB_TOOLS_BATCH_MAX_COMMANDS);
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder, "GDB commands to execute, in order");
+    json_builder_end_object (builder);
+
+    /* stopOnError (optional) */
+    json_builder_set_member_name (builder, "stopOnError");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "boolean");
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder,
+        "Skip the remaining commands after one fails (optional, default: false)");
+    json_builder_end_object (builder);
+
+    json_builder_end_object (builder); /* properties */
+
+    json_builder_set_member_name (builder, "required");
+    json_builder_begin_array (builder);
+    json_builder_add_string_value (builder, "sessionId");
+    json_builder_add_string_value (builder, "commands");
+    json_builder_end_array (builder);
+
+    json_builder_end_object (builder);
+
+    return json_builder_get_root (builder);
+}
+
+/*
+ * add_batch_entry:
+ * @entries: the response array
+ * @command: the command
+ * @result: (nullable): its result, or %NULL if it was skipped
+ *
+ * Appends the serialized @result, tagged with @command.
+ */
+static void
+add_batch_entry (JsonArray        *entries,
+                 const gchar      *command,
+                 GdbCommandResult *result)
+{
+    JsonObject *entry;
+
+    if (result != NULL)
+    {
+        JsonNode *node = gdb_command_result_to_json (result);
+
+        entry = json_object_ref (json_node_get_object (node));
+        json_node_unref (node);
+    }
+    else
+    {
+        entry = json_object_new ();
+        json_object_set_boolean_member (entry, "skipped", TRUE);
+    }
+
+    json_object_set_string_member (entry, "command", command);
+    json_array_add_object_element (entries, entry);
+}
+
+McpToolResult *
+gdb_tools_handle_gdb_batch (McpServer   *server G_GNUC_UNUSED,
+                            const gchar *name G_GNUC_UNUSED,
+                            JsonObject  *arguments,
+                            gpointer     user_data)
+{
+    GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
+    McpToolResult *error_result = NULL;
+    g_autoptr(GdbSession) session = NULL;
+    g_auto(GStrv) commands = NULL;
+    g_autoptr(JsonArray) entries = NULL;
+    g_autoptr(JsonNode) root = NULL;
+    g_autofree gchar *text = NULL;
+    g_autoptr(GError) error = NULL;
+    JsonNode *node;
+    JsonArray *array;
+    gboolean stop_on_error = FALSE;
+    guint n_commands;
+    guint n_failed = 0;
+    guint i;
+
+    /* Get session */
+    session = gdb_tools_get_session (manager, arguments, &error_result);
+    if (session == NULL)
+    {
+        return error_result;
+    }
+
+    /* Get commands */
+    node = json_object_get_member (arguments, "commands");
+    if (node == NULL)
+    {
+        return gdb_tools_create_error_result ("Missing required parameter: commands");
+    }
+    if (!JSON_NODE_HOLDS_ARRAY (node))
+    {
+        return gdb_tools_create_error_result ("Parameter commands must be an array of strings");
+    }
+
+    array = json_node_get_array (node);
+    n_commands = json_array_get_length (array);
+    if (n_commands == 0)
+    {
+        return gdb_tools_create_error_result ("Parameter commands must not be empty");
+    }
+    if (n_commands > GDB_TOOLS_BATCH_MAX_COMMANDS)
+    {
+        /* Bounds the response and the time spent in one call */
+        return gdb_tools_create_error_result ("Parameter commands must hold at most %u commands",
+                                              GDB_TOOLS_BATCH_MAX_COMMANDS);
+    }
+
+    commands = g_new0 (gchar *, n_commands + 1);
+    for (i = 0; i < n_commands; i++)
+    {
+        JsonNode *element = json_array_get_element (array, i);
+
+        if (!JSON_NODE_HOLDS_VALUE (element) ||
+            json_node_get_value_type (element) != G_TYPE_STRING)
+        {
+            return gdb_tools_create_error_result ("Parameter commands must be an array of strings");
+        }
+        commands[i] = g_strdup (json_node_get_string (element));
+    }
+
+    if (json_object_has_member (arguments, "stopOnError"))
+    {
+        stop_on_error = json_object_get_boolean_member (arguments, "stopOnError");
+    }
+
+    entries = json_array_sized_new (n_commands);
+
+    if (!stop_on_error)
+    {
+        guint chunk_size;
+
+        /* Independent commands: written together, answered in order.
+         * The session refuses a batch deeper than its queue, so longer
+         * ones go in chunks that fit, each after the last is answered.
+         */
+        chunk_size = MIN (n_commands, gdb_session_get_max_queue_depth (session));
+
+        for (i = 0; i < n_commands; i += chunk_size)
+        {
+            g_autofree const gchar **chunk = NULL;
+            g_autoptr(GPtrArray) results = NULL;
+            guint n_chunk = MIN (chunk_size, n_commands - i);
+            guint j;
+
+            chunk = g_new0 (const gchar *, n_chunk + 1);
+            memcpy (chunk, commands + i, n_chunk * sizeof (gchar *));
+
+            results = gdb_tools_execute_result_batch_sync (session, chunk, &error);
+            if (results == NULL)
+            {
+                return gdb_tools_create_error_result ("Failed to execute batch: %s",
+                                                      error->message);
+            }
+
+            for (j = 0; j < n_chunk; j++)
+            {
+                GdbCommandResult *result = g_ptr_array_index (results, j);
+
+                if (gdb_command_result_is_error (result))
+                {
+                    n_failed++;
+                }
+                add_batch_entry (entries, commands[i + j], result);
+            }
+        }
+    }
+    else
+    {
+        /* Each command waits for the previous answer, so nothing past
+         * the first failure reaches GDB.
+         */
+        for (i = 0; i < n_commands; i++)
+        {
+            const gchar *single[] = { commands[i], NULL };
+            g_autoptr(GPtrArray) results = NULL;
+            GdbCommandResult *result;
+
+            if (n_failed > 0)
+            {
+                add_batch_entry (entries, commands[i], NULL);
+                continue;
+            }
+
+            results = gdb_tools_execute_result_batch_sync (session, single, &error);
+            if (results == NULL)
+            {
+                return gdb_tools_create_error_result ("Failed to execute batch: %s",
+                                                      error->message);
+            }
+
+            result = g_ptr_array_index (results, 0);
+            if (gdb_command_result_is_error (result))
+            {
+                n_failed++;
+            }
+            add_batch_entry (entries, commands[i], result);
+        }
+    }
+
+    root = json_node_new (JSON_NODE_ARRAY);
+    json_node_set_array (root, entries);
+    text = json_to_string (root, TRUE);
+
+    return gdb_tools_create_success_result ("Batch: %u command%s, %u failed\n\n%s",
+                                            n_commands, n_commands == 1 ? "" : "s",
+                                            n_failed, text);
+}
@@ -105,8 +105,10 @@ gdb_tools_get_session_id (JsonObject *arguments)
  * @error_result: (out) (optional): location for error result
  *
  * Gets a session from arguments. If session not found, creates error result.
+ * The caller holds a reference, so a concurrent gdb_terminate cannot free
+ * the session while the tool uses it.
  *
- * Returns: (transfer none) (nullable): the session, or %NULL with error result
+ * Returns: (transfer full) (nullable): the session, or %NULL with error result
  */
 static inline GdbSession *
 gdb_tools_get_session (GdbSessionManager  *manager,
@@ -126,7 +128,7 @@ gdb_tools_get_session (GdbSessionManager  *manager,
         return NULL;
     }
 
-    session = gdb_session_manager_get_session (manager, session_id);
+    session = gdb_session_manager_lookup_session (manager, session_id);
     if (session == NULL)
     {
         if (error_result != NULL)
@@ -139,6 +141,38 @@ gdb_tools_get_session (GdbSessionManager  *manager,
     return session;
 }
 
+/**
+ * gdb_tools_mark_fiber_thread:
+ *
+ * Marks the calling thread as one that runs tool handlers as libdex
+ * fibers. The synchronous helpers below then await futures instead of
+ * running a nested main loop on a fresh #GMainContext.
+ */
+void gdb_tools_mark_fiber_thread (void);
+
+/**
+ * gdb_tools_on_fiber:
+ *
+ * Checks whether the calling thread was marked with
+ * gdb_tools_mark_fiber_thread().
+ *
+ * Returns: %TRUE if the helpers may await
+ */
+gboolean gdb_tools_on_fiber (void);
+
+/**
+ * gdb_tools_start_sync:
+ * @session: the GDB session
+ * @error: (out) (optional): return location for error
+ *
+ * Starts @session synchronously. A start that does not finish within
+ * the session timeout fails with %GDB_ERROR_TIMEOUT.
+ *
+ * Returns: %TRUE once GDB is ready
+ */
+gboolean gdb_tools_start_sync (GdbSession  *session,
+                               GError     **error);
+
 /**
  * gdb_tools_execute_command_sync:
  * @session: the GDB session
@@ -153,6 +187,109 @@ gchar *gdb_tools_execute_command_sync (GdbSession  *session,
                                        const gchar *command,
                                        GError     **error);
 
+/**
+ * gdb_tools_execute_result_sync:
+ * @session: the GDB session
+ * @command: the command to execute
+ * @error: (out) (optional): return location for error
+ *
+ * Executes a GDB command synchronously and returns its parsed records.
+ *
+ * Returns: (transfer full) (nullable): the result, or %NULL on error
+ */
+GdbCommandResult *gdb_tools_execute_result_sync (GdbSession  *session,
+                                                 const gchar *command,
+                                                 GError     **error);
+
+/**
+ * gdb_tools_evaluate_sync:
+ * @session: the GDB session
+ * @expression: a C expression
+ * @error: (out) (optional): return location for error
+ *
+ * Evaluates @expression with -data-evaluate-expression and returns the
+ * value field, e.g. "0x0" for a NULL pointer or "0" for false.
+ *
+ * Returns: (transfer full) (nullable): the value, or %NULL on error
+ */
+gchar *gdb_tools_evaluate_sync (GdbSession  *session,
+                                const gchar *expression,
+                                GError     **error);
+
+/**
+ * gdb_tools_execute_batch_sync:
+ * @session: the GDB session
+ * @commands: (array zero-terminated=1): the commands to execute
+ * @error: (out) (optional): return location for error
+ *
+ * Executes several independent GDB commands synchronously as one
+ * pipelined batch. Entries for commands GDB rejected are %NULL.
+ *
+ * Returns: (transfer full) (element-type utf8) (nullable): the outputs,
+ *     one per command, or %NULL on error
+ */
+GPtrArray *gdb_tools_execute_batch_sync (GdbSession          *session,
+                                         const gchar * const *commands,
+                                         GError             **error);
+
+/**
+ * gdb_tools_execute_result_batch_sync:
+ * @session: the GDB session
+ * @commands: (array zero-terminated=1): the commands to execute
+ * @error: (out) (optional): return location for error
+ *
+ * Executes several GDB commands synchronously as one pipelined batch
+ * and returns their parsed records. Commands GDB rejected get a result
+ * for which gdb_command_result_is_error() is %TRUE.
+ *
+ * Returns: (transfer full) (element-type GdbCommandResult) (nullable):
+ *     the results, one per command, or %NULL on error
+ */
+GPtrArray *gdb_tools_execute_result_batch_sync (GdbSession          *session,
+                                                const gchar * const *commands,
+                                                GError             **error);
+
+/**
+ * gdb_tools_execute_detached_sync:
+ * @session: the GDB session
+ * @command: an execution command, e.g. "continue"
+ * @run_id: (out) (optional): return location for the run ID
+ * @error: (out) (optional): return location for error
+ *
+ * Executes a command that resumes the target and returns as soon as GDB
+ * reports it running, without waiting for the stop.
+ *
+ * Returns: (transfer full) (nullable): the output, or %NULL on error
+ */
+gchar *gdb_tools_execute_detached_sync (GdbSession   *session,
+                                        const gchar  *command,
+                                        guint64      *run_id,
+                                        GError      **error);
+
+/**
+ * gdb_tools_wait_for_stop_sync:
+ * @session: the GDB session
+ * @run_id: the run ID, or 0 for the most recent run
+ * @timeout_ms: how long to wait
+ * @reason: (out) (optional): return location for the stop reason
+ * @details: (out) (optional) (transfer full): return location for the
+ *     *stopped fields
+ * @output: (out) (optional) (transfer full): return location for the
+ *     output of the run
+ * @error: (out) (optional): return location for error
+ *
+ * Waits synchronously for the target to stop after a run.
+ *
+ * Returns: %TRUE if the target stopped
+ */
+gboolean gdb_tools_wait_for_stop_sync (GdbSession     *session,
+                                       guint64         run_id,
+                                       guint           timeout_ms,
+                                       GdbStopReason  *reason,
+                                       JsonObject    **details,
+                                       gchar         **output,
+                                       GError        **error);
+
 
 /* ========================================================================== */
 /* Schema Creation Functions                                                  */
@@ -168,8 +305,11 @@ JsonNode *gdb_tools_create_gdb_attach_schema      (void);
 JsonNode *gdb_tools_create_gdb_load_core_schema   (void);
 
 /* Execution tools schemas */
+JsonNode *gdb_tools_create_gdb_continue_schema    (void);
 JsonNode *gdb_tools_create_gdb_step_schema        (void);
 JsonNode *gdb_tools_create_gdb_next_schema        (void);
+JsonNode *gdb_tools_create_gdb_finish_schema      (void);
+JsonNode *gdb_tools_create_gdb_wait_for_stop_schema (void);
 
 /* Breakpoint tools schemas */
 JsonNode *gdb_tools_create_gdb_breakpoint_schema  (void);
@@ -180,6 +320,7 @@ JsonNode *gdb_tools_create_gdb_print_schema          (void);
 JsonNode *gdb_tools_create_gdb_examine_schema        (void);
 JsonNode *gdb_tools_create_gdb_info_registers_schema (void);
 JsonNode *gdb_tools_create_gdb_command_schema        (void);
+JsonNode *gdb_tools_create_gdb_batch_schema          (void);
 
 /* GLib tools schemas */
 JsonNode *gdb_tools_create_gdb_glib_print_gobject_schema  (void);
@@ -208,6 +349,7 @@ McpToolResult *gdb_tools_handle_gdb_continue     (McpServer *server, const gchar
 McpToolResult *gdb_tools_handle_gdb_step         (McpServer *server, const gchar *name, JsonObject *arguments, gpointer user_data);
 McpToolResult *gdb_tools_handle_gdb_next         (McpServer *server, const gchar *name, JsonObject *arguments, gpointer user_data);
 McpToolResult *gdb_tools_handle_gdb_finish       (McpServer *server, const gchar *name, JsonObject *arguments, gpointer user_data);
+McpToolResult *gdb_tools_handle_gdb_wait_for_stop(McpServer *server, const gchar *name, JsonObject *arguments, gpointer user_data);
 
 /* Breakpoint tools */
 McpToolResult *gdb_tools_handle_gdb_set_breakpoint (McpServer *server, const gchar *name, JsonObject *arguments, gpointer user_data);
@@ -218,6 +360,10 @@ McpToolResult *gdb_tools_handle_gdb_print        (McpServer *server, const gchar
 McpToolResult *gdb_tools_handle_gdb_examine      (McpServer *server, const gchar *name, JsonObject *arguments, gpointer user_data);
 McpToolResult *gdb_tools_handle_gdb_info_registers(McpServer *server, const gchar *name, JsonObject *arguments, gpointer user_data);
 McpToolResult *gdb_tools_handle_gdb_command      (McpServer *server, const gchar *name, JsonObject *arguments, gpointer user_data);
+McpToolResult *gdb_tools_handle_gdb_batch        (McpServer *server, const gchar *name, JsonObject *arguments, gpointer user_data);
+
+/* Most commands gdb_batch takes in one call */
+#define GDB_TOOLS_BATCH_MAX_COMMANDS 256
 
 /* GLib-specific tools */
 McpToolResult *gdb_tools_handle_gdb_glib_print_gobject   (McpServer *server, const gchar *name, JsonObject *arguments, gpointer user_data);
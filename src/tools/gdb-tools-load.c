@@ -78,7 +78,7 @@ gdb_tools_handle_gdb_load (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *program;
     g_autofree gchar *output = NULL;
     g_autofree gchar *args_output = NULL;
@@ -197,7 +197,7 @@ gdb_tools_handle_gdb_attach (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     gint64 pid;
     g_autofree gchar *output = NULL;
     g_autoptr(GError) error = NULL;
@@ -297,7 +297,7 @@ gdb_tools_handle_gdb_load_core (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     McpToolResult *error_result = NULL;
-    GdbSession *session;
+    g_autoptr(GdbSession) session = NULL;
     const gchar *program;
     const gchar *core_path;
     g_autofree gchar *file_output = NULL;
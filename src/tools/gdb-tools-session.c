@@ -43,39 +43,44 @@ gdb_tools_create_gdb_start_schema (void)
     json_builder_add_string_value (builder, "Working directory for GDB (optional)");
     json_builder_end_object (builder);
 
-    json_builder_end_object (builder); /* properties */
+    /* startupProfile property */
+    json_builder_set_member_name (builder, "startupProfile");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "string");
+    json_builder_set_member_name (builder, "enum");
+    json_builder_begin_array (builder);
+    json_builder_add_string_value (builder, "default");
+    json_builder_add_string_value (builder, "fast");
+    json_builder_end_array (builder);
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder, "'fast' skips gdbinit and the banner (-nx -q) and applies "
+                                            "session settings at launch (optional)");
     json_builder_end_object (builder);
 
-    return json_builder_get_root (builder);
-}
-
-/*
- * Synchronous session start data
- */
-typedef struct {
-    GMainLoop *loop;
-    gboolean   success;
-    GError    *error;
-} SyncStartData;
-
-static void
-on_session_started (GObject      *source,
-                    GAsyncResult *result,
-                    gpointer      user_data)
-{
-    SyncStartData *data = (SyncStartData *)user_data;
+    /* initScript property */
+    json_builder_set_member_name (builder, "initScript");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "string");
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder, "GDB command file to run at startup (optional)");
+    json_builder_end_object (builder);
 
-    data->success = gdb_session_start_finish (GDB_SESSION (source), result, &data->error);
-    g_main_loop_quit (data->loop);
-}
+    /* autoLoadSafePath property */
+    json_builder_set_member_name (builder, "autoLoadSafePath");
+    json_builder_begin_object (builder);
+    json_builder_set_member_name (builder, "type");
+    json_builder_add_string_value (builder, "string");
+    json_builder_set_member_name (builder, "description");
+    json_builder_add_string_value (builder, "Directories GDB may auto-load scripts from, "
+                                            "colon-separated (optional)");
+    json_builder_end_object (builder);
 
-static gboolean
-on_start_timeout (gpointer user_data)
-{
-    GMainLoop *loop = (GMainLoop *)user_data;
+    json_builder_end_object (builder); /* properties */
+    json_builder_end_object (builder);
 
-    g_main_loop_quit (loop);
-    return G_SOURCE_REMOVE;
+    return json_builder_get_root (builder);
 }
 
 McpToolResult *
@@ -86,10 +91,15 @@ gdb_tools_handle_gdb_start (McpServer   *server G_GNUC_UNUSED,
 {
     GdbSessionManager *manager = GDB_SESSION_MANAGER (user_data);
     g_autoptr(GdbSession) session = NULL;
-    g_autoptr(GMainLoop) loop = NULL;
+    g_autoptr(GError) error = NULL;
     const gchar *gdb_path = NULL;
     const gchar *working_dir = NULL;
-    SyncStartData sync_data;
+    const gchar *init_script = NULL;
+    const gchar *auto_load_safe_path = NULL;
+    GdbStartupProfile profile;
+    gboolean warm = FALSE;
+
+    profile = gdb_session_manager_get_default_startup_profile (manager);
 
     /* Extract arguments */
     if (arguments != NULL)
@@ -102,59 +112,37 @@ gdb_tools_handle_gdb_start (McpServer   *server G_GNUC_UNUSED,
         {
             working_dir = json_object_get_string_member (arguments, "workingDir");
         }
+        if (json_object_has_member (arguments, "startupProfile"))
+        {
+            profile = gdb_startup_profile_from_string (
+                json_object_get_string_member (arguments, "startupProfile"));
+        }
+        if (json_object_has_member (arguments, "initScript"))
+        {
+            init_script = json_object_get_string_member (arguments, "initScript");
+        }
+        if (json_object_has_member (arguments, "autoLoadSafePath"))
+        {
+            auto_load_safe_path = json_object_get_string_member (arguments, "autoLoadSafePath");
+        }
     }
 
     /* Create session */
-    session = gdb_session_manager_create_session (manager, gdb_path, working_dir);
+    session = gdb_session_manager_create_session_full (manager, gdb_path, working_dir,
+                                                       profile, init_script,
+                                                       auto_load_safe_path);
 
-    /* Start session synchronously using a temporary main loop.
-     * We create our own context and push it as thread-default so that
-     * all async operations and timeouts work correctly.
-     */
+    /* Sessions from the warm pool are already started */
+    if (gdb_session_get_state (session) == GDB_SESSION_STATE_READY)
     {
-        g_autoptr(GMainContext) context = g_main_context_new ();
-        GSource *timeout_source;
-
-        loop = g_main_loop_new (context, FALSE);
-
-        sync_data.loop = loop;
-        sync_data.success = FALSE;
-        sync_data.error = NULL;
-
-        g_main_context_push_thread_default (context);
-
-        gdb_session_start_async (session, NULL, on_session_started, &sync_data);
-
-        /* Add timeout to the same context */
-        timeout_source = g_timeout_source_new (gdb_session_get_timeout_ms (session) + 1000);
-        g_source_set_callback (timeout_source, on_start_timeout, loop, NULL);
-        g_source_attach (timeout_source, context);
-
-        g_main_loop_run (loop);
-
-        /* Destroy the timeout source - use g_source_destroy since the source
-         * is attached to our local context, not the global default context.
-         */
-        g_source_destroy (timeout_source);
-        g_source_unref (timeout_source);
-
-        g_main_context_pop_thread_default (context);
+        warm = TRUE;
     }
-
-    if (!sync_data.success)
+    else if (!gdb_tools_start_sync (session, &error))
     {
         const gchar *session_id = gdb_session_get_session_id (session);
         gdb_session_manager_remove_session (manager, session_id);
 
-        if (sync_data.error != NULL)
-        {
-            McpToolResult *result = gdb_tools_create_error_result (
-                "Failed to start GDB: %s", sync_data.error->message);
-            g_error_free (sync_data.error);
-            return result;
-        }
-
-        return gdb_tools_create_error_result ("Failed to start GDB: Timeout");
+        return gdb_tools_create_error_result ("Failed to start GDB: %s", error->message);
     }
 
     /* Build success result */
@@ -166,11 +154,17 @@ gdb_tools_handle_gdb_start (McpServer   *server G_GNUC_UNUSED,
         text = g_strdup_printf ("GDB session started successfully.\n\n"
                                 "Session ID: %s\n"
                                 "GDB Path: %s\n"
-                                "Working Directory: %s",
+                                "Working Directory: %s\n"
+                                "Startup Profile: %s\n"
+                                "Startup Time: %.1f ms%s",
                                 session_id,
                                 gdb_session_get_gdb_path (session),
                                 gdb_session_get_working_dir (session) ?
-                                    gdb_session_get_working_dir (session) : "(current)");
+                                    gdb_session_get_working_dir (session) : "(current)",
+                                gdb_startup_profile_to_string (
+                                    gdb_session_get_startup_profile (session)),
+                                gdb_session_get_startup_time (session) / 1000.0,
+                                warm ? " (pre-started)" : "");
 
         result = mcp_tool_result_new (FALSE);
         mcp_tool_result_add_text (result, text);
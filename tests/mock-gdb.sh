@@ -27,8 +27,9 @@ do
     # Skip empty lines
     [[ -z "$line" ]] && continue
 
-    # Extract token if present (e.g., "123-exec-run" -> token="123", cmd="-exec-run")
-    if [[ "$line" =~ ^([0-9]+)(-.*)$ ]]
+    # Extract token if present (e.g., "123-exec-run" -> token="123", cmd="-exec-run",
+    # "7help" -> token="7", cmd="help")
+    if [[ "$line" =~ ^([0-9]+)(.*)$ ]]
     then
         token="${BASH_REMATCH[1]}"
         cmd="${BASH_REMATCH[2]}"
@@ -68,12 +69,38 @@ do
             ;;
 
         -exec-continue)
+            # Like real GDB: the prompt returns while the target runs
             echo "${token}^running"
+            echo "*running,thread-id=\"all\""
+            echo "(gdb)"
             # Simulate program exit
+            echo "~\"[Inferior 1 (process 4242) exited normally]\\n\""
             echo "*stopped,reason=\"exited-normally\""
             echo "(gdb)"
             ;;
 
+        -exec-until\ *)
+            # Simulate a target that keeps running until interrupted
+            is_running=1
+            echo "${token}^running"
+            echo "*running,thread-id=\"all\""
+            echo "(gdb)"
+            ;;
+
+        -exec-interrupt)
+            if [[ $is_running -eq 1 ]]
+            then
+                is_running=0
+                echo "${token}^done"
+                echo "(gdb)"
+                echo "*stopped,reason=\"signal-received\",signal-name=\"SIGINT\",signal-meaning=\"Interrupt\",frame={addr=\"0x0000555555555180\",func=\"main\",args=[]}"
+                echo "(gdb)"
+            else
+                echo "${token}^error,msg=\"The program is not being run.\""
+                echo "(gdb)"
+            fi
+            ;;
+
         -exec-step|-exec-stepi)
             echo "${token}^running"
             echo "*stopped,reason=\"end-stepping-range\",frame={addr=\"0x0000555555555150\",func=\"main\",args=[],file=\"test.c\",fullname=\"/tmp/test.c\",line=\"6\"}"
@@ -141,6 +168,25 @@ do
             echo "(gdb)"
             ;;
 
+        # Output framed the awkward ways a pipe may deliver it
+        -mock-split-record)
+            printf '%s' "${token}^done,value=\"sp"
+            sleep 0.2
+            printf '%s\n(gd' 'lit"'
+            sleep 0.2
+            printf 'b)\n'
+            ;;
+
+        -mock-crlf-record)
+            printf '%s\r\n(gdb)\r\n' "${token}^done,value=\"crlf\""
+            ;;
+
+        -mock-long-record\ *)
+            printf -v pad '%*s' "${cmd#-mock-long-record }" ''
+            echo "${token}^done,value=\"${pad// /x}\""
+            echo "(gdb)"
+            ;;
+
         *)
             # Unknown command - return done
             echo "${token}^done"
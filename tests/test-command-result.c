@@ -0,0 +1,217 @@
+/*
+ * test-command-result.c - Unit tests for GdbCommandResult
+ *
+ * Copyright (C) 2025 Zach Podbielniak
+ * SPDX-License-Identifier: AGPL-3.0-or-later
+ */
+
+#include <glib.h>
+#include <json-glib/json-glib.h>
+#include "mcp-gdb/gdb-command-result.h"
+#include "mcp-gdb/gdb-mi-parser.h"
+
+/* ========================================================================== */
+/* Helpers                                                                    */
+/* ========================================================================== */
+
+/*
+ * build_result:
+ * @lines: (array zero-terminated=1): raw MI lines
+ *
+ * Parses @lines and files them into a new command result.
+ */
+static GdbCommandResult *
+build_result (const gchar * const *lines)
+{
+    g_autoptr(GdbMiParser) parser = NULL;
+    GdbCommandResult *result;
+    guint i;
+
+    parser = gdb_mi_parser_new ();
+    result = gdb_command_result_new ();
+
+    for (i = 0; lines[i] != NULL; i++)
+    {
+        g_autoptr(GdbMiRecord) record = NULL;
+
+        record = gdb_mi_parser_parse_line (parser, lines[i], NULL);
+        g_assert_nonnull (record);
+        gdb_command_result_add_record (result, record);
+    }
+
+    return result;
+}
+
+/* ========================================================================== */
+/* GdbCommandResult Tests                                                     */
+/* ========================================================================== */
+
+static void
+test_command_result_new (void)
+{
+    g_autoptr(GdbCommandResult) result = NULL;
+
+    result = gdb_command_result_new ();
+    g_assert_nonnull (result);
+    g_assert_null (gdb_command_result_get_result (result));
+    g_assert_cmpint (gdb_command_result_get_result_class (result), ==, GDB_MI_RESULT_ERROR);
+    g_assert_false (gdb_command_result_is_error (result));
+    g_assert_cmpuint (gdb_command_result_get_console (result)->len, ==, 0);
+    g_assert_cmpuint (gdb_command_result_get_async (result)->len, ==, 0);
+    g_assert_cmpuint (gdb_command_result_get_log (result)->len, ==, 0);
+    g_assert_cmpstr (gdb_command_result_get_console_text (result), ==, "");
+}
+
+static void
+test_command_result_ref_unref (void)
+{
+    GdbCommandResult *result;
+
+    result = gdb_command_result_new ();
+    g_assert_true (gdb_command_result_ref (result) == result);
+    gdb_command_result_unref (result);
+    gdb_command_result_unref (result);
+
+    /* NULL is accepted like the other unref functions */
+    gdb_command_result_unref (NULL);
+}
+
+static void
+test_command_result_split (void)
+{
+    const gchar *lines[] = {
+        "=thread-group-started,id=\"i1\",pid=\"4242\"",
+        "~\"$1 = \"",
+        "@\"target says hi\\n\"",
+        "~\"0x0\\n\"",
+        "&\"warning: something\\n\"",
+        "*stopped,reason=\"breakpoint-hit\",bkptno=\"1\"",
+        "5^done,value=\"0x0\"",
+        "(gdb)",
+        NULL
+    };
+    g_autoptr(GdbCommandResult) result = NULL;
+
+    result = build_result (lines);
+
+    /* Every record lands in its class, in order */
+    g_assert_nonnull (gdb_command_result_get_result (result));
+    g_assert_cmpint (gdb_command_result_get_result_class (result), ==, GDB_MI_RESULT_DONE);
+    g_assert_cmpuint (gdb_command_result_get_console (result)->len, ==, 3);
+    g_assert_cmpuint (gdb_command_result_get_async (result)->len, ==, 2);
+    g_assert_cmpuint (gdb_command_result_get_log (result)->len, ==, 1);
+
+    g_assert_cmpstr (gdb_command_result_get_console_text (result), ==,
+                     "$1 = target says hi\n0x0\n");
+    g_assert_cmpstr (gdb_command_result_get_field (result, "value"), ==, "0x0");
+    g_assert_null (gdb_command_result_get_field (result, "missing"));
+}
+
+static void
+test_command_result_error (void)
+{
+    const gchar *lines[] = {
+        "&\"No symbol table is loaded.\\n\"",
+        "7^error,msg=\"No symbol table is loaded.\"",
+        NULL
+    };
+    g_autoptr(GdbCommandResult) result = NULL;
+
+    result = build_result (lines);
+
+    g_assert_true (gdb_command_result_is_error (result));
+    g_assert_cmpint (gdb_command_result_get_result_class (result), ==, GDB_MI_RESULT_ERROR);
+    g_assert_cmpstr (gdb_command_result_get_error_message (result), ==,
+                     "No symbol table is loaded.");
+}
+
+static void
+test_command_result_from_records (void)
+{
+    g_autoptr(GdbMiParser) parser = NULL;
+    g_autoptr(GdbCommandResult) result = NULL;
+    GList *records = NULL;
+
+    parser = gdb_mi_parser_new ();
+    records = g_list_append (records, gdb_mi_parser_parse_line (parser, "~\"hello\\n\"", NULL));
+    records = g_list_append (records, gdb_mi_parser_parse_line (parser, "^done", NULL));
+
+    result = gdb_command_result_new_from_records (records);
+    g_list_free_full (records, (GDestroyNotify) gdb_mi_record_unref);
+
+    /* The result keeps its own references */
+    g_assert_cmpstr (gdb_command_result_get_console_text (result), ==, "hello\n");
+    g_assert_false (gdb_command_result_is_error (result));
+}
+
+static void
+test_command_result_to_json (void)
+{
+    const gchar *lines[] = {
+        "~\"Breakpoint 1, main () at test.c:5\\n\"",
+        "*stopped,reason=\"breakpoint-hit\",bkptno=\"1\"",
+        "&\"log line\\n\"",
+        "^done,bkpt={number=\"1\",func=\"main\"}",
+        NULL
+    };
+    g_autoptr(GdbCommandResult) result = NULL;
+    g_autoptr(JsonNode) node = NULL;
+    JsonObject *object;
+    JsonObject *bkpt;
+    JsonArray *async;
+    JsonObject *stopped;
+
+    result = build_result (lines);
+    node = gdb_command_result_to_json (result);
+
+    g_assert_true (JSON_NODE_HOLDS_OBJECT (node));
+    object = json_node_get_object (node);
+
+    g_assert_cmpstr (json_object_get_string_member (object, "class"), ==, "done");
+    bkpt = json_object_get_object_member (json_object_get_object_member (object, "results"), "bkpt");
+    g_assert_cmpstr (json_object_get_string_member (bkpt, "func"), ==, "main");
+    g_assert_cmpstr (json_object_get_string_member (object, "console"), ==,
+                     "Breakpoint 1, main () at test.c:5\n");
+    g_assert_cmpstr (json_object_get_string_member (object, "log"), ==, "log line\n");
+
+    async = json_object_get_array_member (object, "async");
+    g_assert_cmpuint (json_array_get_length (async), ==, 1);
+    stopped = json_array_get_object_element (async, 0);
+    g_assert_cmpstr (json_object_get_string_member (stopped, "type"), ==, "exec");
+    g_assert_cmpstr (json_object_get_string_member (stopped, "class"), ==, "stopped");
+}
+
+static void
+test_command_result_to_json_empty (void)
+{
+    g_autoptr(GdbCommandResult) result = NULL;
+    g_autoptr(JsonNode) node = NULL;
+
+    result = gdb_command_result_new ();
+    node = gdb_command_result_to_json (result);
+
+    /* Missing parts are omitted */
+    g_assert_true (JSON_NODE_HOLDS_OBJECT (node));
+    g_assert_cmpuint (json_object_get_size (json_node_get_object (node)), ==, 0);
+}
+
+/* ========================================================================== */
+/* Main                                                                       */
+/* ========================================================================== */
+
+int
+main (int   argc,
+      char *argv[])
+{
+    g_test_init (&argc, &argv, NULL);
+
+    g_test_add_func ("/gdb/command-result/new", test_command_result_new);
+    g_test_add_func ("/gdb/command-result/ref-unref", test_command_result_ref_unref);
+    g_test_add_func ("/gdb/command-result/split", test_command_result_split);
+    g_test_add_func ("/gdb/command-result/error", test_command_result_error);
+    g_test_add_func ("/gdb/command-result/from-records", test_command_result_from_records);
+    g_test_add_func ("/gdb/command-result/to-json", test_command_result_to_json);
+    g_test_add_func ("/gdb/command-result/to-json-empty", test_command_result_to_json_empty);
+
+    return g_test_run ();
+}
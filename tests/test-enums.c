@@ -276,6 +276,39 @@ test_mi_result_class_roundtrip (void)
 }
 
 
+/* ========================================================================== */
+/* GdbStartupProfile Tests                                                    */
+/* ========================================================================== */
+
+static void
+test_startup_profile_to_string (void)
+{
+    g_assert_cmpstr (gdb_startup_profile_to_string (GDB_STARTUP_PROFILE_DEFAULT), ==, "default");
+    g_assert_cmpstr (gdb_startup_profile_to_string (GDB_STARTUP_PROFILE_FAST), ==, "fast");
+}
+
+static void
+test_startup_profile_from_string (void)
+{
+    g_assert_cmpint (gdb_startup_profile_from_string ("default"), ==, GDB_STARTUP_PROFILE_DEFAULT);
+    g_assert_cmpint (gdb_startup_profile_from_string ("fast"), ==, GDB_STARTUP_PROFILE_FAST);
+
+    /* Unknown values fall back to the default profile */
+    g_assert_cmpint (gdb_startup_profile_from_string ("turbo"), ==, GDB_STARTUP_PROFILE_DEFAULT);
+    g_assert_cmpint (gdb_startup_profile_from_string (NULL), ==, GDB_STARTUP_PROFILE_DEFAULT);
+}
+
+static void
+test_startup_profile_get_type (void)
+{
+    GType type = gdb_startup_profile_get_type ();
+
+    g_assert_true (G_TYPE_IS_ENUM (type));
+    g_assert_cmpstr (g_type_name (type), ==, "GdbStartupProfile");
+    g_assert_cmpuint (GDB_TYPE_STARTUP_PROFILE, ==, type);
+}
+
+
 /* ========================================================================== */
 /* Main                                                                       */
 /* ========================================================================== */
@@ -309,5 +342,10 @@ main (int   argc,
     g_test_add_func ("/gdb/enums/mi-result-class/get-type", test_mi_result_class_get_type);
     g_test_add_func ("/gdb/enums/mi-result-class/roundtrip", test_mi_result_class_roundtrip);
 
+    /* GdbStartupProfile tests */
+    g_test_add_func ("/gdb/enums/startup-profile/to-string", test_startup_profile_to_string);
+    g_test_add_func ("/gdb/enums/startup-profile/from-string", test_startup_profile_from_string);
+    g_test_add_func ("/gdb/enums/startup-profile/get-type", test_startup_profile_get_type);
+
     return g_test_run ();
 }
@@ -66,6 +66,7 @@ test_error_code_to_string (void)
     g_assert_nonnull (gdb_error_code_to_string (GDB_ERROR_ALREADY_RUNNING));
     g_assert_nonnull (gdb_error_code_to_string (GDB_ERROR_NOT_RUNNING));
     g_assert_nonnull (gdb_error_code_to_string (GDB_ERROR_INTERNAL));
+    g_assert_nonnull (gdb_error_code_to_string (GDB_ERROR_QUEUE_FULL));
 }
 
 static void
@@ -85,6 +86,7 @@ test_error_code_to_string_content (void)
     g_assert_cmpstr (gdb_error_code_to_string (GDB_ERROR_ALREADY_RUNNING), ==, "Session already has a running program");
     g_assert_cmpstr (gdb_error_code_to_string (GDB_ERROR_NOT_RUNNING), ==, "No program is running");
     g_assert_cmpstr (gdb_error_code_to_string (GDB_ERROR_INTERNAL), ==, "Internal error");
+    g_assert_cmpstr (gdb_error_code_to_string (GDB_ERROR_QUEUE_FULL), ==, "Command queue is full");
 }
 
 static void
@@ -180,7 +182,8 @@ test_error_all_codes_unique (void)
         GDB_ERROR_ATTACH_FAILED,
         GDB_ERROR_ALREADY_RUNNING,
         GDB_ERROR_NOT_RUNNING,
-        GDB_ERROR_INTERNAL
+        GDB_ERROR_INTERNAL,
+        GDB_ERROR_QUEUE_FULL
     };
     gsize i, j;
 
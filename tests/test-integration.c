@@ -9,6 +9,7 @@
  */
 
 #include <glib.h>
+#include <string.h>
 #include "mcp-gdb/gdb-session.h"
 #include "mcp-gdb/gdb-session-manager.h"
 #include "mcp-gdb/gdb-mi-parser.h"
@@ -130,6 +131,138 @@ start_callback (GObject      *source,
     g_main_loop_quit (fixture->loop);
 }
 
+/*
+ * run_loop_for:
+ * @fixture: the fixture
+ * @timeout_ms: how long to run at most
+ *
+ * Returns: %TRUE if the loop was quit before @timeout_ms passed
+ */
+static gboolean
+run_loop_for (IntegrationFixture *fixture,
+              guint               timeout_ms)
+{
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    timeout_id = g_timeout_add (timeout_ms, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id == 0)
+    {
+        return FALSE;
+    }
+
+    g_source_remove (timeout_id);
+    return TRUE;
+}
+
+typedef struct {
+    GMainLoop *loop;
+    gint       remaining;  /* Operations left before the loop quits */
+    gchar     *output;
+    GError    *error;
+} CommandData;
+
+static void
+command_callback (GObject      *source,
+                  GAsyncResult *result,
+                  gpointer      user_data)
+{
+    CommandData *data = (CommandData *)user_data;
+
+    data->output = gdb_session_execute_finish (GDB_SESSION (source), result, &data->error);
+    if (--data->remaining == 0)
+    {
+        g_main_loop_quit (data->loop);
+    }
+}
+
+/*
+ * fixture_execute:
+ * @fixture: the fixture, with a started session
+ * @command: the command
+ *
+ * Runs @command and asserts it succeeds.
+ *
+ * Returns: (transfer full): the output
+ */
+static gchar *
+fixture_execute (IntegrationFixture *fixture,
+                 const gchar        *command)
+{
+    CommandData data = { fixture->loop, 1, NULL, NULL };
+
+    gdb_session_execute_async (fixture->session, command, NULL, command_callback, &data);
+    g_assert_true (run_loop_for (fixture, 10000));
+    g_assert_no_error (data.error);
+
+    return data.output;
+}
+
+/*
+ * fixture_start_spinner:
+ * @fixture: the fixture
+ *
+ * Starts GDB with the test program loaded to spin until interrupted.
+ *
+ * Returns: %FALSE, after marking the test skipped, if that is not possible
+ */
+static gboolean
+fixture_start_spinner (IntegrationFixture *fixture)
+{
+    g_autofree gchar *load = NULL;
+
+    if (!gdb_is_available ())
+    {
+        g_test_skip ("GDB not available");
+        return FALSE;
+    }
+
+    if (!test_program_exists ())
+    {
+        g_test_skip ("Test program not available");
+        return FALSE;
+    }
+
+    gdb_session_start_async (fixture->session, NULL, start_callback, fixture);
+    run_loop_for (fixture, 10000);
+    if (!fixture->success)
+    {
+        g_test_skip ("Could not start GDB");
+        return FALSE;
+    }
+
+    load = g_strdup_printf ("-file-exec-and-symbols \"%s\"", test_program_path);
+    g_free (fixture_execute (fixture, load));
+    g_free (fixture_execute (fixture, "-exec-arguments spin"));
+
+    return TRUE;
+}
+
+typedef struct {
+    GMainLoop     *loop;
+    guint64        run_id;
+    GdbStopReason  reason;
+    gboolean       stopped;
+    GError        *error;
+} StopData;
+
+static void
+wait_for_stop_callback (GObject      *source,
+                        GAsyncResult *result,
+                        gpointer      user_data)
+{
+    StopData *data = (StopData *)user_data;
+
+    data->stopped = gdb_session_wait_for_stop_finish (GDB_SESSION (source), result,
+                                                      &data->reason, NULL, NULL,
+                                                      &data->error);
+    g_main_loop_quit (data->loop);
+}
+
 
 /* ========================================================================== */
 /* Full Session Lifecycle Test                                                */
@@ -255,6 +388,141 @@ test_integration_state_transitions (IntegrationFixture *fixture,
 }
 
 
+/* ========================================================================== */
+/* Interrupt Tests                                                            */
+/* ========================================================================== */
+
+static void
+cancel_when_running (GdbSession      *session G_GNUC_UNUSED,
+                     GdbSessionState  old_state G_GNUC_UNUSED,
+                     GdbSessionState  new_state,
+                     gpointer         user_data)
+{
+    if (new_state == GDB_SESSION_STATE_RUNNING)
+    {
+        g_cancellable_cancel (G_CANCELLABLE (user_data));
+    }
+}
+
+static void
+test_integration_cancel_interrupts (IntegrationFixture *fixture,
+                                    gconstpointer       user_data G_GNUC_UNUSED)
+{
+    g_autoptr(GCancellable) cancellable = NULL;
+    g_autofree gchar *output = NULL;
+    CommandData run = { fixture->loop, 1, NULL, NULL };
+    StopData stop = { fixture->loop, 0, GDB_STOP_REASON_UNKNOWN, FALSE, NULL };
+    gulong handler_id;
+
+    if (!fixture_start_spinner (fixture))
+    {
+        return;
+    }
+
+    cancellable = g_cancellable_new ();
+    handler_id = g_signal_connect (fixture->session, "state-changed",
+                                   G_CALLBACK (cancel_when_running), cancellable);
+
+    /* The target never stops on its own; cancelling must interrupt it */
+    gdb_session_execute_async (fixture->session, "-exec-run", cancellable,
+                               command_callback, &run);
+    g_assert_true (run_loop_for (fixture, 10000));
+    g_signal_handler_disconnect (fixture->session, handler_id);
+
+    g_assert_error (run.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_clear_error (&run.error);
+
+    gdb_session_wait_for_stop_async (fixture->session, 0, NULL,
+                                     wait_for_stop_callback, &stop);
+    g_assert_true (run_loop_for (fixture, 5000));
+    g_assert_no_error (stop.error);
+    g_assert_true (stop.stopped);
+    g_assert_cmpint (stop.reason, ==, GDB_STOP_REASON_SIGNAL);
+
+    /* The session is usable again well before the command timeout */
+    output = fixture_execute (fixture, "-data-evaluate-expression 1+1");
+    g_assert_nonnull (strstr (output, "value=\"2\""));
+}
+
+typedef struct {
+    GMainLoop *loop;
+    gchar     *output;
+    guint64    run_id;
+    GError    *error;
+} DetachedData;
+
+static void
+detached_callback (GObject      *source,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+    DetachedData *data = (DetachedData *)user_data;
+
+    data->output = gdb_session_execute_detached_finish (GDB_SESSION (source), result,
+                                                        &data->run_id, &data->error);
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_integration_detached_run (IntegrationFixture *fixture,
+                               gconstpointer       user_data G_GNUC_UNUSED)
+{
+    DetachedData run = { fixture->loop, NULL, 0, NULL };
+    CommandData query = { fixture->loop, 1, NULL, NULL };
+    CommandData interrupt = { fixture->loop, 1, NULL, NULL };
+    StopData stop = { fixture->loop, 0, GDB_STOP_REASON_UNKNOWN, FALSE, NULL };
+    gint64 started;
+
+    if (!fixture_start_spinner (fixture))
+    {
+        return;
+    }
+
+    /* Returns as soon as the target runs */
+    gdb_session_execute_detached_async (fixture->session, "-exec-run", NULL,
+                                        detached_callback, &run);
+    g_assert_true (run_loop_for (fixture, 10000));
+    g_assert_no_error (run.error);
+    g_assert_cmpuint (run.run_id, >, 0);
+    g_assert_cmpint (gdb_session_get_state (fixture->session), ==, GDB_SESSION_STATE_RUNNING);
+    g_free (run.output);
+
+    /* Other calls are answered while the target runs: a query is
+     * refused right away, and GDB reads the interrupt and stops it.
+     */
+    started = g_get_monotonic_time ();
+    gdb_session_execute_async (fixture->session, "-data-evaluate-expression 6*7", NULL,
+                               command_callback, &query);
+    gdb_session_execute_async (fixture->session, "-exec-interrupt", NULL,
+                               command_callback, &interrupt);
+    while (query.remaining > 0 || interrupt.remaining > 0)
+    {
+        g_assert_true (run_loop_for (fixture, 5000));
+    }
+    g_assert_error (query.error, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY);
+    g_clear_error (&query.error);
+    g_assert_no_error (interrupt.error);
+    g_free (interrupt.output);
+    g_assert_cmpint (g_get_monotonic_time () - started, <,
+                     gdb_session_get_timeout_ms (fixture->session) * G_TIME_SPAN_MILLISECOND);
+
+    gdb_session_wait_for_stop_async (fixture->session, run.run_id, NULL,
+                                     wait_for_stop_callback, &stop);
+    g_assert_true (run_loop_for (fixture, 5000));
+    g_assert_no_error (stop.error);
+    g_assert_true (stop.stopped);
+    g_assert_cmpint (stop.reason, ==, GDB_STOP_REASON_SIGNAL);
+
+    query.remaining = 1;
+    gdb_session_execute_async (fixture->session, "-data-evaluate-expression 6*7", NULL,
+                               command_callback, &query);
+    g_assert_true (run_loop_for (fixture, 5000));
+    g_assert_no_error (query.error);
+    g_assert_nonnull (strstr (query.output, "value=\"42\""));
+    g_free (query.output);
+}
+
+
 /* ========================================================================== */
 /* MI Parser with Real Output Test                                            */
 /* ========================================================================== */
@@ -376,6 +644,20 @@ main (int   argc,
                 test_integration_state_transitions,
                 integration_fixture_teardown);
 
+    /* Cancelling a run interrupts the target */
+    g_test_add ("/gdb/integration/cancel-interrupts",
+                IntegrationFixture, NULL,
+                integration_fixture_setup,
+                test_integration_cancel_interrupts,
+                integration_fixture_teardown);
+
+    /* A detached run leaves the session usable */
+    g_test_add ("/gdb/integration/detached-run",
+                IntegrationFixture, NULL,
+                integration_fixture_setup,
+                test_integration_detached_run,
+                integration_fixture_teardown);
+
     /* MI Parser with real output */
     g_test_add_func ("/gdb/integration/mi-parser", test_integration_mi_parser);
 
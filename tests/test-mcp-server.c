@@ -6,8 +6,18 @@
  */
 
 #include <glib.h>
+#include <signal.h>
+#include <string.h>
+#include <json-glib/json-glib.h>
+#include <libsoup/soup.h>
+#include <gio/gunixsocketaddress.h>
+#include <glib/gstdio.h>
 #include "mcp-gdb/gdb-mcp-server.h"
 #include "mcp-gdb/gdb-session-manager.h"
+#include "mcp-gdb/gdb-error.h"
+
+/* Path to mock GDB script */
+static gchar *mock_gdb_path = NULL;
 
 /* ========================================================================== */
 /* Construction Tests                                                         */
@@ -98,6 +108,26 @@ test_mcp_server_properties_default_gdb_path (void)
     g_assert_cmpstr (path, ==, "/usr/local/bin/gdb");
 }
 
+static void
+test_mcp_server_properties_max_workers (void)
+{
+    g_autoptr(GdbMcpServer) server = NULL;
+    guint max_workers = 0;
+
+    server = gdb_mcp_server_new ("test", "1.0.0");
+
+    /* Tool calls run as fibers, so the default allows many at once */
+    g_assert_cmpuint (gdb_mcp_server_get_max_workers (server), ==, 64);
+
+    g_object_set (server, "max-workers", 2, NULL);
+    g_object_get (server, "max-workers", &max_workers, NULL);
+    g_assert_cmpuint (max_workers, ==, 2);
+
+    /* Clamped to the dispatcher limit */
+    gdb_mcp_server_set_max_workers (server, 100000);
+    g_assert_cmpuint (gdb_mcp_server_get_max_workers (server), ==, 4096);
+}
+
 
 /* ========================================================================== */
 /* Session Manager Accessor Tests                                             */
@@ -272,6 +302,725 @@ test_mcp_server_ref_unref (void)
 }
 
 
+/* ========================================================================== */
+/* HTTP Transport Tests                                                       */
+/* ========================================================================== */
+
+#define INITIALIZE_REQUEST \
+    "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"initialize\",\"params\":" \
+    "{\"protocolVersion\":\"2025-03-26\",\"capabilities\":{}," \
+    "\"clientInfo\":{\"name\":\"test\",\"version\":\"1.0\"}}}"
+
+typedef struct {
+    GBytes   *body;
+    gboolean  done;
+} HttpReply;
+
+static void
+on_http_reply (GObject      *source,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+    HttpReply *reply = (HttpReply *)user_data;
+
+    reply->body = soup_session_send_and_read_finish (SOUP_SESSION (source), result, NULL);
+    reply->done = TRUE;
+}
+
+/*
+ * http_send:
+ * @session: the client session
+ * @port: the server port
+ * @method: the HTTP method
+ * @session_id: (nullable): the Mcp-Session-Id to send
+ * @body: (nullable): a JSON-RPC message to POST
+ * @reply_session_id: (out) (optional): the Mcp-Session-Id of the reply
+ * @reply_body: (out) (optional): the reply body
+ *
+ * Sends one request to the server, which runs on the same main context,
+ * and iterates it until the reply arrives.
+ *
+ * Returns: the HTTP status
+ */
+static guint
+http_send (SoupSession  *session,
+           guint         port,
+           const gchar  *method,
+           const gchar  *session_id,
+           const gchar  *body,
+           gchar       **reply_session_id,
+           gchar       **reply_body)
+{
+    g_autofree gchar *uri = NULL;
+    g_autoptr(SoupMessage) msg = NULL;
+    SoupMessageHeaders *headers;
+    HttpReply reply = { NULL, FALSE };
+
+    uri = g_strdup_printf ("http://127.0.0.1:%u/mcp", port);
+    msg = soup_message_new (method, uri);
+    headers = soup_message_get_request_headers (msg);
+    soup_message_headers_replace (headers, "Accept", "application/json, text/event-stream");
+    if (session_id != NULL)
+    {
+        soup_message_headers_replace (headers, "Mcp-Session-Id", session_id);
+    }
+    if (body != NULL)
+    {
+        g_autoptr(GBytes) bytes = g_bytes_new (body, strlen (body));
+
+        soup_message_set_request_body_from_bytes (msg, "application/json", bytes);
+    }
+
+    soup_session_send_and_read_async (session, msg, G_PRIORITY_DEFAULT, NULL,
+                                      on_http_reply, &reply);
+    while (!reply.done)
+    {
+        g_main_context_iteration (NULL, TRUE);
+    }
+
+    if (reply_session_id != NULL)
+    {
+        *reply_session_id = g_strdup (soup_message_headers_get_one (
+            soup_message_get_response_headers (msg), "Mcp-Session-Id"));
+    }
+    if (reply_body != NULL)
+    {
+        *reply_body = reply.body != NULL
+                      ? g_strndup (g_bytes_get_data (reply.body, NULL),
+                                   g_bytes_get_size (reply.body))
+                      : NULL;
+    }
+    g_clear_pointer (&reply.body, g_bytes_unref);
+
+    return soup_message_get_status (msg);
+}
+
+static void
+on_raw_reply (GObject      *source,
+              GAsyncResult *result,
+              gpointer      user_data)
+{
+    HttpReply *reply = (HttpReply *)user_data;
+
+    reply->body = g_input_stream_read_bytes_finish (G_INPUT_STREAM (source), result, NULL);
+    reply->done = TRUE;
+}
+
+/*
+ * http_send_raw:
+ * @port: the server port
+ * @host: the Host header
+ * @origin: (nullable): the Origin header
+ *
+ * POSTs initialize over a plain connection, so the headers go out
+ * exactly as given, the way a browser could send them.
+ *
+ * Returns: the HTTP status
+ */
+static guint
+http_send_raw (guint        port,
+               const gchar *host,
+               const gchar *origin)
+{
+    g_autoptr(GSocketClient) socket_client = NULL;
+    g_autoptr(GSocketConnection) connection = NULL;
+    g_autoptr(GString) request = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *head = NULL;
+    HttpReply reply = { NULL, FALSE };
+
+    socket_client = g_socket_client_new ();
+    connection = g_socket_client_connect_to_host (socket_client, "127.0.0.1", port,
+                                                  NULL, &error);
+    g_assert_no_error (error);
+
+    request = g_string_new ("POST /mcp HTTP/1.1\r\n");
+    g_string_append_printf (request, "Host: %s\r\n", host);
+    if (origin != NULL)
+    {
+        g_string_append_printf (request, "Origin: %s\r\n", origin);
+    }
+    g_string_append_printf (request,
+                            "Accept: application/json, text/event-stream\r\n"
+                            "Content-Type: application/json\r\n"
+                            "Content-Length: %" G_GSIZE_FORMAT "\r\n"
+                            "Connection: close\r\n"
+                            "\r\n%s",
+                            strlen (INITIALIZE_REQUEST), INITIALIZE_REQUEST);
+    g_assert_true (g_output_stream_write_all (
+        g_io_stream_get_output_stream (G_IO_STREAM (connection)),
+        request->str, request->len, NULL, NULL, &error));
+
+    g_input_stream_read_bytes_async (g_io_stream_get_input_stream (G_IO_STREAM (connection)),
+                                     64, G_PRIORITY_DEFAULT, NULL, on_raw_reply, &reply);
+    while (!reply.done)
+    {
+        g_main_context_iteration (NULL, TRUE);
+    }
+
+    g_assert_nonnull (reply.body);
+    head = g_strndup (g_bytes_get_data (reply.body, NULL), g_bytes_get_size (reply.body));
+    g_bytes_unref (reply.body);
+    g_assert_true (g_str_has_prefix (head, "HTTP/1.1 "));
+
+    return (guint) g_ascii_strtoull (head + strlen ("HTTP/1.1 "), NULL, 10);
+}
+
+static void
+test_mcp_server_listen_invalid_address (void)
+{
+    g_autoptr(GdbMcpServer) server = NULL;
+    g_autoptr(GError) error = NULL;
+
+    server = gdb_mcp_server_new ("test", "1.0.0");
+
+    g_assert_false (gdb_mcp_server_listen (server, "not an address", 0, &error));
+    g_assert_error (error, GDB_ERROR, GDB_ERROR_INVALID_ARGUMENT);
+    g_assert_cmpuint (gdb_mcp_server_get_port (server), ==, 0);
+}
+
+static void
+test_mcp_server_listen_clients (void)
+{
+    g_autoptr(GdbMcpServer) server = NULL;
+    g_autoptr(SoupSession) session = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *first_id = NULL;
+    g_autofree gchar *second_id = NULL;
+    g_autofree gchar *body = NULL;
+    guint port;
+
+    server = gdb_mcp_server_new ("test", "1.0.0");
+    g_assert_true (gdb_mcp_server_listen (server, NULL, 0, &error));
+    g_assert_no_error (error);
+
+    port = gdb_mcp_server_get_port (server);
+    g_assert_cmpuint (port, >, 0);
+    session = soup_session_new ();
+
+    /* Only initialize may come without a session */
+    g_assert_cmpuint (http_send (session, port, "POST", NULL,
+                                 "{\"jsonrpc\":\"2.0\",\"id\":1,\"method\":\"tools/list\"}",
+                                 NULL, NULL), ==, 400);
+    g_assert_cmpuint (gdb_mcp_server_get_client_count (server), ==, 0);
+
+    /* Initialize creates a client and answers in the response body */
+    g_assert_cmpuint (http_send (session, port, "POST", NULL, INITIALIZE_REQUEST,
+                                 &first_id, &body), ==, 200);
+    g_assert_nonnull (first_id);
+    g_assert_nonnull (strstr (body, "\"result\""));
+    g_clear_pointer (&body, g_free);
+
+    /* Notifications are accepted without a body */
+    g_assert_cmpuint (http_send (session, port, "POST", first_id,
+                                 "{\"jsonrpc\":\"2.0\",\"method\":\"notifications/initialized\"}",
+                                 NULL, NULL), ==, 202);
+
+    /* The client's own McpServer has every tool */
+    g_assert_cmpuint (http_send (session, port, "POST", first_id,
+                                 "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/list\"}",
+                                 NULL, &body), ==, 200);
+    g_assert_nonnull (strstr (body, "gdb_start"));
+
+    /* A second client is independent */
+    g_assert_cmpuint (http_send (session, port, "POST", NULL, INITIALIZE_REQUEST,
+                                 &second_id, NULL), ==, 200);
+    g_assert_cmpstr (first_id, !=, second_id);
+    g_assert_cmpuint (gdb_mcp_server_get_client_count (server), ==, 2);
+
+    /* DELETE ends a client; its id is then unknown */
+    g_assert_cmpuint (http_send (session, port, "DELETE", first_id, NULL, NULL, NULL), ==, 204);
+    g_assert_cmpuint (gdb_mcp_server_get_client_count (server), ==, 1);
+    g_assert_cmpuint (http_send (session, port, "POST", first_id,
+                                 "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"tools/list\"}",
+                                 NULL, NULL), ==, 404);
+}
+
+static void
+test_mcp_server_listen_origin_host (void)
+{
+    g_autoptr(GdbMcpServer) server = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *address_host = NULL;
+    g_autofree gchar *localhost = NULL;
+    g_autofree gchar *rebound = NULL;
+    g_autofree gchar *other_port = NULL;
+    guint port;
+
+    server = gdb_mcp_server_new ("test", "1.0.0");
+    g_assert_true (gdb_mcp_server_listen (server, NULL, 0, &error));
+    g_assert_no_error (error);
+    port = gdb_mcp_server_get_port (server);
+
+    address_host = g_strdup_printf ("127.0.0.1:%u", port);
+    localhost = g_strdup_printf ("localhost:%u", port);
+    rebound = g_strdup_printf ("attacker.example:%u", port);
+    other_port = g_strdup_printf ("127.0.0.1:%u", port + 1);
+
+    /* The bound address, or localhost for a loopback one */
+    g_assert_cmpuint (http_send_raw (port, address_host, NULL), ==, 200);
+    g_assert_cmpuint (http_send_raw (port, localhost, NULL), ==, 200);
+
+    /* A DNS name pointing at us, or another port, is refused */
+    g_assert_cmpuint (http_send_raw (port, rebound, NULL), ==, 403);
+    g_assert_cmpuint (http_send_raw (port, other_port, NULL), ==, 403);
+
+    /* Browsers may only connect from a page served by this machine */
+    g_assert_cmpuint (http_send_raw (port, address_host, "http://localhost:3000"), ==, 200);
+    g_assert_cmpuint (http_send_raw (port, address_host, "http://[::1]:3000"), ==, 200);
+    g_assert_cmpuint (http_send_raw (port, address_host, "https://attacker.example"), ==, 403);
+    g_assert_cmpuint (http_send_raw (port, address_host, "null"), ==, 403);
+
+    /* Refused requests never became clients */
+    g_assert_cmpuint (gdb_mcp_server_get_client_count (server), ==, 4);
+}
+
+/* ========================================================================== */
+/* Socket Transport Tests                                                     */
+/* ========================================================================== */
+
+typedef struct {
+    gchar    *line;
+    gboolean  done;
+} LineReply;
+
+static void
+on_line_reply (GObject      *source,
+               GAsyncResult *result,
+               gpointer      user_data)
+{
+    LineReply *reply = (LineReply *)user_data;
+
+    reply->line = g_data_input_stream_read_line_finish_utf8 (G_DATA_INPUT_STREAM (source),
+                                                             result, NULL, NULL);
+    reply->done = TRUE;
+}
+
+static void
+test_mcp_server_properties_share_sessions (void)
+{
+    g_autoptr(GdbMcpServer) server = NULL;
+    gboolean share = TRUE;
+
+    server = gdb_mcp_server_new ("test", "1.0.0");
+
+    /* Clients own their sessions by default */
+    g_object_get (server, "share-sessions", &share, NULL);
+    g_assert_false (share);
+
+    gdb_mcp_server_set_share_sessions (server, TRUE);
+    g_assert_true (gdb_mcp_server_get_share_sessions (server));
+}
+
+static void
+test_mcp_server_listen_socket (void)
+{
+    g_autoptr(GdbMcpServer) server = NULL;
+    g_autoptr(GSocketClient) socket_client = NULL;
+    g_autoptr(GSocketAddress) address = NULL;
+    g_autoptr(GSocketConnection) connection = NULL;
+    g_autoptr(GDataInputStream) input = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *dir = NULL;
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *request = NULL;
+    LineReply reply = { NULL, FALSE };
+    GStatBuf st;
+    gint64 deadline;
+
+    dir = g_dir_make_tmp ("gdb-mcp-test-XXXXXX", &error);
+    g_assert_no_error (error);
+    path = g_build_filename (dir, "mcp.sock", NULL);
+
+    server = gdb_mcp_server_new ("test", "1.0.0");
+    g_assert_true (gdb_mcp_server_listen_socket (server, path, &error));
+    g_assert_no_error (error);
+
+    /* Only the owner may connect */
+    g_assert_cmpint (g_stat (path, &st), ==, 0);
+    g_assert_cmpuint (st.st_mode & 0777, ==, 0600);
+
+    socket_client = g_socket_client_new ();
+    address = g_unix_socket_address_new (path);
+    connection = g_socket_client_connect (socket_client, G_SOCKET_CONNECTABLE (address),
+                                          NULL, &error);
+    g_assert_no_error (error);
+
+    /* One JSON-RPC message per line, answered on the same connection */
+    request = g_strconcat (INITIALIZE_REQUEST, "\n", NULL);
+    g_assert_true (g_output_stream_write_all (
+        g_io_stream_get_output_stream (G_IO_STREAM (connection)),
+        request, strlen (request), NULL, NULL, &error));
+
+    input = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+    g_data_input_stream_read_line_async (input, G_PRIORITY_DEFAULT, NULL, on_line_reply, &reply);
+    while (!reply.done)
+    {
+        g_main_context_iteration (NULL, TRUE);
+    }
+
+    g_assert_nonnull (reply.line);
+    g_assert_nonnull (strstr (reply.line, "\"result\""));
+    g_assert_cmpuint (gdb_mcp_server_get_client_count (server), ==, 1);
+    g_free (reply.line);
+
+    /* Closing the connection ends the client */
+    g_io_stream_close (G_IO_STREAM (connection), NULL, NULL);
+    deadline = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+    while (gdb_mcp_server_get_client_count (server) > 0 &&
+           g_get_monotonic_time () < deadline)
+    {
+        g_main_context_iteration (NULL, FALSE);
+        g_usleep (1000);
+    }
+    g_assert_cmpuint (gdb_mcp_server_get_client_count (server), ==, 0);
+
+    /* The socket goes away with the server */
+    g_clear_object (&server);
+    g_assert_false (g_file_test (path, G_FILE_TEST_EXISTS));
+    g_rmdir (dir);
+}
+
+static void
+test_mcp_server_listen_socket_stale (void)
+{
+    g_autoptr(GdbMcpServer) server = NULL;
+    g_autoptr(GdbMcpServer) other = NULL;
+    g_autoptr(GSocket) stale = NULL;
+    g_autoptr(GSocketAddress) address = NULL;
+    g_autoptr(GSocketClient) socket_client = NULL;
+    g_autoptr(GSocketConnection) connection = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *dir = NULL;
+    g_autofree gchar *path = NULL;
+
+    dir = g_dir_make_tmp ("gdb-mcp-test-XXXXXX", &error);
+    g_assert_no_error (error);
+    path = g_build_filename (dir, "mcp.sock", NULL);
+    address = g_unix_socket_address_new (path);
+
+    /* Bound but never listening: what a crashed server leaves behind */
+    stale = g_socket_new (G_SOCKET_FAMILY_UNIX, G_SOCKET_TYPE_STREAM,
+                          G_SOCKET_PROTOCOL_DEFAULT, &error);
+    g_assert_no_error (error);
+    g_assert_true (g_socket_bind (stale, address, FALSE, &error));
+    g_assert_no_error (error);
+    g_socket_close (stale, NULL);
+
+    server = gdb_mcp_server_new ("test", "1.0.0");
+    g_assert_true (gdb_mcp_server_listen_socket (server, path, &error));
+    g_assert_no_error (error);
+
+    /* A live socket is not stolen */
+    other = gdb_mcp_server_new ("test", "1.0.0");
+    g_assert_false (gdb_mcp_server_listen_socket (other, path, &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_ADDRESS_IN_USE);
+    g_clear_error (&error);
+    g_clear_object (&other);
+
+    /* ...and still reaches the first server */
+    socket_client = g_socket_client_new ();
+    connection = g_socket_client_connect (socket_client, G_SOCKET_CONNECTABLE (address),
+                                          NULL, &error);
+    g_assert_no_error (error);
+    g_io_stream_close (G_IO_STREAM (connection), NULL, NULL);
+
+    g_clear_object (&server);
+    g_assert_false (g_file_test (path, G_FILE_TEST_EXISTS));
+    g_rmdir (dir);
+}
+
+/*
+ * socket_read_line:
+ * @input: the client end of a connection
+ *
+ * Iterates the main context, which also runs the server, until a line
+ * arrives.
+ *
+ * Returns: (transfer full) (nullable): the line
+ */
+static gchar *
+socket_read_line (GDataInputStream *input)
+{
+    LineReply reply = { NULL, FALSE };
+
+    g_data_input_stream_read_line_async (input, G_PRIORITY_DEFAULT, NULL, on_line_reply, &reply);
+    while (!reply.done)
+    {
+        g_main_context_iteration (NULL, TRUE);
+    }
+
+    return reply.line;
+}
+
+static void
+test_mcp_server_listen_socket_out_of_order (void)
+{
+    g_autoptr(GdbMcpServer) server = NULL;
+    g_autoptr(GSocketClient) socket_client = NULL;
+    g_autoptr(GSocketAddress) address = NULL;
+    g_autoptr(GSocketConnection) connection = NULL;
+    g_autoptr(GDataInputStream) input = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *dir = NULL;
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *slow_gdb = NULL;
+    g_autofree gchar *script = NULL;
+    g_autofree gchar *request = NULL;
+    g_autofree gchar *line = NULL;
+    GOutputStream *output;
+    gint64 deadline;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB script not available");
+        return;
+    }
+
+    dir = g_dir_make_tmp ("gdb-mcp-test-XXXXXX", &error);
+    g_assert_no_error (error);
+    path = g_build_filename (dir, "mcp.sock", NULL);
+
+    /* A GDB that takes a second to start */
+    slow_gdb = g_build_filename (dir, "slow-gdb.sh", NULL);
+    script = g_strdup_printf ("#!/bin/sh\nsleep 1\nexec '%s' \"$@\"\n", mock_gdb_path);
+    g_assert_true (g_file_set_contents (slow_gdb, script, -1, &error));
+    g_assert_cmpint (g_chmod (slow_gdb, 0755), ==, 0);
+
+    server = gdb_mcp_server_new ("test", "1.0.0");
+    g_assert_true (gdb_mcp_server_listen_socket (server, path, &error));
+    g_assert_no_error (error);
+
+    socket_client = g_socket_client_new ();
+    address = g_unix_socket_address_new (path);
+    connection = g_socket_client_connect (socket_client, G_SOCKET_CONNECTABLE (address),
+                                          NULL, &error);
+    g_assert_no_error (error);
+    output = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+    input = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+
+    request = g_strconcat (INITIALIZE_REQUEST, "\n", NULL);
+    g_assert_true (g_output_stream_write_all (output, request, strlen (request),
+                                              NULL, NULL, &error));
+    line = socket_read_line (input);
+    g_assert_nonnull (strstr (line, "\"id\":1"));
+    g_clear_pointer (&line, g_free);
+    g_clear_pointer (&request, g_free);
+
+    /* The slow call goes first, but the quick one is answered first */
+    request = g_strdup_printf (
+        "{\"jsonrpc\":\"2.0\",\"id\":2,\"method\":\"tools/call\",\"params\":"
+        "{\"name\":\"gdb_start\",\"arguments\":{\"gdbPath\":\"%s\"}}}\n"
+        "{\"jsonrpc\":\"2.0\",\"id\":3,\"method\":\"tools/call\",\"params\":"
+        "{\"name\":\"gdb_list_sessions\",\"arguments\":{}}}\n",
+        slow_gdb);
+    g_assert_true (g_output_stream_write_all (output, request, strlen (request),
+                                              NULL, NULL, &error));
+
+    line = socket_read_line (input);
+    g_assert_nonnull (line);
+    g_assert_nonnull (strstr (line, "\"id\":3"));
+    g_assert_nonnull (strstr (line, "\"result\""));
+    g_clear_pointer (&line, g_free);
+
+    line = socket_read_line (input);
+    g_assert_nonnull (line);
+    g_assert_nonnull (strstr (line, "\"id\":2"));
+    g_assert_nonnull (strstr (line, "\"result\""));
+
+    /* Closing the connection ends the client and its session */
+    g_io_stream_close (G_IO_STREAM (connection), NULL, NULL);
+    deadline = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+    while (gdb_mcp_server_get_client_count (server) > 0 &&
+           g_get_monotonic_time () < deadline)
+    {
+        g_main_context_iteration (NULL, FALSE);
+        g_usleep (1000);
+    }
+    g_assert_cmpuint (gdb_mcp_server_get_client_count (server), ==, 0);
+
+    g_clear_object (&server);
+    g_unlink (slow_gdb);
+    g_rmdir (dir);
+}
+
+/*
+ * socket_call:
+ * @output: the client end of a connection
+ * @id: the JSON-RPC id
+ * @tool: the tool name
+ * @arguments: the tool arguments, as JSON
+ *
+ * Sends one tools/call request without waiting for the answer.
+ */
+static void
+socket_call (GOutputStream *output,
+             guint          id,
+             const gchar   *tool,
+             const gchar   *arguments)
+{
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *request = NULL;
+
+    request = g_strdup_printf ("{\"jsonrpc\":\"2.0\",\"id\":%u,\"method\":\"tools/call\","
+                               "\"params\":{\"name\":\"%s\",\"arguments\":%s}}\n",
+                               id, tool, arguments);
+    g_assert_true (g_output_stream_write_all (output, request, strlen (request),
+                                              NULL, NULL, &error));
+    g_assert_no_error (error);
+}
+
+/*
+ * socket_collect_replies:
+ * @input: the client end of a connection
+ * @n_replies: how many replies to read
+ * @arrived: (array): arrival times, indexed by JSON-RPC id
+ *
+ * Reads @n_replies successful replies, in whatever order they come, and
+ * records the monotonic time each one arrived.
+ */
+static void
+socket_collect_replies (GDataInputStream *input,
+                        guint             n_replies,
+                        gint64           *arrived)
+{
+    guint i;
+
+    for (i = 0; i < n_replies; i++)
+    {
+        g_autoptr(JsonParser) parser = json_parser_new ();
+        g_autofree gchar *line = NULL;
+        g_autoptr(GError) error = NULL;
+        JsonObject *object;
+
+        line = socket_read_line (input);
+        g_assert_nonnull (line);
+        g_assert_true (json_parser_load_from_data (parser, line, -1, &error));
+        g_assert_no_error (error);
+
+        object = json_node_get_object (json_parser_get_root (parser));
+        g_assert_true (json_object_has_member (object, "result"));
+        arrived[json_object_get_int_member (object, "id")] = g_get_monotonic_time ();
+    }
+}
+
+static void
+test_mcp_server_dispatch_sessions (void)
+{
+    g_autoptr(GdbMcpServer) server = NULL;
+    g_autoptr(GSocketClient) socket_client = NULL;
+    g_autoptr(GSocketAddress) address = NULL;
+    g_autoptr(GSocketConnection) connection = NULL;
+    g_autoptr(GDataInputStream) input = NULL;
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *dir = NULL;
+    g_autofree gchar *path = NULL;
+    g_autofree gchar *request = NULL;
+    g_autofree gchar *line = NULL;
+    g_autofree gchar *args_a = NULL;
+    g_autofree gchar *args_b = NULL;
+    g_autofree gchar *args_c = NULL;
+    g_autofree gchar *list_c = NULL;
+    g_autofree gchar *wait_a = NULL;
+    GdbSessionManager *manager;
+    GOutputStream *output;
+    GList *sessions;
+    gint64 arrived[10];
+    gint64 start;
+    guint i;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB script not available");
+        return;
+    }
+
+    dir = g_dir_make_tmp ("gdb-mcp-test-XXXXXX", &error);
+    g_assert_no_error (error);
+    path = g_build_filename (dir, "mcp.sock", NULL);
+
+    /* Shared, so the test can see the sessions the client starts */
+    server = gdb_mcp_server_new ("test", "1.0.0");
+    gdb_mcp_server_set_default_gdb_path (server, mock_gdb_path);
+    gdb_mcp_server_set_share_sessions (server, TRUE);
+    manager = gdb_mcp_server_get_session_manager (server);
+    gdb_session_manager_set_default_timeout_ms (manager, 1000);
+    g_assert_true (gdb_mcp_server_listen_socket (server, path, &error));
+    g_assert_no_error (error);
+
+    socket_client = g_socket_client_new ();
+    address = g_unix_socket_address_new (path);
+    connection = g_socket_client_connect (socket_client, G_SOCKET_CONNECTABLE (address),
+                                          NULL, &error);
+    g_assert_no_error (error);
+    output = g_io_stream_get_output_stream (G_IO_STREAM (connection));
+    input = g_data_input_stream_new (g_io_stream_get_input_stream (G_IO_STREAM (connection)));
+
+    request = g_strconcat (INITIALIZE_REQUEST, "\n", NULL);
+    g_assert_true (g_output_stream_write_all (output, request, strlen (request),
+                                              NULL, NULL, &error));
+    line = socket_read_line (input);
+    g_assert_nonnull (strstr (line, "\"id\":1"));
+
+    for (i = 2; i <= 4; i++)
+    {
+        socket_call (output, i, "gdb_start", "{}");
+        socket_collect_replies (input, 1, arrived);
+    }
+
+    sessions = gdb_session_manager_list_sessions (manager);
+    g_assert_cmpuint (g_list_length (sessions), ==, 3);
+    args_a = g_strdup_printf ("{\"sessionId\":\"%s\",\"command\":\"-exec-until 99\"}",
+                              gdb_session_get_session_id (sessions->data));
+    args_b = g_strdup_printf ("{\"sessionId\":\"%s\",\"command\":\"-exec-until 99\"}",
+                              gdb_session_get_session_id (sessions->next->data));
+    args_c = g_strdup_printf ("{\"sessionId\":\"%s\",\"command\":\"-exec-until 99\"}",
+                              gdb_session_get_session_id (sessions->next->next->data));
+    list_c = g_strdup_printf ("{\"sessionId\":\"%s\"}",
+                              gdb_session_get_session_id (sessions->next->next->data));
+    wait_a = g_strdup_printf ("{\"sessionId\":\"%s\",\"timeoutMs\":600000}",
+                              gdb_session_get_session_id (sessions->data));
+    g_list_free_full (sessions, g_object_unref);
+
+    /* The mock target keeps running, so each call lasts until its one
+     * second command timeout. On two sessions they overlap...
+     */
+    start = g_get_monotonic_time ();
+    socket_call (output, 5, "gdb_command", args_a);
+    socket_call (output, 6, "gdb_command", args_b);
+    socket_collect_replies (input, 2, arrived);
+    g_assert_cmpint (arrived[5] - start, <, 1800 * G_TIME_SPAN_MILLISECOND);
+    g_assert_cmpint (arrived[6] - start, <, 1800 * G_TIME_SPAN_MILLISECOND);
+
+    /* ...while a quick call naming the same session waits for the slow
+     * one; without a session it does not.
+     */
+    start = g_get_monotonic_time ();
+    socket_call (output, 7, "gdb_command", args_c);
+    socket_call (output, 8, "gdb_list_sessions", list_c);
+    socket_call (output, 9, "gdb_list_sessions", "{}");
+    socket_collect_replies (input, 3, arrived);
+    g_assert_cmpint (arrived[7] - start, >=, 900 * G_TIME_SPAN_MILLISECOND);
+    g_assert_cmpint (arrived[8] - start, >=, 900 * G_TIME_SPAN_MILLISECOND);
+    g_assert_cmpint (arrived[9] - start, <, 500 * G_TIME_SPAN_MILLISECOND);
+
+    /* A wait without a practical deadline does not hold up shutdown */
+    socket_call (output, 10, "gdb_wait_for_stop", wait_a);
+    start = g_get_monotonic_time ();
+    while (g_get_monotonic_time () - start < 200 * G_TIME_SPAN_MILLISECOND)
+    {
+        g_main_context_iteration (NULL, FALSE);
+        g_usleep (1000);
+    }
+
+    start = g_get_monotonic_time ();
+    g_clear_object (&server);
+    g_assert_cmpint (g_get_monotonic_time () - start, <, 5 * G_USEC_PER_SEC);
+
+    g_io_stream_close (G_IO_STREAM (connection), NULL, NULL);
+    g_rmdir (dir);
+}
+
 /* ========================================================================== */
 /* Main                                                                       */
 /* ========================================================================== */
@@ -280,8 +1029,31 @@ int
 main (int   argc,
       char *argv[])
 {
+    g_autofree gchar *test_dir = NULL;
+    int result;
+
     g_test_init (&argc, &argv, NULL);
 
+    /* As in main.c: clients that hang up must not kill the test */
+    signal (SIGPIPE, SIG_IGN);
+
+    /* Find mock-gdb.sh path */
+    test_dir = g_path_get_dirname (argv[0]);
+    if (g_str_has_suffix (test_dir, "build"))
+    {
+        /* Running from build directory */
+        mock_gdb_path = g_build_filename (test_dir, "..", "tests", "mock-gdb.sh", NULL);
+    }
+    else
+    {
+        mock_gdb_path = g_build_filename (test_dir, "mock-gdb.sh", NULL);
+    }
+
+    if (!g_file_test (mock_gdb_path, G_FILE_TEST_IS_EXECUTABLE))
+    {
+        g_clear_pointer (&mock_gdb_path, g_free);
+    }
+
     /* Construction tests */
     g_test_add_func ("/gdb/mcp-server/new", test_mcp_server_new);
     g_test_add_func ("/gdb/mcp-server/new-custom-name", test_mcp_server_new_custom_name);
@@ -291,6 +1063,7 @@ main (int   argc,
     g_test_add_func ("/gdb/mcp-server/properties/version", test_mcp_server_properties_version);
     g_test_add_func ("/gdb/mcp-server/properties/session-manager", test_mcp_server_properties_session_manager);
     g_test_add_func ("/gdb/mcp-server/properties/default-gdb-path", test_mcp_server_properties_default_gdb_path);
+    g_test_add_func ("/gdb/mcp-server/properties/max-workers", test_mcp_server_properties_max_workers);
 
     /* Session manager accessor tests */
     g_test_add_func ("/gdb/mcp-server/get-session-manager", test_mcp_server_get_session_manager);
@@ -305,6 +1078,18 @@ main (int   argc,
     /* Lifecycle tests */
     g_test_add_func ("/gdb/mcp-server/stop-not-running", test_mcp_server_stop_not_running);
 
+    /* HTTP transport tests */
+    g_test_add_func ("/gdb/mcp-server/listen/invalid-address", test_mcp_server_listen_invalid_address);
+    g_test_add_func ("/gdb/mcp-server/listen/clients", test_mcp_server_listen_clients);
+    g_test_add_func ("/gdb/mcp-server/listen/origin-host", test_mcp_server_listen_origin_host);
+
+    /* Socket transport tests */
+    g_test_add_func ("/gdb/mcp-server/properties/share-sessions", test_mcp_server_properties_share_sessions);
+    g_test_add_func ("/gdb/mcp-server/listen-socket", test_mcp_server_listen_socket);
+    g_test_add_func ("/gdb/mcp-server/listen-socket/stale", test_mcp_server_listen_socket_stale);
+    g_test_add_func ("/gdb/mcp-server/listen-socket/out-of-order", test_mcp_server_listen_socket_out_of_order);
+    g_test_add_func ("/gdb/mcp-server/dispatch/sessions", test_mcp_server_dispatch_sessions);
+
     /* Type tests */
     g_test_add_func ("/gdb/mcp-server/type", test_mcp_server_type);
     g_test_add_func ("/gdb/mcp-server/type-name", test_mcp_server_type_name);
@@ -312,5 +1097,8 @@ main (int   argc,
     /* Reference counting tests */
     g_test_add_func ("/gdb/mcp-server/ref-unref", test_mcp_server_ref_unref);
 
-    return g_test_run ();
+    result = g_test_run ();
+    g_free (mock_gdb_path);
+
+    return result;
 }
@@ -9,6 +9,8 @@
  */
 
 #include <stdio.h>
+#include <string.h>
+#include <unistd.h>
 
 /*
  * add:
@@ -64,8 +66,24 @@ factorial (int n)
     return n * factorial (n - 1);
 }
 
+/*
+ * spin:
+ *
+ * Runs until interrupted, for tests that need a target which never
+ * stops on its own.
+ */
+static void
+spin (void)
+{
+    for (;;)
+    {
+        sleep (1);
+    }
+}
+
 int
-main (void)
+main (int   argc,
+      char *argv[])
 {
     int x;
     int y;
@@ -73,6 +91,11 @@ main (void)
     int product;
     int fact;
 
+    if (argc > 1 && strcmp (argv[1], "spin") == 0)
+    {
+        spin ();
+    }
+
     x = 3;
     y = 4;
 
@@ -8,6 +8,12 @@
 #include <glib.h>
 #include "mcp-gdb/gdb-session-manager.h"
 
+/* Path to mock GDB script */
+static gchar *mock_gdb_path = NULL;
+
+static void wait_for_pool (GdbSessionManager *manager,
+                           guint              count);
+
 /* ========================================================================== */
 /* Construction Tests                                                         */
 /* ========================================================================== */
@@ -66,6 +72,22 @@ test_session_manager_properties (void)
 
     /* Session count (should be 0 initially) */
     g_assert_cmpuint (gdb_session_manager_get_session_count (manager), ==, 0);
+
+    /* Warm pool is disabled by default */
+    g_assert_cmpuint (gdb_session_manager_get_pool_size (manager), ==, 0);
+    g_assert_cmpuint (gdb_session_manager_get_pool_count (manager), ==, 0);
+
+    /* Eviction is disabled by default */
+    g_assert_cmpuint (gdb_session_manager_get_idle_timeout (manager), ==, 0);
+    g_assert_cmpuint (gdb_session_manager_get_max_sessions (manager), ==, 0);
+    g_assert_cmpuint (gdb_session_manager_get_memory_budget (manager), ==, 0);
+
+    gdb_session_manager_set_idle_timeout (manager, 600);
+    gdb_session_manager_set_max_sessions (manager, 8);
+    gdb_session_manager_set_memory_budget (manager, G_GUINT64_CONSTANT (4) << 30);
+    g_assert_cmpuint (gdb_session_manager_get_idle_timeout (manager), ==, 600);
+    g_assert_cmpuint (gdb_session_manager_get_max_sessions (manager), ==, 8);
+    g_assert_cmpuint (gdb_session_manager_get_memory_budget (manager), ==, G_GUINT64_CONSTANT (4) << 30);
 }
 
 
@@ -125,6 +147,19 @@ test_session_manager_create_with_options (void)
 /* Session Lookup Tests                                                       */
 /* ========================================================================== */
 
+/* Whether @session_id currently names @expected (%NULL: nothing) */
+static gboolean
+lookup_is (GdbSessionManager *manager,
+           const gchar       *session_id,
+           GdbSession        *expected)
+{
+    g_autoptr(GdbSession) found = NULL;
+
+    found = gdb_session_manager_lookup_session (manager, session_id);
+
+    return found == expected;
+}
+
 static void
 test_session_manager_get_session (void)
 {
@@ -138,12 +173,97 @@ test_session_manager_get_session (void)
     session = gdb_session_manager_create_session (manager, NULL, NULL);
     id = gdb_session_get_session_id (session);
 
+    /* Deprecated, but still has to work */
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS
     found = gdb_session_manager_get_session (manager, id);
+    G_GNUC_END_IGNORE_DEPRECATIONS
     g_assert_true (found == session);
 
     g_object_unref (session);
 }
 
+static void
+test_session_manager_lookup_session (void)
+{
+    g_autoptr(GdbSessionManager) manager = NULL;
+    g_autoptr(GdbSession) found = NULL;
+    g_autofree gchar *id = NULL;
+    GdbSession *session;
+
+    manager = gdb_session_manager_new ();
+
+    session = gdb_session_manager_create_session (manager, NULL, NULL);
+    id = g_strdup (gdb_session_get_session_id (session));
+    g_object_unref (session);
+
+    found = gdb_session_manager_lookup_session (manager, id);
+    g_assert_nonnull (found);
+    g_assert_null (gdb_session_manager_lookup_session (manager, "nonexistent-session"));
+
+    /* The reference outlives removal */
+    g_assert_true (gdb_session_manager_remove_session (manager, id));
+    g_assert_true (lookup_is (manager, id, NULL));
+    g_assert_true (GDB_IS_SESSION (found));
+    g_assert_cmpstr (gdb_session_get_session_id (found), ==, id);
+}
+
+static void
+test_session_manager_handle_parse (void)
+{
+    GdbSessionHandle handle;
+    g_autofree gchar *id = NULL;
+
+    g_assert_true (gdb_session_handle_parse ("3-7", &handle));
+    id = gdb_session_handle_to_string (handle);
+    g_assert_cmpstr (id, ==, "3-7");
+
+    /* Malformed IDs and generation 0 are rejected */
+    g_assert_false (gdb_session_handle_parse ("nonexistent", &handle));
+    g_assert_cmpuint (handle, ==, GDB_SESSION_HANDLE_INVALID);
+    g_assert_false (gdb_session_handle_parse ("3-0", &handle));
+    g_assert_false (gdb_session_handle_parse ("-1", &handle));
+    g_assert_false (gdb_session_handle_parse ("3-x", &handle));
+    g_assert_false (gdb_session_handle_parse ("3-7x", &handle));
+    g_assert_false (gdb_session_handle_parse ("3-+7", &handle));
+    g_assert_false (gdb_session_handle_parse (" 3-7", &handle));
+    g_assert_false (gdb_session_handle_parse ("4294967296-1", &handle));
+    g_assert_false (gdb_session_handle_parse (NULL, &handle));
+}
+
+static void
+test_session_manager_stale_handle (void)
+{
+    g_autoptr(GdbSessionManager) manager = NULL;
+    g_autoptr(GdbSession) reused = NULL;
+    g_autoptr(GdbSession) found = NULL;
+    g_autofree gchar *old_id = NULL;
+    GdbSessionHandle old_handle;
+    GdbSessionHandle new_handle;
+    GdbSession *session;
+
+    manager = gdb_session_manager_new ();
+
+    session = gdb_session_manager_create_session (manager, NULL, NULL);
+    old_id = g_strdup (gdb_session_get_session_id (session));
+    g_object_unref (session);
+    g_assert_true (gdb_session_manager_remove_session (manager, old_id));
+
+    /* The freed slot is reused under a new generation */
+    reused = gdb_session_manager_create_session (manager, NULL, NULL);
+    g_assert_true (gdb_session_handle_parse (old_id, &old_handle));
+    g_assert_true (gdb_session_handle_parse (gdb_session_get_session_id (reused), &new_handle));
+    g_assert_cmpuint (old_handle & G_MAXUINT32, ==, new_handle & G_MAXUINT32);
+    g_assert_cmpuint (old_handle, !=, new_handle);
+
+    /* The old ID no longer names anything */
+    g_assert_true (lookup_is (manager, old_id, NULL));
+    g_assert_null (gdb_session_manager_lookup_handle (manager, old_handle));
+    g_assert_false (gdb_session_manager_remove_session (manager, old_id));
+
+    found = gdb_session_manager_lookup_handle (manager, new_handle);
+    g_assert_true (found == reused);
+}
+
 static void
 test_session_manager_get_session_not_found (void)
 {
@@ -152,7 +272,9 @@ test_session_manager_get_session_not_found (void)
 
     manager = gdb_session_manager_new ();
 
+    G_GNUC_BEGIN_IGNORE_DEPRECATIONS
     found = gdb_session_manager_get_session (manager, "nonexistent-session");
+    G_GNUC_END_IGNORE_DEPRECATIONS
     g_assert_null (found);
 }
 
@@ -182,7 +304,7 @@ test_session_manager_remove_session (void)
     g_assert_cmpuint (gdb_session_manager_get_session_count (manager), ==, 0);
 
     /* Should not be found anymore */
-    g_assert_null (gdb_session_manager_get_session (manager, id));
+    g_assert_true (lookup_is (manager, id, NULL));
 
     g_free ((gchar *)id);
 }
@@ -332,6 +454,388 @@ test_session_manager_terminate_all (void)
 }
 
 
+
+/* ========================================================================== */
+/* Eviction Tests                                                             */
+/* ========================================================================== */
+
+static void
+test_session_manager_evict_max_sessions (void)
+{
+    g_autoptr(GdbSessionManager) manager = NULL;
+    g_autoptr(GdbSession) oldest = NULL;
+    g_autoptr(GdbSession) middle = NULL;
+    g_autoptr(GdbSession) newest = NULL;
+    g_autofree gchar *oldest_id = NULL;
+    gint remove_count = 0;
+
+    manager = gdb_session_manager_new ();
+    gdb_session_manager_set_max_sessions (manager, 2);
+
+    g_signal_connect (manager, "session-removed",
+                      G_CALLBACK (on_session_removed), &remove_count);
+
+    oldest = gdb_session_manager_create_session (manager, NULL, NULL);
+    oldest_id = g_strdup (gdb_session_get_session_id (oldest));
+    g_usleep (1000);
+    middle = gdb_session_manager_create_session (manager, NULL, NULL);
+    g_usleep (1000);
+    newest = gdb_session_manager_create_session (manager, NULL, NULL);
+
+    /* The least recently used session made room */
+    g_assert_cmpuint (gdb_session_manager_get_session_count (manager), ==, 2);
+    g_assert_cmpint (remove_count, ==, 1);
+    g_assert_true (lookup_is (manager, oldest_id, NULL));
+    g_assert_true (lookup_is (manager, gdb_session_get_session_id (middle), middle));
+
+    /* Lowering the limit evicts on the next pass */
+    gdb_session_manager_set_max_sessions (manager, 1);
+    g_assert_cmpuint (gdb_session_manager_reap (manager), ==, 1);
+    g_assert_true (lookup_is (manager, gdb_session_get_session_id (newest), newest));
+}
+
+static void
+test_session_manager_evict_shared_limits (void)
+{
+    g_autoptr(GdbSessionManager) manager = NULL;
+    g_autoptr(GdbSessionManager) first = NULL;
+    g_autoptr(GdbSessionManager) second = NULL;
+    g_autoptr(GdbSession) oldest = NULL;
+    g_autoptr(GdbSession) middle = NULL;
+    g_autoptr(GdbSession) newest = NULL;
+    g_autofree gchar *oldest_id = NULL;
+    gint remove_count = 0;
+
+    manager = gdb_session_manager_new ();
+    first = gdb_session_manager_new_sharing_limits (manager);
+    second = gdb_session_manager_new_sharing_limits (first);
+
+    /* Set on one, the limit holds for all */
+    gdb_session_manager_set_max_sessions (second, 2);
+    g_assert_cmpuint (gdb_session_manager_get_max_sessions (manager), ==, 2);
+    g_assert_cmpuint (gdb_session_manager_get_max_sessions (first), ==, 2);
+
+    g_signal_connect (first, "session-removed",
+                      G_CALLBACK (on_session_removed), &remove_count);
+
+    oldest = gdb_session_manager_create_session (first, NULL, NULL);
+    oldest_id = g_strdup (gdb_session_get_session_id (oldest));
+    g_usleep (1000);
+    middle = gdb_session_manager_create_session (second, NULL, NULL);
+    g_usleep (1000);
+    newest = gdb_session_manager_create_session (second, NULL, NULL);
+
+    /* The least recently used session of either made room */
+    g_assert_cmpuint (gdb_session_manager_get_session_count (first), ==, 0);
+    g_assert_cmpuint (gdb_session_manager_get_session_count (second), ==, 2);
+    g_assert_cmpint (remove_count, ==, 1);
+    g_assert_true (lookup_is (first, oldest_id, NULL));
+
+    /* A manager that is gone no longer counts */
+    g_clear_object (&second);
+    g_clear_object (&middle);
+    g_clear_object (&newest);
+    g_clear_object (&oldest);
+    oldest = gdb_session_manager_create_session (first, NULL, NULL);
+    g_assert_cmpuint (gdb_session_manager_reap (manager), ==, 0);
+    g_assert_cmpuint (gdb_session_manager_get_session_count (first), ==, 1);
+}
+
+static void
+test_session_manager_evict_idle (void)
+{
+    g_autoptr(GdbSessionManager) manager = NULL;
+    g_autoptr(GdbSession) session = NULL;
+    gint remove_count = 0;
+
+    manager = gdb_session_manager_new ();
+
+    g_signal_connect (manager, "session-removed",
+                      G_CALLBACK (on_session_removed), &remove_count);
+
+    session = gdb_session_manager_create_session (manager, NULL, NULL);
+
+    /* Not idle for long enough yet */
+    gdb_session_manager_set_idle_timeout (manager, 1);
+    g_assert_cmpuint (gdb_session_manager_reap (manager), ==, 0);
+
+    g_usleep (1100 * 1000);
+    g_assert_cmpuint (gdb_session_manager_reap (manager), ==, 1);
+    g_assert_cmpuint (gdb_session_manager_get_session_count (manager), ==, 0);
+    g_assert_cmpint (remove_count, ==, 1);
+}
+
+static void
+test_session_manager_evict_memory (void)
+{
+    g_autoptr(GdbSessionManager) manager = NULL;
+    g_autoptr(GdbSession) session = NULL;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    /* A started session from the pool has a process to measure */
+    manager = gdb_session_manager_new ();
+    gdb_session_manager_set_default_gdb_path (manager, mock_gdb_path);
+    gdb_session_manager_set_pool_size (manager, 1);
+    wait_for_pool (manager, 1);
+    gdb_session_manager_set_pool_size (manager, 0);
+
+    session = gdb_session_manager_create_session (manager, NULL, NULL);
+    g_assert_cmpint (gdb_session_get_state (session), ==, GDB_SESSION_STATE_READY);
+    g_assert_cmpuint (gdb_session_get_rss (session), >, 0);
+
+    gdb_session_manager_set_memory_budget (manager, G_GUINT64_CONSTANT (1) << 40);
+    g_assert_cmpuint (gdb_session_manager_reap (manager), ==, 0);
+
+    gdb_session_manager_set_memory_budget (manager, 1);
+    g_assert_cmpuint (gdb_session_manager_reap (manager), ==, 1);
+    g_assert_cmpuint (gdb_session_manager_get_session_count (manager), ==, 0);
+}
+
+/* ========================================================================== */
+/* Lock-free Lookup Tests                                                     */
+/* ========================================================================== */
+
+typedef struct {
+    GdbSessionManager *manager;
+    GdbSession        *session;
+    const gchar       *session_id;
+    gint               stop;
+    gint               misses;
+} LookupData;
+
+static gpointer
+lookup_thread (gpointer user_data)
+{
+    LookupData *data = (LookupData *)user_data;
+
+    while (!g_atomic_int_get (&data->stop))
+    {
+        if (!lookup_is (data->manager, data->session_id, data->session))
+        {
+            g_atomic_int_inc (&data->misses);
+        }
+        gdb_session_manager_get_session_count (data->manager);
+    }
+
+    return NULL;
+}
+
+static void
+on_session_finalized (gpointer  user_data,
+                      GObject  *where_the_object_was)
+{
+    g_atomic_int_inc ((gint *)user_data);
+}
+
+static void
+test_session_manager_lookup_concurrent (void)
+{
+    g_autoptr(GdbSessionManager) manager = NULL;
+    g_autoptr(GdbSession) session = NULL;
+    GThread *threads[4];
+    LookupData data;
+    gint finalized = 0;
+    guint i;
+
+    manager = gdb_session_manager_new ();
+    session = gdb_session_manager_create_session (manager, NULL, NULL);
+
+    data.manager = manager;
+    data.session = session;
+    data.session_id = gdb_session_get_session_id (session);
+    data.stop = 0;
+    data.misses = 0;
+
+    for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    {
+        threads[i] = g_thread_new ("lookup", lookup_thread, &data);
+    }
+
+    /* Churn the table while lookups run without the mutex */
+    for (i = 0; i < 200; i++)
+    {
+        g_autoptr(GdbSession) other = NULL;
+        g_autofree gchar *other_id = NULL;
+
+        other = gdb_session_manager_create_session (manager, NULL, NULL);
+        g_object_weak_ref (G_OBJECT (other), on_session_finalized, &finalized);
+        other_id = g_strdup (gdb_session_get_session_id (other));
+        g_assert_true (gdb_session_manager_remove_session (manager, other_id));
+    }
+
+    g_atomic_int_set (&data.stop, 1);
+    for (i = 0; i < G_N_ELEMENTS (threads); i++)
+    {
+        g_thread_join (threads[i]);
+    }
+
+    g_assert_cmpint (data.misses, ==, 0);
+    g_assert_cmpuint (gdb_session_manager_get_session_count (manager), ==, 1);
+
+    /* Indexes retired during a lookup were reclaimed by the last reader,
+     * not left holding removed sessions until the next write.
+     */
+    g_assert_cmpint (g_atomic_int_get (&finalized), ==, 200);
+}
+
+
+/* ========================================================================== */
+/* Warm Pool Tests                                                            */
+/* ========================================================================== */
+
+static gboolean
+pool_wait_timeout (gpointer user_data)
+{
+    gboolean *timed_out = (gboolean *)user_data;
+
+    *timed_out = TRUE;
+    return G_SOURCE_REMOVE;
+}
+
+/*
+ * wait_for_pool:
+ *
+ * Iterates the default context until @manager holds @count warm sessions.
+ */
+static void
+wait_for_pool (GdbSessionManager *manager,
+               guint              count)
+{
+    gboolean timed_out = FALSE;
+    guint timeout_id;
+
+    timeout_id = g_timeout_add (5000, pool_wait_timeout, &timed_out);
+    while (!timed_out && gdb_session_manager_get_pool_count (manager) < count)
+    {
+        g_main_context_iteration (NULL, TRUE);
+    }
+    if (!timed_out)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_cmpuint (gdb_session_manager_get_pool_count (manager), ==, count);
+}
+
+static void
+test_session_manager_pool (void)
+{
+    g_autoptr(GdbSessionManager) manager = NULL;
+    g_autoptr(GdbSession) warm = NULL;
+    g_autoptr(GdbSession) cold = NULL;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    manager = gdb_session_manager_new ();
+    gdb_session_manager_set_default_gdb_path (manager, mock_gdb_path);
+    gdb_session_manager_set_pool_size (manager, 1);
+    g_assert_cmpuint (gdb_session_manager_get_pool_size (manager), ==, 1);
+
+    /* The pool fills in the background */
+    wait_for_pool (manager, 1);
+    g_assert_cmpuint (gdb_session_manager_get_session_count (manager), ==, 0);
+
+    /* A default session comes from the pool, already started */
+    warm = gdb_session_manager_create_session (manager, NULL, NULL);
+    g_assert_cmpint (gdb_session_get_state (warm), ==, GDB_SESSION_STATE_READY);
+    g_assert_cmpuint (gdb_session_manager_get_pool_count (manager), ==, 0);
+    g_assert_cmpuint (gdb_session_manager_get_session_count (manager), ==, 1);
+    g_assert_true (lookup_is (manager, gdb_session_get_session_id (warm), warm));
+
+    /* A custom working directory bypasses the pool */
+    cold = gdb_session_manager_create_session (manager, NULL, "/tmp");
+    g_assert_cmpint (gdb_session_get_state (cold), ==, GDB_SESSION_STATE_DISCONNECTED);
+
+    /* Taking a session triggers a refill */
+    wait_for_pool (manager, 1);
+
+    gdb_session_manager_set_pool_size (manager, 0);
+    g_assert_cmpuint (gdb_session_manager_get_pool_count (manager), ==, 0);
+
+    gdb_session_manager_terminate_all (manager);
+}
+
+#define N_STARTED_SESSIONS 16
+
+static void
+test_session_manager_terminate_all_started (void)
+{
+    g_autoptr(GdbSessionManager) manager = NULL;
+    GdbSession *sessions[N_STARTED_SESSIONS];
+    gint remove_count = 0;
+    gboolean timed_out = FALSE;
+    guint timeout_id;
+    gint64 start_time;
+    gint64 elapsed;
+    guint n_running;
+    gint i;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    /* Take started sessions from the pool */
+    manager = gdb_session_manager_new ();
+    gdb_session_manager_set_default_gdb_path (manager, mock_gdb_path);
+    gdb_session_manager_set_pool_size (manager, N_STARTED_SESSIONS);
+    wait_for_pool (manager, N_STARTED_SESSIONS);
+    gdb_session_manager_set_pool_size (manager, 0);
+
+    for (i = 0; i < N_STARTED_SESSIONS; i++)
+    {
+        sessions[i] = gdb_session_manager_create_session (manager, NULL, NULL);
+        g_assert_cmpint (gdb_session_get_state (sessions[i]), ==, GDB_SESSION_STATE_READY);
+    }
+
+    g_signal_connect (manager, "session-removed",
+                      G_CALLBACK (on_session_removed), &remove_count);
+
+    start_time = g_get_monotonic_time ();
+    gdb_session_manager_terminate_all (manager);
+    g_assert_cmpuint (gdb_session_manager_get_session_count (manager), ==, 0);
+    g_assert_cmpint (remove_count, ==, N_STARTED_SESSIONS);
+
+    /* All sessions share one deadline */
+    timeout_id = g_timeout_add (5000, pool_wait_timeout, &timed_out);
+    do
+    {
+        n_running = 0;
+        for (i = 0; i < N_STARTED_SESSIONS; i++)
+        {
+            if (gdb_session_get_state (sessions[i]) != GDB_SESSION_STATE_TERMINATED)
+            {
+                n_running++;
+            }
+        }
+    }
+    while (n_running > 0 && !timed_out && g_main_context_iteration (NULL, TRUE));
+    elapsed = g_get_monotonic_time () - start_time;
+    if (!timed_out)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_cmpuint (n_running, ==, 0);
+    g_assert_cmpint (elapsed, <, 2 * G_USEC_PER_SEC);
+
+    for (i = 0; i < N_STARTED_SESSIONS; i++)
+    {
+        g_object_unref (sessions[i]);
+    }
+}
+
+
 /* ========================================================================== */
 /* Concurrent Sessions Tests                                                  */
 /* ========================================================================== */
@@ -382,8 +886,28 @@ int
 main (int   argc,
       char *argv[])
 {
+    g_autofree gchar *test_dir = NULL;
+    int result;
+
     g_test_init (&argc, &argv, NULL);
 
+    /* Find mock-gdb.sh path */
+    test_dir = g_path_get_dirname (argv[0]);
+    if (g_str_has_suffix (test_dir, "build"))
+    {
+        /* Running from build directory */
+        mock_gdb_path = g_build_filename (test_dir, "..", "tests", "mock-gdb.sh", NULL);
+    }
+    else
+    {
+        mock_gdb_path = g_build_filename (test_dir, "mock-gdb.sh", NULL);
+    }
+
+    if (!g_file_test (mock_gdb_path, G_FILE_TEST_IS_EXECUTABLE))
+    {
+        g_clear_pointer (&mock_gdb_path, g_free);
+    }
+
     /* Construction tests */
     g_test_add_func ("/gdb/session-manager/new", test_session_manager_new);
     g_test_add_func ("/gdb/session-manager/singleton", test_session_manager_singleton);
@@ -397,6 +921,9 @@ main (int   argc,
 
     /* Lookup tests */
     g_test_add_func ("/gdb/session-manager/get-session", test_session_manager_get_session);
+    g_test_add_func ("/gdb/session-manager/lookup-session", test_session_manager_lookup_session);
+    g_test_add_func ("/gdb/session-manager/handle-parse", test_session_manager_handle_parse);
+    g_test_add_func ("/gdb/session-manager/stale-handle", test_session_manager_stale_handle);
     g_test_add_func ("/gdb/session-manager/get-session-not-found", test_session_manager_get_session_not_found);
 
     /* Removal tests */
@@ -417,5 +944,22 @@ main (int   argc,
     /* Concurrent */
     g_test_add_func ("/gdb/session-manager/concurrent", test_session_manager_concurrent);
 
-    return g_test_run ();
+    /* Lock-free lookup */
+    g_test_add_func ("/gdb/session-manager/lookup-concurrent", test_session_manager_lookup_concurrent);
+
+    /* Eviction tests */
+    g_test_add_func ("/gdb/session-manager/evict-max-sessions", test_session_manager_evict_max_sessions);
+    g_test_add_func ("/gdb/session-manager/evict-shared-limits", test_session_manager_evict_shared_limits);
+    g_test_add_func ("/gdb/session-manager/evict-idle", test_session_manager_evict_idle);
+    g_test_add_func ("/gdb/session-manager/evict-memory", test_session_manager_evict_memory);
+
+    /* Warm pool */
+    g_test_add_func ("/gdb/session-manager/pool", test_session_manager_pool);
+    g_test_add_func ("/gdb/session-manager/terminate-all-started", test_session_manager_terminate_all_started);
+
+    result = g_test_run ();
+
+    g_free (mock_gdb_path);
+
+    return result;
 }
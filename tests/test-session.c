@@ -6,6 +6,10 @@
  */
 
 #include <glib.h>
+#include <glib/gstdio.h>
+#include <errno.h>
+#include <signal.h>
+#include <string.h>
 #include "mcp-gdb/gdb-session.h"
 #include "mcp-gdb/gdb-error.h"
 
@@ -98,6 +102,20 @@ test_session_properties (void)
     gdb_session_set_timeout_ms (session, 5000);
     g_assert_cmpuint (gdb_session_get_timeout_ms (session), ==, 5000);
 
+    /* Default and custom queue depth */
+    g_assert_cmpuint (gdb_session_get_max_queue_depth (session), ==, 64);
+    gdb_session_set_max_queue_depth (session, 8);
+    g_assert_cmpuint (gdb_session_get_max_queue_depth (session), ==, 8);
+
+    /* Startup options */
+    g_assert_cmpint (gdb_session_get_startup_profile (session), ==, GDB_STARTUP_PROFILE_DEFAULT);
+    gdb_session_set_startup_profile (session, GDB_STARTUP_PROFILE_FAST);
+    g_assert_cmpint (gdb_session_get_startup_profile (session), ==, GDB_STARTUP_PROFILE_FAST);
+    g_assert_null (gdb_session_get_init_script (session));
+    gdb_session_set_init_script (session, "/tmp/init.gdb");
+    g_assert_cmpstr (gdb_session_get_init_script (session), ==, "/tmp/init.gdb");
+    g_assert_cmpint (gdb_session_get_startup_time (session), ==, -1);
+
     /* Set target program */
     gdb_session_set_target_program (session, "/path/to/prog");
     g_assert_cmpstr (gdb_session_get_target_program (session), ==, "/path/to/prog");
@@ -142,6 +160,8 @@ start_callback (GObject      *source,
     g_main_loop_quit (fixture->loop);
 }
 
+static gboolean fixture_start_session (SessionFixture *fixture);
+
 
 /* ========================================================================== */
 /* Lifecycle Tests                                                            */
@@ -234,6 +254,131 @@ test_session_terminate (SessionFixture *fixture,
     g_assert_cmpint (gdb_session_get_state (fixture->session), ==, GDB_SESSION_STATE_TERMINATED);
 }
 
+static void
+on_terminated_quit_loop (GdbSession *session G_GNUC_UNUSED,
+                         gint        exit_status,
+                         gpointer    user_data)
+{
+    SessionFixture *fixture = (SessionFixture *)user_data;
+
+    fixture->success = (exit_status == 0);
+    g_main_loop_quit (fixture->loop);
+}
+
+static void
+test_session_terminate_on_exit (SessionFixture *fixture,
+                                gconstpointer   user_data G_GNUC_UNUSED)
+{
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+    gint64 start_time;
+    gint64 elapsed;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    gdb_session_start_async (fixture->session, NULL, start_callback, fixture);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_true (fixture->success);
+    fixture->success = FALSE;
+
+    g_signal_connect (fixture->session, "terminated",
+                      G_CALLBACK (on_terminated_quit_loop), fixture);
+
+    /* The mock exits on quit, so cleanup must not wait for the deadline */
+    start_time = g_get_monotonic_time ();
+    gdb_session_terminate (fixture->session);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    elapsed = g_get_monotonic_time () - start_time;
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_true (fixture->success);
+    g_assert_cmpint (gdb_session_get_state (fixture->session), ==, GDB_SESSION_STATE_TERMINATED);
+    g_assert_cmpint (elapsed, <, 400 * 1000);
+}
+
+
+static void
+test_session_unref_stops_gdb (SessionFixture *fixture,
+                              gconstpointer   user_data G_GNUC_UNUSED)
+{
+    g_autoptr(GError) error = NULL;
+    g_autofree gchar *dir = NULL;
+    g_autofree gchar *pid_gdb = NULL;
+    g_autofree gchar *pid_file = NULL;
+    g_autofree gchar *script = NULL;
+    g_autofree gchar *contents = NULL;
+    GdbSession *session;
+    gint64 deadline;
+    pid_t pid;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    /* A GDB that tells us its pid */
+    dir = g_dir_make_tmp ("gdb-session-test-XXXXXX", &error);
+    g_assert_no_error (error);
+    pid_file = g_build_filename (dir, "gdb.pid", NULL);
+    pid_gdb = g_build_filename (dir, "pid-gdb.sh", NULL);
+    script = g_strdup_printf ("#!/bin/sh\necho $$ > '%s'\nexec '%s' \"$@\"\n",
+                              pid_file, mock_gdb_path);
+    g_assert_true (g_file_set_contents (pid_gdb, script, -1, &error));
+    g_assert_cmpint (g_chmod (pid_gdb, 0755), ==, 0);
+
+    g_object_unref (fixture->session);
+    fixture->session = gdb_session_new ("unref-session", pid_gdb, NULL);
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    g_assert_true (g_file_get_contents (pid_file, &contents, NULL, &error));
+    pid = (pid_t) g_ascii_strtoll (contents, NULL, 10);
+    g_assert_cmpint (pid, >, 0);
+
+    /* Dropping the last reference without terminating stops GDB */
+    session = g_steal_pointer (&fixture->session);
+    g_object_add_weak_pointer (G_OBJECT (session), (gpointer *) &session);
+    g_object_unref (session);
+
+    /* Finalized at once; nothing revives it while GDB quits */
+    g_assert_null (session);
+
+    deadline = g_get_monotonic_time () + 5 * G_TIME_SPAN_SECOND;
+    while (kill (pid, 0) == 0 && g_get_monotonic_time () < deadline)
+    {
+        g_main_context_iteration (NULL, FALSE);
+        g_usleep (10 * 1000);
+    }
+
+    g_assert_cmpint (kill (pid, 0), ==, -1);
+    g_assert_cmpint (errno, ==, ESRCH);
+
+    g_unlink (pid_gdb);
+    g_unlink (pid_file);
+    g_rmdir (dir);
+}
 
 /* ========================================================================== */
 /* State Tests                                                                */
@@ -415,79 +560,1380 @@ test_session_execute_command (SessionFixture *fixture,
     g_clear_error (&data.error);
 }
 
+/*
+ * fixture_start_session:
+ * @fixture: the fixture
+ *
+ * Starts the fixture session against the mock GDB and spins the loop
+ * until startup completes.
+ *
+ * Returns: %TRUE if the session is ready
+ */
+static gboolean
+fixture_start_session (SessionFixture *fixture)
+{
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
 
-/* ========================================================================== */
-/* Main                                                                       */
-/* ========================================================================== */
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
 
-int
-main (int   argc,
-      char *argv[])
+    gdb_session_start_async (fixture->session, NULL, start_callback, fixture);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    return fixture->success;
+}
+
+static void
+test_session_execute_framed (SessionFixture *fixture,
+                             gconstpointer   user_data G_GNUC_UNUSED)
 {
-    g_autofree gchar *test_dir = NULL;
-    int result;
+    ExecuteData data = { fixture->loop, NULL, NULL };
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+    gint64 start_time;
 
-    g_test_init (&argc, &argv, NULL);
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
 
-    /* Find mock-gdb.sh path */
-    test_dir = g_path_get_dirname (argv[0]);
-    if (g_str_has_suffix (test_dir, "build"))
+    if (!fixture_start_session (fixture))
     {
-        /* Running from build directory */
-        mock_gdb_path = g_build_filename (test_dir, "..", "tests", "mock-gdb.sh", NULL);
+        g_test_skip ("Could not start session");
+        return;
     }
-    else
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    /* Completion is driven by the tagged result and prompt, not a delay */
+    start_time = g_get_monotonic_time ();
+    gdb_session_execute_async (fixture->session, "help", NULL,
+                               execute_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
     {
-        mock_gdb_path = g_build_filename (test_dir, "mock-gdb.sh", NULL);
+        g_source_remove (timeout_id);
     }
 
-    if (!g_file_test (mock_gdb_path, G_FILE_TEST_IS_EXECUTABLE))
+    g_assert_no_error (data.error);
+    g_assert_nonnull (data.output);
+    g_assert_cmpint (g_get_monotonic_time () - start_time, <, G_USEC_PER_SEC);
+
+    /* Console output preceding our result belongs to us */
+    g_assert_nonnull (strstr (data.output, "List of classes of commands"));
+    g_assert_nonnull (strstr (data.output, "^done"));
+    g_free (data.output);
+}
+
+/*
+ * fixture_execute:
+ * @fixture: the fixture, with a started session
+ * @command: the command
+ *
+ * Runs @command and spins the loop until it completes.
+ *
+ * Returns: (transfer full): the command's output
+ */
+static gchar *
+fixture_execute (SessionFixture *fixture,
+                 const gchar    *command)
+{
+    ExecuteData data = { fixture->loop, NULL, NULL };
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    gdb_session_execute_async (fixture->session, command, NULL,
+                               execute_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
     {
-        g_free (mock_gdb_path);
-        mock_gdb_path = NULL;
-        g_message ("Mock GDB script not found or not executable - some tests will be skipped");
+        g_source_remove (timeout_id);
     }
 
-    /* Construction tests */
-    g_test_add_func ("/gdb/session/new", test_session_new);
-    g_test_add_func ("/gdb/session/new-defaults", test_session_new_defaults);
-    g_test_add_func ("/gdb/session/properties", test_session_properties);
+    g_assert_no_error (data.error);
+    g_assert_nonnull (data.output);
 
-    /* State tests */
-    g_test_add_func ("/gdb/session/initial-state", test_session_initial_state);
-    g_test_add_func ("/gdb/session/start-invalid-path", test_session_start_invalid_path);
+    return data.output;
+}
 
-    /* Lifecycle tests with fixture */
-    g_test_add ("/gdb/session/start",
-                SessionFixture, NULL,
-                session_fixture_setup,
-                test_session_start,
-                session_fixture_teardown);
+static void
+test_session_reader_split_record (SessionFixture *fixture,
+                                  gconstpointer   user_data G_GNUC_UNUSED)
+{
+    g_autofree gchar *output = NULL;
 
-    g_test_add ("/gdb/session/terminate",
-                SessionFixture, NULL,
-                session_fixture_setup,
-                test_session_terminate,
-                session_fixture_teardown);
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
 
-    /* Signal tests */
-    g_test_add ("/gdb/session/signal-state-changed",
-                SessionFixture, NULL,
-                session_fixture_setup,
-                test_session_state_signal,
-                session_fixture_teardown);
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
 
-    g_test_add ("/gdb/session/signal-ready",
-                SessionFixture, NULL,
-                session_fixture_setup,
-                test_session_ready_signal,
-                session_fixture_teardown);
+    /* The record and the prompt each arrive in two reads */
+    output = fixture_execute (fixture, "-mock-split-record");
+    g_assert_nonnull (strstr (output, "^done,value=\"split\""));
 
-    /* Execute tests */
-    g_test_add ("/gdb/session/execute-command",
-                SessionFixture, NULL,
-                session_fixture_setup,
-                test_session_execute_command,
+    /* The reader is still in step with GDB */
+    g_free (output);
+    output = fixture_execute (fixture, "-data-evaluate-expression 1");
+    g_assert_nonnull (strstr (output, "value=\"42\""));
+}
+
+static void
+test_session_reader_crlf (SessionFixture *fixture,
+                          gconstpointer   user_data G_GNUC_UNUSED)
+{
+    g_autofree gchar *output = NULL;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    /* The "(gdb)\r" prompt must still end the command */
+    output = fixture_execute (fixture, "-mock-crlf-record");
+    g_assert_nonnull (strstr (output, "^done,value=\"crlf\""));
+    g_assert_null (strchr (output, '\r'));
+
+    g_free (output);
+    output = fixture_execute (fixture, "-data-evaluate-expression 1");
+    g_assert_nonnull (strstr (output, "value=\"42\""));
+}
+
+static void
+test_session_reader_long_line (SessionFixture *fixture,
+                               gconstpointer   user_data G_GNUC_UNUSED)
+{
+    g_autofree gchar *output = NULL;
+    g_autofree gchar *command = NULL;
+    const gchar *value;
+    const gsize length = 200000; /* Past the reader's initial 64 KiB */
+    gsize n_x;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    command = g_strdup_printf ("-mock-long-record %" G_GSIZE_FORMAT, length);
+    output = fixture_execute (fixture, command);
+
+    value = strstr (output, "^done,value=\"");
+    g_assert_nonnull (value);
+    value += strlen ("^done,value=\"");
+    n_x = strspn (value, "x");
+    g_assert_cmpuint (n_x, ==, length);
+    g_assert_cmpint (value[n_x], ==, '"');
+
+    g_free (output);
+    output = fixture_execute (fixture, "-data-evaluate-expression 1");
+    g_assert_nonnull (strstr (output, "value=\"42\""));
+}
+
+static void
+test_session_execute_waits_for_stop (SessionFixture *fixture,
+                                     gconstpointer   user_data G_GNUC_UNUSED)
+{
+    ExecuteData data = { fixture->loop, NULL, NULL };
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    gdb_session_execute_async (fixture->session, "-exec-run", NULL,
+                               execute_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_no_error (data.error);
+    g_assert_nonnull (data.output);
+    g_assert_nonnull (strstr (data.output, "^running"));
+    g_assert_nonnull (strstr (data.output, "*stopped,reason=\"breakpoint-hit\""));
+    g_free (data.output);
+}
+
+typedef struct {
+    GMainLoop *loop;
+    GList     *records;
+    GError    *error;
+} ExecuteMiData;
+
+static void
+execute_mi_callback (GObject      *source,
+                     GAsyncResult *result,
+                     gpointer      user_data)
+{
+    ExecuteMiData *data = (ExecuteMiData *)user_data;
+    data->records = gdb_session_execute_mi_finish (GDB_SESSION (source),
+                                                   result,
+                                                   &data->error);
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_session_execute_mi_token (SessionFixture *fixture,
+                               gconstpointer   user_data G_GNUC_UNUSED)
+{
+    ExecuteMiData data = { fixture->loop, NULL, NULL };
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+    GdbMiRecord *last;
+    gint64 first_token;
+    gint i;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+    first_token = -1;
+
+    /* Each command gets its own, increasing token echoed on its result */
+    for (i = 0; i < 2; i++)
+    {
+        gdb_session_execute_mi_async (fixture->session, "-break-insert main", NULL,
+                                      execute_mi_callback, &data);
+        timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+        g_main_loop_run (fixture->loop);
+        if (timeout_id != 0)
+        {
+            g_source_remove (timeout_id);
+        }
+
+        g_assert_no_error (data.error);
+        g_assert_nonnull (data.records);
+
+        last = (GdbMiRecord *)g_list_last (data.records)->data;
+        g_assert_cmpint (gdb_mi_record_get_type_enum (last), ==, GDB_MI_RECORD_RESULT);
+        g_assert_cmpint (gdb_mi_record_get_result_class (last), ==, GDB_MI_RESULT_DONE);
+        g_assert_cmpint (gdb_mi_record_get_token (last), >, first_token);
+        first_token = gdb_mi_record_get_token (last);
+
+        g_list_free_full (data.records, (GDestroyNotify) gdb_mi_record_unref);
+        data.records = NULL;
+    }
+}
+
+/*
+ * settle_future:
+ * @future: a future
+ *
+ * Iterates the default main context, where the session completes its
+ * tasks, until @future settles or five seconds pass.
+ *
+ * Returns: %TRUE if @future settled
+ */
+static gboolean
+settle_future (DexFuture *future)
+{
+    gint64 deadline = g_get_monotonic_time () + 5 * G_USEC_PER_SEC;
+
+    while (dex_future_is_pending (future) && g_get_monotonic_time () < deadline)
+    {
+        g_main_context_iteration (NULL, FALSE);
+        g_usleep (1000);
+    }
+
+    return !dex_future_is_pending (future);
+}
+
+static void
+test_session_execute_future (SessionFixture *fixture,
+                             gconstpointer   user_data G_GNUC_UNUSED)
+{
+    g_autoptr(GdbSession) unstarted = NULL;
+    DexFuture *future;
+    const GValue *value;
+    GdbCommandResult *result;
+    GError *error = NULL;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    /* The future resolves to the same parsed result as the GTask API */
+    future = gdb_session_execute_result_future (fixture->session, "-break-insert main");
+    g_assert_true (settle_future (future));
+
+    value = dex_future_get_value (future, &error);
+    g_assert_no_error (error);
+    g_assert_true (G_VALUE_HOLDS (value, GDB_TYPE_COMMAND_RESULT));
+    result = g_value_get_boxed (value);
+    g_assert_cmpint (gdb_command_result_get_result_class (result), ==, GDB_MI_RESULT_DONE);
+    dex_unref (future);
+
+    /* Errors reject the future instead of resolving it */
+    unstarted = gdb_session_new ("unstarted", mock_gdb_path, NULL);
+    future = gdb_session_execute_future (unstarted, "help");
+    g_assert_true (settle_future (future));
+
+    value = dex_future_get_value (future, &error);
+    g_assert_null (value);
+    g_assert_error (error, GDB_ERROR, GDB_ERROR_SESSION_NOT_READY);
+    g_clear_error (&error);
+    dex_unref (future);
+}
+
+static void
+test_session_run_futures (SessionFixture *fixture,
+                          gconstpointer   user_data G_GNUC_UNUSED)
+{
+    const gchar *commands[] = { "-break-insert main", "-data-evaluate-expression 6*7", NULL };
+    g_autoptr(GCancellable) cancellable = NULL;
+    g_autofree gchar *output = NULL;
+    DexFuture *future;
+    const GValue *value;
+    GPtrArray *outputs;
+    GAsyncResult *result;
+    GdbStopReason reason = GDB_STOP_REASON_UNKNOWN;
+    guint64 run_id = 0;
+    GError *error = NULL;
+    guint i;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    /* A batch resolves to one output per command */
+    future = gdb_session_execute_batch_future (fixture->session, commands);
+    g_assert_true (settle_future (future));
+
+    value = dex_future_get_value (future, &error);
+    g_assert_no_error (error);
+    g_assert_true (G_VALUE_HOLDS (value, G_TYPE_PTR_ARRAY));
+    outputs = g_value_get_boxed (value);
+    g_assert_cmpuint (outputs->len, ==, 2);
+    dex_unref (future);
+
+    /* Multi-result operations resolve to their GAsyncResult */
+    future = gdb_session_execute_detached_future (fixture->session, "-exec-continue");
+    g_assert_true (settle_future (future));
+
+    value = dex_future_get_value (future, &error);
+    g_assert_no_error (error);
+    result = g_value_get_object (value);
+    output = gdb_session_execute_detached_finish (fixture->session, result, &run_id, &error);
+    g_assert_no_error (error);
+    g_assert_nonnull (output);
+    g_assert_cmpuint (run_id, >, 0);
+    dex_unref (future);
+
+    future = gdb_session_wait_for_stop_future (fixture->session, run_id, NULL);
+    g_assert_true (settle_future (future));
+
+    value = dex_future_get_value (future, &error);
+    g_assert_no_error (error);
+    g_assert_true (gdb_session_wait_for_stop_finish (fixture->session,
+                                                     g_value_get_object (value),
+                                                     &reason, NULL, NULL, &error));
+    g_assert_no_error (error);
+    g_assert_cmpint (reason, ==, GDB_STOP_REASON_EXITED_NORMALLY);
+    dex_unref (future);
+
+    /* A wait that is given up on is released through its cancellable */
+    g_clear_pointer (&output, g_free);
+    future = gdb_session_execute_detached_future (fixture->session, "-exec-until 99");
+    g_assert_true (settle_future (future));
+    value = dex_future_get_value (future, &error);
+    g_assert_no_error (error);
+    output = gdb_session_execute_detached_finish (fixture->session, g_value_get_object (value),
+                                                  &run_id, &error);
+    g_assert_no_error (error);
+    dex_unref (future);
+
+    cancellable = g_cancellable_new ();
+    future = gdb_session_wait_for_stop_future (fixture->session, run_id, cancellable);
+    for (i = 0; i < 50; i++)
+    {
+        g_main_context_iteration (NULL, FALSE);
+        g_usleep (1000);
+    }
+    g_assert_true (dex_future_is_pending (future));
+    g_cancellable_cancel (cancellable);
+    g_assert_true (settle_future (future));
+
+    value = dex_future_get_value (future, &error);
+    g_assert_no_error (error);
+    g_assert_false (gdb_session_wait_for_stop_finish (fixture->session,
+                                                      g_value_get_object (value),
+                                                      NULL, NULL, NULL, &error));
+    g_assert_error (error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_clear_error (&error);
+    dex_unref (future);
+}
+
+typedef struct {
+    GMainLoop   *loop;
+    gint        *remaining;
+    const gchar *expected_func;
+    gboolean     matched;
+    GError      *error;
+} InFlightData;
+
+static void
+in_flight_callback (GObject      *source,
+                    GAsyncResult *result,
+                    gpointer      user_data)
+{
+    InFlightData *data = (InFlightData *)user_data;
+    GList *records;
+    GList *l;
+
+    records = gdb_session_execute_mi_finish (GDB_SESSION (source), result, &data->error);
+
+    for (l = records; l != NULL; l = l->next)
+    {
+        GdbMiRecord *record = (GdbMiRecord *)l->data;
+        JsonObject *results = gdb_mi_record_get_results (record);
+
+        if (gdb_mi_record_get_type_enum (record) == GDB_MI_RECORD_RESULT &&
+            results != NULL && json_object_has_member (results, "bkpt"))
+        {
+            JsonObject *bkpt = json_object_get_object_member (results, "bkpt");
+
+            data->matched = g_strcmp0 (json_object_get_string_member (bkpt, "func"),
+                                       data->expected_func) == 0;
+        }
+    }
+    g_list_free_full (records, (GDestroyNotify) gdb_mi_record_unref);
+
+    if (--(*data->remaining) == 0)
+    {
+        g_main_loop_quit (data->loop);
+    }
+}
+
+static void
+test_session_execute_in_flight (SessionFixture *fixture,
+                                gconstpointer   user_data G_GNUC_UNUSED)
+{
+    const gchar *funcs[] = { "alpha", "beta", "gamma" };
+    InFlightData data[3];
+    gint remaining;
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+    gint i;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    /* Issue all commands before any response is read */
+    remaining = G_N_ELEMENTS (funcs);
+
+    for (i = 0; i < (gint) G_N_ELEMENTS (funcs); i++)
+    {
+        g_autofree gchar *cmd = g_strdup_printf ("-break-insert %s", funcs[i]);
+
+        data[i].loop = fixture->loop;
+        data[i].remaining = &remaining;
+        data[i].expected_func = funcs[i];
+        data[i].matched = FALSE;
+        data[i].error = NULL;
+
+        gdb_session_execute_mi_async (fixture->session, cmd, NULL,
+                                      in_flight_callback, &data[i]);
+    }
+
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_cmpint (remaining, ==, 0);
+
+    /* Every response was routed to the command that produced it */
+    for (i = 0; i < (gint) G_N_ELEMENTS (funcs); i++)
+    {
+        g_assert_no_error (data[i].error);
+        g_assert_true (data[i].matched);
+    }
+}
+
+typedef struct {
+    GMainLoop *loop;
+    GPtrArray *outputs;
+    GError    *error;
+} BatchData;
+
+static void
+batch_callback (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+    BatchData *data = (BatchData *)user_data;
+
+    data->outputs = gdb_session_execute_batch_finish (GDB_SESSION (source), result, &data->error);
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_session_execute_batch (SessionFixture *fixture,
+                            gconstpointer   user_data G_GNUC_UNUSED)
+{
+    const gchar *commands[] = {
+        "-break-insert alpha",
+        "-break-insert beta",
+        "-break-insert gamma",
+        NULL
+    };
+    const gchar *funcs[] = { "func=\"alpha\"", "func=\"beta\"", "func=\"gamma\"" };
+    BatchData data = { fixture->loop, NULL, NULL };
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+    guint i;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    gdb_session_execute_batch_async (fixture->session, commands, NULL,
+                                     batch_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_no_error (data.error);
+    g_assert_nonnull (data.outputs);
+    g_assert_cmpuint (data.outputs->len, ==, G_N_ELEMENTS (funcs));
+
+    /* One output per command, in submission order */
+    for (i = 0; i < G_N_ELEMENTS (funcs); i++)
+    {
+        const gchar *output = g_ptr_array_index (data.outputs, i);
+
+        g_assert_nonnull (output);
+        g_assert_nonnull (strstr (output, funcs[i]));
+    }
+
+    g_ptr_array_unref (data.outputs);
+}
+
+static void
+result_batch_callback (GObject      *source,
+                       GAsyncResult *result,
+                       gpointer      user_data)
+{
+    BatchData *data = (BatchData *)user_data;
+
+    data->outputs = gdb_session_execute_result_batch_finish (GDB_SESSION (source), result,
+                                                             &data->error);
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_session_execute_result_batch (SessionFixture *fixture,
+                                   gconstpointer   user_data G_GNUC_UNUSED)
+{
+    const gchar *commands[] = {
+        "-break-insert alpha",
+        "-exec-interrupt",
+        "-break-insert beta",
+        NULL
+    };
+    BatchData data = { fixture->loop, NULL, NULL };
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+    GdbCommandResult *result;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    gdb_session_execute_result_batch_async (fixture->session, commands, NULL,
+                                            result_batch_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    /* A rejected command does not fail the batch */
+    g_assert_no_error (data.error);
+    g_assert_nonnull (data.outputs);
+    g_assert_cmpuint (data.outputs->len, ==, 3);
+
+    result = g_ptr_array_index (data.outputs, 0);
+    g_assert_false (gdb_command_result_is_error (result));
+    g_assert_cmpint (gdb_command_result_get_result_class (result), ==, GDB_MI_RESULT_DONE);
+
+    result = g_ptr_array_index (data.outputs, 1);
+    g_assert_true (gdb_command_result_is_error (result));
+    g_assert_cmpstr (gdb_command_result_get_error_message (result), ==,
+                     "The program is not being run.");
+
+    /* Commands after the rejected one still ran */
+    result = g_ptr_array_index (data.outputs, 2);
+    g_assert_false (gdb_command_result_is_error (result));
+    g_assert_nonnull (gdb_command_result_get_result (result));
+
+    g_ptr_array_unref (data.outputs);
+}
+
+typedef struct {
+    GMainLoop *loop;
+    GPtrArray *outputs;
+    GError    *error;
+    gint64     queue_time;
+} QueueData;
+
+static void
+queue_callback (GObject      *source,
+                GAsyncResult *result,
+                gpointer      user_data)
+{
+    QueueData *data = (QueueData *)user_data;
+
+    data->queue_time = gdb_session_execute_get_queue_time (GDB_SESSION (source), result);
+    data->outputs = gdb_session_execute_batch_finish (GDB_SESSION (source), result, &data->error);
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_session_queue_depth (SessionFixture *fixture,
+                          gconstpointer   user_data G_GNUC_UNUSED)
+{
+    const gchar *too_many[] = { "-break-insert a", "-break-insert b", "-break-insert c", NULL };
+    const gchar *fitting[] = { "-break-insert a", "-break-insert b", NULL };
+    QueueData data = { fixture->loop, NULL, NULL, 0 };
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    gdb_session_set_max_queue_depth (fixture->session, 2);
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    /* More commands than the queue holds are refused, not queued */
+    gdb_session_execute_batch_async (fixture->session, too_many, NULL,
+                                     queue_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+        timeout_id = 0;
+    }
+
+    g_assert_error (data.error, GDB_ERROR, GDB_ERROR_QUEUE_FULL);
+    g_assert_null (data.outputs);
+    g_assert_cmpint (data.queue_time, ==, -1);
+    g_clear_error (&data.error);
+
+    /* The refusal released its slots again */
+    gdb_session_execute_batch_async (fixture->session, fitting, NULL,
+                                     queue_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_no_error (data.error);
+    g_assert_nonnull (data.outputs);
+    g_assert_cmpuint (data.outputs->len, ==, 2);
+    g_assert_cmpint (data.queue_time, >=, 0);
+
+    g_ptr_array_unref (data.outputs);
+}
+
+static void
+on_async_record (GdbSession  *session G_GNUC_UNUSED,
+                 GdbMiRecord *record,
+                 gpointer     user_data)
+{
+    gchar **klass = (gchar **)user_data;
+
+    if (gdb_mi_record_get_type_enum (record) == GDB_MI_RECORD_EXEC_ASYNC)
+    {
+        g_free (*klass);
+        *klass = g_strdup (gdb_mi_record_get_class (record));
+    }
+}
+
+static void
+test_session_async_record_signal (SessionFixture *fixture,
+                                  gconstpointer   user_data G_GNUC_UNUSED)
+{
+    ExecuteData data = { fixture->loop, NULL, NULL };
+    g_autofree gchar *last_class = NULL;
+    guint timeout_id = 0;
+    gulong handler_id;
+    TimeoutData timeout_data;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    handler_id = g_signal_connect (fixture->session, "async-record",
+                                   G_CALLBACK (on_async_record), &last_class);
+
+    gdb_session_execute_async (fixture->session, "-exec-run", NULL,
+                               execute_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    /* Emissions are delivered on this thread; flush any still queued */
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+
+    g_signal_handler_disconnect (fixture->session, handler_id);
+
+    g_assert_no_error (data.error);
+    g_assert_cmpstr (last_class, ==, "stopped");
+    g_free (data.output);
+}
+
+
+typedef struct {
+    GdbStopReason  reason;
+    gchar         *func;
+    guint          count;
+} StoppedData;
+
+static void
+on_stopped (GdbSession    *session G_GNUC_UNUSED,
+            GdbStopReason  reason,
+            JsonObject    *details,
+            gpointer       user_data)
+{
+    StoppedData *data = (StoppedData *)user_data;
+
+    data->reason = reason;
+    data->count++;
+
+    g_clear_pointer (&data->func, g_free);
+    if (details != NULL && json_object_has_member (details, "frame"))
+    {
+        JsonObject *frame = json_object_get_object_member (details, "frame");
+
+        data->func = g_strdup (json_object_get_string_member (frame, "func"));
+    }
+}
+
+static void
+test_session_stopped_signal (SessionFixture *fixture,
+                             gconstpointer   user_data G_GNUC_UNUSED)
+{
+    ExecuteData data = { fixture->loop, NULL, NULL };
+    StoppedData stopped = { GDB_STOP_REASON_UNKNOWN, NULL, 0 };
+    guint timeout_id = 0;
+    gulong handler_id;
+    TimeoutData timeout_data;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    handler_id = g_signal_connect (fixture->session, "stopped",
+                                   G_CALLBACK (on_stopped), &stopped);
+
+    /* Mock GDB stops at a breakpoint in main */
+    gdb_session_execute_async (fixture->session, "-exec-run", NULL,
+                               execute_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+
+    g_assert_no_error (data.error);
+    g_clear_pointer (&data.output, g_free);
+    g_assert_cmpuint (stopped.count, ==, 1);
+    g_assert_cmpint (stopped.reason, ==, GDB_STOP_REASON_BREAKPOINT);
+    g_assert_cmpstr (stopped.func, ==, "main");
+    g_assert_cmpint (gdb_session_get_state (fixture->session), ==,
+                     GDB_SESSION_STATE_STOPPED);
+
+    /* Mock GDB runs the program to completion; the session is idle again */
+    gdb_session_execute_async (fixture->session, "-exec-continue", NULL,
+                               execute_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    while (g_main_context_iteration (NULL, FALSE))
+        ;
+
+    g_signal_handler_disconnect (fixture->session, handler_id);
+
+    g_assert_no_error (data.error);
+    g_free (data.output);
+    g_assert_cmpuint (stopped.count, ==, 2);
+    g_assert_cmpint (stopped.reason, ==, GDB_STOP_REASON_EXITED_NORMALLY);
+    g_assert_null (stopped.func);
+    g_assert_cmpint (gdb_session_get_state (fixture->session), ==,
+                     GDB_SESSION_STATE_READY);
+}
+
+typedef struct {
+    GMainLoop     *loop;
+    gchar         *output;
+    guint64        run_id;
+    GdbStopReason  reason;
+    gboolean       stopped;
+    GError        *error;
+} DetachedData;
+
+static void
+detached_callback (GObject      *source,
+                   GAsyncResult *result,
+                   gpointer      user_data)
+{
+    DetachedData *data = (DetachedData *)user_data;
+
+    data->output = gdb_session_execute_detached_finish (GDB_SESSION (source), result,
+                                                        &data->run_id, &data->error);
+    g_main_loop_quit (data->loop);
+}
+
+static void
+wait_for_stop_callback (GObject      *source,
+                        GAsyncResult *result,
+                        gpointer      user_data)
+{
+    DetachedData *data = (DetachedData *)user_data;
+
+    g_clear_pointer (&data->output, g_free);
+    data->stopped = gdb_session_wait_for_stop_finish (GDB_SESSION (source), result,
+                                                      &data->reason, NULL,
+                                                      &data->output, &data->error);
+    g_main_loop_quit (data->loop);
+}
+
+static void
+test_session_execute_detached (SessionFixture *fixture,
+                               gconstpointer   user_data G_GNUC_UNUSED)
+{
+    DetachedData data = { fixture->loop, NULL, 0, GDB_STOP_REASON_UNKNOWN, FALSE, NULL };
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    /* Completes on the prompt after ^running, before the target exits */
+    gdb_session_execute_detached_async (fixture->session, "-exec-continue", NULL,
+                                        detached_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_no_error (data.error);
+    g_assert_nonnull (data.output);
+    g_assert_null (strstr (data.output, "*stopped"));
+    g_assert_cmpuint (data.run_id, >, 0);
+
+    /* The stop is delivered to waiters whether or not it already happened */
+    gdb_session_wait_for_stop_async (fixture->session, data.run_id, NULL,
+                                     wait_for_stop_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_no_error (data.error);
+    g_assert_true (data.stopped);
+    g_assert_cmpint (data.reason, ==, GDB_STOP_REASON_EXITED_NORMALLY);
+    g_assert_nonnull (strstr (data.output, "exited normally"));
+    g_assert_nonnull (strstr (data.output, "*stopped"));
+    g_free (data.output);
+}
+
+static void
+test_session_execute_timeout (SessionFixture *fixture,
+                              gconstpointer   user_data G_GNUC_UNUSED)
+{
+    ExecuteData data = { fixture->loop, NULL, NULL };
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+    gint64 started;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+
+    /* The mock target never stops on its own, so only the deadline ends it */
+    gdb_session_set_timeout_ms (fixture->session, 200);
+    started = g_get_monotonic_time ();
+    gdb_session_execute_async (fixture->session, "-exec-until 99", NULL,
+                               execute_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_error (data.error, GDB_ERROR, GDB_ERROR_TIMEOUT);
+    g_assert_null (data.output);
+    g_assert_cmpint (g_get_monotonic_time () - started, <, 2 * G_TIME_SPAN_SECOND);
+    g_clear_error (&data.error);
+}
+
+static void
+cancel_when_running (GdbSession      *session G_GNUC_UNUSED,
+                     GdbSessionState  old_state G_GNUC_UNUSED,
+                     GdbSessionState  new_state,
+                     gpointer         user_data)
+{
+    if (new_state == GDB_SESSION_STATE_RUNNING)
+    {
+        g_cancellable_cancel (G_CANCELLABLE (user_data));
+    }
+}
+
+static void
+test_session_execute_cancel_interrupts (SessionFixture *fixture,
+                                        gconstpointer   user_data G_GNUC_UNUSED)
+{
+    g_autoptr(GCancellable) cancellable = NULL;
+    ExecuteData data = { fixture->loop, NULL, NULL };
+    DetachedData stop = { fixture->loop, NULL, 0, GDB_STOP_REASON_UNKNOWN, FALSE, NULL };
+    guint timeout_id = 0;
+    TimeoutData timeout_data;
+    gulong handler_id;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    if (!fixture_start_session (fixture))
+    {
+        g_test_skip ("Could not start session");
+        return;
+    }
+
+    timeout_data.loop = fixture->loop;
+    timeout_data.timeout_id_ptr = &timeout_id;
+    cancellable = g_cancellable_new ();
+    handler_id = g_signal_connect (fixture->session, "state-changed",
+                                   G_CALLBACK (cancel_when_running), cancellable);
+
+    /* The mock target only stops when interrupted */
+    gdb_session_execute_async (fixture->session, "-exec-until 99", cancellable,
+                               execute_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+        timeout_id = 0;
+    }
+    g_signal_handler_disconnect (fixture->session, handler_id);
+
+    g_assert_error (data.error, G_IO_ERROR, G_IO_ERROR_CANCELLED);
+    g_assert_null (data.output);
+    g_clear_error (&data.error);
+
+    /* Cancellation interrupted the target rather than leaving it running */
+    gdb_session_wait_for_stop_async (fixture->session, 0, NULL,
+                                     wait_for_stop_callback, &stop);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+        timeout_id = 0;
+    }
+
+    g_assert_no_error (stop.error);
+    g_assert_true (stop.stopped);
+    g_assert_cmpint (stop.reason, ==, GDB_STOP_REASON_SIGNAL);
+    g_free (stop.output);
+
+    /* The cancelled command's output does not leak into the next one */
+    gdb_session_execute_async (fixture->session, "help", NULL,
+                               execute_callback, &data);
+    timeout_id = g_timeout_add (5000, timeout_quit_loop, &timeout_data);
+    g_main_loop_run (fixture->loop);
+    if (timeout_id != 0)
+    {
+        g_source_remove (timeout_id);
+    }
+
+    g_assert_no_error (data.error);
+    g_assert_nonnull (data.output);
+    g_assert_nonnull (strstr (data.output, "List of classes"));
+    g_assert_null (strstr (data.output, "*stopped"));
+    g_free (data.output);
+}
+
+/* ========================================================================== */
+/* Main                                                                       */
+/* ========================================================================== */
+
+int
+main (int   argc,
+      char *argv[])
+{
+    g_autofree gchar *test_dir = NULL;
+    int result;
+
+    g_test_init (&argc, &argv, NULL);
+    dex_init ();
+
+    /* Find mock-gdb.sh path */
+    test_dir = g_path_get_dirname (argv[0]);
+    if (g_str_has_suffix (test_dir, "build"))
+    {
+        /* Running from build directory */
+        mock_gdb_path = g_build_filename (test_dir, "..", "tests", "mock-gdb.sh", NULL);
+    }
+    else
+    {
+        mock_gdb_path = g_build_filename (test_dir, "mock-gdb.sh", NULL);
+    }
+
+    if (!g_file_test (mock_gdb_path, G_FILE_TEST_IS_EXECUTABLE))
+    {
+        g_free (mock_gdb_path);
+        mock_gdb_path = NULL;
+        g_message ("Mock GDB script not found or not executable - some tests will be skipped");
+    }
+
+    /* Construction tests */
+    g_test_add_func ("/gdb/session/new", test_session_new);
+    g_test_add_func ("/gdb/session/new-defaults", test_session_new_defaults);
+    g_test_add_func ("/gdb/session/properties", test_session_properties);
+
+    /* State tests */
+    g_test_add_func ("/gdb/session/initial-state", test_session_initial_state);
+    g_test_add_func ("/gdb/session/start-invalid-path", test_session_start_invalid_path);
+
+    /* Lifecycle tests with fixture */
+    g_test_add ("/gdb/session/start",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_start,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/terminate",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_terminate,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/terminate-on-exit",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_terminate_on_exit,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/unref-stops-gdb",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_unref_stops_gdb,
+                session_fixture_teardown);
+
+    /* Signal tests */
+    g_test_add ("/gdb/session/signal-state-changed",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_state_signal,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/signal-ready",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_ready_signal,
+                session_fixture_teardown);
+
+    /* Execute tests */
+    g_test_add ("/gdb/session/execute-command",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_command,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/execute-framed",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_framed,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/reader-split-record",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_reader_split_record,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/reader-crlf",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_reader_crlf,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/reader-long-line",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_reader_long_line,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/execute-waits-for-stop",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_waits_for_stop,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/execute-mi-token",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_mi_token,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/execute-future",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_future,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/run-futures",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_run_futures,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/execute-in-flight",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_in_flight,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/execute-batch",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_batch,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/execute-result-batch",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_result_batch,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/queue-depth",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_queue_depth,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/signal-async-record",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_async_record_signal,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/signal-stopped",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_stopped_signal,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/execute-detached",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_detached,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/execute-timeout",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_timeout,
+                session_fixture_teardown);
+
+    g_test_add ("/gdb/session/execute-cancel-interrupts",
+                SessionFixture, NULL,
+                session_fixture_setup,
+                test_session_execute_cancel_interrupts,
                 session_fixture_teardown);
 
     result = g_test_run ();
@@ -189,7 +189,7 @@ test_get_session_found (void)
     g_autoptr(GdbSessionManager) manager = NULL;
     g_autoptr(JsonObject) arguments = json_object_new ();
     GdbSession *created_session;
-    GdbSession *found_session;
+    g_autoptr(GdbSession) found_session = NULL;
     const gchar *session_id;
     McpToolResult *error_result = NULL;
 
@@ -181,6 +181,57 @@ test_gdb_finish_missing_session_id (void)
     g_assert_true (mcp_tool_result_get_is_error (result));
 }
 
+static void
+test_gdb_continue_schema_async (void)
+{
+    g_autoptr(JsonNode) schema = NULL;
+    JsonObject *obj;
+    JsonObject *props;
+
+    schema = gdb_tools_create_gdb_continue_schema ();
+    obj = json_node_get_object (schema);
+    props = json_object_get_object_member (obj, "properties");
+
+    g_assert_true (json_object_has_member (props, "sessionId"));
+    g_assert_true (json_object_has_member (props, "async"));
+}
+
+
+/* ========================================================================== */
+/* gdb_wait_for_stop Tests                                                    */
+/* ========================================================================== */
+
+static void
+test_gdb_wait_for_stop_missing_session (void)
+{
+    g_autoptr(GdbSessionManager) manager = gdb_session_manager_new ();
+    g_autoptr(JsonObject) arguments = json_object_new ();
+    g_autoptr(McpToolResult) result = NULL;
+
+    json_object_set_string_member (arguments, "sessionId", "nonexistent");
+    json_object_set_int_member (arguments, "runId", 1);
+
+    result = gdb_tools_handle_gdb_wait_for_stop (NULL, "gdb_wait_for_stop", arguments, manager);
+
+    g_assert_nonnull (result);
+    g_assert_true (mcp_tool_result_get_is_error (result));
+}
+
+static void
+test_gdb_wait_for_stop_schema (void)
+{
+    g_autoptr(JsonNode) schema = NULL;
+    JsonObject *obj;
+    JsonObject *props;
+
+    schema = gdb_tools_create_gdb_wait_for_stop_schema ();
+    obj = json_node_get_object (schema);
+    props = json_object_get_object_member (obj, "properties");
+
+    g_assert_true (json_object_has_member (props, "runId"));
+    g_assert_true (json_object_has_member (props, "timeoutMs"));
+}
+
 
 /* ========================================================================== */
 /* Main                                                                       */
@@ -209,6 +260,11 @@ main (int   argc,
     /* gdb_finish tests */
     g_test_add_func ("/gdb/tools/exec/finish-missing-session", test_gdb_finish_missing_session);
     g_test_add_func ("/gdb/tools/exec/finish-missing-session-id", test_gdb_finish_missing_session_id);
+    g_test_add_func ("/gdb/tools/exec/continue-schema-async", test_gdb_continue_schema_async);
+
+    /* gdb_wait_for_stop tests */
+    g_test_add_func ("/gdb/tools/exec/wait-for-stop-missing-session", test_gdb_wait_for_stop_missing_session);
+    g_test_add_func ("/gdb/tools/exec/wait-for-stop-schema", test_gdb_wait_for_stop_schema);
 
     return g_test_run ();
 }
@@ -11,6 +11,8 @@
 #include "mcp-gdb/gdb-session-manager.h"
 #include "src/tools/gdb-tools-internal.h"
 
+/* Path to mock GDB script */
+static gchar *mock_gdb_path = NULL;
 
 /* ========================================================================== */
 /* Fixture                                                                    */
@@ -310,6 +312,173 @@ test_gdb_command_missing_session_id (void)
 }
 
 
+/* ========================================================================== */
+/* gdb_batch Tests                                                            */
+/* ========================================================================== */
+
+static void
+test_gdb_batch_missing_session (void)
+{
+    g_autoptr(GdbSessionManager) manager = gdb_session_manager_new ();
+    g_autoptr(JsonObject) arguments = json_object_new ();
+    g_autoptr(McpToolResult) result = NULL;
+    JsonArray *commands;
+
+    commands = json_array_new ();
+    json_array_add_string_element (commands, "info threads");
+    json_object_set_string_member (arguments, "sessionId", "nonexistent");
+    json_object_set_array_member (arguments, "commands", commands);
+
+    result = gdb_tools_handle_gdb_batch (NULL, "gdb_batch", arguments, manager);
+
+    g_assert_nonnull (result);
+    g_assert_true (mcp_tool_result_get_is_error (result));
+}
+
+static void
+test_gdb_batch_missing_commands (InspectFixture *fixture,
+                                 gconstpointer   user_data G_GNUC_UNUSED)
+{
+    g_autoptr(JsonObject) arguments = json_object_new ();
+    g_autoptr(McpToolResult) result = NULL;
+
+    json_object_set_string_member (arguments, "sessionId", fixture->session_id);
+    /* Missing "commands" */
+
+    result = gdb_tools_handle_gdb_batch (NULL, "gdb_batch", arguments,
+                                          fixture->manager);
+
+    g_assert_nonnull (result);
+    g_assert_true (mcp_tool_result_get_is_error (result));
+}
+
+static void
+test_gdb_batch_invalid_commands (InspectFixture *fixture,
+                                 gconstpointer   user_data G_GNUC_UNUSED)
+{
+    g_autoptr(McpToolResult) empty_result = NULL;
+    g_autoptr(McpToolResult) mixed_result = NULL;
+    g_autoptr(McpToolResult) long_result = NULL;
+    g_autoptr(JsonObject) arguments = json_object_new ();
+    JsonArray *commands;
+    guint i;
+
+    /* An empty array */
+    json_object_set_string_member (arguments, "sessionId", fixture->session_id);
+    json_object_set_array_member (arguments, "commands", json_array_new ());
+
+    empty_result = gdb_tools_handle_gdb_batch (NULL, "gdb_batch", arguments,
+                                                fixture->manager);
+
+    g_assert_nonnull (empty_result);
+    g_assert_true (mcp_tool_result_get_is_error (empty_result));
+
+    /* A non-string entry */
+    commands = json_array_new ();
+    json_array_add_string_element (commands, "info threads");
+    json_array_add_int_element (commands, 42);
+    json_object_set_array_member (arguments, "commands", commands);
+
+    mixed_result = gdb_tools_handle_gdb_batch (NULL, "gdb_batch", arguments,
+                                                fixture->manager);
+
+    g_assert_nonnull (mixed_result);
+    g_assert_true (mcp_tool_result_get_is_error (mixed_result));
+
+    /* More commands than one call may carry */
+    commands = json_array_new ();
+    for (i = 0; i <= GDB_TOOLS_BATCH_MAX_COMMANDS; i++)
+    {
+        json_array_add_string_element (commands, "info threads");
+    }
+    json_object_set_array_member (arguments, "commands", commands);
+
+    long_result = gdb_tools_handle_gdb_batch (NULL, "gdb_batch", arguments,
+                                               fixture->manager);
+
+    g_assert_nonnull (long_result);
+    g_assert_true (mcp_tool_result_get_is_error (long_result));
+}
+
+static void
+test_gdb_batch_runs (void)
+{
+    g_autoptr(GdbSessionManager) manager = NULL;
+    g_autoptr(JsonObject) start_args = json_object_new ();
+    g_autoptr(JsonObject) arguments = json_object_new ();
+    g_autoptr(McpToolResult) start_result = NULL;
+    g_autoptr(McpToolResult) result = NULL;
+    g_autoptr(JsonNode) node = NULL;
+    JsonArray *commands;
+    JsonArray *content;
+    GList *sessions;
+    const gchar *text;
+    guint i;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    manager = gdb_session_manager_new ();
+    gdb_session_manager_set_default_gdb_path (manager, mock_gdb_path);
+
+    start_result = gdb_tools_handle_gdb_start (NULL, "gdb_start", start_args, manager);
+    g_assert_false (mcp_tool_result_get_is_error (start_result));
+
+    sessions = gdb_session_manager_list_sessions (manager);
+    json_object_set_string_member (arguments, "sessionId",
+                                   gdb_session_get_session_id (sessions->data));
+
+    /* The longest batch allowed, well past the session's queue depth */
+    g_assert_cmpuint (gdb_session_get_max_queue_depth (sessions->data), <,
+                      GDB_TOOLS_BATCH_MAX_COMMANDS);
+    g_list_free_full (sessions, g_object_unref);
+
+    commands = json_array_new ();
+    for (i = 0; i < GDB_TOOLS_BATCH_MAX_COMMANDS; i++)
+    {
+        json_array_add_string_element (commands, "-data-evaluate-expression 1");
+    }
+    json_object_set_array_member (arguments, "commands", commands);
+
+    result = gdb_tools_handle_gdb_batch (NULL, "gdb_batch", arguments, manager);
+
+    g_assert_nonnull (result);
+    g_assert_false (mcp_tool_result_get_is_error (result));
+
+    node = mcp_tool_result_to_json (result);
+    content = json_object_get_array_member (json_node_get_object (node), "content");
+    text = json_object_get_string_member (json_array_get_object_element (content, 0),
+                                          "text");
+    g_assert_true (g_str_has_prefix (text, "Batch: 256 commands, 0 failed"));
+
+    gdb_session_manager_terminate_all (manager);
+}
+
+static void
+test_gdb_batch_schema (void)
+{
+    g_autoptr(JsonNode) schema = NULL;
+    JsonObject *obj;
+    JsonObject *props;
+
+    schema = gdb_tools_create_gdb_batch_schema ();
+
+    g_assert_nonnull (schema);
+
+    obj = json_node_get_object (schema);
+    props = json_object_get_object_member (obj, "properties");
+
+    g_assert_true (json_object_has_member (props, "sessionId"));
+    g_assert_cmpstr (json_object_get_string_member (
+                         json_object_get_object_member (props, "commands"), "type"),
+                     ==, "array");
+    g_assert_true (json_object_has_member (props, "stopOnError"));
+}
+
+
 /* ========================================================================== */
 /* Main                                                                       */
 /* ========================================================================== */
@@ -318,8 +487,30 @@ int
 main (int   argc,
       char *argv[])
 {
+    g_autofree gchar *test_dir = NULL;
+    int result;
+
     g_test_init (&argc, &argv, NULL);
 
+    /* Find mock-gdb.sh path */
+    test_dir = g_path_get_dirname (argv[0]);
+    if (g_str_has_suffix (test_dir, "build"))
+    {
+        /* Running from build directory */
+        mock_gdb_path = g_build_filename (test_dir, "..", "tests", "mock-gdb.sh", NULL);
+    }
+    else
+    {
+        mock_gdb_path = g_build_filename (test_dir, "mock-gdb.sh", NULL);
+    }
+
+    if (!g_file_test (mock_gdb_path, G_FILE_TEST_IS_EXECUTABLE))
+    {
+        g_free (mock_gdb_path);
+        mock_gdb_path = NULL;
+        g_message ("Mock GDB script not found or not executable - some tests will be skipped");
+    }
+
     /* gdb_backtrace tests */
     g_test_add_func ("/gdb/tools/inspect/backtrace-missing-session", test_gdb_backtrace_missing_session);
     g_test_add_func ("/gdb/tools/inspect/backtrace-missing-session-id", test_gdb_backtrace_missing_session_id);
@@ -357,5 +548,24 @@ main (int   argc,
                 inspect_fixture_teardown);
     g_test_add_func ("/gdb/tools/inspect/command-missing-session-id", test_gdb_command_missing_session_id);
 
-    return g_test_run ();
+    /* gdb_batch tests */
+    g_test_add_func ("/gdb/tools/inspect/batch-missing-session", test_gdb_batch_missing_session);
+    g_test_add ("/gdb/tools/inspect/batch-missing-commands",
+                InspectFixture, NULL,
+                inspect_fixture_setup,
+                test_gdb_batch_missing_commands,
+                inspect_fixture_teardown);
+    g_test_add ("/gdb/tools/inspect/batch-invalid-commands",
+                InspectFixture, NULL,
+                inspect_fixture_setup,
+                test_gdb_batch_invalid_commands,
+                inspect_fixture_teardown);
+    g_test_add_func ("/gdb/tools/inspect/batch-runs", test_gdb_batch_runs);
+    g_test_add_func ("/gdb/tools/inspect/batch-schema", test_gdb_batch_schema);
+
+    result = g_test_run ();
+
+    g_free (mock_gdb_path);
+
+    return result;
 }
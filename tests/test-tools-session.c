@@ -107,6 +107,41 @@ test_gdb_start_with_gdb_path (ToolsFixture  *fixture,
     g_list_free_full (sessions, g_object_unref);
 }
 
+static void
+test_gdb_start_fast_profile (ToolsFixture  *fixture,
+                             gconstpointer  user_data G_GNUC_UNUSED)
+{
+    g_autoptr(JsonObject) arguments = json_object_new ();
+    g_autoptr(McpToolResult) result = NULL;
+    GList *sessions;
+    GdbSession *session;
+
+    if (mock_gdb_path == NULL)
+    {
+        g_test_skip ("Mock GDB not available");
+        return;
+    }
+
+    json_object_set_string_member (arguments, "startupProfile", "fast");
+    json_object_set_string_member (arguments, "autoLoadSafePath", "/tmp");
+
+    result = gdb_tools_handle_gdb_start (NULL, "gdb_start", arguments,
+                                          fixture->manager);
+
+    g_assert_nonnull (result);
+    g_assert_false (mcp_tool_result_get_is_error (result));
+
+    /* The options reach the session and startup is timed */
+    sessions = gdb_session_manager_list_sessions (fixture->manager);
+    g_assert_nonnull (sessions);
+    session = GDB_SESSION (sessions->data);
+    g_assert_cmpint (gdb_session_get_startup_profile (session), ==, GDB_STARTUP_PROFILE_FAST);
+    g_assert_cmpstr (gdb_session_get_auto_load_safe_path (session), ==, "/tmp");
+    g_assert_cmpint (gdb_session_get_startup_time (session), >=, 0);
+
+    g_list_free_full (sessions, g_object_unref);
+}
+
 static void
 test_gdb_start_with_working_dir (ToolsFixture  *fixture,
                                  gconstpointer  user_data G_GNUC_UNUSED)
@@ -353,6 +388,12 @@ main (int   argc,
                 test_gdb_start_with_gdb_path,
                 tools_fixture_teardown);
 
+    g_test_add ("/gdb/tools/session/start-fast-profile",
+                ToolsFixture, NULL,
+                tools_fixture_setup,
+                test_gdb_start_fast_profile,
+                tools_fixture_teardown);
+
     g_test_add ("/gdb/tools/session/start-with-working-dir",
                 ToolsFixture, NULL,
                 tools_fixture_setup,